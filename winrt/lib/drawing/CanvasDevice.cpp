@@ -434,6 +434,78 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    // Keeps the device alive for as long as the pool is being used.
+    class DeviceContextPoolAccess
+    {
+        ComPtr<ICanvasDeviceInternal> m_device;
+        DeviceContextPool* m_pool;
+
+    public:
+        DeviceContextPoolAccess(ICanvasResourceCreator* resourceCreator)
+        {
+            ComPtr<ICanvasDevice> device;
+            ThrowIfFailed(resourceCreator->get_Device(&device));
+
+            m_device = As<ICanvasDeviceInternal>(device);
+            m_pool = m_device->GetDeviceContextPool();
+            ThrowIfNullPointer(m_pool, RO_E_CLOSED);
+        }
+
+        DeviceContextPool* operator->()
+        {
+            return m_pool;
+        }
+    };
+
+    IFACEMETHODIMP CanvasDeviceFactory::GetDeviceContextPoolStatistics(
+        ICanvasResourceCreator* resourceCreator,
+        CanvasDeviceContextPoolStatistics* statistics)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(statistics);
+
+                auto poolStatistics = DeviceContextPoolAccess(resourceCreator)->GetStatistics();
+
+                statistics->LeaseCount = poolStatistics.LeaseCount;
+                statistics->MissCount = poolStatistics.MissCount;
+                statistics->CreatedCount = poolStatistics.CreatedCount;
+                statistics->DiscardedCount = poolStatistics.DiscardedCount;
+                statistics->ActiveLeaseCount = poolStatistics.ActiveLeaseCount;
+                statistics->PeakActiveLeaseCount = poolStatistics.PeakActiveLeaseCount;
+            });
+    }
+
+    IFACEMETHODIMP CanvasDeviceFactory::GetDeviceContextPoolMaximumSize(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t* maximumSize)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(maximumSize);
+
+                *maximumSize = DeviceContextPoolAccess(resourceCreator)->GetMaxPoolSize();
+            });
+    }
+
+    IFACEMETHODIMP CanvasDeviceFactory::SetDeviceContextPoolMaximumSize(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t maximumSize)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+
+                DeviceContextPoolAccess(resourceCreator)->SetMaxPoolSize(maximumSize);
+            });
+    }
+
+
     //
     // ICanvasFactoryNative.
     //
@@ -449,7 +521,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 CheckInPointer(resource);
                 CheckAndClearOutPointer(wrapper);
 
-                auto result = ResourceManager::GetOrCreate(device, resource, dpi);
+                auto result = ResourceManager::GetOrCreateFromInterop(device, resource, dpi);
 
                 ThrowIfFailed(result.CopyTo(wrapper));
             });
@@ -469,6 +541,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         , m_dxgiDevice(dxgiDevice)
         , m_sharedState(SharedDeviceState::GetInstance())
         , m_deviceContextPool(d2dDevice)
+        , m_histogramEffectPool(std::make_shared<HistogramEffectPool>())
+        , m_textLayoutCache(std::make_shared<Text::TextLayoutCache>())
 #if WINVER > _WIN32_WINNT_WINBLUE
         , m_spriteBatchQuirk(SpriteBatchQuirk::NeedsCheck)
 #endif
@@ -712,6 +786,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                     ThrowHR(E_INVALIDARG, Strings::DeviceExpectedToBeLost);
                 }
 
+                // Apps recreate their resources when the device is lost, so
+                // cached layouts would only be holding on to memory.
+                if (auto cache = std::atomic_load(&m_textLayoutCache))
+                    cache->Clear();
+
                 ThrowIfFailed(m_deviceLostEventList.InvokeAll(this, nullptr));
             });
     }
@@ -741,8 +820,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 m_dxgiDevice.Close();
                 m_primaryOutput.Reset();
                 m_sharedState.reset();
-                m_histogramEffect.Reset();
-                m_atlasEffect.Reset();
+
+                if (auto pool = std::atomic_exchange(&m_histogramEffectPool, std::shared_ptr<HistogramEffectPool>()))
+                    pool->Clear();
+
+                if (auto cache = std::atomic_exchange(&m_textLayoutCache, std::shared_ptr<Text::TextLayoutCache>()))
+                    cache->Clear();
         });
     }
 
@@ -1034,6 +1117,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 auto& d2dDevice = GetResource();
                 auto& dxgiDevice = m_dxgiDevice.EnsureNotClosed();
 
+                if (auto cache = std::atomic_load(&m_textLayoutCache))
+                    cache->Clear();
+
+                if (auto pool = std::atomic_load(&m_histogramEffectPool))
+                    pool->Clear();
+
                 D2DResourceLock lock(d2dDevice.Get());
 
                 d2dDevice->ClearResources();
@@ -1276,6 +1365,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         return m_deviceContextPool.TakeLease();
     }
 
+    DeviceContextPool* CanvasDevice::GetDeviceContextPool()
+    {
+        return HasResource() ? &m_deviceContextPool : nullptr;
+    }
+
     void CanvasDevice::InitializePrimaryOutput(IDXGIDevice3* dxgiDevice)
     {
         D2DResourceLock lock(GetResource().Get());
@@ -1334,40 +1428,36 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ThrowIfFailed(hr);
     }
 
-    static ComPtr<ID2D1Effect> InterlockedExchangeComPtr(ComPtr<ID2D1Effect>& target, ComPtr<ID2D1Effect>&& value)
+    CanvasDevice::HistogramAndAtlasEffects CanvasDevice::LeaseHistogramEffect(ID2D1DeviceContext* d2dContext)
     {
-        auto addressOfTarget = reinterpret_cast<void* volatile*>(target.GetAddressOf());
+        if (auto pool = GetHistogramEffectPool())
+            return pool->Lease(d2dContext);
 
-        auto exchanged = InterlockedExchangePointer(addressOfTarget, value.Detach());
+        // The device has been closed, so there is nowhere to return these effects to.
+        HistogramAndAtlasEffects effects;
 
-        ComPtr<ID2D1Effect> result;
-        result.Attach(reinterpret_cast<ID2D1Effect*>(exchanged));
-        return result;
+        ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Histogram, &effects.HistogramEffect));
+        ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Atlas, &effects.AtlasEffect));
+
+        return effects;
     }
 
-    CanvasDevice::HistogramAndAtlasEffects CanvasDevice::LeaseHistogramEffect(ID2D1DeviceContext* d2dContext)
+    void CanvasDevice::ReleaseHistogramEffect(HistogramAndAtlasEffects&& effects)
     {
-        ComPtr<ID2D1Effect> histogram = InterlockedExchangeComPtr(m_histogramEffect, nullptr);
-
-        if (!histogram)
-        {
-            ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Histogram, &histogram));
-        }
-
-        ComPtr<ID2D1Effect> atlas = InterlockedExchangeComPtr(m_atlasEffect, nullptr);
-
-        if (!atlas)
-        {
-            ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Atlas, &atlas));
-        }
+        if (auto pool = GetHistogramEffectPool())
+            pool->Release(std::move(effects));
+        else
+            effects = HistogramAndAtlasEffects{};
+    }
 
-        return HistogramAndAtlasEffects{ histogram, atlas };
+    std::shared_ptr<HistogramEffectPool> CanvasDevice::GetHistogramEffectPool()
+    {
+        return std::atomic_load(&m_histogramEffectPool);
     }
 
-    void CanvasDevice::ReleaseHistogramEffect(HistogramAndAtlasEffects&& effects)
+    std::shared_ptr<Text::TextLayoutCache> CanvasDevice::GetTextLayoutCache()
     {
-        InterlockedExchangeComPtr(m_histogramEffect, std::move(effects.HistogramEffect));
-        InterlockedExchangeComPtr(m_atlasEffect, std::move(effects.AtlasEffect));
+        return std::atomic_load(&m_textLayoutCache);
     }
 
 #if WINVER > _WIN32_WINNT_WINBLUE
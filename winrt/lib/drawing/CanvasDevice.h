@@ -5,6 +5,8 @@
 #pragma once
 
 #include "DeviceContextPool.h"
+#include "HistogramEffectPool.h"
+#include "text/TextLayoutCache.h"
 #include "Utils/GuidUtilities.h"
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
@@ -153,19 +155,24 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual DeviceContextLease GetResourceCreationDeviceContext() = 0;
 
+        // Returns null once the device has been closed.
+        virtual DeviceContextPool* GetDeviceContextPool() = 0;
+
         virtual ComPtr<IDXGIOutput> GetPrimaryDisplayOutput() = 0;
 
         virtual void ThrowIfCreateSurfaceFailed(HRESULT hr, wchar_t const* typeName, uint32_t width, uint32_t height) = 0;
 
-        struct HistogramAndAtlasEffects
-        {
-            ComPtr<ID2D1Effect> HistogramEffect;
-            ComPtr<ID2D1Effect> AtlasEffect;
-        };
+        typedef ABI::Microsoft::Graphics::Canvas::HistogramAndAtlasEffects HistogramAndAtlasEffects;
 
         virtual HistogramAndAtlasEffects LeaseHistogramEffect(ID2D1DeviceContext* d2dContext) = 0;
         virtual void ReleaseHistogramEffect(HistogramAndAtlasEffects&& effects) = 0;
 
+        // Returns null once the device has been closed.
+        virtual std::shared_ptr<HistogramEffectPool> GetHistogramEffectPool() = 0;
+
+        // Returns null once the device has been closed.
+        virtual std::shared_ptr<Text::TextLayoutCache> GetTextLayoutCache() = 0;
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(D2D1_GRADIENT_MESH_PATCH const* patches, uint32_t patchCount) = 0;
 
@@ -209,8 +216,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         DeviceContextPool m_deviceContextPool;
 
-        ComPtr<ID2D1Effect> m_histogramEffect;
-        ComPtr<ID2D1Effect> m_atlasEffect;
+        // Histogram and atlas effects used by CanvasImage.ComputeHistogram(s).
+        std::shared_ptr<HistogramEffectPool> m_histogramEffectPool;
+
+        // Layouts created by CanvasTextLayout.CreateCached.
+        std::shared_ptr<Text::TextLayoutCache> m_textLayoutCache;
 
 #if WINVER > _WIN32_WINNT_WINBLUE
         std::mutex m_quirkMutex;
@@ -357,6 +367,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             float dpi) override;
 
         virtual DeviceContextLease GetResourceCreationDeviceContext() override final;
+        virtual DeviceContextPool* GetDeviceContextPool() override;
 
         virtual ComPtr<IDXGIOutput> GetPrimaryDisplayOutput() override;
 
@@ -364,6 +375,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         virtual HistogramAndAtlasEffects LeaseHistogramEffect(ID2D1DeviceContext* d2dContext) override;
         virtual void ReleaseHistogramEffect(HistogramAndAtlasEffects&& effects) override;
+        virtual std::shared_ptr<HistogramEffectPool> GetHistogramEffectPool() override;
+
+        virtual std::shared_ptr<Text::TextLayoutCache> GetTextLayoutCache() override;
 
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(D2D1_GRADIENT_MESH_PATCH const* patches, uint32_t patchCount) override;
@@ -504,6 +518,18 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHOD(put_DebugLevel)(CanvasDebugLevel debugLevel);
         IFACEMETHOD(get_DebugLevel)(CanvasDebugLevel* debugLevel);
 
+        IFACEMETHOD(GetDeviceContextPoolStatistics)(
+            ICanvasResourceCreator* resourceCreator,
+            CanvasDeviceContextPoolStatistics* statistics) override;
+
+        IFACEMETHOD(GetDeviceContextPoolMaximumSize)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t* maximumSize) override;
+
+        IFACEMETHOD(SetDeviceContextPoolMaximumSize)(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t maximumSize) override;
+
         //
         // ICanvasFactoryNative.
         //
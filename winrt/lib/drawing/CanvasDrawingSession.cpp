@@ -6,6 +6,7 @@
 
 #include "CanvasActiveLayer.h"
 #include "CanvasSpriteBatch.h"
+#include "DrawBitmapBatcher.h"
 #include "text/CanvasTextFormat.h"
 #include "text/CanvasTextRenderingParameters.h"
 #include "text/CanvasFontFace.h"
@@ -159,6 +160,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             [&]
             {
                 auto deviceContext = MaybeGetResource();
+
+                // Draw anything that BatchBitmapDraws is still holding back.
+                FlushBitmapDraws();
         
                 ReleaseResource();
 
@@ -182,10 +186,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
                 m_solidColorBrush.Reset();
                 m_defaultTextFormat.Reset();
+                m_drawImageEffects.Clear();
                 m_owner.Reset();
 #if WINVER > _WIN32_WINNT_WINBLUE
                 m_inkD2DRenderer.Reset();
                 m_inkStateBlock.Reset();
+                m_bitmapBatcher.reset();
 #endif
             });
     }
@@ -223,6 +229,91 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+    IFACEMETHODIMP CanvasDrawingSession::get_BatchBitmapDraws(boolean* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ResourceWrapper::GetResource();
+
+                *value = static_cast<bool>(m_bitmapBatcher);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasDrawingSession::put_BatchBitmapDraws(boolean value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto& deviceContext = GetResource();
+
+                if (!value)
+                {
+                    m_bitmapBatcher.reset();
+                    return;
+                }
+
+                if (m_bitmapBatcher)
+                    return;
+
+                // Without sprite batch support, bitmaps are simply drawn one at a time.
+                auto deviceContext3 = MaybeAs<ID2D1DeviceContext3>(deviceContext);
+                if (!deviceContext3)
+                    return;
+
+                auto isSpriteBatchQuirkRequired = As<ICanvasDeviceInternal>(GetDevice())->IsSpriteBatchQuirkRequired();
+
+                m_bitmapBatcher = std::make_unique<DrawBitmapBatcher>(deviceContext3.Get(), isSpriteBatchQuirkRequired);
+            });
+    }
+
+#endif
+
+
+    IFACEMETHODIMP CanvasDrawingSession::GetNativeResource(ICanvasDevice* device, float dpi, REFIID iid, void** resource)
+    {
+        // Interop code may draw straight to the device context, so it must not
+        // overtake bitmaps that BatchBitmapDraws is holding back.
+        HRESULT hr = ExceptionBoundary([&] { FlushBitmapDraws(); });
+
+        if (FAILED(hr))
+            return hr;
+
+        return ResourceWrapper::GetNativeResource(device, dpi, iid, resource);
+    }
+
+
+    ComPtr<ID2D1DeviceContext1> const& CanvasDrawingSession::GetResource()
+    {
+        FlushBitmapDraws();
+
+        return ResourceWrapper::GetResource();
+    }
+
+
+    DrawBitmapBatcher* CanvasDrawingSession::GetBitmapBatcher()
+    {
+#if WINVER > _WIN32_WINNT_WINBLUE
+        return m_bitmapBatcher.get();
+#else
+        return nullptr;
+#endif
+    }
+
+
+    void CanvasDrawingSession::FlushBitmapDraws()
+    {
+#if WINVER > _WIN32_WINNT_WINBLUE
+        if (m_bitmapBatcher)
+            m_bitmapBatcher->Flush();
+#endif
+    }
+
+
     // 
     // DrawImage
     //  
@@ -426,6 +517,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         ICanvasDevice* m_canvasDevice;
         ID2D1DeviceContext1* m_deviceContext;
+        DrawImageEffectPool* m_effectPool;
+        DrawBitmapBatcher* m_bitmapBatcher;
         Vector2* m_offset;
         Rect* m_destinationRect;
         Rect* m_sourceRect;
@@ -437,9 +530,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         ComPtr<ID2D1Image> m_borderEffectOutput;
 
     public:
-        DrawImageWorker(ICanvasDevice* canvasDevice, ID2D1DeviceContext1* deviceContext, Vector2* offset, Rect* destinationRect, Rect* sourceRect, float opacity, CanvasImageInterpolation interpolation)
+        DrawImageWorker(ICanvasDevice* canvasDevice, ID2D1DeviceContext1* deviceContext, DrawImageEffectPool* effectPool, DrawBitmapBatcher* bitmapBatcher, Vector2* offset, Rect* destinationRect, Rect* sourceRect, float opacity, CanvasImageInterpolation interpolation)
             : m_canvasDevice(canvasDevice)
             , m_deviceContext(deviceContext)
+            , m_effectPool(effectPool)
+            , m_bitmapBatcher(bitmapBatcher)
             , m_offset(offset)
             , m_destinationRect(destinationRect)
             , m_sourceRect(sourceRect)
@@ -472,6 +567,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             {
                 // If DrawBitmap cannot handle this request, we must use the DrawImage slow path.
 
+                FlushBitmapDraws();
+
                 auto internalImage = As<ICanvasImageInternal>(image);
                 auto d2dImage = internalImage->GetD2DImage(m_canvasDevice, m_deviceContext);
 
@@ -493,6 +590,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
             auto d2dDestRect = CalculateDestRect(d2dBitmap.Get());
 
+#if WINVER > _WIN32_WINNT_WINBLUE
+            if (m_bitmapBatcher)
+            {
+                if (!perspective &&
+                    m_bitmapBatcher->TryAdd(d2dBitmap.Get(), d2dDestRect, m_opacity, static_cast<D2D1_INTERPOLATION_MODE>(m_interpolation), GetD2DSourceRect()))
+                {
+                    return;
+                }
+
+                m_bitmapBatcher->Flush();
+            }
+#endif
+
             m_deviceContext->DrawBitmap(
                 d2dBitmap.Get(),
                 &d2dDestRect,
@@ -502,6 +612,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 ReinterpretAs<D2D1_MATRIX_4X4_F*>(perspective));
         }
 
+        void FlushBitmapDraws()
+        {
+#if WINVER > _WIN32_WINNT_WINBLUE
+            if (m_bitmapBatcher)
+                m_bitmapBatcher->Flush();
+#endif
+        }
+
         void DrawImageAtOffset(
             ID2D1Image* d2dImage,
             Vector2 offset,
@@ -551,9 +669,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             if (m_opacity >= 1.0f)
                 return d2dImage;
 
-            ComPtr<ID2D1Effect> opacityEffect;
-
-            ThrowIfFailed(m_deviceContext->CreateEffect(CLSID_D2D1ColorMatrix, &opacityEffect));
+            auto opacityEffect = m_effectPool->GetEffect(m_deviceContext, CLSID_D2D1ColorMatrix);
 
             if (auto bitmap = MaybeAs<ID2D1Bitmap>(d2dImage))
             {
@@ -562,7 +678,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 // the bitmap's DPI before passing it to the color matrix effect
                 // (since effects by default ignore a bitmap's DPI).
                 //
-                ThrowIfFailed(D2D1::SetDpiCompensatedEffectInput(m_deviceContext, opacityEffect.Get(), 0, bitmap.Get()));
+                m_effectPool->SetDpiCompensatedEffectInput(m_deviceContext, opacityEffect, 0, bitmap.Get());
             }
             else
             {
@@ -704,9 +820,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             // image, but it is non trivial to detect that for different filter modes, and this
             // is a slow path in any case so we keep it simple and always add the border.
 
-            ComPtr<ID2D1Effect> borderEffect;
-            ThrowIfFailed(m_deviceContext->CreateEffect(CLSID_D2D1Border, &borderEffect));
-            ThrowIfFailed(D2D1::SetDpiCompensatedEffectInput(m_deviceContext, borderEffect.Get(), 0, d2dBitmap.Get()));
+            auto borderEffect = m_effectPool->GetEffect(m_deviceContext, CLSID_D2D1Border);
+            m_effectPool->SetDpiCompensatedEffectInput(m_deviceContext, borderEffect, 0, d2dBitmap.Get());
 
             borderEffect->GetOutput(&m_borderEffectOutput);
             return m_borderEffectOutput.Get();
@@ -732,10 +847,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         return ExceptionBoundary([&]
         {
-            auto& deviceContext = GetResource();
+            auto& deviceContext = ResourceWrapper::GetResource();
             CheckInPointer(image);
 
-            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), offset, destinationRect, sourceRect, opacity, interpolation).DrawImage(image, composite);
+            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), &m_drawImageEffects, GetBitmapBatcher(), offset, destinationRect, sourceRect, opacity, interpolation).DrawImage(image, composite);
         });
 
     }
@@ -751,10 +866,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {        
         return ExceptionBoundary([&]
         {
-            auto& deviceContext = GetResource();
+            auto& deviceContext = ResourceWrapper::GetResource();
             CheckInPointer(bitmap);
 
-            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), offset, destinationRect, sourceRect, opacity, interpolation).DrawBitmap(bitmap, perspective);
+            DrawImageWorker(GetDevice().Get(), deviceContext.Get(), &m_drawImageEffects, GetBitmapBatcher(), offset, destinationRect, sourceRect, opacity, interpolation).DrawBitmap(bitmap, perspective);
         });
     }
 
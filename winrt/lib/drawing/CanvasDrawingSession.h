@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "DrawImageEffectPool.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
@@ -18,6 +20,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     using namespace ::Microsoft::WRL;
 
+    class DrawBitmapBatcher;
+
     class ICanvasDrawingSessionAdapter
     {
     public:
@@ -67,6 +71,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         std::vector<int> m_activeLayerIds;
         int m_nextLayerId;
 
+        // Opacity, border and DPI compensation effects reused by DrawImage.
+        DrawImageEffectPool m_drawImageEffects;
+
         //
         // Contract:
         //     Drawing sessions created conventionally initialize this member.
@@ -83,6 +90,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 #if WINVER > _WIN32_WINNT_WINBLUE
         ComPtr<IInkD2DRenderer> m_inkD2DRenderer;
         ComPtr<ID2D1DrawingStateBlock1> m_inkStateBlock;
+
+        // Set while BatchBitmapDraws is enabled.
+        std::unique_ptr<DrawBitmapBatcher> m_bitmapBatcher;
 #endif
 
     public:
@@ -117,6 +127,26 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         IFACEMETHOD(Flush)() override;
 
+#if WINVER > _WIN32_WINNT_WINBLUE
+        IFACEMETHOD(get_BatchBitmapDraws)(boolean* value) override;
+        IFACEMETHOD(put_BatchBitmapDraws)(boolean value) override;
+#endif
+
+        // ICanvasResourceWrapperNative
+
+        IFACEMETHOD(GetNativeResource)(ICanvasDevice* device, float dpi, REFIID iid, void** resource) override;
+
+        //
+        // Hides ResourceWrapper::GetResource, so anything that uses the device
+        // context first draws any bitmaps that BatchBitmapDraws has held back.
+        // This keeps drawing in order, and makes sure that state changes (eg.
+        // to the transform) only apply to later drawing.
+        //
+        // DrawImage and DrawBitmap call ResourceWrapper::GetResource directly,
+        // because they decide for themselves whether to flush.
+        //
+        ComPtr<ID2D1DeviceContext1> const& GetResource();
+
         // 
         // DrawImage
         // 
@@ -303,6 +333,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         IFACEMETHODIMP ConvertPixelsToDips(int pixels, float* dips) override;
         IFACEMETHODIMP ConvertDipsToPixels(float dips, CanvasDpiRounding dpiRounding, int* pixels) override;
 
+        DrawImageEffectPoolStatistics const& GetDrawImageEffectStatistics() const { return m_drawImageEffects.GetStatistics(); }
+
     private:
         void DrawLineImpl(
             Vector2 const& p0,
@@ -423,6 +455,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
         ComPtr<ICanvasDevice> const& GetDevice();
 
+        DrawBitmapBatcher* GetBitmapBatcher();
+        void FlushBitmapDraws();
+
         static void InitializeDefaultState(ID2D1DeviceContext1* deviceContext);
     };
 
@@ -9,6 +9,7 @@
 #include <WindowsNumerics.h>
 
 #include "CanvasSpriteBatch.h"
+#include "utils/SpriteTransforms.h"
 
 using namespace ::Windows::Foundation::Numerics;
 
@@ -42,13 +43,18 @@ IFACEMETHODIMP CanvasSpriteBatchStatics::IsSupported(ICanvasDevice* device, bool
 Vector4 const CanvasSpriteBatch::DEFAULT_TINT{ 1.0f, 1.0f, 1.0f, 1.0f };
 
 
-static D2D1_RECT_F MakeDestRect(ComPtr<ID2D1Bitmap> const& d2dBitmap, Vector2 offset = Vector2{ 0, 0 })
+static D2D1_RECT_F MakeDestRect(D2D1_SIZE_F sizeInDips, Vector2 offset)
 {
-    auto sizeInDips = d2dBitmap->GetSize();
     return D2D1_RECT_F{ offset.X, offset.Y, offset.X + sizeInDips.width, offset.Y + sizeInDips.height };
 }
 
 
+static D2D1_RECT_F MakeDestRect(ComPtr<ID2D1Bitmap> const& d2dBitmap, Vector2 offset = Vector2{ 0, 0 })
+{
+    return MakeDestRect(d2dBitmap->GetSize(), offset);
+}
+
+
 static D2D1_RECT_F MakeDestRect(Rect sourceRect, Vector2 offset = Vector2{ 0, 0 })
 {
     return D2D1_RECT_F{ offset.X, offset.Y, offset.X + sourceRect.Width, offset.Y + sourceRect.Height };
@@ -77,13 +83,19 @@ static D2D1_RECT_U MakeSourceRect(ComPtr<ID2D1Bitmap> const& d2dBitmap, CanvasSp
 }
 
 
-static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, D2D1_UNIT_MODE unitMode, ICanvasBitmap* bitmap, Rect sourceRect)
+static float GetSourceRectDpi(D2D1_UNIT_MODE unitMode, ICanvasBitmap* bitmap)
 {
-    float dpi = 96.0f;
+    float dpi = DEFAULT_DPI;
 
     if (unitMode == D2D1_UNIT_MODE_DIPS)
         ThrowIfFailed(As<ICanvasResourceCreatorWithDpi>(bitmap)->get_Dpi(&dpi));
-    
+
+    return dpi;
+}
+
+
+static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, float dpi, Rect sourceRect)
+{
     auto sourceLeft   = DipsToPixels(sourceRect.X,      dpi, CanvasDpiRounding::Round);
     auto sourceTop    = DipsToPixels(sourceRect.Y,      dpi, CanvasDpiRounding::Round);
     auto sourceWidth  = DipsToPixels(sourceRect.Width,  dpi, CanvasDpiRounding::Round);
@@ -101,8 +113,21 @@ static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, D2D1_UNIT_MODE unitMode
 }
 
 
-static float3x2 MakeTransform(Vector2 const& origin, float rotation, Vector2 const& scale, Vector2 const& offset)
+static D2D1_RECT_U MakeSourceRect(CanvasSpriteFlip flip, D2D1_UNIT_MODE unitMode, ICanvasBitmap* bitmap, Rect sourceRect)
+{
+    return MakeSourceRect(flip, GetSourceRectDpi(unitMode, bitmap), sourceRect);
+}
+
+
+static float3x2 MakeTransform(Vector2 const& origin, float rotation, Vector2 const& scale, Vector2 const& offset, bool useFastRotation)
 {
+    if (useFastRotation)
+    {
+        float3x2 transform;
+        ComputeSpriteTransform(offset.X, offset.Y, origin.X, origin.Y, rotation, scale.X, scale.Y, SinCosMode::Fast, &transform.m11);
+        return transform;
+    }
+
     return
         make_float3x2_translation(-origin.X, -origin.Y) *
         make_float3x2_rotation(rotation) *
@@ -121,6 +146,7 @@ CanvasSpriteBatch::CanvasSpriteBatch(
     , m_interpolationMode(interpolation)
     , m_spriteOptions(options)
     , m_unitMode(deviceContext->GetUnitMode())
+    , m_useFastRotation(false)
 {
     assert(m_sortMode == CanvasSpriteSortMode::None
         || m_sortMode == CanvasSpriteSortMode::Bitmap);
@@ -269,7 +295,7 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawAtOffsetWithTintAndTransform(
         auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
         auto d2dDestRect = MakeDestRect(d2dBitmap);
         auto d2dSourceRect = MakeSourceRect(d2dBitmap, flip);
-        auto transform = MakeTransform(origin, rotation, scale, offset);
+        auto transform = MakeTransform(origin, rotation, scale, offset, m_useFastRotation);
 
         m_sprites.emplace_back(
             std::move(d2dBitmap),
@@ -420,7 +446,7 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetAtOffsetWithTintAndTransfor
         auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
         auto d2dDestRect = MakeDestRect(sourceRect);
         auto d2dSourceRect = MakeSourceRect(flip, m_unitMode, bitmap, sourceRect);
-        auto transform = MakeTransform(origin, rotation, scale, offset);
+        auto transform = MakeTransform(origin, rotation, scale, offset, m_useFastRotation);
 
         m_sprites.emplace_back(
             std::move(d2dBitmap),
@@ -432,6 +458,234 @@ IFACEMETHODIMP CanvasSpriteBatch::DrawFromSpriteSheetAtOffsetWithTintAndTransfor
 }
 
 
+IFACEMETHODIMP CanvasSpriteBatch::get_UseFastRotation(
+    boolean* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+        EnsureNotClosed();
+
+        *value = m_useFastRotation;
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::put_UseFastRotation(
+    boolean value)
+{
+    return ExceptionBoundary([&]
+    {
+        EnsureNotClosed();
+
+        m_useFastRotation = !!value;
+    });
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyAtOffsets(
+    ICanvasBitmap* bitmap,
+    uint32_t offsetCount,
+    Vector2* offsets)
+{
+    return DrawManyFromSpriteSheet(bitmap, offsetCount, offsets, 0, nullptr, 0, nullptr, 0, nullptr, 0, nullptr);
+}
+
+
+// The optional DrawMany arrays may either be empty, in which case a default
+// is used for every sprite, or have one element per offset.
+static bool ValidateOptionalArray(wchar_t const* name, uint32_t expectedCount, uint32_t actualCount, void const* elements)
+{
+    if (actualCount == 0)
+        return false;
+
+    if (actualCount != expectedCount)
+    {
+        WinStringBuilder message;
+        message.Format(Strings::WrongNamedArrayLength, name, expectedCount, actualCount);
+        ThrowHR(E_INVALIDARG, message.Get());
+    }
+
+    CheckInPointer(elements);
+    return true;
+}
+
+
+IFACEMETHODIMP CanvasSpriteBatch::DrawManyFromSpriteSheet(
+    ICanvasBitmap* bitmap,
+    uint32_t offsetCount,
+    Vector2* offsets,
+    uint32_t sourceRectCount,
+    Rect* sourceRects,
+    uint32_t tintCount,
+    Vector4* tints,
+    uint32_t rotationCount,
+    float* rotations,
+    uint32_t scaleCount,
+    Vector2* scales)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(bitmap);
+        EnsureNotClosed();
+
+        if (offsetCount == 0)
+            return;
+
+        CheckInPointer(offsets);
+
+        bool hasSourceRects = ValidateOptionalArray(L"sourceRects", offsetCount, sourceRectCount, sourceRects);
+        bool hasTints       = ValidateOptionalArray(L"tints",       offsetCount, tintCount,       tints);
+        bool hasRotations   = ValidateOptionalArray(L"rotations",   offsetCount, rotationCount,   rotations);
+        bool hasScales      = ValidateOptionalArray(L"scales",      offsetCount, scaleCount,      scales);
+        bool hasTransforms  = hasRotations || hasScales;
+
+        //
+        // Everything that depends only on the bitmap is looked up once, rather
+        // than once per sprite as the single-sprite Draw methods do.
+        //
+
+        auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+        auto bitmapSize = d2dBitmap->GetSize();
+        auto fullSourceRect = MakeSourceRect(d2dBitmap, CanvasSpriteFlip::None);
+        auto sourceRectDpi = hasSourceRects ? GetSourceRectDpi(m_unitMode, bitmap) : DEFAULT_DPI;
+
+        auto firstNewSprite = m_sprites.size();
+        m_sprites.reserve(firstNewSprite + offsetCount);
+
+        for (uint32_t i = 0; i < offsetCount; ++i)
+        {
+            auto const& tint = hasTints ? tints[i] : DEFAULT_TINT;
+
+            auto d2dSourceRect = hasSourceRects
+                ? MakeSourceRect(CanvasSpriteFlip::None, sourceRectDpi, sourceRects[i])
+                : fullSourceRect;
+
+            // When there's a transform the offset is applied by the transform
+            // rather than the destination rect.
+            auto destOffset = hasTransforms ? Vector2{ 0, 0 } : offsets[i];
+
+            auto d2dDestRect = hasSourceRects
+                ? MakeDestRect(sourceRects[i], destOffset)
+                : MakeDestRect(bitmapSize, destOffset);
+
+            m_sprites.emplace_back(
+                ComPtr<ID2D1Bitmap>(d2dBitmap),
+                d2dDestRect,
+                d2dSourceRect,
+                tint);
+        }
+
+        //
+        // The transforms are built in bulk, straight into the sprite storage.
+        //
+
+        if (hasTransforms)
+        {
+            SpriteTransformInputs inputs{};
+            inputs.Count = offsetCount;
+            inputs.Offsets = &offsets->X;
+            inputs.Rotations = hasRotations ? rotations : nullptr;
+            inputs.Scales = hasScales ? &scales->X : nullptr;
+
+            ComputeSpriteTransforms(
+                inputs,
+                m_useFastRotation ? SinCosMode::Fast : SinCosMode::Accurate,
+                &m_sprites[firstNewSprite].Transform._11,
+                sizeof(Sprite));
+        }
+    });
+}
+
+
+//
+// Stable sort of sprites by bitmap.
+//
+// Each distinct bitmap is given a small key, in order of first appearance,
+// and a counting sort over an index array then works out where each sprite
+// ends up.  This is linear in the number of sprites, and each Sprite is
+// moved exactly once (so no AddRef / Release on the bitmaps).
+//
+void ABI::Microsoft::Graphics::Canvas::SortSpritesByBitmap(std::vector<Sprite>& sprites)
+{
+    auto const spriteCount = sprites.size();
+
+    if (spriteCount < 2)
+        return;
+
+    assert(spriteCount < std::numeric_limits<uint32_t>::max());
+
+    //
+    // Assign keys.  Consecutive sprites usually share a bitmap, so the map
+    // lookup is only needed when the bitmap changes.
+    //
+
+    std::vector<uint32_t> keys(spriteCount);
+    std::vector<uint32_t> bucketStarts;
+    std::unordered_map<ID2D1Bitmap*, uint32_t> keysByBitmap;
+
+    ID2D1Bitmap* currentBitmap = nullptr;
+    uint32_t currentKey = 0;
+    bool alreadySorted = true;
+
+    for (size_t i = 0; i < spriteCount; ++i)
+    {
+        auto bitmap = sprites[i].Bitmap.Get();
+
+        if (i == 0 || bitmap != currentBitmap)
+        {
+            auto result = keysByBitmap.emplace(bitmap, static_cast<uint32_t>(bucketStarts.size()));
+            if (result.second)
+                bucketStarts.push_back(0);
+
+            auto key = result.first->second;
+
+            // Keys are handed out in order of first appearance, so going back
+            // to a lower key means this bitmap has been seen before.
+            if (key < currentKey)
+                alreadySorted = false;
+
+            currentBitmap = bitmap;
+            currentKey = key;
+        }
+
+        keys[i] = currentKey;
+        ++bucketStarts[currentKey];
+    }
+
+    if (alreadySorted)
+        return;
+
+    //
+    // Turn the bucket sizes into start offsets, then scatter the indices.
+    //
+
+    uint32_t offset = 0;
+    for (auto& bucketStart : bucketStarts)
+    {
+        auto bucketSize = bucketStart;
+        bucketStart = offset;
+        offset += bucketSize;
+    }
+
+    std::vector<uint32_t> order(spriteCount);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(spriteCount); ++i)
+        order[bucketStarts[keys[i]]++] = i;
+
+    //
+    // Gather the sprites into their new positions.
+    //
+
+    std::vector<Sprite> sortedSprites;
+    sortedSprites.reserve(spriteCount);
+
+    for (auto index : order)
+        sortedSprites.push_back(std::move(sprites[index]));
+
+    sprites.swap(sortedSprites);
+}
+
+
 template<typename T>
 class BatchFinder
 {
@@ -504,6 +758,71 @@ private:
     }
 };
 
+//
+// Draws the sprites that have been added to a D2D sprite batch - one
+// DrawSpriteBatch call for each run of sprites that use the same bitmap.
+//
+void ABI::Microsoft::Graphics::Canvas::DrawSpriteBatchRuns(
+    ID2D1DeviceContext3* deviceContext,
+    ID2D1SpriteBatch* spriteBatch,
+    std::vector<Sprite> const& sprites,
+    D2D1_UNIT_MODE unitMode,
+    D2D1_BITMAP_INTERPOLATION_MODE interpolationMode,
+    D2D1_SPRITE_OPTIONS spriteOptions,
+    bool quirked)
+{
+    //
+    // Get the device context into the right state
+    //
+        
+    auto originalAntialiasMode = deviceContext->GetAntialiasMode();
+
+    if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
+        deviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+
+    auto originalUnitMode = deviceContext->GetUnitMode();
+    if (originalUnitMode != unitMode)
+        deviceContext->SetUnitMode(unitMode);
+
+    //
+    // Draw the sprites - one DrawSpriteBatch call for each bitmap
+    //
+
+    // When the quirk is required we limit the batch size to workaround an
+    // issue with older Qualcomm drivers.
+    uint32_t maxSpritesPerBatch = quirked ? 256 : std::numeric_limits<uint32_t>::max();
+        
+    for (BatchFinder<Sprite> batchFinder(sprites, maxSpritesPerBatch); !batchFinder.Done(); batchFinder.FindNext())
+    {
+        deviceContext->DrawSpriteBatch(
+            spriteBatch,
+            batchFinder.CurrentStartIndex(),
+            batchFinder.CurrentSpriteCount(),
+            batchFinder.CurrentBitmap(),
+            interpolationMode,
+            spriteOptions);
+
+        if (quirked)
+        {
+            // Direct2D will helpfully batch up our DrawSpriteBatch calls - when
+            // we're manually unbatching them to avoid limits of the maximum sprites per batch!
+            // An explicit Flush here prevents that from happening.
+            deviceContext->Flush();
+        }
+    }
+
+    //
+    // Restore the state we may have changed
+    //
+
+    if (originalUnitMode != unitMode)
+        deviceContext->SetUnitMode(originalUnitMode);
+
+    if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
+        deviceContext->SetAntialiasMode(originalAntialiasMode);
+}
+
+
 IFACEMETHODIMP CanvasSpriteBatch::Close()
 {
     return ExceptionBoundary([&]
@@ -520,13 +839,7 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
         //
         
         if (m_sortMode == CanvasSpriteSortMode::Bitmap)
-        {
-            std::stable_sort(m_sprites.begin(), m_sprites.end(),
-                [] (auto const& a, auto const& b)
-                {
-                    return a.Bitmap.Get() < b.Bitmap.Get();
-                });
-        }
+            SortSpritesByBitmap(m_sprites);
 
         //
         // Build up a D2D sprite batch from our sprites
@@ -552,58 +865,23 @@ IFACEMETHODIMP CanvasSpriteBatch::Close()
             stride));
 
         //
-        // Get the device context into the right state
-        //
-        
-        auto originalAntialiasMode = deviceContext->GetAntialiasMode();
-
-        if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
-            deviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
-
-        auto originalUnitMode = deviceContext->GetUnitMode();
-        if (originalUnitMode != m_unitMode)
-            deviceContext->SetUnitMode(m_unitMode);
-
-        //
-        // Draw the sprites - one DrawSpriteBatch call for each bitmap
+        // Figure out if we need to quirk the batch size to workaround an issue
+        // with older Qualcomm drivers, and then draw.
         //
 
-        // Figure out if we need to quirk the batch size to workaround an issue
-        // with older Qualcomm drivers.
         ComPtr<ID2D1Device> d2dDevice;
         deviceContext->GetDevice(&d2dDevice);
         auto device = ResourceManager::GetOrCreate<ICanvasDeviceInternal>(d2dDevice.Get());
         bool quirked = device->IsSpriteBatchQuirkRequired();
-        uint32_t maxSpritesPerBatch = quirked ? 256 : std::numeric_limits<uint32_t>::max();
-        
-        for (BatchFinder<Sprite> batchFinder(m_sprites, maxSpritesPerBatch); !batchFinder.Done(); batchFinder.FindNext())
-        {
-            deviceContext->DrawSpriteBatch(
-                spriteBatch.Get(),
-                batchFinder.CurrentStartIndex(),
-                batchFinder.CurrentSpriteCount(),
-                batchFinder.CurrentBitmap(),
-                m_interpolationMode,
-                m_spriteOptions);
-
-            if (quirked)
-            {
-                // Direct2D will helpfully batch up our DrawSpriteBatch calls - when
-                // we're manually unbatching them to avoid limits of the maximum sprites per batch!
-                // An explicit Flush here prevents that from happening.
-                deviceContext->Flush();
-            }
-        }
 
-        //
-        // Restore the state we may have changed
-        //
-
-        if (originalUnitMode != m_unitMode)
-            deviceContext->SetUnitMode(originalUnitMode);
-
-        if (originalAntialiasMode == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE)
-            deviceContext->SetAntialiasMode(originalAntialiasMode);
+        DrawSpriteBatchRuns(
+            deviceContext.Get(),
+            spriteBatch.Get(),
+            m_sprites,
+            m_unitMode,
+            m_interpolationMode,
+            m_spriteOptions,
+            quirked);
 
         //
         // Release our working memory
@@ -677,4 +955,475 @@ void CanvasSpriteBatch::EnsureNotClosed()
 }
 
 
+//
+// CanvasRetainedSpriteBatchFactory implementation
+//
+
+
+ActivatableClassWithFactory(CanvasRetainedSpriteBatch, CanvasRetainedSpriteBatchFactory);
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatchFactory::Create(
+    ICanvasResourceCreator* resourceCreator,
+    ICanvasRetainedSpriteBatch** spriteBatch)
+{
+    return CreateWithInterpolationAndOptions(
+        resourceCreator,
+        CanvasImageInterpolation::Linear,
+        CanvasSpriteOptions::None,
+        spriteBatch);
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatchFactory::CreateWithInterpolationAndOptions(
+    ICanvasResourceCreator* resourceCreator,
+    CanvasImageInterpolation interpolation,
+    CanvasSpriteOptions options,
+    ICanvasRetainedSpriteBatch** spriteBatch)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(resourceCreator);
+        CheckAndClearOutPointer(spriteBatch);
+
+        if (interpolation != CanvasImageInterpolation::NearestNeighbor &&
+            interpolation != CanvasImageInterpolation::Linear)
+        {
+            ThrowHR(E_INVALIDARG, Strings::SpriteBatchInvalidInterpolation);
+        }
+
+        if (options != CanvasSpriteOptions::None &&
+            options != CanvasSpriteOptions::ClampToSourceRect)
+        {
+            ThrowHR(E_INVALIDARG);
+        }
+
+        auto newSpriteBatch = CanvasRetainedSpriteBatch::CreateNew(
+            resourceCreator,
+            static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(interpolation),
+            static_cast<D2D1_SPRITE_OPTIONS>(options));
+
+        ThrowIfFailed(newSpriteBatch.CopyTo(spriteBatch));
+    });
+}
+
+
+//
+// CanvasRetainedSpriteBatch implementation
+//
+
+
+ComPtr<CanvasRetainedSpriteBatch> CanvasRetainedSpriteBatch::CreateNew(
+    ICanvasResourceCreator* resourceCreator,
+    D2D1_BITMAP_INTERPOLATION_MODE interpolation,
+    D2D1_SPRITE_OPTIONS options)
+{
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto deviceInternal = As<ICanvasDeviceInternal>(device);
+
+    // ID2D1SpriteBatch objects belong to the device rather than to the context
+    // that created them, so a pooled context is good enough here.
+    ComPtr<ID2D1SpriteBatch> spriteBatch;
+    {
+        auto lease = deviceInternal->GetResourceCreationDeviceContext();
+        auto deviceContext3 = MaybeAs<ID2D1DeviceContext3>(lease.Get());
+
+        if (!deviceContext3)
+            ThrowHR(E_NOTIMPL, Strings::SpriteBatchNotAvailable);
+
+        ThrowIfFailed(deviceContext3->CreateSpriteBatch(&spriteBatch));
+    }
+
+    auto newSpriteBatch = Make<CanvasRetainedSpriteBatch>(
+        device.Get(),
+        deviceInternal->GetD2DDevice().Get(),
+        spriteBatch.Get(),
+        interpolation,
+        options,
+        deviceInternal->IsSpriteBatchQuirkRequired());
+    CheckMakeResult(newSpriteBatch);
+
+    return newSpriteBatch;
+}
+
+
+CanvasRetainedSpriteBatch::CanvasRetainedSpriteBatch(
+    ICanvasDevice* device,
+    ID2D1Device* d2dDevice,
+    ID2D1SpriteBatch* spriteBatch,
+    D2D1_BITMAP_INTERPOLATION_MODE interpolation,
+    D2D1_SPRITE_OPTIONS options,
+    bool isQuirkRequired)
+    : m_device(device)
+    , m_d2dDevice(d2dDevice)
+    , m_spriteBatch(spriteBatch)
+    , m_interpolationMode(interpolation)
+    , m_spriteOptions(options)
+    , m_isQuirkRequired(isQuirkRequired)
+    , m_uploadedSpriteCount(0)
+{
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::get_Count(int32_t* value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(value);
+        m_device.EnsureNotClosed();
+
+        *value = static_cast<int32_t>(m_sprites.size());
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::AddToRect(
+    ICanvasBitmap* bitmap,
+    Rect destRect,
+    Rect sourceRect,
+    Vector4 tint,
+    CanvasSpriteFlip flip,
+    int32_t* index)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(index);
+
+        *index = AddSprite(MakeSprite(bitmap, &destRect, Identity3x2(), sourceRect, tint, flip));
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::AddWithTransform(
+    ICanvasBitmap* bitmap,
+    Matrix3x2 transform,
+    Rect sourceRect,
+    Vector4 tint,
+    CanvasSpriteFlip flip,
+    int32_t* index)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(index);
+
+        *index = AddSprite(MakeSprite(bitmap, nullptr, transform, sourceRect, tint, flip));
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::SetToRect(
+    int32_t index,
+    ICanvasBitmap* bitmap,
+    Rect destRect,
+    Rect sourceRect,
+    Vector4 tint,
+    CanvasSpriteFlip flip)
+{
+    return ExceptionBoundary([&]
+    {
+        SetSprite(index, MakeSprite(bitmap, &destRect, Identity3x2(), sourceRect, tint, flip));
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::SetWithTransform(
+    int32_t index,
+    ICanvasBitmap* bitmap,
+    Matrix3x2 transform,
+    Rect sourceRect,
+    Vector4 tint,
+    CanvasSpriteFlip flip)
+{
+    return ExceptionBoundary([&]
+    {
+        SetSprite(index, MakeSprite(bitmap, nullptr, transform, sourceRect, tint, flip));
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::SetTransforms(
+    int32_t startIndex,
+    uint32_t transformCount,
+    Matrix3x2* transforms)
+{
+    return ExceptionBoundary([&]
+    {
+        if (transformCount > 0)
+            CheckInPointer(transforms);
+
+        m_device.EnsureNotClosed();
+
+        auto begin = CheckRange(startIndex, transformCount);
+
+        for (uint32_t i = 0; i < transformCount; ++i)
+            m_sprites[begin + i].Transform = *ReinterpretAs<D2D1_MATRIX_3X2_F const*>(&transforms[i]);
+
+        MarkDirty(begin, begin + transformCount);
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::SetTints(
+    int32_t startIndex,
+    uint32_t tintCount,
+    Vector4* tints)
+{
+    return ExceptionBoundary([&]
+    {
+        if (tintCount > 0)
+            CheckInPointer(tints);
+
+        m_device.EnsureNotClosed();
+
+        auto begin = CheckRange(startIndex, tintCount);
+
+        for (uint32_t i = 0; i < tintCount; ++i)
+            m_sprites[begin + i].Color = *ReinterpretAs<D2D1_COLOR_F const*>(&tints[i]);
+
+        MarkDirty(begin, begin + tintCount);
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::Clear()
+{
+    return ExceptionBoundary([&]
+    {
+        m_device.EnsureNotClosed();
+
+        m_sprites.clear();
+        m_dirtyRanges.clear();
+
+        if (m_uploadedSpriteCount > 0)
+        {
+            m_spriteBatch->Clear();
+            m_uploadedSpriteCount = 0;
+        }
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::Draw(
+    ICanvasDrawingSession* drawingSession)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(drawingSession);
+        m_device.EnsureNotClosed();
+
+        auto deviceContext = As<ID2D1DeviceContext3>(GetWrappedResource<ID2D1DeviceContext1>(drawingSession));
+
+        ComPtr<ID2D1Device> d2dDevice;
+        deviceContext->GetDevice(&d2dDevice);
+
+        if (!IsSameInstance(d2dDevice.Get(), m_d2dDevice.Get()))
+            ThrowHR(E_INVALIDARG, Strings::RetainedSpriteBatchWrongDevice);
+
+        if (m_sprites.empty())
+            return;
+
+        UploadChanges();
+
+        // Source rectangles were converted to pixels using each bitmap's DPI
+        // when the sprites were added, so the batch is always drawn in DIPs.
+        DrawSpriteBatchRuns(
+            deviceContext.Get(),
+            m_spriteBatch.Get(),
+            m_sprites,
+            D2D1_UNIT_MODE_DIPS,
+            m_interpolationMode,
+            m_spriteOptions,
+            m_isQuirkRequired);
+    });
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::Close()
+{
+    m_device.Close();
+    m_spriteBatch.Reset();
+    m_d2dDevice.Reset();
+
+    m_sprites.clear();
+    m_sprites.shrink_to_fit();
+    m_dirtyRanges.clear();
+    m_uploadedSpriteCount = 0;
+
+    return S_OK;
+}
+
+
+IFACEMETHODIMP CanvasRetainedSpriteBatch::get_Device(ICanvasDevice** value)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckAndClearOutPointer(value);
+
+        ThrowIfFailed(m_device.EnsureNotClosed().CopyTo(value));
+    });
+}
+
+
+Sprite CanvasRetainedSpriteBatch::MakeSprite(
+    ICanvasBitmap* bitmap,
+    Rect const* destRect,
+    Matrix3x2 const& transform,
+    Rect const& sourceRect,
+    Vector4 const& tint,
+    CanvasSpriteFlip flip)
+{
+    CheckInPointer(bitmap);
+    m_device.EnsureNotClosed();
+
+    auto d2dBitmap = GetWrappedResource<ID2D1Bitmap>(bitmap);
+    auto d2dDestRect = destRect ? ToD2DRect(*destRect) : MakeDestRect(sourceRect);
+    auto d2dSourceRect = MakeSourceRect(flip, D2D1_UNIT_MODE_DIPS, bitmap, sourceRect);
+
+    return Sprite(std::move(d2dBitmap), d2dDestRect, d2dSourceRect, tint, transform);
+}
+
+
+int32_t CanvasRetainedSpriteBatch::AddSprite(Sprite&& sprite)
+{
+    if (m_sprites.size() >= static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+        ThrowHR(E_OUTOFMEMORY);
+
+    m_sprites.emplace_back(std::move(sprite));
+
+    // Newly added sprites are past m_uploadedSpriteCount, so they'll be picked
+    // up by the next UploadChanges without needing to be marked as dirty.
+    return static_cast<int32_t>(m_sprites.size() - 1);
+}
+
+
+void CanvasRetainedSpriteBatch::SetSprite(int32_t index, Sprite&& sprite)
+{
+    auto i = CheckRange(index, 1);
+
+    m_sprites[i] = std::move(sprite);
+
+    MarkDirty(i, i + 1);
+}
+
+
+uint32_t CanvasRetainedSpriteBatch::CheckRange(int32_t startIndex, uint32_t count)
+{
+    if (startIndex < 0)
+        ThrowHR(E_BOUNDS);
+
+    auto begin = static_cast<size_t>(startIndex);
+
+    if (begin > m_sprites.size() || count > m_sprites.size() - begin)
+        ThrowHR(E_BOUNDS);
+
+    return static_cast<uint32_t>(begin);
+}
+
+
+void CanvasRetainedSpriteBatch::MarkDirty(uint32_t begin, uint32_t end)
+{
+    // Sprites that D2D hasn't seen yet will be uploaded in full anyway.
+    end = std::min(end, m_uploadedSpriteCount);
+
+    if (begin >= end)
+        return;
+
+    // The common pattern is to walk through the sprites in order, so try to
+    // extend the most recent range before adding a new one.
+    if (!m_dirtyRanges.empty())
+    {
+        auto& last = m_dirtyRanges.back();
+
+        if (begin <= last.second && end >= last.first)
+        {
+            last.first = std::min(last.first, begin);
+            last.second = std::max(last.second, end);
+            return;
+        }
+    }
+
+    m_dirtyRanges.emplace_back(begin, end);
+}
+
+
+void CanvasRetainedSpriteBatch::UploadChanges()
+{
+    auto stride = static_cast<uint32_t>(sizeof(Sprite));
+
+    //
+    // Re-send modified sprites that D2D already knows about.  Ranges are
+    // sorted and coalesced so that each modified span costs one SetSprites.
+    //
+
+    if (!m_dirtyRanges.empty())
+    {
+        std::sort(m_dirtyRanges.begin(), m_dirtyRanges.end());
+
+        auto current = m_dirtyRanges.front();
+
+        auto flush = [&]
+        {
+            auto sprite = &m_sprites[current.first];
+
+            ThrowIfFailed(m_spriteBatch->SetSprites(
+                current.first,
+                current.second - current.first,
+                &sprite->DestinationRect,
+                &sprite->SourceRect,
+                &sprite->Color,
+                &sprite->Transform,
+                stride,
+                stride,
+                stride,
+                stride));
+        };
+
+        for (auto it = m_dirtyRanges.begin() + 1; it != m_dirtyRanges.end(); ++it)
+        {
+            if (it->first <= current.second)
+            {
+                current.second = std::max(current.second, it->second);
+            }
+            else
+            {
+                flush();
+                current = *it;
+            }
+        }
+
+        flush();
+
+        m_dirtyRanges.clear();
+    }
+
+    //
+    // Add any sprites that have been appended since the last upload.
+    //
+
+    assert(m_sprites.size() < std::numeric_limits<uint32_t>::max());
+
+    auto spriteCount = static_cast<uint32_t>(m_sprites.size());
+
+    if (spriteCount > m_uploadedSpriteCount)
+    {
+        auto firstNewSprite = &m_sprites[m_uploadedSpriteCount];
+
+        ThrowIfFailed(m_spriteBatch->AddSprites(
+            spriteCount - m_uploadedSpriteCount,
+            &firstNewSprite->DestinationRect,
+            &firstNewSprite->SourceRect,
+            &firstNewSprite->Color,
+            &firstNewSprite->Transform,
+            stride,
+            stride,
+            stride,
+            stride));
+
+        m_uploadedSpriteCount = spriteCount;
+    }
+}
+
+
 #endif
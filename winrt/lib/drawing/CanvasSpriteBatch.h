@@ -18,6 +18,64 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     };
 
     
+    //
+    // A single sprite, laid out so that the D2D AddSprites / SetSprites calls
+    // can read directly out of a std::vector<Sprite> using strides.
+    //
+    struct Sprite
+    {
+        ComPtr<ID2D1Bitmap> Bitmap;
+        D2D1_RECT_F DestinationRect;
+        D2D1_RECT_U SourceRect;
+        D2D1_COLOR_F Color;
+        D2D1_MATRIX_3X2_F Transform;
+
+        Sprite(
+            ComPtr<ID2D1Bitmap>&& bitmap,
+            D2D1_RECT_F const& destinationRect,
+            D2D1_RECT_U const& sourceRect,
+            Vector4 const& tint,
+            Matrix3x2 const& transform)
+            : Bitmap(std::move(bitmap))
+            , DestinationRect(destinationRect)
+            , SourceRect(sourceRect)
+            , Color(*ReinterpretAs<D2D1_COLOR_F const*>(&tint))
+            , Transform(*ReinterpretAs<D2D1_MATRIX_3X2_F const*>(&transform))
+        {
+        }
+
+        Sprite(
+            ComPtr<ID2D1Bitmap>&& bitmap,
+            D2D1_RECT_F const& destinationRect,
+            D2D1_RECT_U const& sourceRect,
+            Vector4 const& tint)
+            : Sprite(std::move(bitmap), destinationRect, sourceRect, tint, Identity3x2())
+        {
+        }
+    };
+
+
+    //
+    // Stable, linear-time sort of sprites so that sprites using the same
+    // bitmap are adjacent.  Bitmaps are ordered by first appearance.
+    //
+    void SortSpritesByBitmap(std::vector<Sprite>& sprites);
+
+
+    //
+    // Draws the sprites that have been added to a D2D sprite batch - one
+    // DrawSpriteBatch call for each run of sprites that use the same bitmap.
+    //
+    void DrawSpriteBatchRuns(
+        ID2D1DeviceContext3* deviceContext,
+        ID2D1SpriteBatch* spriteBatch,
+        std::vector<Sprite> const& sprites,
+        D2D1_UNIT_MODE unitMode,
+        D2D1_BITMAP_INTERPOLATION_MODE interpolationMode,
+        D2D1_SPRITE_OPTIONS spriteOptions,
+        bool quirked);
+
+
     class CanvasSpriteBatch
         : public RuntimeClass<ICanvasSpriteBatch, IClosable, ICanvasResourceCreator, ICanvasResourceCreatorWithDpi>
         , private LifespanTracker<CanvasSpriteBatch>
@@ -29,38 +87,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         D2D1_BITMAP_INTERPOLATION_MODE m_interpolationMode;
         D2D1_SPRITE_OPTIONS m_spriteOptions;
         D2D1_UNIT_MODE m_unitMode;
-        
-        struct Sprite
-        {
-            ComPtr<ID2D1Bitmap> Bitmap;
-            D2D1_RECT_F DestinationRect;
-            D2D1_RECT_U SourceRect;
-            D2D1_COLOR_F Color;
-            D2D1_MATRIX_3X2_F Transform;
-
-            Sprite(
-                ComPtr<ID2D1Bitmap>&& bitmap,
-                D2D1_RECT_F const& destinationRect,
-                D2D1_RECT_U const& sourceRect,
-                Vector4 const& tint,
-                Matrix3x2 const& transform)
-                : Bitmap(std::move(bitmap))
-                , DestinationRect(destinationRect)
-                , SourceRect(sourceRect)
-                , Color(*ReinterpretAs<D2D1_COLOR_F const*>(&tint))
-                , Transform(*ReinterpretAs<D2D1_MATRIX_3X2_F const*>(&transform))
-            {
-            }
-
-            Sprite(
-                ComPtr<ID2D1Bitmap>&& bitmap,
-                D2D1_RECT_F const& destinationRect,
-                D2D1_RECT_U const& sourceRect,
-                Vector4 const& tint)
-                : Sprite(std::move(bitmap), destinationRect, sourceRect, tint, Identity3x2())
-            {
-            }
-        };
+        bool m_useFastRotation;
 
         std::vector<Sprite> m_sprites;
 
@@ -184,6 +211,30 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             Vector2 scale,
             CanvasSpriteFlip flip) override;
 
+        IFACEMETHODIMP get_UseFastRotation(
+            boolean* value) override;
+
+        IFACEMETHODIMP put_UseFastRotation(
+            boolean value) override;
+
+        IFACEMETHODIMP DrawManyAtOffsets(
+            ICanvasBitmap* bitmap,
+            uint32_t offsetCount,
+            Vector2* offsets) override;
+
+        IFACEMETHODIMP DrawManyFromSpriteSheet(
+            ICanvasBitmap* bitmap,
+            uint32_t offsetCount,
+            Vector2* offsets,
+            uint32_t sourceRectCount,
+            Rect* sourceRects,
+            uint32_t tintCount,
+            Vector4* tints,
+            uint32_t rotationCount,
+            float* rotations,
+            uint32_t scaleCount,
+            Vector2* scales) override;
+
         //
         // IClosable
         //
@@ -218,6 +269,152 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         void EnsureNotClosed();
     };
 
+
+    class CanvasRetainedSpriteBatchFactory
+        : public AgileActivationFactory<ICanvasRetainedSpriteBatchStatics>
+        , private LifespanTracker<CanvasRetainedSpriteBatchFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_CanvasRetainedSpriteBatch, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasResourceCreator* resourceCreator,
+            ICanvasRetainedSpriteBatch** spriteBatch) override;
+
+        IFACEMETHOD(CreateWithInterpolationAndOptions)(
+            ICanvasResourceCreator* resourceCreator,
+            CanvasImageInterpolation interpolation,
+            CanvasSpriteOptions options,
+            ICanvasRetainedSpriteBatch** spriteBatch) override;
+    };
+
+
+    //
+    // A sprite batch that outlives any one drawing session.
+    //
+    // The sprites and the D2D sprite batch are kept between frames.  Changes
+    // made through Add / Set / SetTransforms / SetTints are tracked as dirty
+    // ranges, and only those ranges are sent to D2D the next time the batch is
+    // drawn.
+    //
+    class CanvasRetainedSpriteBatch
+        : public RuntimeClass<ICanvasRetainedSpriteBatch, IClosable, ICanvasResourceCreator>
+        , private LifespanTracker<CanvasRetainedSpriteBatch>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasRetainedSpriteBatch, BaseTrust);
+
+        ClosablePtr<ICanvasDevice> m_device;
+        ComPtr<ID2D1Device> m_d2dDevice;
+        ComPtr<ID2D1SpriteBatch> m_spriteBatch;
+        D2D1_BITMAP_INTERPOLATION_MODE m_interpolationMode;
+        D2D1_SPRITE_OPTIONS m_spriteOptions;
+        bool m_isQuirkRequired;
+
+        std::vector<Sprite> m_sprites;
+
+        // Number of sprites (from the start of m_sprites) that D2D already
+        // knows about.  Sprites past this point are added on the next draw.
+        uint32_t m_uploadedSpriteCount;
+
+        // [begin, end) ranges of uploaded sprites that have been modified.
+        std::vector<std::pair<uint32_t, uint32_t>> m_dirtyRanges;
+
+    public:
+        static ComPtr<CanvasRetainedSpriteBatch> CreateNew(
+            ICanvasResourceCreator* resourceCreator,
+            D2D1_BITMAP_INTERPOLATION_MODE interpolation,
+            D2D1_SPRITE_OPTIONS options);
+
+        CanvasRetainedSpriteBatch(
+            ICanvasDevice* device,
+            ID2D1Device* d2dDevice,
+            ID2D1SpriteBatch* spriteBatch,
+            D2D1_BITMAP_INTERPOLATION_MODE interpolation,
+            D2D1_SPRITE_OPTIONS options,
+            bool isQuirkRequired);
+
+        //
+        // ICanvasRetainedSpriteBatch
+        //
+
+        IFACEMETHOD(get_Count)(int32_t* value) override;
+
+        IFACEMETHOD(AddToRect)(
+            ICanvasBitmap* bitmap,
+            Rect destRect,
+            Rect sourceRect,
+            Vector4 tint,
+            CanvasSpriteFlip flip,
+            int32_t* index) override;
+
+        IFACEMETHOD(AddWithTransform)(
+            ICanvasBitmap* bitmap,
+            Matrix3x2 transform,
+            Rect sourceRect,
+            Vector4 tint,
+            CanvasSpriteFlip flip,
+            int32_t* index) override;
+
+        IFACEMETHOD(SetToRect)(
+            int32_t index,
+            ICanvasBitmap* bitmap,
+            Rect destRect,
+            Rect sourceRect,
+            Vector4 tint,
+            CanvasSpriteFlip flip) override;
+
+        IFACEMETHOD(SetWithTransform)(
+            int32_t index,
+            ICanvasBitmap* bitmap,
+            Matrix3x2 transform,
+            Rect sourceRect,
+            Vector4 tint,
+            CanvasSpriteFlip flip) override;
+
+        IFACEMETHOD(SetTransforms)(
+            int32_t startIndex,
+            uint32_t transformCount,
+            Matrix3x2* transforms) override;
+
+        IFACEMETHOD(SetTints)(
+            int32_t startIndex,
+            uint32_t tintCount,
+            Vector4* tints) override;
+
+        IFACEMETHOD(Clear)() override;
+
+        IFACEMETHOD(Draw)(
+            ICanvasDrawingSession* drawingSession) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+        //
+        // ICanvasResourceCreator
+        //
+
+        IFACEMETHOD(get_Device)(ICanvasDevice** value) override;
+
+    private:
+        Sprite MakeSprite(
+            ICanvasBitmap* bitmap,
+            Rect const* destRect,
+            Matrix3x2 const& transform,
+            Rect const& sourceRect,
+            Vector4 const& tint,
+            CanvasSpriteFlip flip);
+
+        int32_t AddSprite(Sprite&& sprite);
+        void SetSprite(int32_t index, Sprite&& sprite);
+
+        uint32_t CheckRange(int32_t startIndex, uint32_t count);
+        void MarkDirty(uint32_t begin, uint32_t end);
+        void UploadChanges();
+    };
+
 } } } }
 
 #endif
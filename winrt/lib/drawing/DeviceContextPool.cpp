@@ -12,33 +12,96 @@
 //
 
 
-DeviceContextPool::DeviceContextPool(ID2D1Device1* d2dDevice)
+//
+// Marks a TakeLease or ReturnLease call as running for as long as it is in
+// scope.  The counter is incremented before the closed flag is checked, and
+// Close sets the flag before it waits for the counter, so (with sequentially
+// consistent ordering on both) either the call sees that the pool is closed
+// or Close waits for the call to finish.
+//
+class DeviceContextPool::ActiveCall
+{
+    DeviceContextPool* m_pool;
+
+public:
+    ActiveCall(DeviceContextPool* pool)
+        : m_pool(pool)
+    {
+        m_pool->m_activeCallCount.fetch_add(1);
+    }
+
+    ~ActiveCall()
+    {
+        m_pool->m_activeCallCount.fetch_sub(1);
+    }
+
+    ActiveCall(ActiveCall const&) = delete;
+    ActiveCall& operator=(ActiveCall const&) = delete;
+
+    bool IsPoolClosed() const
+    {
+        return m_pool->m_closed.load();
+    }
+};
+
+
+uint32_t DeviceContextPool::DefaultMaxPoolSize()
+{
+    auto cpuCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+    return (cpuCount < MaxPoolSizeLimit) ? cpuCount : MaxPoolSizeLimit;
+}
+
+
+DeviceContextPool::DeviceContextPool(ID2D1Device1* d2dDevice, uint32_t maxPoolSize)
     : m_d2dDevice(d2dDevice)
+    , m_closed(false)
+    , m_activeCallCount(0)
+    , m_slots(MaxPoolSizeLimit)
+    , m_maxPoolSize(0)
+    , m_leaseCount(0)
+    , m_missCount(0)
+    , m_createdCount(0)
+    , m_discardedCount(0)
+    , m_activeLeaseCount(0)
+    , m_peakActiveLeaseCount(0)
 {
+    SetMaxPoolSize(maxPoolSize);
 }
 
 
 DeviceContextLease DeviceContextPool::TakeLease()
 {
-    Lock lock(m_mutex);
+    ActiveCall activeCall(this);
 
-    if (!m_d2dDevice)
+    if (activeCall.IsPoolClosed())
         ThrowHR(RO_E_CLOSED);
-    
-    if (m_deviceContexts.empty())
+
+    m_leaseCount.fetch_add(1, std::memory_order_relaxed);
+
+    ComPtr<ID2D1DeviceContext1> deviceContext;
+
+    if (!m_slots.TryTake(deviceContext, m_maxPoolSize.load(std::memory_order_relaxed)))
     {
-        ComPtr<ID2D1DeviceContext1> deviceContext;
+        m_missCount.fetch_add(1, std::memory_order_relaxed);
+
         ThrowIfFailed(m_d2dDevice->CreateDeviceContext(
             D2D1_DEVICE_CONTEXT_OPTIONS_NONE,
             &deviceContext));
-        return DeviceContextLease(this, std::move(deviceContext));
+
+        m_createdCount.fetch_add(1, std::memory_order_relaxed);
     }
-    else
+
+    auto activeLeaseCount = m_activeLeaseCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto peak = m_peakActiveLeaseCount.load(std::memory_order_relaxed);
+
+    while (activeLeaseCount > peak &&
+           !m_peakActiveLeaseCount.compare_exchange_weak(peak, activeLeaseCount, std::memory_order_relaxed))
     {
-        DeviceContextLease newLease(this, std::move(m_deviceContexts.back()));
-        m_deviceContexts.pop_back();
-        return newLease;
+        // compare_exchange_weak has updated 'peak'; try again
     }
+
+    return DeviceContextLease(this, std::move(deviceContext));
 }
 
 
@@ -46,13 +109,15 @@ void DeviceContextPool::ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext)
 {
     if (!deviceContext)
         return;
-        
-    Lock lock(m_mutex);
+
+    m_activeLeaseCount.fetch_sub(1, std::memory_order_relaxed);
+
+    ActiveCall activeCall(this);
 
     //
     // If the pool has been closed we just discard the context
     //
-    if (!m_d2dDevice)
+    if (activeCall.IsPoolClosed())
         return;
 
     //
@@ -61,21 +126,58 @@ void DeviceContextPool::ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext)
     // destroyed.  This is to give the pool a chance to shrink back down to a
     // reasonable size if there is ever any large scale concurrency going on.
     //
-    // Max pool size is picked from number of CPUs - reasoning being that you
-    // should expect to be able to have that many threads running and reusing
-    // contexts without recreating them.
-    //
-    static auto maxPoolSize = std::max(std::thread::hardware_concurrency(), 1U);
-
-    if (m_deviceContexts.size() < maxPoolSize)
-        m_deviceContexts.emplace_back(std::move(deviceContext));
+    if (!m_slots.TryPut(deviceContext, m_maxPoolSize.load(std::memory_order_relaxed)))
+        m_discardedCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 
 void DeviceContextPool::Close()
 {
-    Lock lock(m_mutex);
+    m_closed.store(true);
 
-    m_deviceContexts.clear();
+    //
+    // Wait for any TakeLease that may be creating a context from the device,
+    // and any ReturnLease that may be about to put a context in a slot.  Any
+    // call that starts after this sees the pool as closed.
+    //
+    while (m_activeCallCount.load() != 0)
+        std::this_thread::yield();
+
+    m_slots.Clear();
     m_d2dDevice = nullptr;
 }
+
+
+DeviceContextPoolStatistics DeviceContextPool::GetStatistics() const
+{
+    DeviceContextPoolStatistics statistics{};
+    statistics.LeaseCount = m_leaseCount.load(std::memory_order_relaxed);
+    statistics.MissCount = m_missCount.load(std::memory_order_relaxed);
+    statistics.CreatedCount = m_createdCount.load(std::memory_order_relaxed);
+    statistics.DiscardedCount = m_discardedCount.load(std::memory_order_relaxed);
+    statistics.ActiveLeaseCount = m_activeLeaseCount.load(std::memory_order_relaxed);
+    statistics.PeakActiveLeaseCount = m_peakActiveLeaseCount.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+
+uint32_t DeviceContextPool::GetMaxPoolSize() const
+{
+    return m_maxPoolSize.load(std::memory_order_relaxed);
+}
+
+
+void DeviceContextPool::SetMaxPoolSize(uint32_t maxPoolSize)
+{
+    if (maxPoolSize > MaxPoolSizeLimit)
+        ThrowHR(E_INVALIDARG);
+
+    m_maxPoolSize.store(maxPoolSize, std::memory_order_relaxed);
+
+    //
+    // A ReturnLease racing with this may still put a context in one of the
+    // slots being emptied.  That context is reused by a later TakeLease,
+    // which looks in every slot, and is released when the pool is closed.
+    //
+    m_slots.Clear(maxPoolSize);
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "utils/LockFreeSlotArray.h"
 #include "utils/LockUtilities.h"
 
 using namespace Microsoft::WRL;
@@ -11,15 +12,62 @@ using namespace ABI::Microsoft::Graphics::Canvas;
 
 class DeviceContextLease;
 
+//
+// Counters describing how well the pool is working.  These are updated with
+// relaxed atomics, so a snapshot taken while leases are being taken or
+// returned may be very slightly inconsistent.
+//
+struct DeviceContextPoolStatistics
+{
+    uint64_t LeaseCount;            // Number of calls to TakeLease
+    uint64_t MissCount;             // Leases that found no pooled context
+    uint64_t CreatedCount;          // Device contexts created by the pool
+    uint64_t DiscardedCount;        // Returned contexts dropped because the pool was full
+    uint32_t ActiveLeaseCount;      // Leases currently outstanding
+    uint32_t PeakActiveLeaseCount;  // Highest value ActiveLeaseCount has reached
+};
+
+
+//
+// Hands out device contexts for short term use, reusing them where possible.
+//
+// Pooled contexts are kept in a LockFreeSlotArray, so neither TakeLease nor
+// returning a lease ever takes a lock.  At most GetMaxPoolSize() contexts
+// (the high water mark) are kept; slots are allocated up front for
+// MaxPoolSizeLimit of them.
+//
 class DeviceContextPool
 {
+    // Owned by the CanvasDevice, which closes the pool before releasing it.
     ID2D1Device1* m_d2dDevice;
-
-    std::mutex m_mutex;
-    std::vector<ComPtr<ID2D1DeviceContext1>> m_deviceContexts;
+    std::atomic<bool> m_closed;
+
+    // Number of TakeLease and ReturnLease calls currently running.  Close
+    // waits for this to reach zero, so once it returns nothing can still be
+    // using the D2D device or putting a context back into a slot.
+    std::atomic<uint32_t> m_activeCallCount;
+
+    LockFreeSlotArray<ComPtr<ID2D1DeviceContext1>> m_slots;
+    std::atomic<uint32_t> m_maxPoolSize;
+
+    std::atomic<uint64_t> m_leaseCount;
+    std::atomic<uint64_t> m_missCount;
+    std::atomic<uint64_t> m_createdCount;
+    std::atomic<uint64_t> m_discardedCount;
+    std::atomic<uint32_t> m_activeLeaseCount;
+    std::atomic<uint32_t> m_peakActiveLeaseCount;
     
 public:
-    DeviceContextPool(ID2D1Device1* d2dDevice);
+    static uint32_t const MaxPoolSizeLimit = 64;
+
+    //
+    // The default maximum pool size is the number of CPUs - reasoning being
+    // that you should expect to be able to have that many threads running and
+    // reusing contexts without recreating them.
+    //
+    static uint32_t DefaultMaxPoolSize();
+
+    DeviceContextPool(ID2D1Device1* d2dDevice, uint32_t maxPoolSize = DefaultMaxPoolSize());
 
     DeviceContextPool(DeviceContextPool const&) = delete;
     DeviceContextPool& operator=(DeviceContextPool const&) = delete;
@@ -28,7 +76,17 @@ public:
 
     void Close();
 
+    DeviceContextPoolStatistics GetStatistics() const;
+
+    uint32_t GetMaxPoolSize() const;
+
+    // The size must not be larger than MaxPoolSizeLimit.  Shrinking the pool
+    // releases any contexts that no longer fit.
+    void SetMaxPoolSize(uint32_t maxPoolSize);
+
 private:
+    class ActiveCall;
+
     void ReturnLease(ComPtr<ID2D1DeviceContext1>&& deviceContext);
 
     friend class DeviceContextLease;
@@ -56,6 +114,7 @@ public:
         : m_owner(other.m_owner)
         , m_deviceContext(std::move(other.m_deviceContext))
     {
+        other.m_owner = nullptr;
     }
     
     DeviceContextLease& operator=(DeviceContextLease&& other)
@@ -63,6 +122,7 @@ public:
         ReturnLease();
         m_owner = other.m_owner;
         m_deviceContext = std::move(other.m_deviceContext);
+        other.m_owner = nullptr;
         return *this;
     }
 
@@ -0,0 +1,281 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include "DrawBitmapBatcher.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    std::mutex DrawBitmapBatcher::s_pendingMutex;
+    std::vector<DrawBitmapBatcher::PendingBatcher> DrawBitmapBatcher::s_pendingBatchers;
+
+
+    DrawBitmapBatcher::DrawBitmapBatcher(ID2D1DeviceContext3* deviceContext, bool isSpriteBatchQuirkRequired)
+        : m_deviceContext(deviceContext)
+        , m_isSpriteBatchQuirkRequired(isSpriteBatchQuirkRequired)
+        , m_interpolationMode(D2D1_BITMAP_INTERPOLATION_MODE_LINEAR)
+    {
+    }
+
+
+    DrawBitmapBatcher::~DrawBitmapBatcher()
+    {
+        if (!m_sprites.empty())
+            RemoveFromPendingBatchers();
+    }
+
+
+    bool DrawBitmapBatcher::TryAdd(
+        ID2D1Bitmap* bitmap,
+        D2D1_RECT_F const& destinationRect,
+        float opacity,
+        D2D1_INTERPOLATION_MODE interpolationMode,
+        D2D1_RECT_F const* sourceRect)
+    {
+        // Sprites only support the two interpolation modes that
+        // D2D1_BITMAP_INTERPOLATION_MODE shares with D2D1_INTERPOLATION_MODE.
+        if (interpolationMode != D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR &&
+            interpolationMode != D2D1_INTERPOLATION_MODE_LINEAR)
+        {
+            return false;
+        }
+
+        // DrawBitmap clamps opacity, whereas a sprite's alpha is a multiplier.
+        if (!(opacity >= 0.0f && opacity <= 1.0f))
+            return false;
+
+        D2D1_RECT_U pixelSourceRect;
+
+        if (!TryGetSourceRect(bitmap, sourceRect, &pixelSourceRect))
+            return false;
+
+        if (m_deviceContext->GetAntialiasMode() == D2D1_ANTIALIAS_MODE_PER_PRIMITIVE &&
+            !IsPixelAligned(destinationRect))
+        {
+            return false;
+        }
+
+        auto bitmapInterpolationMode = static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(interpolationMode);
+
+        // Each DrawSpriteBatch call has a single interpolation mode.
+        if (!m_sprites.empty() && bitmapInterpolationMode != m_interpolationMode)
+            Flush();
+
+        m_interpolationMode = bitmapInterpolationMode;
+
+        if (m_sprites.empty())
+            AddToPendingBatchers();
+
+        m_sprites.emplace_back(
+            ComPtr<ID2D1Bitmap>(bitmap),
+            destinationRect,
+            pixelSourceRect,
+            Vector4{ 1, 1, 1, opacity });
+
+        return true;
+    }
+
+
+    void DrawBitmapBatcher::Flush()
+    {
+        if (m_sprites.empty())
+            return;
+
+        // If drawing fails the pending sprites are dropped, rather than being
+        // drawn again (out of order) by the next flush.
+        auto clearSprites = MakeScopeWarden(
+            [&]
+            {
+                m_sprites.clear();
+                RemoveFromPendingBatchers();
+            });
+
+        assert(m_sprites.size() < std::numeric_limits<uint32_t>::max());
+
+        ComPtr<ID2D1SpriteBatch> spriteBatch;
+        ThrowIfFailed(m_deviceContext->CreateSpriteBatch(&spriteBatch));
+
+        auto firstSprite = &m_sprites.front();
+        auto stride = static_cast<uint32_t>(sizeof(Sprite));
+
+        ThrowIfFailed(spriteBatch->AddSprites(
+            static_cast<uint32_t>(m_sprites.size()),
+            &firstSprite->DestinationRect,
+            &firstSprite->SourceRect,
+            &firstSprite->Color,
+            &firstSprite->Transform,
+            stride,
+            stride,
+            stride,
+            stride));
+
+        // Sprites were recorded using the current unit mode, and anything that
+        // changes it flushes first, so there's nothing to switch here.
+        DrawSpriteBatchRuns(
+            m_deviceContext.Get(),
+            spriteBatch.Get(),
+            m_sprites,
+            m_deviceContext->GetUnitMode(),
+            m_interpolationMode,
+            D2D1_SPRITE_OPTIONS_NONE,
+            m_isSpriteBatchQuirkRequired);
+    }
+
+
+    //
+    // DrawBitmap takes a floating point source rectangle, in DIPs or pixels
+    // depending on the unit mode, while sprites use whole pixels.  We only
+    // batch draws where these are exactly equivalent: the source rectangle
+    // falls on pixel boundaries, and lies within the bitmap.
+    //
+    bool DrawBitmapBatcher::TryGetSourceRect(ID2D1Bitmap* bitmap, D2D1_RECT_F const* sourceRect, D2D1_RECT_U* pixelSourceRect)
+    {
+        auto pixelSize = bitmap->GetPixelSize();
+
+        if (!sourceRect)
+        {
+            *pixelSourceRect = D2D1_RECT_U{ 0, 0, pixelSize.width, pixelSize.height };
+            return true;
+        }
+
+        float dpiX = DEFAULT_DPI;
+        float dpiY = DEFAULT_DPI;
+
+        if (m_deviceContext->GetUnitMode() == D2D1_UNIT_MODE_DIPS)
+            bitmap->GetDpi(&dpiX, &dpiY);
+
+        float const coordinates[] =
+        {
+            sourceRect->left   * dpiX / DEFAULT_DPI,
+            sourceRect->top    * dpiY / DEFAULT_DPI,
+            sourceRect->right  * dpiX / DEFAULT_DPI,
+            sourceRect->bottom * dpiY / DEFAULT_DPI,
+        };
+
+        uint32_t const limits[] = { pixelSize.width, pixelSize.height, pixelSize.width, pixelSize.height };
+
+        uint32_t pixels[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto rounded = std::round(coordinates[i]);
+
+            if (std::abs(coordinates[i] - rounded) > 0.001f)
+                return false;
+
+            if (rounded < 0 || rounded > limits[i])
+                return false;
+
+            pixels[i] = static_cast<uint32_t>(rounded);
+        }
+
+        // Empty or flipped rectangles are left for DrawBitmap to deal with.
+        if (pixels[0] >= pixels[2] || pixels[1] >= pixels[3])
+            return false;
+
+        *pixelSourceRect = D2D1_RECT_U{ pixels[0], pixels[1], pixels[2], pixels[3] };
+        return true;
+    }
+
+
+    //
+    // Checks whether a destination rectangle, once transformed, has its edges
+    // on whole pixels.  This is only possible when the transform doesn't
+    // rotate or skew.
+    //
+    bool DrawBitmapBatcher::IsPixelAligned(D2D1_RECT_F const& destinationRect)
+    {
+        D2D1_MATRIX_3X2_F transform;
+        m_deviceContext->GetTransform(&transform);
+
+        if (transform._12 != 0 || transform._21 != 0)
+            return false;
+
+        float dpiX = DEFAULT_DPI;
+        float dpiY = DEFAULT_DPI;
+
+        if (m_deviceContext->GetUnitMode() == D2D1_UNIT_MODE_DIPS)
+            m_deviceContext->GetDpi(&dpiX, &dpiY);
+
+        float const coordinates[] =
+        {
+            (destinationRect.left   * transform._11 + transform._31) * dpiX / DEFAULT_DPI,
+            (destinationRect.top    * transform._22 + transform._32) * dpiY / DEFAULT_DPI,
+            (destinationRect.right  * transform._11 + transform._31) * dpiX / DEFAULT_DPI,
+            (destinationRect.bottom * transform._22 + transform._32) * dpiY / DEFAULT_DPI,
+        };
+
+        for (auto coordinate : coordinates)
+        {
+            if (std::abs(coordinate - std::round(coordinate)) > 0.001f)
+                return false;
+        }
+
+        return true;
+    }
+
+
+    bool DrawBitmapBatcher::IsDrawing(ID2D1Bitmap* bitmap) const
+    {
+        return std::any_of(m_sprites.begin(), m_sprites.end(),
+            [=](Sprite const& sprite)
+            {
+                return IsSameInstance(sprite.Bitmap.Get(), bitmap);
+            });
+    }
+
+
+    void DrawBitmapBatcher::AddToPendingBatchers()
+    {
+        auto lock = Lock(s_pendingMutex);
+
+        s_pendingBatchers.push_back(PendingBatcher{ this, std::this_thread::get_id() });
+    }
+
+
+    void DrawBitmapBatcher::RemoveFromPendingBatchers()
+    {
+        auto lock = Lock(s_pendingMutex);
+
+        s_pendingBatchers.erase(
+            std::remove_if(s_pendingBatchers.begin(), s_pendingBatchers.end(),
+                [=](PendingBatcher const& pending) { return pending.Batcher == this; }),
+            s_pendingBatchers.end());
+    }
+
+
+    void DrawBitmapBatcher::FlushDrawsOf(ID2D1Bitmap* bitmap)
+    {
+        std::vector<DrawBitmapBatcher*> batchers;
+
+        {
+            auto lock = Lock(s_pendingMutex);
+
+            if (s_pendingBatchers.empty())
+                return;
+
+            auto threadId = std::this_thread::get_id();
+
+            for (auto& pending : s_pendingBatchers)
+            {
+                if (pending.ThreadId == threadId)
+                    batchers.push_back(pending.Batcher);
+            }
+        }
+
+        // Flushing removes the batcher from s_pendingBatchers, so this happens
+        // outside the lock.  Only this thread can flush or destroy batchers
+        // that it has recorded sprites on, so they are still alive here.
+        for (auto batcher : batchers)
+        {
+            if (batcher->IsDrawing(bitmap))
+                batcher->Flush();
+        }
+    }
+}}}}
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include "CanvasSpriteBatch.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Implements CanvasDrawingSession.BatchBitmapDraws.
+    //
+    // Simple bitmap draws (ones that would otherwise go to the DrawBitmap
+    // fast path) are recorded as sprites instead of being drawn straight
+    // away.  Flush draws everything recorded so far using a single sprite
+    // batch, with one DrawSpriteBatch call for each run of consecutive
+    // sprites that use the same bitmap.
+    //
+    // Sprites are never reordered, so overlapping bitmaps are drawn in the
+    // same order as they would have been without batching.  It is up to the
+    // drawing session to call Flush before doing anything else with the
+    // device context, including changing its state.
+    //
+    // D2D doesn't know about the draws we are holding back, so it can't
+    // order them before changes to the bitmaps they use.  CanvasBitmap calls
+    // FlushDrawsOf before changing a bitmap's pixels (or drawing to it), which
+    // flushes any batcher on the current thread that has a draw of it
+    // pending.  Changes made from another thread, or through interop, are
+    // not tracked.
+    //
+    // DrawSpriteBatch only supports aliased drawing, so when the device
+    // context is antialiased we only batch draws whose edges fall on whole
+    // pixels, where antialiasing makes no difference.
+    //
+    class DrawBitmapBatcher
+    {
+        ComPtr<ID2D1DeviceContext3> m_deviceContext;
+        bool m_isSpriteBatchQuirkRequired;
+
+        std::vector<Sprite> m_sprites;
+        D2D1_BITMAP_INTERPOLATION_MODE m_interpolationMode;
+
+        // Batchers with pending sprites, and the thread that recorded them.
+        struct PendingBatcher
+        {
+            DrawBitmapBatcher* Batcher;
+            std::thread::id ThreadId;
+        };
+
+        static std::mutex s_pendingMutex;
+        static std::vector<PendingBatcher> s_pendingBatchers;
+
+    public:
+        DrawBitmapBatcher(ID2D1DeviceContext3* deviceContext, bool isSpriteBatchQuirkRequired);
+        ~DrawBitmapBatcher();
+
+        DrawBitmapBatcher(DrawBitmapBatcher const&) = delete;
+        DrawBitmapBatcher& operator=(DrawBitmapBatcher const&) = delete;
+
+        // Records a draw with the same meaning as ID2D1DeviceContext::DrawBitmap.
+        // Returns false, without recording anything, if the draw can't be
+        // expressed as a sprite; the caller should Flush and then draw the
+        // bitmap directly.
+        bool TryAdd(
+            ID2D1Bitmap* bitmap,
+            D2D1_RECT_F const& destinationRect,
+            float opacity,
+            D2D1_INTERPOLATION_MODE interpolationMode,
+            D2D1_RECT_F const* sourceRect);
+
+        void Flush();
+
+        size_t GetPendingCount() const { return m_sprites.size(); }
+
+        // Flushes every batcher on the current thread that has a pending draw of this bitmap.
+        static void FlushDrawsOf(ID2D1Bitmap* bitmap);
+
+    private:
+        bool TryGetSourceRect(ID2D1Bitmap* bitmap, D2D1_RECT_F const* sourceRect, D2D1_RECT_U* pixelSourceRect);
+        bool IsPixelAligned(D2D1_RECT_F const& destinationRect);
+        bool IsDrawing(ID2D1Bitmap* bitmap) const;
+
+        void AddToPendingBatchers();
+        void RemoveFromPendingBatchers();
+    };
+}}}}
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "DrawImageEffectPool.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    DrawImageEffectPool::DrawImageEffectPool()
+        : m_statistics{}
+    {
+    }
+
+
+    ID2D1Effect* DrawImageEffectPool::GetEffect(ID2D1DeviceContext* deviceContext, IID const& effectId)
+    {
+        for (auto& pooledEffect : m_effects)
+        {
+            if (IsEqualGUID(pooledEffect.EffectId, effectId))
+            {
+                ++m_statistics.ReusedCount;
+                return pooledEffect.Effect.Get();
+            }
+        }
+
+        ComPtr<ID2D1Effect> effect;
+        ThrowIfFailed(deviceContext->CreateEffect(effectId, &effect));
+
+        m_effects.push_back(PooledEffect{ effectId, effect });
+
+        ++m_statistics.CreatedCount;
+
+        return effect.Get();
+    }
+
+
+    void DrawImageEffectPool::SetDpiCompensatedEffectInput(ID2D1DeviceContext* deviceContext, ID2D1Effect* effect, uint32_t inputIndex, ID2D1Bitmap* inputBitmap)
+    {
+        auto dpiCompensationEffect = GetEffect(deviceContext, CLSID_D2D1DpiCompensation);
+
+        dpiCompensationEffect->SetInput(0, inputBitmap);
+
+        D2D1_POINT_2F bitmapDpi;
+        inputBitmap->GetDpi(&bitmapDpi.x, &bitmapDpi.y);
+
+        ThrowIfFailed(dpiCompensationEffect->SetValue(D2D1_DPICOMPENSATION_PROP_INPUT_DPI, bitmapDpi));
+        ThrowIfFailed(dpiCompensationEffect->SetValue(D2D1_DPICOMPENSATION_PROP_INTERPOLATION_MODE, D2D1_DPICOMPENSATION_INTERPOLATION_MODE_LINEAR));
+        ThrowIfFailed(dpiCompensationEffect->SetValue(D2D1_DPICOMPENSATION_PROP_BORDER_MODE, D2D1_BORDER_MODE_HARD));
+
+        effect->SetInputEffect(inputIndex, dpiCompensationEffect);
+    }
+
+
+    void DrawImageEffectPool::Clear()
+    {
+        m_effects.clear();
+    }
+}}}}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    struct DrawImageEffectPoolStatistics
+    {
+        uint64_t CreatedCount;          // Helper effects created by the pool
+        uint64_t ReusedCount;           // Requests satisfied by an existing effect
+    };
+
+
+    //
+    // Helper effects used by DrawImage to emulate DrawBitmap options (opacity
+    // and source rectangles) that D2D's DrawImage doesn't support directly.
+    //
+    // Drawing a lot of images with these options used to create a new
+    // ColorMatrix, Border and DpiCompensation effect for every call.  Instead,
+    // each drawing session keeps one effect of each type and points it at the
+    // next image to be drawn.  D2D processes each DrawImage call against the
+    // effect graph as it was at the time of the call, so changing the inputs
+    // and properties of a pooled effect doesn't affect earlier draws (this is
+    // the same thing that happens when an app draws a CanvasEffect, changes
+    // one of its properties, then draws it again).
+    //
+    // A single DrawImage must therefore never request the same type of effect
+    // twice.  Drawing sessions are only used from one thread at a time, so the
+    // pool is not synchronized.
+    //
+    class DrawImageEffectPool
+    {
+        struct PooledEffect
+        {
+            IID EffectId;
+            ComPtr<ID2D1Effect> Effect;
+        };
+
+        std::vector<PooledEffect> m_effects;
+        DrawImageEffectPoolStatistics m_statistics;
+
+    public:
+        DrawImageEffectPool();
+
+        DrawImageEffectPool(DrawImageEffectPool const&) = delete;
+        DrawImageEffectPool& operator=(DrawImageEffectPool const&) = delete;
+
+        ID2D1Effect* GetEffect(ID2D1DeviceContext* deviceContext, IID const& effectId);
+
+        // Equivalent to D2D1::SetDpiCompensatedEffectInput, but using a pooled
+        // DpiCompensation effect.
+        void SetDpiCompensatedEffectInput(ID2D1DeviceContext* deviceContext, ID2D1Effect* effect, uint32_t inputIndex, ID2D1Bitmap* inputBitmap);
+
+        void Clear();
+
+        DrawImageEffectPoolStatistics const& GetStatistics() const { return m_statistics; }
+    };
+}}}}
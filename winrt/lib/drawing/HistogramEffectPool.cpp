@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "HistogramEffectPool.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    HistogramEffectPool::HistogramEffectPool(uint32_t capacity)
+        : m_slots(MaximumCapacity)
+        , m_capacity(0)
+        , m_leaseCount(0)
+        , m_reusedCount(0)
+        , m_createdCount(0)
+        , m_discardedCount(0)
+    {
+        SetCapacity(capacity);
+    }
+
+
+    HistogramAndAtlasEffects HistogramEffectPool::Lease(ID2D1DeviceContext* d2dContext)
+    {
+        m_leaseCount.fetch_add(1, std::memory_order_relaxed);
+
+        HistogramAndAtlasEffects effects;
+
+        // Start from the slot this thread would have put its effects in.
+        // TryTake looks in every slot, so pairs left beyond the capacity by a
+        // racing SetCapacity still get reused.
+        if (m_slots.TryTake(effects, m_capacity.load(std::memory_order_relaxed)))
+        {
+            m_reusedCount.fetch_add(1, std::memory_order_relaxed);
+            return effects;
+        }
+
+        ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Histogram, &effects.HistogramEffect));
+        ThrowIfFailed(d2dContext->CreateEffect(CLSID_D2D1Atlas, &effects.AtlasEffect));
+
+        m_createdCount.fetch_add(1, std::memory_order_relaxed);
+
+        return effects;
+    }
+
+
+    void HistogramEffectPool::Release(HistogramAndAtlasEffects&& effects)
+    {
+        if (!effects.HistogramEffect || !effects.AtlasEffect)
+        {
+            effects = HistogramAndAtlasEffects{};
+            return;
+        }
+
+        if (!m_slots.TryPut(effects, m_capacity.load(std::memory_order_relaxed)))
+        {
+            m_discardedCount.fetch_add(1, std::memory_order_relaxed);
+            effects = HistogramAndAtlasEffects{};
+        }
+    }
+
+
+    void HistogramEffectPool::Clear()
+    {
+        m_slots.Clear();
+    }
+
+
+    uint32_t HistogramEffectPool::GetPooledCount() const
+    {
+        return m_slots.GetFullCount();
+    }
+
+
+    uint32_t HistogramEffectPool::GetCapacity() const
+    {
+        return m_capacity.load(std::memory_order_relaxed);
+    }
+
+
+    void HistogramEffectPool::SetCapacity(uint32_t capacity)
+    {
+        if (capacity > MaximumCapacity)
+            ThrowHR(E_INVALIDARG);
+
+        m_capacity.store(capacity, std::memory_order_relaxed);
+
+        //
+        // A Release racing with this may still put a pair in one of the slots
+        // being emptied.  That pair is not lost: Lease looks in every slot, so
+        // it will be reused, and the pool can never hold more than
+        // MaximumCapacity pairs.
+        //
+        m_slots.Clear(capacity);
+    }
+
+
+    HistogramEffectPoolStatistics HistogramEffectPool::GetStatistics() const
+    {
+        HistogramEffectPoolStatistics statistics{};
+        statistics.LeaseCount = m_leaseCount.load(std::memory_order_relaxed);
+        statistics.ReusedCount = m_reusedCount.load(std::memory_order_relaxed);
+        statistics.CreatedCount = m_createdCount.load(std::memory_order_relaxed);
+        statistics.DiscardedCount = m_discardedCount.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+}}}}
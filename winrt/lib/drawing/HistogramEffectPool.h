@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/LockFreeSlotArray.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    using namespace ::Microsoft::WRL;
+
+    struct HistogramAndAtlasEffects
+    {
+        ComPtr<ID2D1Effect> HistogramEffect;
+        ComPtr<ID2D1Effect> AtlasEffect;
+    };
+
+
+    //
+    // Counters describing how well the pool is working.  These are updated with
+    // relaxed atomics, so a snapshot taken while effects are being leased or
+    // returned may be very slightly inconsistent.
+    //
+    struct HistogramEffectPoolStatistics
+    {
+        uint64_t LeaseCount;        // Number of calls to Lease
+        uint64_t ReusedCount;       // Leases satisfied by a pooled pair of effects
+        uint64_t CreatedCount;      // Pairs of effects created because the pool was empty
+        uint64_t DiscardedCount;    // Returned pairs dropped because the pool was full
+    };
+
+
+    //
+    // Device scoped pool of histogram and atlas effect pairs, used by
+    // CanvasImage.ComputeHistogram(s).  Several threads computing histograms
+    // at the same time each get their own pair, and up to GetCapacity() pairs
+    // are kept for reuse once they are returned.
+    //
+    // Like DeviceContextPool, pooled pairs live in a LockFreeSlotArray, so
+    // neither Lease nor Release ever takes a lock.  Slots are allocated up
+    // front for MaximumCapacity pairs; the capacity only limits how many of
+    // them are used.
+    //
+    class HistogramEffectPool
+    {
+    public:
+        static uint32_t const DefaultCapacity = 16;
+        static uint32_t const MaximumCapacity = 64;
+
+    private:
+        LockFreeSlotArray<HistogramAndAtlasEffects> m_slots;
+        std::atomic<uint32_t> m_capacity;
+
+        std::atomic<uint64_t> m_leaseCount;
+        std::atomic<uint64_t> m_reusedCount;
+        std::atomic<uint64_t> m_createdCount;
+        std::atomic<uint64_t> m_discardedCount;
+
+    public:
+        explicit HistogramEffectPool(uint32_t capacity = DefaultCapacity);
+
+        HistogramEffectPool(HistogramEffectPool const&) = delete;
+        HistogramEffectPool& operator=(HistogramEffectPool const&) = delete;
+
+        // Returns a pooled pair of effects, or creates a new one using d2dContext.
+        HistogramAndAtlasEffects Lease(ID2D1DeviceContext* d2dContext);
+
+        // Takes back a pair of effects, pooling them unless the pool is full.
+        void Release(HistogramAndAtlasEffects&& effects);
+
+        void Clear();
+
+        uint32_t GetPooledCount() const;
+
+        uint32_t GetCapacity() const;
+
+        // Capacity must not be larger than MaximumCapacity.  Shrinking the
+        // pool releases any pairs that no longer fit.
+        void SetCapacity(uint32_t capacity);
+
+        HistogramEffectPoolStatistics GetStatistics() const;
+    };
+}}}}
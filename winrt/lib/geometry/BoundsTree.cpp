@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "BoundsTree.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+
+// Empty bounds have NaN centers, which would break the sort's ordering, so
+// they are all moved to the end instead.
+static float CenterX(D2D1_RECT_F const& rect)
+{
+    float center = (rect.left + rect.right) * 0.5f;
+    return BoundsTree::IsEmpty(rect) ? FLT_MAX : center;
+}
+
+static float CenterY(D2D1_RECT_F const& rect)
+{
+    float center = (rect.top + rect.bottom) * 0.5f;
+    return BoundsTree::IsEmpty(rect) ? FLT_MAX : center;
+}
+
+// Orders the elements so that runs of NodeCapacity consecutive elements are
+// spatially close together.
+template<typename T>
+static void SortTileRecursive(std::vector<T>& elements)
+{
+    size_t nodeCapacity = BoundsTree::NodeCapacity;
+
+    size_t parentCount = (elements.size() + nodeCapacity - 1) / nodeCapacity;
+    size_t sliceCount = static_cast<size_t>(ceil(sqrt(static_cast<double>(parentCount))));
+    size_t sliceSize = ((parentCount + sliceCount - 1) / sliceCount) * nodeCapacity;
+
+    std::sort(elements.begin(), elements.end(),
+        [](T const& a, T const& b)
+        {
+            return CenterX(a.Bounds) < CenterX(b.Bounds);
+        });
+
+    for (size_t sliceBegin = 0; sliceBegin < elements.size(); sliceBegin += sliceSize)
+    {
+        auto sliceEnd = std::min(sliceBegin + sliceSize, elements.size());
+
+        std::sort(elements.begin() + sliceBegin, elements.begin() + sliceEnd,
+            [](T const& a, T const& b)
+            {
+                return CenterY(a.Bounds) < CenterY(b.Bounds);
+            });
+    }
+}
+
+template<typename T>
+std::vector<BoundsTree::Node> BoundsTree::GroupIntoParents(std::vector<T> const& children, uint32_t firstChild, bool isLeaf)
+{
+    std::vector<Node> parents;
+    parents.reserve((children.size() + NodeCapacity - 1) / NodeCapacity);
+
+    for (size_t begin = 0; begin < children.size(); begin += NodeCapacity)
+    {
+        auto end = std::min(begin + NodeCapacity, children.size());
+
+        // Starts out inverted, so that a node with only empty children is empty too.
+        Node parent{ D2D1_RECT_F{ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX } };
+
+        for (auto i = begin; i < end; ++i)
+        {
+            auto& bounds = children[i].Bounds;
+
+            if (IsEmpty(bounds))
+                continue;
+
+            parent.Bounds.left = std::min(parent.Bounds.left, bounds.left);
+            parent.Bounds.top = std::min(parent.Bounds.top, bounds.top);
+            parent.Bounds.right = std::max(parent.Bounds.right, bounds.right);
+            parent.Bounds.bottom = std::max(parent.Bounds.bottom, bounds.bottom);
+        }
+
+        parent.FirstChild = firstChild + static_cast<uint32_t>(begin);
+        parent.ChildCount = static_cast<uint32_t>(end - begin);
+        parent.IsLeaf = isLeaf;
+
+        parents.push_back(parent);
+    }
+
+    return parents;
+}
+
+BoundsTree::BoundsTree()
+{
+}
+
+BoundsTree::BoundsTree(std::vector<D2D1_RECT_F> const& itemBounds)
+{
+    if (itemBounds.empty())
+        return;
+
+    m_entries.reserve(itemBounds.size());
+
+    for (size_t i = 0; i < itemBounds.size(); ++i)
+    {
+        m_entries.push_back(Entry{ itemBounds[i], static_cast<uint32_t>(i) });
+    }
+
+    SortTileRecursive(m_entries);
+
+    auto level = GroupIntoParents(m_entries, 0, true);
+
+    while (level.size() > 1)
+    {
+        SortTileRecursive(level);
+
+        auto firstChild = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.insert(m_nodes.end(), level.begin(), level.end());
+
+        level = GroupIntoParents(level, firstChild, false);
+    }
+
+    m_nodes.push_back(level.front());
+}
@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    //
+    // A static, packed R-tree over a set of bounding rectangles.
+    //
+    // The tree is bulk loaded with the Sort-Tile-Recursive algorithm: items
+    // are sorted into vertical slices by the x coordinate of their centers,
+    // each slice is sorted by y, and runs of NodeCapacity items become leaf
+    // nodes.  The same is then done to the leaves to build the next level,
+    // and so on up to a single root.  Each node's children are contiguous,
+    // so the whole tree is two flat arrays.
+    //
+    // Items with empty bounds (eg. empty geometry, for which D2D reports
+    // inverted, infinite bounds) are kept in the tree but never match.
+    //
+    class BoundsTree
+    {
+    public:
+        static const uint32_t NodeCapacity = 16;
+
+        BoundsTree();
+        explicit BoundsTree(std::vector<D2D1_RECT_F> const& itemBounds);
+
+        uint32_t GetItemCount() const
+        {
+            return static_cast<uint32_t>(m_entries.size());
+        }
+
+        // Calls fn(itemIndex, itemBounds) for every item whose bounds
+        // intersect the rectangle.  Edges that touch count as intersecting.
+        template<typename FN>
+        void ForEachItemIntersecting(D2D1_RECT_F const& rect, FN&& fn) const
+        {
+            if (m_nodes.empty() || IsEmpty(rect))
+                return;
+
+            // Children are pushed NodeCapacity at a time, at most once per level.
+            uint32_t stack[MaximumDepth * NodeCapacity];
+            uint32_t stackSize = 0;
+
+            stack[stackSize++] = static_cast<uint32_t>(m_nodes.size() - 1);
+
+            while (stackSize > 0)
+            {
+                auto& node = m_nodes[stack[--stackSize]];
+
+                if (!Intersects(node.Bounds, rect))
+                    continue;
+
+                auto end = node.FirstChild + node.ChildCount;
+
+                if (node.IsLeaf)
+                {
+                    for (auto i = node.FirstChild; i < end; ++i)
+                    {
+                        auto& entry = m_entries[i];
+
+                        if (Intersects(entry.Bounds, rect))
+                            fn(entry.ItemIndex, entry.Bounds);
+                    }
+                }
+                else
+                {
+                    for (auto i = node.FirstChild; i < end; ++i)
+                    {
+                        assert(stackSize < _countof(stack));
+                        stack[stackSize++] = i;
+                    }
+                }
+            }
+        }
+
+        // True for inverted rectangles, and for rectangles containing NaNs.
+        static bool IsEmpty(D2D1_RECT_F const& rect)
+        {
+            return !(rect.left <= rect.right && rect.top <= rect.bottom);
+        }
+
+        // Expects the query rectangle not to be empty.
+        static bool Intersects(D2D1_RECT_F const& bounds, D2D1_RECT_F const& query)
+        {
+            return bounds.left <= query.right &&
+                   query.left <= bounds.right &&
+                   bounds.top <= query.bottom &&
+                   query.top <= bounds.bottom &&
+                   !IsEmpty(bounds);
+        }
+
+    private:
+        // 16^8 is 2^32, so no tree of uint32_t items can be deeper than this
+        // plus one level for the root.
+        static const uint32_t MaximumDepth = 9;
+
+        struct Entry
+        {
+            D2D1_RECT_F Bounds;
+            uint32_t ItemIndex;
+        };
+
+        struct Node
+        {
+            D2D1_RECT_F Bounds;
+            uint32_t FirstChild;    // Index into m_entries for leaves, m_nodes otherwise.
+            uint32_t ChildCount;
+            bool IsLeaf;
+        };
+
+        // Sorted so that each leaf covers a contiguous range.
+        std::vector<Entry> m_entries;
+
+        // One level after another, leaves first and the root last.
+        std::vector<Node> m_nodes;
+
+        template<typename T>
+        static std::vector<Node> GroupIntoParents(std::vector<T> const& children, uint32_t firstChild, bool isLeaf);
+    };
+}}}}}
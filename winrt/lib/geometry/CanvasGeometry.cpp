@@ -10,6 +10,7 @@
 #include "TessellationSink.h"
 #include "../images/CanvasCommandList.h"
 #include "../text/DrawGlyphRunHelper.h"
+#include "utils/ParallelUtilities.h"
 
 #if WINVER > _WIN32_WINNT_WINBLUE
 #include "InkToGeometryCommandSink.h"
@@ -412,7 +413,7 @@ IFACEMETHODIMP CanvasGeometryFactory::ComputeFlatteningTolerance(
 // D2D1ComputeMaximumScaleFactor, but unfortunately that DLL entrypoint is not marked as
 // valid for Windows Phone 8.1 apps (an oversight). Using it would make Win2D Phone apps
 // fail certification, so instead we must do the calculation directly here ourselves.
-static float ComputeMaximumScaleFactor(D2D1_MATRIX_3X2_F const& m)
+float Geometry::ComputeMaximumScaleFactor(D2D1_MATRIX_3X2_F const& m)
 {
     if (m._12 == 0.0f && m._21 == 0.0f)
     {
@@ -467,6 +468,222 @@ IFACEMETHODIMP CanvasGeometryFactory::get_DefaultFlatteningTolerance(float* theV
         });
 }
 
+static CanvasGeometryRelation FromD2DGeometryRelation(D2D1_GEOMETRY_RELATION d2dRelation)
+{
+    switch (d2dRelation)
+    {
+        case D2D1_GEOMETRY_RELATION_DISJOINT: return CanvasGeometryRelation::Disjoint;
+        case D2D1_GEOMETRY_RELATION_IS_CONTAINED: return CanvasGeometryRelation::Contained;
+        case D2D1_GEOMETRY_RELATION_CONTAINS: return CanvasGeometryRelation::Contains;
+        case D2D1_GEOMETRY_RELATION_OVERLAP: return CanvasGeometryRelation::Overlap;
+        case D2D1_GEOMETRY_RELATION_UNKNOWN:
+        default:
+            assert(false); // Unexpected value returned from D2D.
+            ThrowHR(E_UNEXPECTED);
+    }
+}
+
+// Looks up the D2D resources for an array of geometries.  The returned
+// references keep them alive for the duration of the call, even if one of
+// the geometries is closed part way through.
+static std::vector<ComPtr<ID2D1Geometry>> GetD2DGeometries(uint32_t geometryCount, ICanvasGeometry** geometries)
+{
+    if (geometryCount > 0)
+    {
+        CheckInPointer(geometries);
+    }
+
+    std::vector<ComPtr<ID2D1Geometry>> d2dGeometries(geometryCount);
+
+    for (uint32_t i = 0; i < geometryCount; ++i)
+    {
+        CheckInPointer(geometries[i]);
+        d2dGeometries[i] = GetWrappedResource<ID2D1Geometry>(geometries[i]);
+    }
+
+    return d2dGeometries;
+}
+
+// Returns how many ranges the batch geometry queries should split their
+// items into.  This is limited by the number of cores, and by how much work
+// there is: operationsPerItem is the number of D2D calls made per item, and
+// ranges with fewer than MinimumOperationsPerRange calls are not worth the
+// cost of starting another thread.
+//
+// Getting a range onto another thread through std::async costs tens of
+// microseconds, while the cheap D2D queries (eg. the bounds or hit-test of
+// a simple shape) take well under one, so the minimum is set high enough
+// that typical batches stay on the calling thread.  Only batches of many
+// complex geometries or many points get split.
+//
+// D2D geometry is free-threaded, since both the device factories and the
+// standalone factory are created multithreaded, so each range only needs to
+// avoid writing to the same outputs as the others.
+static uint32_t GetGeometryQueryRangeCount(uint32_t itemCount, uint32_t operationsPerItem)
+{
+    const uint64_t MinimumOperationsPerRange = 4096;
+
+    uint64_t operationCount = static_cast<uint64_t>(itemCount) * std::max(operationsPerItem, 1u);
+    uint64_t maximumRangeCount = std::max<uint64_t>(operationCount / MinimumOperationsPerRange, 1);
+
+    uint32_t rangeCount = std::max(std::thread::hardware_concurrency(), 1u);
+    return static_cast<uint32_t>(std::min<uint64_t>(rangeCount, maximumRangeCount));
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::ComputeBoundsOfGeometries(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    uint32_t* boundsCount,
+    Rect** bounds)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(boundsCount);
+            CheckAndClearOutPointer(bounds);
+
+            auto d2dGeometries = GetD2DGeometries(geometryCount, geometries);
+            auto transform = D2D1::Matrix3x2F::Identity();
+
+            ComArray<Rect> result(geometryCount);
+
+            ForEachRangeInParallel(geometryCount, GetGeometryQueryRangeCount(geometryCount, 1),
+                [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        D2D1_RECT_F d2dBounds;
+                        ThrowIfFailed(d2dGeometries[i]->GetBounds(&transform, &d2dBounds));
+                        result[i] = FromD2DRect(d2dBounds);
+                    }
+                });
+
+            result.Detach(boundsCount, bounds);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::ComputeAreasOfGeometries(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    uint32_t* areasCount,
+    float** areas)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(areasCount);
+            CheckAndClearOutPointer(areas);
+
+            auto d2dGeometries = GetD2DGeometries(geometryCount, geometries);
+            auto transform = D2D1::Matrix3x2F::Identity();
+
+            ComArray<float> result(geometryCount);
+
+            ForEachRangeInParallel(geometryCount, GetGeometryQueryRangeCount(geometryCount, 1),
+                [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        ThrowIfFailed(d2dGeometries[i]->ComputeArea(&transform, D2D1_DEFAULT_FLATTENING_TOLERANCE, &result[i]));
+                    }
+                });
+
+            result.Detach(areasCount, areas);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::FillContainsPoints(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    uint32_t pointCount,
+    Vector2* points,
+    uint32_t* resultsCount,
+    boolean** results)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resultsCount);
+            CheckAndClearOutPointer(results);
+
+            if (pointCount > 0)
+            {
+                CheckInPointer(points);
+
+                if (geometryCount > UINT_MAX / pointCount)
+                    ThrowHR(E_INVALIDARG);
+            }
+
+            auto d2dGeometries = GetD2DGeometries(geometryCount, geometries);
+            auto transform = D2D1::Matrix3x2F::Identity();
+
+            ComArray<boolean> result(geometryCount * pointCount);
+
+            ForEachRangeInParallel(geometryCount, GetGeometryQueryRangeCount(geometryCount, pointCount),
+                [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        for (uint32_t j = 0; j < pointCount; ++j)
+                        {
+                            BOOL d2dContainsPoint;
+
+                            ThrowIfFailed(d2dGeometries[i]->FillContainsPoint(
+                                ToD2DPoint(points[j]),
+                                &transform,
+                                D2D1_DEFAULT_FLATTENING_TOLERANCE,
+                                &d2dContainsPoint));
+
+                            result[i * pointCount + j] = !!d2dContainsPoint;
+                        }
+                    }
+                });
+
+            result.Detach(resultsCount, results);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryFactory::CompareGeometriesWith(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    ICanvasGeometry* otherGeometry,
+    uint32_t* relationsCount,
+    CanvasGeometryRelation** relations)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(otherGeometry);
+            CheckInPointer(relationsCount);
+            CheckAndClearOutPointer(relations);
+
+            auto d2dGeometries = GetD2DGeometries(geometryCount, geometries);
+            auto d2dOtherGeometry = GetWrappedResource<ID2D1Geometry>(otherGeometry);
+            auto transform = D2D1::Matrix3x2F::Identity();
+
+            ComArray<CanvasGeometryRelation> result(geometryCount);
+
+            ForEachRangeInParallel(geometryCount, GetGeometryQueryRangeCount(geometryCount, 1),
+                [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        D2D1_GEOMETRY_RELATION d2dRelation;
+
+                        ThrowIfFailed(d2dGeometries[i]->CompareWithGeometry(
+                            d2dOtherGeometry.Get(),
+                            &transform,
+                            D2D1_DEFAULT_FLATTENING_TOLERANCE,
+                            &d2dRelation));
+
+                        result[i] = FromD2DGeometryRelation(d2dRelation);
+                    }
+                });
+
+            result.Detach(relationsCount, relations);
+        });
+}
+
 CanvasGeometry::CanvasGeometry(GeometryDevicePtr const& device, ID2D1Geometry* d2dGeometry)
     : ResourceWrapper(d2dGeometry)
     , m_device(device)
@@ -737,17 +954,7 @@ IFACEMETHODIMP CanvasGeometry::CompareWithUsingTransformAndFlatteningTolerance(
                 flatteningTolerance,
                 &d2dRelation));
 
-            switch (d2dRelation)
-            {
-                case D2D1_GEOMETRY_RELATION_DISJOINT: *relation = CanvasGeometryRelation::Disjoint; break;
-                case D2D1_GEOMETRY_RELATION_IS_CONTAINED: *relation = CanvasGeometryRelation::Contained; break;
-                case D2D1_GEOMETRY_RELATION_CONTAINS: *relation = CanvasGeometryRelation::Contains; break;
-                case D2D1_GEOMETRY_RELATION_OVERLAP: *relation = CanvasGeometryRelation::Overlap; break;
-                case D2D1_GEOMETRY_RELATION_UNKNOWN:
-                default:
-                    assert(false); // Unexpected value returned from D2D.
-                    ThrowHR(E_UNEXPECTED);
-            }
+            *relation = FromD2DGeometryRelation(d2dRelation);
         });
 }
 
@@ -1116,6 +1323,63 @@ IFACEMETHODIMP CanvasGeometry::TessellateWithTransformAndFlatteningTolerance(
     });
 }
 
+IFACEMETHODIMP CanvasGeometry::TessellateToBuffer(
+    Matrix3x2 transform,
+    float flatteningTolerance,
+    UINT32 bufferCapacity,
+    CanvasTriangleVertices* buffer,
+    UINT32* writtenCount,
+    UINT32* trianglesCount)
+{
+    return ExceptionBoundary([&]
+    {
+        if (bufferCapacity > 0)
+            CheckInPointer(buffer);
+
+        CheckInPointer(writtenCount);
+        CheckInPointer(trianglesCount);
+
+        *writtenCount = 0;
+        *trianglesCount = 0;
+
+        auto& resource = GetResource();
+
+        auto tessellationSink = Make<BufferTessellationSink>(buffer, bufferCapacity);
+        CheckMakeResult(tessellationSink);
+
+        ThrowIfFailed(resource->Tessellate(
+            ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform),
+            flatteningTolerance,
+            tessellationSink.Get()));
+
+        *writtenCount = tessellationSink->GetWrittenCount();
+        *trianglesCount = tessellationSink->GetTrianglesCount();
+    });
+}
+
+IFACEMETHODIMP CanvasGeometry::TessellateToReceiver(
+    Matrix3x2 transform,
+    float flatteningTolerance,
+    ICanvasTriangleReceiver* receiver)
+{
+    return ExceptionBoundary([&]
+    {
+        CheckInPointer(receiver);
+
+        auto& resource = GetResource();
+
+        auto tessellationSink = Make<ReceiverTessellationSink>(receiver);
+        CheckMakeResult(tessellationSink);
+
+        ThrowIfFailed(resource->Tessellate(
+            ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform),
+            flatteningTolerance,
+            tessellationSink.Get()));
+
+        tessellationSink->ThrowIfSinkFailed();
+    });
+}
+
 IFACEMETHODIMP CanvasGeometry::SendPathTo(
     ICanvasPathReceiver* streamReader)
 {
@@ -304,6 +304,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             UINT32* trianglesCount,
             CanvasTriangleVertices** triangles) override;
 
+        IFACEMETHOD(TessellateToBuffer)(
+            Matrix3x2 transform,
+            float flatteningTolerance,
+            UINT32 bufferCapacity,
+            CanvasTriangleVertices* buffer,
+            UINT32* writtenCount,
+            UINT32* trianglesCount) override;
+
+        IFACEMETHOD(TessellateToReceiver)(
+            Matrix3x2 transform,
+            float flatteningTolerance,
+            ICanvasTriangleReceiver* receiver) override;
+
         IFACEMETHOD(SendPathTo)(
             ICanvasPathReceiver* streamReader) override;
 
@@ -485,8 +498,38 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             float* flatteningTolerance) override;
 
         IFACEMETHOD(get_DefaultFlatteningTolerance)(float* theValue) override;
+
+        IFACEMETHOD(ComputeBoundsOfGeometries)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            uint32_t* boundsCount,
+            Rect** bounds) override;
+
+        IFACEMETHOD(ComputeAreasOfGeometries)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            uint32_t* areasCount,
+            float** areas) override;
+
+        IFACEMETHOD(FillContainsPoints)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            uint32_t pointCount,
+            Vector2* points,
+            uint32_t* resultsCount,
+            boolean** results) override;
+
+        IFACEMETHOD(CompareGeometriesWith)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            ICanvasGeometry* otherGeometry,
+            uint32_t* relationsCount,
+            CanvasGeometryRelation** relations) override;
     };
 
+    // The most that the transform can scale a distance by, in any direction.
+    float ComputeMaximumScaleFactor(D2D1_MATRIX_3X2_F const& m);
+
     inline ComPtr<ID2D1StrokeStyle> MaybeGetStrokeStyleResource(
         ID2D1Resource* factoryOwner,
         ICanvasStrokeStyle* strokeStyle)
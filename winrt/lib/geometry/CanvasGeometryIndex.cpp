@@ -0,0 +1,378 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasGeometryIndex.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Geometry;
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+IFACEMETHODIMP CanvasGeometryIndexFactory::Create(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    ICanvasGeometryIndex** geometryIndex)
+{
+    return CreateWithTransformAndFlatteningTolerance(
+        geometryCount,
+        geometries,
+        Identity3x2(),
+        D2D1_DEFAULT_FLATTENING_TOLERANCE,
+        geometryIndex);
+}
+
+IFACEMETHODIMP CanvasGeometryIndexFactory::CreateWithTransformAndFlatteningTolerance(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    Matrix3x2 transform,
+    float flatteningTolerance,
+    ICanvasGeometryIndex** geometryIndex)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckAndClearOutPointer(geometryIndex);
+
+            auto newGeometryIndex = CanvasGeometryIndex::CreateNew(geometryCount, geometries, transform, flatteningTolerance);
+
+            ThrowIfFailed(newGeometryIndex.CopyTo(geometryIndex));
+        });
+}
+
+ComPtr<CanvasGeometryIndex> CanvasGeometryIndex::CreateNew(
+    uint32_t geometryCount,
+    ICanvasGeometry** geometries,
+    Matrix3x2 transform,
+    float flatteningTolerance)
+{
+    if (geometryCount > 0)
+    {
+        CheckInPointer(geometries);
+    }
+
+    // Query results are returned as INT32 indices.
+    if (geometryCount > INT_MAX)
+        ThrowHR(E_INVALIDARG);
+
+    auto d2dTransform = *ReinterpretAs<D2D1_MATRIX_3X2_F*>(&transform);
+
+    std::vector<ComPtr<ID2D1Geometry>> d2dGeometries;
+    std::vector<D2D1_RECT_F> bounds;
+
+    d2dGeometries.reserve(geometryCount);
+    bounds.reserve(geometryCount);
+
+    for (uint32_t i = 0; i < geometryCount; ++i)
+    {
+        CheckInPointer(geometries[i]);
+
+        auto d2dGeometry = GetWrappedResource<ID2D1Geometry>(geometries[i]);
+
+        // This is what ComputeBoundsWithTransform does, but keeping the D2D
+        // rectangle means that empty geometry (which has inverted, infinite
+        // bounds) doesn't get turned into a Rect full of NaNs.
+        D2D1_RECT_F d2dBounds;
+        ThrowIfFailed(d2dGeometry->GetBounds(&d2dTransform, &d2dBounds));
+
+        d2dGeometries.push_back(d2dGeometry);
+        bounds.push_back(d2dBounds);
+    }
+
+    auto geometryIndex = Make<CanvasGeometryIndex>(
+        std::move(d2dGeometries),
+        BoundsTree(bounds),
+        d2dTransform,
+        flatteningTolerance);
+    CheckMakeResult(geometryIndex);
+
+    return geometryIndex;
+}
+
+CanvasGeometryIndex::CanvasGeometryIndex(
+    std::vector<ComPtr<ID2D1Geometry>>&& geometries,
+    BoundsTree&& tree,
+    D2D1_MATRIX_3X2_F const& transform,
+    float flatteningTolerance)
+    : m_geometries(std::move(geometries))
+    , m_transform(transform)
+    , m_flatteningTolerance(flatteningTolerance)
+    , m_tree(std::move(tree))
+    , m_closed(false)
+{
+}
+
+void CanvasGeometryIndex::EnsureNotClosed() const
+{
+    if (m_closed)
+        ThrowHR(RO_E_CLOSED);
+}
+
+// D2D counts points that miss the geometry by less than the flattening
+// tolerance (or, for strokes, that are within the stroke) as hits, so the
+// tree has to be searched with a square around the point rather than the
+// point itself.
+static D2D1_RECT_F InflatePoint(D2D1_POINT_2F const& point, float margin)
+{
+    margin = fabs(margin);
+
+    return D2D1_RECT_F{ point.x - margin, point.y - margin, point.x + margin, point.y + margin };
+}
+
+static bool RectContains(D2D1_RECT_F const& outer, D2D1_RECT_F const& inner)
+{
+    return inner.left >= outer.left &&
+           inner.top >= outer.top &&
+           inner.right <= outer.right &&
+           inner.bottom <= outer.bottom;
+}
+
+static void ReturnIndices(std::vector<int32_t>& matches, uint32_t* indicesCount, int32_t** indices)
+{
+    std::sort(matches.begin(), matches.end());
+
+    ComArray<int32_t> result(matches.begin(), matches.end());
+    result.Detach(indicesCount, indices);
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::get_Count(int32_t* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+            EnsureNotClosed();
+
+            *value = static_cast<int32_t>(m_geometries.size());
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::FindGeometriesContainingPoint(
+    Vector2 point,
+    uint32_t* indicesCount,
+    int32_t** indices)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(indicesCount);
+            CheckAndClearOutPointer(indices);
+            EnsureNotClosed();
+
+            auto d2dPoint = ToD2DPoint(point);
+            std::vector<int32_t> matches;
+
+            m_tree.ForEachItemIntersecting(InflatePoint(d2dPoint, m_flatteningTolerance),
+                [&](uint32_t index, D2D1_RECT_F const&)
+                {
+                    BOOL containsPoint;
+
+                    ThrowIfFailed(m_geometries[index]->FillContainsPoint(
+                        d2dPoint,
+                        &m_transform,
+                        m_flatteningTolerance,
+                        &containsPoint));
+
+                    if (containsPoint)
+                        matches.push_back(static_cast<int32_t>(index));
+                });
+
+            ReturnIndices(matches, indicesCount, indices);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::FindGeometriesWithStrokeContainingPoint(
+    Vector2 point,
+    float strokeWidth,
+    uint32_t* indicesCount,
+    int32_t** indices)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            FindGeometriesWithStrokeContainingPointImpl(point, strokeWidth, nullptr, indicesCount, indices);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::FindGeometriesWithStrokeContainingPointWithStrokeStyle(
+    Vector2 point,
+    float strokeWidth,
+    ICanvasStrokeStyle* strokeStyle,
+    uint32_t* indicesCount,
+    int32_t** indices)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(strokeStyle);
+            FindGeometriesWithStrokeContainingPointImpl(point, strokeWidth, strokeStyle, indicesCount, indices);
+        });
+}
+
+void CanvasGeometryIndex::FindGeometriesWithStrokeContainingPointImpl(
+    Vector2 point,
+    float strokeWidth,
+    ICanvasStrokeStyle* strokeStyle,
+    uint32_t* indicesCount,
+    int32_t** indices)
+{
+    CheckInPointer(indicesCount);
+    CheckAndClearOutPointer(indices);
+    EnsureNotClosed();
+
+    auto d2dPoint = ToD2DPoint(point);
+    std::vector<int32_t> matches;
+
+    // Stroke styles are realized per D2D factory, and the geometries may not
+    // all share one, so this keeps hold of the most recently used realization.
+    ComPtr<ICanvasStrokeStyleInternal> strokeStyleInternal;
+    ComPtr<ID2D1Factory> strokeStyleFactory;
+    ComPtr<ID2D1StrokeStyle1> d2dStrokeStyle;
+
+    if (strokeStyle)
+        strokeStyleInternal = As<ICanvasStrokeStyleInternal>(strokeStyle);
+
+    m_tree.ForEachItemIntersecting(InflatePoint(d2dPoint, GetStrokeMargin(strokeWidth, strokeStyle)),
+        [&](uint32_t index, D2D1_RECT_F const&)
+        {
+            auto& geometry = m_geometries[index];
+
+            if (strokeStyleInternal)
+            {
+                ComPtr<ID2D1Factory> factory;
+                geometry->GetFactory(&factory);
+
+                if (factory != strokeStyleFactory)
+                {
+                    d2dStrokeStyle = strokeStyleInternal->GetRealizedD2DStrokeStyle(factory.Get());
+                    strokeStyleFactory = factory;
+                }
+            }
+
+            BOOL containsPoint;
+
+            ThrowIfFailed(geometry->StrokeContainsPoint(
+                d2dPoint,
+                strokeWidth,
+                d2dStrokeStyle.Get(),
+                &m_transform,
+                m_flatteningTolerance,
+                &containsPoint));
+
+            if (containsPoint)
+                matches.push_back(static_cast<int32_t>(index));
+        });
+
+    ReturnIndices(matches, indicesCount, indices);
+}
+
+// How far outside a geometry's fill bounds its stroke can reach.
+float CanvasGeometryIndex::GetStrokeMargin(float strokeWidth, ICanvasStrokeStyle* strokeStyle) const
+{
+    // These match D2D's behavior when no stroke style is given.
+    auto lineJoin = CanvasLineJoin::Miter;
+    float miterLimit = 10.0f;
+    auto transformBehavior = CanvasStrokeTransformBehavior::Normal;
+
+    if (strokeStyle)
+    {
+        ThrowIfFailed(strokeStyle->get_LineJoin(&lineJoin));
+        ThrowIfFailed(strokeStyle->get_MiterLimit(&miterLimit));
+        ThrowIfFailed(strokeStyle->get_TransformBehavior(&transformBehavior));
+    }
+
+    // Square caps reach furthest at their corners, sqrt(2) half widths out,
+    // and miter joins reach up to miterLimit half widths out.
+    float reach = sqrtf(2.0f);
+
+    if (lineJoin == CanvasLineJoin::Miter || lineJoin == CanvasLineJoin::MiterOrBevel)
+        reach = std::max(reach, miterLimit);
+
+    float width = fabs(strokeWidth);
+
+    switch (transformBehavior)
+    {
+    case CanvasStrokeTransformBehavior::Normal:
+        width *= ComputeMaximumScaleFactor(m_transform);
+        break;
+
+    case CanvasStrokeTransformBehavior::Hairline:
+        width = std::max(width, 1.0f);
+        break;
+
+    default:
+        break;
+    }
+
+    return width * 0.5f * reach + fabs(m_flatteningTolerance);
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::FindGeometriesIntersectingRectangle(
+    Rect rect,
+    uint32_t* indicesCount,
+    int32_t** indices)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(indicesCount);
+            CheckAndClearOutPointer(indices);
+            EnsureNotClosed();
+
+            auto d2dRect = ToD2DRect(rect);
+            std::vector<int32_t> matches;
+
+            // As with stroke styles, the rectangle geometry must come from the
+            // same factory as the geometry it is compared with.
+            ComPtr<ID2D1Factory> rectangleFactory;
+            ComPtr<ID2D1RectangleGeometry> rectangleGeometry;
+
+            m_tree.ForEachItemIntersecting(d2dRect,
+                [&](uint32_t index, D2D1_RECT_F const& bounds)
+                {
+                    // Geometry whose bounds are entirely inside the rectangle
+                    // can't miss it, so only geometry that straddles the edge
+                    // of the rectangle needs an exact test.
+                    if (RectContains(d2dRect, bounds))
+                    {
+                        matches.push_back(static_cast<int32_t>(index));
+                        return;
+                    }
+
+                    auto& geometry = m_geometries[index];
+
+                    ComPtr<ID2D1Factory> factory;
+                    geometry->GetFactory(&factory);
+
+                    if (factory != rectangleFactory)
+                    {
+                        ThrowIfFailed(factory->CreateRectangleGeometry(d2dRect, &rectangleGeometry));
+                        rectangleFactory = factory;
+                    }
+
+                    D2D1_GEOMETRY_RELATION relation;
+
+                    ThrowIfFailed(rectangleGeometry->CompareWithGeometry(
+                        geometry.Get(),
+                        &m_transform,
+                        m_flatteningTolerance,
+                        &relation));
+
+                    if (relation != D2D1_GEOMETRY_RELATION_DISJOINT)
+                        matches.push_back(static_cast<int32_t>(index));
+                });
+
+            ReturnIndices(matches, indicesCount, indices);
+        });
+}
+
+IFACEMETHODIMP CanvasGeometryIndex::Close()
+{
+    m_geometries.clear();
+    m_tree = BoundsTree();
+    m_closed = true;
+
+    return S_OK;
+}
+
+ActivatableClassWithFactory(CanvasGeometryIndex, CanvasGeometryIndexFactory);
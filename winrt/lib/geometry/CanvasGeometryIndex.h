@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "BoundsTree.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
+{
+    using namespace ::Microsoft::WRL;
+
+    //
+    // Culls hit-tests against a BoundsTree of the geometries' transformed
+    // bounds, and then runs the exact D2D test only on the geometries whose
+    // bounds the query touches.
+    //
+    // The index holds on to the D2D geometries rather than the CanvasGeometry
+    // wrappers, so it keeps working if the wrappers are closed.
+    //
+    class CanvasGeometryIndex
+        : public RuntimeClass<
+            ICanvasGeometryIndex,
+            ABI::Windows::Foundation::IClosable>
+        , private LifespanTracker<CanvasGeometryIndex>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasGeometryIndex, BaseTrust);
+
+        std::vector<ComPtr<ID2D1Geometry>> m_geometries;
+        D2D1_MATRIX_3X2_F m_transform;
+        float m_flatteningTolerance;
+        BoundsTree m_tree;
+        bool m_closed;
+
+    public:
+        static ComPtr<CanvasGeometryIndex> CreateNew(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            Matrix3x2 transform,
+            float flatteningTolerance);
+
+        CanvasGeometryIndex(
+            std::vector<ComPtr<ID2D1Geometry>>&& geometries,
+            BoundsTree&& tree,
+            D2D1_MATRIX_3X2_F const& transform,
+            float flatteningTolerance);
+
+        //
+        // ICanvasGeometryIndex
+        //
+
+        IFACEMETHOD(get_Count)(int32_t* value) override;
+
+        IFACEMETHOD(FindGeometriesContainingPoint)(
+            Vector2 point,
+            uint32_t* indicesCount,
+            int32_t** indices) override;
+
+        IFACEMETHOD(FindGeometriesWithStrokeContainingPoint)(
+            Vector2 point,
+            float strokeWidth,
+            uint32_t* indicesCount,
+            int32_t** indices) override;
+
+        IFACEMETHOD(FindGeometriesWithStrokeContainingPointWithStrokeStyle)(
+            Vector2 point,
+            float strokeWidth,
+            ICanvasStrokeStyle* strokeStyle,
+            uint32_t* indicesCount,
+            int32_t** indices) override;
+
+        IFACEMETHOD(FindGeometriesIntersectingRectangle)(
+            Rect rect,
+            uint32_t* indicesCount,
+            int32_t** indices) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        void EnsureNotClosed() const;
+
+        void FindGeometriesWithStrokeContainingPointImpl(
+            Vector2 point,
+            float strokeWidth,
+            ICanvasStrokeStyle* strokeStyle,
+            uint32_t* indicesCount,
+            int32_t** indices);
+
+        float GetStrokeMargin(float strokeWidth, ICanvasStrokeStyle* strokeStyle) const;
+    };
+
+
+    class CanvasGeometryIndexFactory
+        : public AgileActivationFactory<ICanvasGeometryIndexStatics>
+        , private LifespanTracker<CanvasGeometryIndexFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_Geometry_CanvasGeometryIndex, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            ICanvasGeometryIndex** geometryIndex) override;
+
+        IFACEMETHOD(CreateWithTransformAndFlatteningTolerance)(
+            uint32_t geometryCount,
+            ICanvasGeometry** geometries,
+            Matrix3x2 transform,
+            float flatteningTolerance,
+            ICanvasGeometryIndex** geometryIndex) override;
+    };
+}}}}}
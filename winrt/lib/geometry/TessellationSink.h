@@ -6,40 +6,138 @@
 
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Geometry
 {
-    class TessellationSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1TessellationSink>,
-                             private LifespanTracker<TessellationSink>
+    //
+    // D2D has no way to be told to stop tessellating, so sinks remember the
+    // first error raised while handling triangles, ignore any that follow,
+    // and report the error from Close.
+    //
+    class TessellationSinkBase : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ID2D1TessellationSink>
     {
-        std::vector<CanvasTriangleVertices> m_triangles;
         HRESULT m_result;
 
-    public:
-        TessellationSink()
+    protected:
+        TessellationSinkBase()
             : m_result(S_OK)
         { }
 
-        IFACEMETHODIMP_(void) AddTriangles(D2D1_TRIANGLE const* triangles, UINT32 trianglesCount)
+        virtual void OnAddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount) = 0;
+
+    public:
+        void ThrowIfSinkFailed()
+        {
+            ThrowIfFailed(m_result);
+        }
+
+        IFACEMETHODIMP_(void) AddTriangles(D2D1_TRIANGLE const* triangles, UINT32 trianglesCount) override
         {
             if (FAILED(m_result))
                 return;
 
             m_result = ExceptionBoundary([&]
             {
-                auto canvasTriangles = ReinterpretAs<CanvasTriangleVertices const*>(triangles);
-
-                m_triangles.insert(m_triangles.end(), canvasTriangles, canvasTriangles + trianglesCount);
+                OnAddTriangles(ReinterpretAs<CanvasTriangleVertices const*>(triangles), trianglesCount);
             });
         }
 
-        IFACEMETHODIMP Close()
+        IFACEMETHODIMP Close() override
         {
             return m_result;
         }
+    };
+
+
+    // Collects all the triangles, for CanvasGeometry.Tessellate.
+    class TessellationSink : public TessellationSinkBase,
+                             private LifespanTracker<TessellationSink>
+    {
+        std::vector<CanvasTriangleVertices> m_triangles;
+
+    protected:
+        virtual void OnAddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount) override
+        {
+            m_triangles.insert(m_triangles.end(), triangles, triangles + trianglesCount);
+        }
 
+    public:
         ComArray<CanvasTriangleVertices> GetTriangles()
         {
-            ThrowIfFailed(m_result);
+            ThrowIfSinkFailed();
 
             return ComArray<CanvasTriangleVertices>(m_triangles.begin(), m_triangles.end());
         }
     };
+
+
+    //
+    // Writes triangles straight into a caller provided buffer, for
+    // CanvasGeometry.TessellateToBuffer.  Triangles that don't fit are
+    // counted but dropped, so the caller can find out how big a buffer it
+    // needs.
+    //
+    class BufferTessellationSink : public TessellationSinkBase,
+                                   private LifespanTracker<BufferTessellationSink>
+    {
+        CanvasTriangleVertices* m_buffer;
+        uint32_t m_bufferCapacity;
+        uint32_t m_trianglesCount;
+
+    protected:
+        virtual void OnAddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount) override
+        {
+            if (trianglesCount > UINT32_MAX - m_trianglesCount)
+                ThrowHR(E_BOUNDS);
+
+            if (m_trianglesCount < m_bufferCapacity)
+            {
+                auto copyCount = std::min(trianglesCount, m_bufferCapacity - m_trianglesCount);
+
+                std::copy(triangles, triangles + copyCount, m_buffer + m_trianglesCount);
+            }
+
+            m_trianglesCount += trianglesCount;
+        }
+
+    public:
+        BufferTessellationSink(CanvasTriangleVertices* buffer, uint32_t bufferCapacity)
+            : m_buffer(buffer)
+            , m_bufferCapacity(bufferCapacity)
+            , m_trianglesCount(0)
+        { }
+
+        // Returns the total number of triangles, which may be more than were written.
+        uint32_t GetTrianglesCount()
+        {
+            ThrowIfSinkFailed();
+
+            return m_trianglesCount;
+        }
+
+        uint32_t GetWrittenCount()
+        {
+            return std::min(GetTrianglesCount(), m_bufferCapacity);
+        }
+    };
+
+
+    //
+    // Passes each batch of triangles on to an ICanvasTriangleReceiver as D2D
+    // produces them, for CanvasGeometry.TessellateToReceiver.  The batch is
+    // only valid for the duration of the call.
+    //
+    class ReceiverTessellationSink : public TessellationSinkBase,
+                                     private LifespanTracker<ReceiverTessellationSink>
+    {
+        ComPtr<ICanvasTriangleReceiver> m_receiver;
+
+    protected:
+        virtual void OnAddTriangles(CanvasTriangleVertices const* triangles, uint32_t trianglesCount) override
+        {
+            ThrowIfFailed(m_receiver->AddTriangles(trianglesCount, const_cast<CanvasTriangleVertices*>(triangles)));
+        }
+
+    public:
+        ReceiverTessellationSink(ICanvasTriangleReceiver* receiver)
+            : m_receiver(receiver)
+        { }
+    };
 }}}}}
@@ -5,6 +5,10 @@
 #include "pch.h"
 #include <propkey.h>
 
+#include "CanvasMappedPixels.h"
+#include "drawing/DrawBitmapBatcher.h"
+#include "utils/PixelSwizzle.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     using namespace ABI::Windows::Storage::Streams;
@@ -15,6 +19,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     using ABI::Windows::Graphics::Imaging::BitmapPixelFormat;
 #endif
 
+    void FlushBatchedDrawsOf(ID2D1Bitmap* d2dBitmap)
+    {
+#if WINVER > _WIN32_WINNT_WINBLUE
+        DrawBitmapBatcher::FlushDrawsOf(d2dBitmap);
+#else
+        UNREFERENCED_PARAMETER(d2dBitmap);
+#endif
+    }
+
     static void VerifyWellFormedSubrectangle(D2D1_RECT_U subRectangle, D2D1_SIZE_U targetSize)
     {
         if (subRectangle.right <= subRectangle.left ||
@@ -1229,21 +1242,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         const unsigned int destSizeInPixels = subRectangleWidth * subRectangleHeight;
         ComArray<Color> array(destSizeInPixels);
 
-        byte* sourceRowStart = bitmapPixelAccess.GetLockedData();
-
-        for (unsigned int y = 0; y < subRectangleHeight; y++)
-        {
-            for (unsigned int x = 0; x < subRectangleWidth; x++)
-            {
-                uint32_t sourcePixel = *(reinterpret_cast<uint32_t*>(&sourceRowStart[x * 4]));
-                Color& destColor = array[y * subRectangleWidth + x];
-                destColor.B = (sourcePixel >> 0) & 0xFF;
-                destColor.G = (sourcePixel >> 8) & 0xFF;
-                destColor.R = (sourcePixel >> 16) & 0xFF;
-                destColor.A = (sourcePixel >> 24) & 0xFF;
-            }
-            sourceRowStart += bitmapPixelAccess.GetStride();
-        }
+        // B, G, R, A pixels -> Colors, which are stored as A, R, G, B.
+        SwizzlePixelRows(
+            PixelSwizzle::ReverseBytes,
+            bitmapPixelAccess.GetLockedData(),
+            bitmapPixelAccess.GetStride(),
+            GetColorBytes(array.GetData()),
+            subRectangleWidth * 4,
+            subRectangleWidth,
+            subRectangleHeight);
 
         array.Detach(valueCount, valueElements);
     }
@@ -1374,6 +1381,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowHR(E_INVALIDARG, message.Get());
         }
 
+        FlushBatchedDrawsOf(d2dBitmap.Get());
+
         ThrowIfFailed(d2dBitmap->CopyFromMemory(&subRectangle, valueElements, r.GetBytesPerRow()));
     }
 
@@ -1423,9 +1432,66 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowHR(E_INVALIDARG, Strings::PixelColorsFormatRestriction);
         }
 
-        auto convertedValues = ConvertColorsToBgra(expectedArraySize, valueElements);
+        // CopyFromMemory is the only way to write to a GPU bitmap, so the colors
+        // still have to be staged.  The staging buffer is deliberately left
+        // uninitialized, since every byte of it is about to be overwritten.
+        std::unique_ptr<uint8_t[]> convertedValues(new uint8_t[expectedArraySize * 4]);
+
+        SwizzlePixelRows(
+            PixelSwizzle::ReverseBytes,
+            GetColorBytes(valueElements),
+            subRectangleWidth * 4,
+            convertedValues.get(),
+            subRectangleWidth * 4,
+            subRectangleWidth,
+            subRectangleHeight);
+
+        FlushBatchedDrawsOf(d2dBitmap.Get());
 
-        ThrowIfFailed(d2dBitmap->CopyFromMemory(&subRectangle, convertedValues.data(), subRectangleWidth * 4));
+        ThrowIfFailed(d2dBitmap->CopyFromMemory(&subRectangle, convertedValues.get(), subRectangleWidth * 4));
+    }
+
+
+    void GetBitmapSubRectangleLayout(
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        uint32_t* bytesPerRow,
+        uint32_t* rowCount)
+    {
+        BitmapSubRectangle r(d2dBitmap, subRectangle);
+
+        *bytesPerRow = r.GetBytesPerRow();
+        *rowCount = r.GetBlocksHigh();
+    }
+
+
+    void MapPixelsImpl(
+        ComPtr<ICanvasDevice> const& device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        CanvasBitmapMapAccess access,
+        ICanvasMappedPixels** mappedPixels)
+    {
+        CheckAndClearOutPointer(mappedPixels);
+
+        if (access != CanvasBitmapMapAccess::Read && access != CanvasBitmapMapAccess::ReadWrite)
+            ThrowHR(E_INVALIDARG);
+
+        BitmapSubRectangle r(d2dBitmap, subRectangle);
+
+        if (access == CanvasBitmapMapAccess::ReadWrite)
+            FlushBatchedDrawsOf(d2dBitmap.Get());
+
+        auto pixels = Make<CanvasMappedPixels>(
+            device.Get(),
+            d2dBitmap,
+            subRectangle,
+            access,
+            r.GetBytesPerRow(),
+            r.GetBlocksHigh());
+        CheckMakeResult(pixels);
+
+        ThrowIfFailed(pixels.CopyTo(mappedPixels));
     }
 
 
@@ -1471,6 +1537,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             ThrowHR(E_INVALIDARG, Strings::BitmapFormatsDiffer);
         }
 
+        FlushBatchedDrawsOf(toD2dBitmap.Get());
+
         // Are both bitmaps on the same device?
         ComPtr<ICanvasDevice> toDevice;
         ComPtr<ICanvasDevice> fromDevice;
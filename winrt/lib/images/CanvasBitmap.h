@@ -292,6 +292,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         float quality,
         IAsyncAction **resultAsyncAction);
 
+    // Draws of this bitmap held back by CanvasDrawingSession.BatchBitmapDraws
+    // must be drawn before its pixels change.
+    void FlushBatchedDrawsOf(ID2D1Bitmap* d2dBitmap);
+
     void SetPixelBytesImpl(
         ComPtr<ID2D1Bitmap1> const& d2dBitmap,
         D2D1_RECT_U const& subRectangle,
@@ -309,6 +313,21 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         uint32_t valueCount,
         Color *valueElements);
 
+    // Validates a subrectangle of a bitmap, returning the number of bytes in
+    // each row (or row of blocks) that it covers, and the number of rows.
+    void GetBitmapSubRectangleLayout(
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        uint32_t* bytesPerRow,
+        uint32_t* rowCount);
+
+    void MapPixelsImpl(
+        ComPtr<ICanvasDevice> const& device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& subRectangle,
+        CanvasBitmapMapAccess access,
+        ICanvasMappedPixels** mappedPixels);
+
     void CopyPixelsFromBitmapImpl(
         ICanvasBitmap* to,
         ICanvasBitmap* from,
@@ -839,6 +858,46 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             return GetImageBoundsImpl(this, resourceCreator, &transform, bounds);
         }
 
+        IFACEMETHODIMP MapPixels(
+            CanvasBitmapMapAccess access,
+            ICanvasMappedPixels** mappedPixels) override
+        {
+            return ExceptionBoundary(
+                [&]
+                {
+                    auto& d2dBitmap = GetResource();
+
+                    MapPixelsImpl(
+                        m_device,
+                        d2dBitmap,
+                        GetResourceBitmapExtents(d2dBitmap),
+                        access,
+                        mappedPixels);
+                });
+        }
+
+        IFACEMETHODIMP MapPixelsWithSubrectangle(
+            CanvasBitmapMapAccess access,
+            int32_t left,
+            int32_t top,
+            int32_t width,
+            int32_t height,
+            ICanvasMappedPixels** mappedPixels) override
+        {
+            return ExceptionBoundary(
+                [&]
+                {
+                    auto& d2dBitmap = GetResource();
+
+                    MapPixelsImpl(
+                        m_device,
+                        d2dBitmap,
+                        ToD2DRectU(left, top, width, height),
+                        access,
+                        mappedPixels);
+                });
+        }
+
         IFACEMETHODIMP CopyPixelsFromBitmap(
             ICanvasBitmap* otherBitmap)
         {
@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "CanvasBitmapReadbackQueue.h"
+#include "CanvasMappedPixels.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // CanvasBitmapReadbackQueueFactory
+    //
+
+    static ComPtr<CanvasBitmapReadbackQueue> CreateReadbackQueue(ICanvasResourceCreator* resourceCreator, uint32_t depth)
+    {
+        CheckInPointer(resourceCreator);
+
+        ComPtr<ICanvasDevice> device;
+        ThrowIfFailed(resourceCreator->get_Device(&device));
+
+        auto queue = Make<CanvasBitmapReadbackQueue>(device.Get(), depth);
+        CheckMakeResult(queue);
+
+        return queue;
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueueFactory::Create(
+        ICanvasResourceCreator* resourceCreator,
+        ICanvasBitmapReadbackQueue** readbackQueue)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(readbackQueue);
+
+                auto queue = CreateReadbackQueue(resourceCreator, StagingBitmapRing::DefaultDepth);
+
+                ThrowIfFailed(queue.CopyTo(readbackQueue));
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueueFactory::CreateWithDepth(
+        ICanvasResourceCreator* resourceCreator,
+        int32_t depth,
+        ICanvasBitmapReadbackQueue** readbackQueue)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(readbackQueue);
+
+                if (depth <= 0)
+                    ThrowHR(E_INVALIDARG, Strings::ExpectedPositiveNonzero);
+
+                auto queue = CreateReadbackQueue(resourceCreator, static_cast<uint32_t>(depth));
+
+                ThrowIfFailed(queue.CopyTo(readbackQueue));
+            });
+    }
+
+
+    //
+    // CanvasBitmapReadbackQueue
+    //
+
+    CanvasBitmapReadbackQueue::CanvasBitmapReadbackQueue(ICanvasDevice* device, uint32_t depth)
+        : m_device(device)
+        , m_ring(std::make_shared<StagingBitmapRing>(depth))
+    {
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::ReadPixelsAsync(
+        ICanvasBitmap* bitmap,
+        IAsyncOperation<CanvasMappedPixels*>** operation)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                ReadPixelsAsyncImpl(bitmap, nullptr, operation);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::ReadPixelsAsyncWithSubrectangle(
+        ICanvasBitmap* bitmap,
+        int32_t left,
+        int32_t top,
+        int32_t width,
+        int32_t height,
+        IAsyncOperation<CanvasMappedPixels*>** operation)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                auto subRectangle = ToD2DRectU(left, top, width, height);
+
+                ReadPixelsAsyncImpl(bitmap, &subRectangle, operation);
+            });
+    }
+
+
+    void CanvasBitmapReadbackQueue::ReadPixelsAsyncImpl(
+        ICanvasBitmap* bitmap,
+        D2D1_RECT_U const* subRectangle,
+        IAsyncOperation<CanvasMappedPixels*>** operation)
+    {
+        CheckInPointer(bitmap);
+        CheckAndClearOutPointer(operation);
+
+        auto& device = m_device.EnsureNotClosed();
+
+        ComPtr<ICanvasDevice> bitmapDevice;
+        ThrowIfFailed(As<ICanvasResourceCreator>(bitmap)->get_Device(&bitmapDevice));
+
+        if (!IsSameInstance(device.Get(), bitmapDevice.Get()))
+            ThrowHR(E_INVALIDARG, Strings::ReadbackQueueWrongDevice);
+
+        auto& d2dBitmap = As<ICanvasBitmapInternal>(bitmap)->GetD2DBitmap();
+        auto bitmapSize = d2dBitmap->GetPixelSize();
+
+        auto rect = subRectangle ? *subRectangle : D2D1::RectU(0, 0, bitmapSize.width, bitmapSize.height);
+
+        uint32_t bytesPerRow;
+        uint32_t rowCount;
+        GetBitmapSubRectangleLayout(d2dBitmap, rect, &bytesPerRow, &rowCount);
+
+        auto copySize = D2D1::SizeU(rect.right - rect.left, rect.bottom - rect.top);
+
+        // Queue the copy on the calling thread.  This only records GPU work,
+        // so it doesn't wait for any drawing that is still in flight.
+        auto staging = std::make_shared<StagingBitmapLease>();
+
+        {
+            auto deviceContext = As<ICanvasDeviceInternal>(device)->GetResourceCreationDeviceContext();
+
+            *staging = m_ring->Acquire(deviceContext.Get(), copySize, d2dBitmap->GetPixelFormat());
+        }
+
+        ThrowIfFailed(staging->GetBitmap()->CopyFromBitmap(nullptr, d2dBitmap.Get(), &rect));
+
+        // Mapping waits for the copy to complete, so that happens on the
+        // threadpool.  If anything fails the lease is dropped along with the
+        // lambda, returning its slot to the ring.
+        auto asyncOperation = Make<AsyncOperation<CanvasMappedPixels>>(
+            [=]
+            {
+                auto mappedPixels = Make<CanvasMappedPixels>(std::move(*staging), rect, bytesPerRow, rowCount);
+                CheckMakeResult(mappedPixels);
+                return mappedPixels;
+            });
+
+        CheckMakeResult(asyncOperation);
+        ThrowIfFailed(asyncOperation.CopyTo(operation));
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::get_Depth(int32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                m_device.EnsureNotClosed();
+
+                *value = static_cast<int32_t>(m_ring->GetDepth());
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::get_PendingCount(int32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                m_device.EnsureNotClosed();
+
+                *value = static_cast<int32_t>(m_ring->GetInUseCount());
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::get_ReuseStagingBitmaps(boolean* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                m_device.EnsureNotClosed();
+
+                *value = m_ring->GetReuseStagingBitmaps();
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::put_ReuseStagingBitmaps(boolean value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                m_device.EnsureNotClosed();
+
+                m_ring->SetReuseStagingBitmaps(!!value);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::get_Device(ICanvasDevice** value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(value);
+
+                auto& device = m_device.EnsureNotClosed();
+                ThrowIfFailed(device.CopyTo(value));
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasBitmapReadbackQueue::Close()
+    {
+        // Readbacks that are still in flight, or whose results are still
+        // open, keep their staging bitmaps until they are done with them.
+        m_ring->Close();
+        m_device.Close();
+
+        return S_OK;
+    }
+
+
+    ActivatableClassWithFactory(CanvasBitmapReadbackQueue, CanvasBitmapReadbackQueueFactory);
+
+}}}}
@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "StagingBitmapRing.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Asynchronous pixel readback.  ReadPixelsAsync queues a GPU copy into
+    // the next slot of a StagingBitmapRing and returns immediately; mapping
+    // the copy, which is where the CPU would otherwise wait for the GPU,
+    // happens on the threadpool.  This lets the copy for one frame overlap
+    // with rendering the next.
+    //
+    class CanvasBitmapReadbackQueue
+        : public RuntimeClass<
+            ICanvasBitmapReadbackQueue,
+            ABI::Windows::Foundation::IClosable>
+        , private LifespanTracker<CanvasBitmapReadbackQueue>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasBitmapReadbackQueue, BaseTrust);
+
+        ClosablePtr<ICanvasDevice> m_device;
+        std::shared_ptr<StagingBitmapRing> m_ring;
+
+    public:
+        CanvasBitmapReadbackQueue(ICanvasDevice* device, uint32_t depth);
+
+        //
+        // ICanvasBitmapReadbackQueue
+        //
+
+        IFACEMETHOD(ReadPixelsAsync)(
+            ICanvasBitmap* bitmap,
+            IAsyncOperation<CanvasMappedPixels*>** operation) override;
+
+        IFACEMETHOD(ReadPixelsAsyncWithSubrectangle)(
+            ICanvasBitmap* bitmap,
+            int32_t left,
+            int32_t top,
+            int32_t width,
+            int32_t height,
+            IAsyncOperation<CanvasMappedPixels*>** operation) override;
+
+        IFACEMETHOD(get_Depth)(int32_t* value) override;
+        IFACEMETHOD(get_PendingCount)(int32_t* value) override;
+        IFACEMETHOD(get_ReuseStagingBitmaps)(boolean* value) override;
+        IFACEMETHOD(put_ReuseStagingBitmaps)(boolean value) override;
+        IFACEMETHOD(get_Device)(ICanvasDevice** value) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+    private:
+        void ReadPixelsAsyncImpl(
+            ICanvasBitmap* bitmap,
+            D2D1_RECT_U const* subRectangle,
+            IAsyncOperation<CanvasMappedPixels*>** operation);
+    };
+
+
+    class CanvasBitmapReadbackQueueFactory
+        : public AgileActivationFactory<ICanvasBitmapReadbackQueueFactory>
+        , private LifespanTracker<CanvasBitmapReadbackQueueFactory>
+    {
+        InspectableClassStatic(RuntimeClass_Microsoft_Graphics_Canvas_CanvasBitmapReadbackQueue, BaseTrust);
+
+    public:
+        IFACEMETHOD(Create)(
+            ICanvasResourceCreator* resourceCreator,
+            ICanvasBitmapReadbackQueue** readbackQueue) override;
+
+        IFACEMETHOD(CreateWithDepth)(
+            ICanvasResourceCreator* resourceCreator,
+            int32_t depth,
+            ICanvasBitmapReadbackQueue** readbackQueue) override;
+    };
+
+}}}}
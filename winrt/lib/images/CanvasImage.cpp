@@ -219,6 +219,128 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    static void ValidateHistogramBinCount(int32_t numberOfBins)
+    {
+        if (numberOfBins < 2 || numberOfBins > 1024)
+            ThrowHR(E_INVALIDARG);
+    }
+
+
+    // Evaluates the histogram of every (region, channel) combination, packing the results
+    // as [region][channel][bin]. Rather than flushing the GPU once per histogram, this leases
+    // up to MaxHistogramEffectsPerDraw effect pairs and evaluates that many histograms inside
+    // each BeginDraw/EndDraw, reading them all back once the batch has been drawn.
+    static ComArray<float> ComputeHistogramsImpl(
+        ICanvasImage* image,
+        uint32_t regionCount,
+        Rect const* regions,
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t channelCount,
+        Effects::EffectChannelSelect const* channels,
+        int32_t numberOfBins)
+    {
+        const uint32_t MaxHistogramEffectsPerDraw = 16;
+
+        uint64_t histogramCount = static_cast<uint64_t>(regionCount) * channelCount;
+        uint64_t valueCount = histogramCount * numberOfBins;
+
+        if (valueCount > UINT32_MAX / sizeof(float))
+            ThrowHR(E_INVALIDARG);
+
+        ComArray<float> array(static_cast<uint32_t>(valueCount));
+
+        if (histogramCount == 0)
+            return array;
+
+        // Look up a device context.
+        ComPtr<ICanvasDevice> device;
+        ThrowIfFailed(resourceCreator->get_Device(&device));
+
+        auto deviceInternal = As<ICanvasDeviceInternal>(device);
+
+        auto deviceContext = deviceInternal->GetResourceCreationDeviceContext();
+
+        float realizedDpi;
+
+        auto d2dImage = As<ICanvasImageInternal>(image)->GetD2DImage(device.Get(), deviceContext.Get(), GetImageFlags::None, DEFAULT_DPI, &realizedDpi);
+
+        // Look up histogram and atlas effects, one pair per histogram that will be drawn in the same batch.
+        std::vector<ICanvasDeviceInternal::HistogramAndAtlasEffects> leasedEffects;
+
+        auto releaseEffects = MakeScopeWarden(
+            [&]
+            {
+                for (auto& effects : leasedEffects)
+                {
+                    effects.AtlasEffect->SetInput(0, nullptr);
+                    deviceInternal->ReleaseHistogramEffect(std::move(effects));
+                }
+            });
+
+        auto batchSize = static_cast<uint32_t>(std::min<uint64_t>(histogramCount, MaxHistogramEffectsPerDraw));
+
+        leasedEffects.reserve(batchSize);
+
+        while (leasedEffects.size() < batchSize)
+        {
+            leasedEffects.push_back(deviceInternal->LeaseHistogramEffect(deviceContext.Get()));
+
+            auto& effects = leasedEffects.back();
+
+            // The atlas effect selects what region of the source image we want to feed into the histogram.
+            if (realizedDpi != 0 && realizedDpi != DEFAULT_DPI)
+            {
+                ThrowIfFailed(D2D1::SetDpiCompensatedEffectInput(deviceContext.Get(), effects.AtlasEffect.Get(), 0, As<ID2D1Bitmap>(d2dImage).Get()));
+            }
+            else
+            {
+                effects.AtlasEffect->SetInput(0, d2dImage.Get());
+            }
+
+            effects.HistogramEffect->SetInputEffect(0, effects.AtlasEffect.Get());
+        }
+
+        for (uint64_t batchStart = 0; batchStart < histogramCount; batchStart += batchSize)
+        {
+            auto batchCount = static_cast<uint32_t>(std::min<uint64_t>(histogramCount - batchStart, batchSize));
+
+            // Configure one effect pair per histogram in this batch.
+            for (uint32_t i = 0; i < batchCount; i++)
+            {
+                auto histogramIndex = batchStart + i;
+                auto& effects = leasedEffects[i];
+
+                effects.AtlasEffect->SetValue(D2D1_ATLAS_PROP_INPUT_RECT, ToD2DRect(regions[histogramIndex / channelCount]));
+
+                effects.HistogramEffect->SetValue(D2D1_HISTOGRAM_PROP_CHANNEL_SELECT, channels[histogramIndex % channelCount]);
+                effects.HistogramEffect->SetValue(D2D1_HISTOGRAM_PROP_NUM_BINS, numberOfBins);
+            }
+
+            // Evaluate the whole batch by drawing the effects.
+            deviceContext->BeginDraw();
+
+            for (uint32_t i = 0; i < batchCount; i++)
+            {
+                deviceContext->DrawImage(As<ID2D1Image>(leasedEffects[i].HistogramEffect).Get());
+            }
+
+            ThrowIfFailed(deviceContext->EndDraw());
+
+            // Read back the results.
+            for (uint32_t i = 0; i < batchCount; i++)
+            {
+                auto output = array.GetData() + (batchStart + i) * numberOfBins;
+
+                ThrowIfFailed(leasedEffects[i].HistogramEffect->GetValue(D2D1_HISTOGRAM_PROP_HISTOGRAM_OUTPUT,
+                                                                         reinterpret_cast<BYTE*>(output),
+                                                                         numberOfBins * sizeof(float)));
+            }
+        }
+
+        return array;
+    }
+
+
     IFACEMETHODIMP CanvasImageFactory::ComputeHistogram(
         ICanvasImage* image,
         Rect sourceRectangle,
@@ -236,65 +358,117 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
                 CheckInPointer(valueCount);
                 CheckAndClearOutPointer(valueElements);
 
-                if (numberOfBins < 2 || numberOfBins > 1024)
-                    ThrowHR(E_INVALIDARG);
+                ValidateHistogramBinCount(numberOfBins);
 
-                // Look up a device context.
-                ComPtr<ICanvasDevice> device;
-                ThrowIfFailed(resourceCreator->get_Device(&device));
-                
-                auto deviceInternal = As<ICanvasDeviceInternal>(device);
+                auto array = ComputeHistogramsImpl(image, 1, &sourceRectangle, resourceCreator, 1, &channelSelect, numberOfBins);
 
-                auto deviceContext = deviceInternal->GetResourceCreationDeviceContext();
-                
-                // Look up the histogram and atlas effects.
-                auto effects = deviceInternal->LeaseHistogramEffect(deviceContext.Get());
+                array.Detach(valueCount, valueElements);
+            });
+    }
 
-                auto releaseEffects = MakeScopeWarden(
-                    [&]
-                    {
-                        effects.AtlasEffect->SetInput(0, nullptr);
-                        deviceInternal->ReleaseHistogramEffect(std::move(effects));
-                    });
 
-                // Configure the atlas effect to select what region of the source image we want to feed into the histogram.
-                float realizedDpi;
+    IFACEMETHODIMP CanvasImageFactory::ComputeHistograms(
+        ICanvasImage* image,
+        uint32_t regionCount,
+        Rect* regions,
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t channelCount,
+        Effects::EffectChannelSelect* channels,
+        int32_t numberOfBins,
+        uint32_t* valueCount,
+        float** valueElements)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(image);
+                CheckInPointer(resourceCreator);
+                CheckInPointer(valueCount);
+                CheckAndClearOutPointer(valueElements);
 
-                auto d2dImage = As<ICanvasImageInternal>(image)->GetD2DImage(device.Get(), deviceContext.Get(), GetImageFlags::None, DEFAULT_DPI, &realizedDpi);
+                if (regionCount > 0)
+                    CheckInPointer(regions);
 
-                if (realizedDpi != 0 && realizedDpi != DEFAULT_DPI)
-                {
-                    ThrowIfFailed(D2D1::SetDpiCompensatedEffectInput(deviceContext.Get(), effects.AtlasEffect.Get(), 0, As<ID2D1Bitmap>(d2dImage).Get()));
-                }
-                else
-                {
-                    effects.AtlasEffect->SetInput(0, d2dImage.Get());
-                }
+                if (channelCount > 0)
+                    CheckInPointer(channels);
 
-                effects.AtlasEffect->SetValue(D2D1_ATLAS_PROP_INPUT_RECT, ToD2DRect(sourceRectangle));
+                ValidateHistogramBinCount(numberOfBins);
 
-                // Configure the histogram effect.
-                effects.HistogramEffect->SetInputEffect(0, effects.AtlasEffect.Get());
+                auto array = ComputeHistogramsImpl(image, regionCount, regions, resourceCreator, channelCount, channels, numberOfBins);
 
-                effects.HistogramEffect->SetValue(D2D1_HISTOGRAM_PROP_CHANNEL_SELECT, channelSelect);
-                effects.HistogramEffect->SetValue(D2D1_HISTOGRAM_PROP_NUM_BINS, numberOfBins);
+                array.Detach(valueCount, valueElements);
+            });
+    }
 
-                // Evaluate the histogram by drawing the effect.
-                deviceContext->BeginDraw();
 
-                deviceContext->DrawImage(As<ID2D1Image>(effects.HistogramEffect).Get());
+    static uint8_t Premultiply(uint8_t value, uint8_t alpha)
+    {
+        return static_cast<uint8_t>((value * alpha + 127) / 255);
+    }
 
-                ThrowIfFailed(deviceContext->EndDraw());
 
-                // Read back the results.
-                ComArray<float> array(numberOfBins);
+    // D2D effects work on premultiplied pixels, so the color channels are
+    // premultiplied by alpha before they are binned.
+    static uint8_t GetChannelValue(ABI::Windows::UI::Color const& color, Effects::EffectChannelSelect channel)
+    {
+        switch (channel)
+        {
+        case Effects::EffectChannelSelect::Red:   return Premultiply(color.R, color.A);
+        case Effects::EffectChannelSelect::Green: return Premultiply(color.G, color.A);
+        case Effects::EffectChannelSelect::Blue:  return Premultiply(color.B, color.A);
+        case Effects::EffectChannelSelect::Alpha: return color.A;
 
-                ThrowIfFailed(effects.HistogramEffect->GetValue(D2D1_HISTOGRAM_PROP_HISTOGRAM_OUTPUT,
-                                                                reinterpret_cast<BYTE*>(array.GetData()),
-                                                                array.GetSize() * sizeof(float)));
+        default:
+            ThrowHR(E_INVALIDARG);
+        }
+    }
 
-                array.Detach(valueCount, valueElements);
-            });
+
+    void ComputeReferenceHistogram(
+        ABI::Windows::UI::Color const* pixels,
+        uint32_t width,
+        uint32_t height,
+        Rect const& region,
+        Effects::EffectChannelSelect channel,
+        int32_t numberOfBins,
+        float* values)
+    {
+        ValidateHistogramBinCount(numberOfBins);
+
+        std::fill(values, values + numberOfBins, 0.0f);
+
+        // A pixel belongs to the region if its center lies inside it.
+        auto firstPixel = [](float edge, uint32_t limit)
+        {
+            return static_cast<uint32_t>(std::min<float>(std::max(ceilf(edge - 0.5f), 0.0f), static_cast<float>(limit)));
+        };
+
+        auto left   = firstPixel(region.X, width);
+        auto top    = firstPixel(region.Y, height);
+        auto right  = firstPixel(region.X + region.Width, width);
+        auto bottom = firstPixel(region.Y + region.Height, height);
+
+        if (left >= right || top >= bottom)
+            return;
+
+        for (uint32_t y = top; y < bottom; y++)
+        {
+            for (uint32_t x = left; x < right; x++)
+            {
+                auto value = GetChannelValue(pixels[y * width + x], channel);
+                auto bin = std::min(value * numberOfBins / 255, numberOfBins - 1);
+
+                values[bin]++;
+            }
+        }
+
+        // Like the D2D histogram effect, report each bin as a fraction of the total pixel count.
+        auto pixelCount = static_cast<float>((right - left) * (bottom - top));
+
+        for (int32_t i = 0; i < numberOfBins; i++)
+        {
+            values[i] /= pixelCount;
+        }
     }
 
 
@@ -334,6 +508,67 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    static std::shared_ptr<HistogramEffectPool> GetHistogramEffectPool(ICanvasResourceCreator* resourceCreator)
+    {
+        ComPtr<ICanvasDevice> device;
+        ThrowIfFailed(resourceCreator->get_Device(&device));
+
+        auto pool = As<ICanvasDeviceInternal>(device)->GetHistogramEffectPool();
+        ThrowIfNullPointer(pool.get(), RO_E_CLOSED);
+
+        return pool;
+    }
+
+
+    IFACEMETHODIMP CanvasImageFactory::GetHistogramEffectPoolStatistics(
+        ICanvasResourceCreator* resourceCreator,
+        CanvasHistogramEffectPoolStatistics* statistics)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(statistics);
+
+                auto poolStatistics = GetHistogramEffectPool(resourceCreator)->GetStatistics();
+
+                statistics->LeaseCount = poolStatistics.LeaseCount;
+                statistics->ReusedCount = poolStatistics.ReusedCount;
+                statistics->CreatedCount = poolStatistics.CreatedCount;
+                statistics->DiscardedCount = poolStatistics.DiscardedCount;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasImageFactory::GetHistogramEffectPoolCapacity(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t* capacity)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+                CheckInPointer(capacity);
+
+                *capacity = GetHistogramEffectPool(resourceCreator)->GetCapacity();
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasImageFactory::SetHistogramEffectPoolCapacity(
+        ICanvasResourceCreator* resourceCreator,
+        uint32_t capacity)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(resourceCreator);
+
+                GetHistogramEffectPool(resourceCreator)->SetCapacity(capacity);
+            });
+    }
+
+
     ComPtr<IAsyncAction> DefaultCanvasImageAdapter::RunAsync(
         std::function<void()>&& fn)
     {
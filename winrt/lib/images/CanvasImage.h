@@ -70,6 +70,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
     DeviceContextLease GetDeviceContextForGetBounds(ICanvasDevice* device, ICanvasResourceCreator* resourceCreator);
 
+    // CPU reference implementation of the D2D histogram effect, for checking the output of
+    // CanvasImage.ComputeHistogram(s) without a GPU. The pixels are straight alpha colors, which
+    // are premultiplied before binning as D2D does. The region is specified in pixels, and
+    // numberOfBins values are written to the values array, normalized to sum to 1.
+    void ComputeReferenceHistogram(
+        ABI::Windows::UI::Color const* pixels,
+        uint32_t width,
+        uint32_t height,
+        Rect const& region,
+        Effects::EffectChannelSelect channel,
+        int32_t numberOfBins,
+        float* values);
+
     class DefaultCanvasImageAdapter;
     
     class CanvasImageAdapter : public Singleton<CanvasImageAdapter, DefaultCanvasImageAdapter>
@@ -163,8 +176,31 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             uint32_t* valueCount,
             float** valueElements) override;
 
+        IFACEMETHODIMP ComputeHistograms(
+            ICanvasImage* image,
+            uint32_t regionCount,
+            Rect* regions,
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t channelCount,
+            Effects::EffectChannelSelect* channels,
+            int32_t numberOfBins,
+            uint32_t* valueCount,
+            float** valueElements) override;
+
         IFACEMETHODIMP IsHistogramSupported(
             ICanvasDevice* device,
             boolean* result) override;
+
+        IFACEMETHODIMP GetHistogramEffectPoolStatistics(
+            ICanvasResourceCreator* resourceCreator,
+            CanvasHistogramEffectPoolStatistics* statistics) override;
+
+        IFACEMETHODIMP GetHistogramEffectPoolCapacity(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t* capacity) override;
+
+        IFACEMETHODIMP SetHistogramEffectPoolCapacity(
+            ICanvasResourceCreator* resourceCreator,
+            uint32_t capacity) override;
     };
 }}}}
@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+#include "CanvasMappedPixels.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    CanvasMappedPixels::CanvasMappedPixels(
+        ICanvasDevice* device,
+        ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+        D2D1_RECT_U const& rect,
+        CanvasBitmapMapAccess access,
+        uint32_t bytesPerRow,
+        uint32_t rowCount)
+        : m_d2dBitmap(d2dBitmap)
+        , m_rect(rect)
+        , m_access(access)
+        , m_format(d2dBitmap->GetPixelFormat().format)
+        , m_data(nullptr)
+        , m_stride(0)
+        , m_capacity(0)
+        , m_length(0)
+#ifdef _DEBUG
+        , m_isPoisoned(false)
+#endif
+    {
+        m_mapping = std::make_unique<ScopedBitmapMappedPixelAccess>(device, d2dBitmap.Get(), &rect);
+
+        InitializeData(bytesPerRow, rowCount);
+    }
+
+
+    CanvasMappedPixels::CanvasMappedPixels(
+        StagingBitmapLease&& staging,
+        D2D1_RECT_U const& rect,
+        uint32_t bytesPerRow,
+        uint32_t rowCount)
+        : m_rect(rect)
+        , m_access(CanvasBitmapMapAccess::Read)
+        , m_format(staging.GetBitmap()->GetPixelFormat().format)
+        , m_staging(std::move(staging))
+        , m_data(nullptr)
+        , m_stride(0)
+        , m_capacity(0)
+        , m_length(0)
+#ifdef _DEBUG
+        , m_isPoisoned(false)
+#endif
+    {
+        m_mapping = std::make_unique<ScopedBitmapMappedPixelAccess>(m_staging.GetBitmap());
+
+        InitializeData(bytesPerRow, rowCount);
+    }
+
+
+    void CanvasMappedPixels::InitializeData(uint32_t bytesPerRow, uint32_t rowCount)
+    {
+#ifdef _DEBUG
+        bool useCopy = true;
+#else
+        bool useCopy = (m_access == CanvasBitmapMapAccess::ReadWrite);
+#endif
+
+        if (useCopy)
+        {
+            // Tightly packed, so that ReadWrite views can be written back with
+            // a single CopyFromMemory.
+            m_copy.resize(static_cast<size_t>(bytesPerRow) * rowCount);
+
+            auto source = m_mapping->GetLockedData();
+
+            for (uint32_t row = 0; row < rowCount; ++row)
+            {
+                memcpy(m_copy.data() + row * bytesPerRow, source + row * m_mapping->GetStride(), bytesPerRow);
+            }
+
+            // The mapping is kept until Close even though it's no longer
+            // read from, so that staging leases are returned at the same
+            // point in debug and release builds.
+
+            m_data = m_copy.data();
+            m_stride = bytesPerRow;
+            m_capacity = static_cast<uint32_t>(m_copy.size());
+        }
+        else
+        {
+            m_data = m_mapping->GetLockedData();
+            m_stride = m_mapping->GetStride();
+            m_capacity = m_stride * rowCount;
+        }
+
+        m_length = m_capacity;
+    }
+
+
+    HRESULT CanvasMappedPixels::ReleaseMapping()
+    {
+        // Unmap before handing the staging bitmap back to its ring.  The
+        // unmap is done explicitly, rather than left to the destructor, so
+        // that a failure can be reported.
+        HRESULT hr = S_OK;
+
+        if (m_mapping)
+        {
+            hr = m_mapping->Unmap();
+            m_mapping.reset();
+        }
+
+        m_staging.Release();
+
+        return hr;
+    }
+
+
+    CanvasMappedPixels::~CanvasMappedPixels()
+    {
+#ifdef _DEBUG
+        if (m_isPoisoned)
+        {
+            auto isUnchanged = std::all_of(m_copy.begin(), m_copy.end(), [](uint8_t b) { return b == PoisonValue; });
+
+            assert(isUnchanged && "CanvasMappedPixels was written to after it was closed");
+            UNREFERENCED_PARAMETER(isUnchanged);
+        }
+#endif
+    }
+
+
+    void CanvasMappedPixels::ThrowIfClosed() const
+    {
+        if (!m_data)
+            ThrowHR(RO_E_CLOSED);
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Width(uint32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ThrowIfClosed();
+                *value = m_rect.right - m_rect.left;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Height(uint32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ThrowIfClosed();
+                *value = m_rect.bottom - m_rect.top;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Stride(uint32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ThrowIfClosed();
+                *value = m_stride;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Format(DirectXPixelFormat* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ThrowIfClosed();
+                *value = static_cast<DirectXPixelFormat>(m_format);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Access(CanvasBitmapMapAccess* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                ThrowIfClosed();
+                *value = m_access;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::Close()
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                if (!m_data)
+                    return;
+
+                if (m_access == CanvasBitmapMapAccess::ReadWrite)
+                {
+                    ThrowIfFailed(m_d2dBitmap->CopyFromMemory(&m_rect, m_copy.data(), m_stride));
+                }
+
+                m_data = nullptr;
+                m_length = 0;
+                auto hr = ReleaseMapping();
+                m_d2dBitmap.Reset();
+
+#ifdef _DEBUG
+                std::fill(m_copy.begin(), m_copy.end(), PoisonValue);
+                m_isPoisoned = true;
+#else
+                m_copy.clear();
+                m_copy.shrink_to_fit();
+#endif
+
+                ThrowIfFailed(hr);
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Capacity(uint32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                *value = m_data ? m_capacity : 0;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::get_Length(uint32_t* value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckInPointer(value);
+                *value = m_length;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::put_Length(uint32_t value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                ThrowIfClosed();
+
+                if (value > m_capacity)
+                    ThrowHR(E_INVALIDARG);
+
+                m_length = value;
+            });
+    }
+
+
+    IFACEMETHODIMP CanvasMappedPixels::Buffer(byte** value)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                CheckAndClearOutPointer(value);
+                ThrowIfClosed();
+                *value = m_data;
+            });
+    }
+
+}}}}
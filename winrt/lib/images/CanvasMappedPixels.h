@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "ScopedBitmapMappedPixelAccess.h"
+#include "StagingBitmapRing.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // A view over the pixels of a bitmap, returned by CanvasBitmap.MapPixels.
+    //
+    // Lifetime rules:
+    //
+    //  - The pixels are valid from MapPixels until Close.  After Close, the
+    //    IBuffer reports zero length and IBufferByteAccess::Buffer fails with
+    //    RO_E_CLOSED.  Pointers obtained before Close must not be used after.
+    //
+    //  - The view is a snapshot of the bitmap at the time it was mapped.  It
+    //    doesn't see later drawing to the bitmap.
+    //
+    //  - Changes made through a ReadWrite view are written back to the bitmap
+    //    by Close.  A view that is released without being closed is discarded
+    //    without writing anything back.
+    //
+    // Views returned by CanvasBitmapReadbackQueue also hold a slot in the
+    // queue's staging ring.  The mapping, and with it the slot, is held until
+    // Close (or until a view that wasn't closed is released), whichever kind
+    // of view it is and whether or not this is a debug build.
+    //
+    // Only Read views are zero-copy: they point straight at the mapped
+    // staging texture.  ReadWrite views always use a CPU copy, since staging
+    // textures can only be mapped for reading; this is written back with
+    // CopyFromMemory.
+    //
+    // Debug builds always use a CPU copy, so that use-after-close can be
+    // caught: on Close the copy is filled with a poison value, and when the
+    // view is finally released any bytes that no longer hold that value mean
+    // the pixels were written to after the view was closed.  The copy is
+    // owned by the view, so this doesn't depend on how long the mapping is
+    // held.
+    //
+    class CanvasMappedPixels
+        : public RuntimeClass<
+            RuntimeClassFlags<WinRtClassicComMix>,
+            ICanvasMappedPixels,
+            ABI::Windows::Foundation::IClosable,
+            ABI::Windows::Storage::Streams::IBuffer,
+            ::Windows::Storage::Streams::IBufferByteAccess>
+        , private LifespanTracker<CanvasMappedPixels>
+    {
+        InspectableClass(RuntimeClass_Microsoft_Graphics_Canvas_CanvasMappedPixels, BaseTrust);
+
+        ComPtr<ID2D1Bitmap1> m_d2dBitmap;
+        D2D1_RECT_U m_rect;
+        CanvasBitmapMapAccess m_access;
+        DXGI_FORMAT m_format;
+
+        StagingBitmapLease m_staging;
+        std::unique_ptr<ScopedBitmapMappedPixelAccess> m_mapping;
+        std::vector<uint8_t> m_copy;
+
+        uint8_t* m_data;
+        uint32_t m_stride;
+        uint32_t m_capacity;
+        uint32_t m_length;
+
+#ifdef _DEBUG
+        bool m_isPoisoned;
+#endif
+
+    public:
+        static uint8_t const PoisonValue = 0xDD;
+
+        CanvasMappedPixels(
+            ICanvasDevice* device,
+            ComPtr<ID2D1Bitmap1> const& d2dBitmap,
+            D2D1_RECT_U const& rect,
+            CanvasBitmapMapAccess access,
+            uint32_t bytesPerRow,
+            uint32_t rowCount);
+
+        // Maps a staging bitmap that a readback has already been copied into.
+        CanvasMappedPixels(
+            StagingBitmapLease&& staging,
+            D2D1_RECT_U const& rect,
+            uint32_t bytesPerRow,
+            uint32_t rowCount);
+
+        ~CanvasMappedPixels();
+
+        //
+        // ICanvasMappedPixels
+        //
+
+        IFACEMETHOD(get_Width)(uint32_t* value) override;
+        IFACEMETHOD(get_Height)(uint32_t* value) override;
+        IFACEMETHOD(get_Stride)(uint32_t* value) override;
+        IFACEMETHOD(get_Format)(DirectXPixelFormat* value) override;
+        IFACEMETHOD(get_Access)(CanvasBitmapMapAccess* value) override;
+
+        //
+        // IClosable
+        //
+
+        IFACEMETHOD(Close)() override;
+
+        //
+        // IBuffer
+        //
+
+        IFACEMETHOD(get_Capacity)(uint32_t* value) override;
+        IFACEMETHOD(get_Length)(uint32_t* value) override;
+        IFACEMETHOD(put_Length)(uint32_t value) override;
+
+        //
+        // IBufferByteAccess
+        //
+
+        IFACEMETHOD(Buffer)(byte** value) override;
+
+    private:
+        void InitializeData(uint32_t bytesPerRow, uint32_t rowCount);
+        HRESULT ReleaseMapping();
+        void ThrowIfClosed() const;
+    };
+
+}}}}
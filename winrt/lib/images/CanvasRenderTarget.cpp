@@ -236,6 +236,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
                 auto& resource = GetD2DBitmap();
 
+                // Anything drawn to us must come after draws of us that another session is holding back.
+                FlushBatchedDrawsOf(resource.Get());
+
                 auto newDrawingSession = CreateDrawingSessionOverD2DBitmap(
                     m_device.Get(),
                     resource.Get(),
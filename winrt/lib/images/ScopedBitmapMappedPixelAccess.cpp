@@ -8,6 +8,7 @@
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     ScopedBitmapMappedPixelAccess::ScopedBitmapMappedPixelAccess(ICanvasDevice* device, ID2D1Bitmap1* d2dBitmap, D2D1_RECT_U const* optionalSubRectangle)
+        : m_isMapped(false)
     {
         auto bitmapSize = d2dBitmap->GetPixelSize();
         
@@ -44,17 +45,50 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
             d2dBitmap,
             optionalSubRectangle));
 
+        Map(bitmapSize.height);
+    }
+
+
+    ScopedBitmapMappedPixelAccess::ScopedBitmapMappedPixelAccess(ComPtr<ID2D1Bitmap1> const& stagingBitmap)
+        : m_stagingResource(stagingBitmap)
+        , m_isMapped(false)
+    {
+        Map(stagingBitmap->GetPixelSize().height);
+    }
+
+
+    void ScopedBitmapMappedPixelAccess::Map(unsigned int height)
+    {
         ThrowIfFailed(m_stagingResource->Map(
             D2D1_MAP_OPTIONS_READ,
             &m_mappedSubresource));
 
-        m_lockedBufferSize = m_mappedSubresource.pitch * bitmapSize.height;
+        m_isMapped = true;
+        m_lockedBufferSize = m_mappedSubresource.pitch * height;
     }
 
 
     ScopedBitmapMappedPixelAccess::~ScopedBitmapMappedPixelAccess()
     {
-        ThrowIfFailed(m_stagingResource->Unmap());
+        // Destructors must not throw, so a failure here can only be
+        // reported in debug builds.
+        auto hr = Unmap();
+
+        assert(SUCCEEDED(hr));
+        UNREFERENCED_PARAMETER(hr);
+    }
+
+
+    HRESULT ScopedBitmapMappedPixelAccess::Unmap()
+    {
+        if (!m_isMapped)
+            return S_OK;
+
+        m_isMapped = false;
+        m_mappedSubresource.bits = nullptr;
+        m_lockedBufferSize = 0;
+
+        return m_stagingResource->Unmap();
     }
 
 }}}}
@@ -13,14 +13,29 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         D2D1_MAPPED_RECT m_mappedSubresource;
         unsigned int m_lockedBufferSize;
         ComPtr<ID2D1Bitmap1> m_stagingResource;
+        bool m_isMapped;
 
     public:
         ScopedBitmapMappedPixelAccess(ICanvasDevice* device, ID2D1Bitmap1* d2dBitmap, D2D1_RECT_U const* optionalSubRectangle = nullptr);
+
+        // Maps a CPU readable staging bitmap that the caller has already
+        // copied into, eg. one from a StagingBitmapRing.
+        explicit ScopedBitmapMappedPixelAccess(ComPtr<ID2D1Bitmap1> const& stagingBitmap);
+
+        // Unmaps without throwing.  Call Unmap first to find out whether
+        // unmapping succeeded.
         ~ScopedBitmapMappedPixelAccess();
 
+        // Unmaps the staging bitmap.  The locked data must not be used after
+        // this.  Calling this more than once does nothing.
+        HRESULT Unmap();
+
         uint8_t* GetLockedData()           const { return m_mappedSubresource.bits; }
         unsigned int GetLockedBufferSize() const { return m_lockedBufferSize; }
         unsigned int GetStride()           const { return m_mappedSubresource.pitch; }
+
+    private:
+        void Map(unsigned int height);
     };
 
 
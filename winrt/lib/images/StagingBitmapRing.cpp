@@ -0,0 +1,223 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+#include "StagingBitmapRing.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // StagingBitmapLease
+    //
+
+    StagingBitmapLease::StagingBitmapLease()
+        : m_slotIndex(0)
+    {
+    }
+
+
+    StagingBitmapLease::StagingBitmapLease(std::shared_ptr<StagingBitmapRing> ring, uint32_t slotIndex, ComPtr<ID2D1Bitmap1> bitmap)
+        : m_ring(std::move(ring))
+        , m_slotIndex(slotIndex)
+        , m_bitmap(std::move(bitmap))
+    {
+    }
+
+
+    StagingBitmapLease::StagingBitmapLease(StagingBitmapLease&& other)
+        : m_ring(std::move(other.m_ring))
+        , m_slotIndex(other.m_slotIndex)
+        , m_bitmap(std::move(other.m_bitmap))
+    {
+    }
+
+
+    StagingBitmapLease& StagingBitmapLease::operator=(StagingBitmapLease&& other)
+    {
+        if (this != &other)
+        {
+            Release();
+
+            m_ring = std::move(other.m_ring);
+            m_slotIndex = other.m_slotIndex;
+            m_bitmap = std::move(other.m_bitmap);
+        }
+
+        return *this;
+    }
+
+
+    StagingBitmapLease::~StagingBitmapLease()
+    {
+        Release();
+    }
+
+
+    void StagingBitmapLease::Release()
+    {
+        m_bitmap.Reset();
+
+        if (m_ring)
+        {
+            m_ring->Release(m_slotIndex);
+            m_ring.reset();
+        }
+    }
+
+
+    //
+    // StagingBitmapRing
+    //
+
+    StagingBitmapRing::StagingBitmapRing(uint32_t depth)
+        : m_slots(depth)
+        , m_nextSlot(0)
+        , m_createdCount(0)
+        , m_reuseStagingBitmaps(true)
+        , m_isClosed(false)
+    {
+        if (depth == 0)
+            ThrowHR(E_INVALIDARG);
+    }
+
+
+    StagingBitmapLease StagingBitmapRing::Acquire(
+        ID2D1DeviceContext* deviceContext,
+        D2D1_SIZE_U size,
+        D2D1_PIXEL_FORMAT format)
+    {
+        Lock lock(m_mutex);
+
+        if (m_isClosed)
+            ThrowHR(RO_E_CLOSED);
+
+        // Take the first free slot at or after m_nextSlot, so that slots are
+        // reused in the order they were handed out.  The oldest readback is
+        // the one most likely to have finished on the GPU.
+        auto depth = GetDepth();
+        uint32_t slotIndex = depth;
+
+        for (uint32_t i = 0; i < depth; ++i)
+        {
+            auto candidate = (m_nextSlot + i) % depth;
+
+            if (!m_slots[candidate].IsInUse)
+            {
+                slotIndex = candidate;
+                break;
+            }
+        }
+
+        if (slotIndex == depth)
+            ThrowHR(E_ILLEGAL_METHOD_CALL, Strings::ReadbackQueueFull);
+
+        auto& slot = m_slots[slotIndex];
+
+        if (!m_reuseStagingBitmaps || !CanReuse(slot.Bitmap.Get(), size, format))
+        {
+            slot.Bitmap.Reset();
+
+            auto properties = D2D1::BitmapProperties1(
+                D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+                format);
+
+            ThrowIfFailed(deviceContext->CreateBitmap(size, nullptr, 0, &properties, &slot.Bitmap));
+
+            ++m_createdCount;
+        }
+
+        slot.IsInUse = true;
+        m_nextSlot = (slotIndex + 1) % depth;
+
+        return StagingBitmapLease(shared_from_this(), slotIndex, slot.Bitmap);
+    }
+
+
+    void StagingBitmapRing::Release(uint32_t slotIndex)
+    {
+        Lock lock(m_mutex);
+
+        auto& slot = m_slots[slotIndex];
+
+        assert(slot.IsInUse);
+
+        slot.IsInUse = false;
+
+        if (!m_reuseStagingBitmaps || m_isClosed)
+            slot.Bitmap.Reset();
+    }
+
+
+    bool StagingBitmapRing::CanReuse(ID2D1Bitmap1* bitmap, D2D1_SIZE_U size, D2D1_PIXEL_FORMAT format)
+    {
+        if (!bitmap)
+            return false;
+
+        // Readbacks always copy to (0, 0), so a larger staging bitmap works
+        // just as well.  Only the format has to match exactly.
+        auto bitmapSize = bitmap->GetPixelSize();
+        auto bitmapFormat = bitmap->GetPixelFormat();
+
+        return bitmapSize.width >= size.width &&
+               bitmapSize.height >= size.height &&
+               bitmapFormat.format == format.format &&
+               bitmapFormat.alphaMode == format.alphaMode;
+    }
+
+
+    uint32_t StagingBitmapRing::GetInUseCount()
+    {
+        Lock lock(m_mutex);
+
+        return static_cast<uint32_t>(std::count_if(m_slots.begin(), m_slots.end(), [](Slot const& slot) { return slot.IsInUse; }));
+    }
+
+
+    uint32_t StagingBitmapRing::GetCreatedCount()
+    {
+        Lock lock(m_mutex);
+
+        return m_createdCount;
+    }
+
+
+    bool StagingBitmapRing::GetReuseStagingBitmaps()
+    {
+        Lock lock(m_mutex);
+
+        return m_reuseStagingBitmaps;
+    }
+
+
+    void StagingBitmapRing::SetReuseStagingBitmaps(bool value)
+    {
+        Lock lock(m_mutex);
+
+        m_reuseStagingBitmaps = value;
+
+        if (!value)
+        {
+            for (auto& slot : m_slots)
+            {
+                if (!slot.IsInUse)
+                    slot.Bitmap.Reset();
+            }
+        }
+    }
+
+
+    void StagingBitmapRing::Close()
+    {
+        Lock lock(m_mutex);
+
+        m_isClosed = true;
+
+        for (auto& slot : m_slots)
+        {
+            if (!slot.IsInUse)
+                slot.Bitmap.Reset();
+        }
+    }
+
+}}}}
@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    class StagingBitmapRing;
+
+    //
+    // A staging bitmap checked out of a StagingBitmapRing.  Its slot is
+    // returned to the ring when the lease is released or destroyed.
+    //
+    class StagingBitmapLease
+    {
+        std::shared_ptr<StagingBitmapRing> m_ring;
+        uint32_t m_slotIndex;
+        ComPtr<ID2D1Bitmap1> m_bitmap;
+
+    public:
+        StagingBitmapLease();
+        StagingBitmapLease(std::shared_ptr<StagingBitmapRing> ring, uint32_t slotIndex, ComPtr<ID2D1Bitmap1> bitmap);
+        StagingBitmapLease(StagingBitmapLease&& other);
+        StagingBitmapLease& operator=(StagingBitmapLease&& other);
+        ~StagingBitmapLease();
+
+        StagingBitmapLease(StagingBitmapLease const&) = delete;
+        StagingBitmapLease& operator=(StagingBitmapLease const&) = delete;
+
+        ComPtr<ID2D1Bitmap1> const& GetBitmap() const { return m_bitmap; }
+        uint32_t GetSlotIndex() const { return m_slotIndex; }
+
+        void Release();
+    };
+
+
+    //
+    // A fixed number of CPU readable staging bitmaps, handed out in ring
+    // order.  CanvasBitmapReadbackQueue copies each readback into the next
+    // free slot, so that the copy for one frame can still be in flight on
+    // the GPU while the previous frame's slot is being mapped and read.
+    //
+    // A slot's staging bitmap is kept when its lease is released, and is
+    // reused by later readbacks of the same format that fit inside it.  This
+    // can be turned off, in which case each slot releases its bitmap as soon
+    // as it is no longer in use.
+    //
+    // When every slot is in use Acquire fails rather than blocking, leaving
+    // it to the caller to decide whether to drop or delay the readback.
+    //
+    // This holds no reference to a device; staging bitmaps are created
+    // through whichever device context is passed to Acquire.
+    //
+    class StagingBitmapRing : public std::enable_shared_from_this<StagingBitmapRing>,
+                              private LifespanTracker<StagingBitmapRing>
+    {
+        struct Slot
+        {
+            ComPtr<ID2D1Bitmap1> Bitmap;
+            bool IsInUse;
+        };
+
+        std::mutex m_mutex;
+        std::vector<Slot> m_slots;
+        uint32_t m_nextSlot;
+        uint32_t m_createdCount;
+        bool m_reuseStagingBitmaps;
+        bool m_isClosed;
+
+    public:
+        static uint32_t const DefaultDepth = 3;
+
+        explicit StagingBitmapRing(uint32_t depth = DefaultDepth);
+
+        StagingBitmapLease Acquire(
+            ID2D1DeviceContext* deviceContext,
+            D2D1_SIZE_U size,
+            D2D1_PIXEL_FORMAT format);
+
+        uint32_t GetDepth() const { return static_cast<uint32_t>(m_slots.size()); }
+        uint32_t GetInUseCount();
+        uint32_t GetCreatedCount();
+
+        bool GetReuseStagingBitmaps();
+        void SetReuseStagingBitmaps(bool value);
+
+        // Drops all idle staging bitmaps and fails any further Acquire calls.
+        // Bitmaps that are still leased are dropped as their leases end.
+        void Close();
+
+    private:
+        friend class StagingBitmapLease;
+
+        void Release(uint32_t slotIndex);
+
+        static bool CanReuse(ID2D1Bitmap1* bitmap, D2D1_SIZE_U size, D2D1_PIXEL_FORMAT format);
+    };
+
+}}}}
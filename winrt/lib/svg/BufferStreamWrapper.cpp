@@ -178,6 +178,233 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         return stream;
     }
 
+
+
+    //
+    // WriteOnlyStream
+    //
+
+    WriteOnlyStream::WriteOnlyStream()
+        : m_position(0)
+    {
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Read(void*, ULONG, ULONG*)
+    {
+        return E_NOTIMPL; // This stream supports write only.
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Write(void const* source, ULONG numberOfBytes, ULONG* outputNumberOfBytesWritten)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                if (numberOfBytes && !source)
+                    ThrowHR(STG_E_INVALIDPOINTER);
+
+                WriteBytes(static_cast<uint8_t const*>(source), numberOfBytes);
+
+                m_position += numberOfBytes;
+
+                if (outputNumberOfBytesWritten)
+                    *outputNumberOfBytesWritten = numberOfBytes;
+            });
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Seek(LARGE_INTEGER distanceToMove, DWORD origin, ULARGE_INTEGER* newSeekLocation)
+    {
+        // Writers may ask where they are, but cannot move.
+        if (origin != STREAM_SEEK_CUR || distanceToMove.QuadPart != 0)
+            return E_NOTIMPL;
+
+        if (newSeekLocation)
+            newSeekLocation->QuadPart = m_position;
+
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::SetSize(ULARGE_INTEGER)
+    {
+        return E_NOTIMPL; // This stream is not resizable.
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*)
+    {
+        return E_NOTIMPL; // Copying to other streams is not supported
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Commit(DWORD)
+    {
+        return S_OK; // Nothing is transacted (e.g., requires flushing), so this has no effect.
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Revert()
+    {
+        return S_OK; // Nothing is transacted, so this has no effect.
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return E_NOTIMPL; // Region locking is not supported
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return E_NOTIMPL; // Region locking is not supported
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Clone(IStream**)
+    {
+        return E_NOTIMPL; // Nothing should be cloning this stream.
+    }
+
+    HRESULT STDMETHODCALLTYPE WriteOnlyStream::Stat(STATSTG*, DWORD)
+    {
+        return E_NOTIMPL; // Not supported
+    }
+
+
+    //
+    // Utf8ToUtf16Stream
+    //
+
+    // Number of bytes in a UTF-8 sequence, given its first byte.  Invalid
+    // lead bytes count as one, and are left for MultiByteToWideChar to
+    // replace.
+    static size_t GetUtf8SequenceLength(uint8_t leadByte)
+    {
+        if ((leadByte & 0xE0) == 0xC0) return 2;
+        if ((leadByte & 0xF0) == 0xE0) return 3;
+        if ((leadByte & 0xF8) == 0xF0) return 4;
+        return 1;
+    }
+
+    static bool IsUtf8ContinuationByte(uint8_t value)
+    {
+        return (value & 0xC0) == 0x80;
+    }
+
+    Utf8ToUtf16Stream::Utf8ToUtf16Stream()
+        : m_pendingByteCount(0)
+    {
+    }
+
+    void Utf8ToUtf16Stream::WriteBytes(uint8_t const* bytes, size_t numberOfBytes)
+    {
+        // Finish off a sequence left over from the previous write.
+        while (m_pendingByteCount && numberOfBytes)
+        {
+            if (!IsUtf8ContinuationByte(*bytes))
+            {
+                // Truncated sequence; let MultiByteToWideChar replace it.
+                Convert(m_pendingBytes, m_pendingByteCount);
+                m_pendingByteCount = 0;
+                break;
+            }
+
+            m_pendingBytes[m_pendingByteCount++] = *bytes++;
+            numberOfBytes--;
+
+            if (m_pendingByteCount == GetUtf8SequenceLength(m_pendingBytes[0]))
+            {
+                Convert(m_pendingBytes, m_pendingByteCount);
+                m_pendingByteCount = 0;
+            }
+        }
+
+        if (!numberOfBytes)
+            return;
+
+        // Hold back a sequence that continues into the next write.
+        size_t sequenceStart = numberOfBytes;
+        size_t lookBack = std::min<size_t>(numberOfBytes, 3);
+
+        for (size_t i = 1; i <= lookBack; ++i)
+        {
+            if (!IsUtf8ContinuationByte(bytes[numberOfBytes - i]))
+            {
+                sequenceStart = numberOfBytes - i;
+                break;
+            }
+        }
+
+        size_t completeByteCount = numberOfBytes;
+
+        if (sequenceStart < numberOfBytes &&
+            GetUtf8SequenceLength(bytes[sequenceStart]) > numberOfBytes - sequenceStart)
+        {
+            completeByteCount = sequenceStart;
+        }
+
+        Convert(bytes, completeByteCount);
+
+        m_pendingByteCount = numberOfBytes - completeByteCount;
+        std::copy(bytes + completeByteCount, bytes + numberOfBytes, m_pendingBytes);
+    }
+
+    void Utf8ToUtf16Stream::Convert(uint8_t const* bytes, size_t numberOfBytes)
+    {
+        if (!numberOfBytes)
+            return;
+
+        if (numberOfBytes > INT_MAX)
+            ThrowHR(E_INVALIDARG);
+
+        // UTF-16 never needs more code units than UTF-8 needs bytes.
+        auto previousCount = m_characters.size();
+        m_characters.resize(previousCount + numberOfBytes);
+
+        int convertedCount = MultiByteToWideChar(
+            CP_UTF8,
+            0, // Default flags
+            reinterpret_cast<char const*>(bytes),
+            static_cast<int>(numberOfBytes),
+            m_characters.data() + previousCount,
+            static_cast<int>(numberOfBytes));
+
+        if (convertedCount == 0)
+            ThrowHR(E_INVALIDARG);
+
+        m_characters.resize(previousCount + convertedCount);
+    }
+
+    WinString Utf8ToUtf16Stream::GetString()
+    {
+        if (m_pendingByteCount)
+        {
+            Convert(m_pendingBytes, m_pendingByteCount);
+            m_pendingByteCount = 0;
+        }
+
+        if (m_characters.empty())
+            return WinString();
+
+        return WinString(m_characters.data(), m_characters.data() + m_characters.size());
+    }
+
+
+    //
+    // FixedBufferStream
+    //
+
+    FixedBufferStream::FixedBufferStream(uint8_t* buffer, size_t capacity)
+        : m_buffer(buffer)
+        , m_capacity(capacity)
+    {
+    }
+
+    void FixedBufferStream::WriteBytes(uint8_t const* bytes, size_t numberOfBytes)
+    {
+        auto position = GetPosition();
+
+        if (position >= m_capacity)
+            return;
+
+        auto bytesToCopy = std::min<uint64_t>(numberOfBytes, m_capacity - position);
+
+        memcpy(m_buffer + position, bytes, static_cast<size_t>(bytesToCopy));
+    }
+
 }}}}}
 
 #endif
\ No newline at end of file
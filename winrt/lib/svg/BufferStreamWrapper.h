@@ -8,4 +8,89 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 {    
     ComPtr<IStream> WrapSvgStringInStream(HSTRING sourceString);
 
+
+    //
+    // Base for streams that ID2D1SvgDocument::Serialize writes into.  Only
+    // sequential writes are supported.
+    //
+    class WriteOnlyStream : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IStream>
+    {
+        uint64_t m_position;
+
+    public:
+        WriteOnlyStream();
+
+        // ISequentialStream Interface
+
+        virtual HRESULT STDMETHODCALLTYPE Read(void*, ULONG, ULONG*) override;
+        virtual HRESULT STDMETHODCALLTYPE Write(void const* source, ULONG numberOfBytes, ULONG* outputNumberOfBytesWritten) override;
+
+        // IStream Interface
+
+        virtual HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER distanceToMove, DWORD origin, ULARGE_INTEGER* newSeekLocation) override;
+        virtual HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER) override;
+        virtual HRESULT STDMETHODCALLTYPE CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*) override;
+        virtual HRESULT STDMETHODCALLTYPE Commit(DWORD) override;
+        virtual HRESULT STDMETHODCALLTYPE Revert() override;
+        virtual HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override;
+        virtual HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override;
+        virtual HRESULT STDMETHODCALLTYPE Clone(IStream**) override;
+        virtual HRESULT STDMETHODCALLTYPE Stat(STATSTG*, DWORD) override;
+
+        uint64_t GetPosition() const { return m_position; }
+
+    protected:
+        virtual void WriteBytes(uint8_t const* bytes, size_t numberOfBytes) = 0;
+    };
+
+
+    //
+    // Converts the UTF-8 written to it into UTF-16 as each chunk arrives, so
+    // that serialized XML is only converted once and never has to be held in
+    // memory as UTF-8 as well.
+    //
+    class Utf8ToUtf16Stream : public WriteOnlyStream
+                            , private LifespanTracker<Utf8ToUtf16Stream>
+    {
+        std::vector<wchar_t> m_characters;
+
+        // A multi-byte sequence split across two writes.
+        uint8_t m_pendingBytes[4];
+        size_t m_pendingByteCount;
+
+    public:
+        Utf8ToUtf16Stream();
+
+        // Returns everything written so far.  A multi-byte sequence left
+        // unfinished at the end is replaced, as MultiByteToWideChar would.
+        WinString GetString();
+
+    protected:
+        virtual void WriteBytes(uint8_t const* bytes, size_t numberOfBytes) override;
+
+    private:
+        void Convert(uint8_t const* bytes, size_t numberOfBytes);
+    };
+
+
+    //
+    // Writes into a caller supplied buffer.  Once the buffer is full, further
+    // writes are only counted, so that the caller can find out how big a
+    // buffer it needs.
+    //
+    class FixedBufferStream : public WriteOnlyStream
+                            , private LifespanTracker<FixedBufferStream>
+    {
+        uint8_t* m_buffer;
+        size_t m_capacity;
+
+    public:
+        FixedBufferStream(uint8_t* buffer, size_t capacity);
+
+        bool HasOverflowed() const { return GetPosition() > m_capacity; }
+
+    protected:
+        virtual void WriteBytes(uint8_t const* bytes, size_t numberOfBytes) override;
+    };
+
 }}}}}
\ No newline at end of file
@@ -44,11 +44,15 @@ CanvasSvgDocument::CanvasSvgDocument(
     ID2D1SvgDocument* d2dSvgDocument)
     : ResourceWrapper(d2dSvgDocument)
     , m_canvasDevice(canvasDevice)
+    , m_elementCache(std::make_shared<SvgElementCache>())
 {
 }
 
 IFACEMETHODIMP CanvasSvgDocument::Close()
 {
+    if (auto elementCache = std::atomic_exchange(&m_elementCache, std::shared_ptr<SvgElementCache>()))
+        elementCache->Clear();
+
     m_canvasDevice.Close();
     return ResourceWrapper::Close();
 }
@@ -73,62 +77,19 @@ IFACEMETHODIMP CanvasSvgDocument::GetXml(HSTRING* result)
 
             auto& resource = GetResource();
 
-            ComPtr<IStream> outputStream;
-            ThrowIfFailed(CreateStreamOnHGlobal(nullptr, TRUE, &outputStream));
+            // D2D writes the document out as UTF-8, which is converted to UTF-16 chunk by chunk as it arrives
+            // rather than being collected and then converted as a whole.
+            auto outputStream = Make<Utf8ToUtf16Stream>();
+            CheckMakeResult(outputStream);
 
             ThrowIfFailed(resource->Serialize(outputStream.Get()));
-            
-            HGLOBAL globalHandle;
-            ThrowIfFailed(GetHGlobalFromStream(outputStream.Get(), &globalHandle));
-
-            void* lockedBytes = GlobalLock(globalHandle);
-            if (!lockedBytes)
-            {
-                ThrowHR(E_INVALIDARG);
-            }
-
-            auto unlockBytes = MakeScopeWarden([&] { GlobalUnlock(globalHandle); });
 
-            auto lockedBytesLength = GlobalSize(globalHandle);
-            if (lockedBytesLength == 0)
+            if (outputStream->GetPosition() == 0)
             {
                 ThrowHR(E_INVALIDARG);
             }
-            
-            // The string is returned from D2D in a multi-byte UTF-8 format. We need to convert it to a wide
-            // character format to return it through the platform.
-
-            // Note that the string pointed at by lockedBytes is not null terminated. Therefore, we need to 
-            // pass the locked size to the function below.
-            
-            assert(lockedBytesLength <= INT_MAX);
-            int wideCharacterCount = MultiByteToWideChar(
-                CP_UTF8,
-                0, // Default flags
-                reinterpret_cast<char* const>(lockedBytes),
-                static_cast<int32_t>(lockedBytesLength),
-                nullptr,
-                0); // Write nothing, and retrieve size
-
-            WinStringBuilder stringBuilder;
-            wideCharacterCount++; // Account for null terminator
-            auto buffer = stringBuilder.Allocate(wideCharacterCount);
-
-            if (MultiByteToWideChar(
-                CP_UTF8,
-                0, // Default flags
-                reinterpret_cast<char* const>(lockedBytes),
-                static_cast<int32_t>(lockedBytesLength),
-                buffer,
-                wideCharacterCount) == 0)
-            {
-                ThrowHR(E_INVALIDARG);
-            }
-
-            // MultiByteToWideChar does not null-terminate the string, so we do it ourselves here.
-            buffer[wideCharacterCount - 1] = 0;
 
-            stringBuilder.Get().CopyTo(result);
+            outputStream->GetString().CopyTo(result);
         });
 }
 
@@ -158,6 +119,46 @@ IFACEMETHODIMP CanvasSvgDocument::SaveAsync(IRandomAccessStream* rawStream, IAsy
         });
 }
 
+IFACEMETHODIMP CanvasSvgDocument::WriteXmlToBuffer(IBuffer* buffer, uint32_t* byteCount)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            using ::Windows::Storage::Streams::IBufferByteAccess;
+
+            CheckInPointer(buffer);
+            CheckInPointer(byteCount);
+
+            auto& resource = GetResource();
+
+            uint32_t capacity;
+            ThrowIfFailed(buffer->get_Capacity(&capacity));
+
+            uint8_t* bytes = nullptr;
+
+            if (capacity)
+            {
+                ThrowIfFailed(As<IBufferByteAccess>(buffer)->Buffer(&bytes));
+            }
+
+            auto outputStream = Make<FixedBufferStream>(bytes, capacity);
+            CheckMakeResult(outputStream);
+
+            ThrowIfFailed(resource->Serialize(outputStream.Get()));
+
+            auto totalBytes = outputStream->GetPosition();
+
+            if (totalBytes > UINT32_MAX)
+            {
+                ThrowHR(E_OUTOFMEMORY);
+            }
+
+            ThrowIfFailed(buffer->put_Length(outputStream->HasOverflowed() ? 0 : static_cast<uint32_t>(totalBytes)));
+
+            *byteCount = static_cast<uint32_t>(totalBytes);
+        });
+}
+
 IFACEMETHODIMP CanvasSvgDocument::put_Root(ICanvasSvgNamedElement* root)
 {
     return ExceptionBoundary(
@@ -171,7 +172,13 @@ IFACEMETHODIMP CanvasSvgDocument::put_Root(ICanvasSvgNamedElement* root)
 
             VerifyDeviceBoundary(m_canvasDevice, implementation);
 
-            resource->SetRoot(implementation->GetResource().Get());
+            auto& d2dRoot = implementation->GetResource();
+
+            ThrowIfFailed(resource->SetRoot(d2dRoot.Get()));
+
+            auto elementCache = GetElementCache();
+            if (elementCache && elementCache->GetIndexesIds())
+                elementCache->EnableIdIndex(d2dRoot.Get());
         });
 }
 
@@ -189,7 +196,7 @@ IFACEMETHODIMP CanvasSvgDocument::get_Root(ICanvasSvgNamedElement** result)
 
             auto& device = m_canvasDevice.EnsureNotClosed();
 
-            auto rootElement = ResourceManager::GetOrCreate<ICanvasSvgElement>(device.Get(), d2dSvgElement.Get());
+            auto rootElement = WrapElementFromD2DResource(device.Get(), d2dSvgElement.Get(), GetElementCache());
             ThrowIfFailed(rootElement.CopyTo(result));
         });
 }
@@ -244,6 +251,27 @@ IFACEMETHODIMP CanvasSvgDocument::LoadElementAsync(
         });
 }
 
+ComPtr<ICanvasSvgNamedElement> CanvasSvgDocument::FindElementByIdImpl(HSTRING id)
+{
+    auto& resource = GetResource();
+
+    auto& device = m_canvasDevice.EnsureNotClosed();
+
+    auto elementCache = GetElementCache();
+
+    ComPtr<ID2D1SvgElement> d2dFoundElement;
+
+    if (elementCache)
+        d2dFoundElement = elementCache->FindElementById(resource.Get(), GetStringBuffer(id));
+    else
+        ThrowIfFailed(resource->FindElementById(GetStringBuffer(id), &d2dFoundElement));
+
+    if (!d2dFoundElement)
+        return nullptr;
+
+    return As<ICanvasSvgNamedElement>(WrapElementFromD2DResource(device.Get(), d2dFoundElement.Get(), elementCache));
+}
+
 IFACEMETHODIMP CanvasSvgDocument::FindElementById(HSTRING elementName, ICanvasSvgNamedElement** foundElement)
 { 
     return ExceptionBoundary(
@@ -251,21 +279,107 @@ IFACEMETHODIMP CanvasSvgDocument::FindElementById(HSTRING elementName, ICanvasSv
         { 
             CheckAndClearOutPointer(foundElement);
 
-            auto& resource = GetResource();
-
-            auto& device = m_canvasDevice.EnsureNotClosed();
-
-            ComPtr<ID2D1SvgElement> d2dFoundElement;
-            ThrowIfFailed(resource->FindElementById(GetStringBuffer(elementName), &d2dFoundElement));
+            auto wrapped = FindElementByIdImpl(elementName);
 
-            if (!d2dFoundElement)
+            if (!wrapped)
                 ThrowHR(E_INVALIDARG);
 
-            ComPtr<ICanvasSvgNamedElement> wrapped = ResourceManager::GetOrCreate<ICanvasSvgNamedElement>(device.Get(), d2dFoundElement.Get());
             ThrowIfFailed(wrapped.CopyTo(foundElement));
         });
 }
 
+IFACEMETHODIMP CanvasSvgDocument::FindElementsById(
+    uint32_t idCount,
+    HSTRING* ids,
+    uint32_t* elementCount,
+    ICanvasSvgNamedElement*** elements)
+{
+    return ExceptionBoundary(
+        [=]
+        {
+            if (idCount > 0)
+                CheckInPointer(ids);
+            CheckInPointer(elementCount);
+            CheckAndClearOutPointer(elements);
+
+            GetResource();
+
+            ComArray<ComPtr<ICanvasSvgNamedElement>> foundElements(idCount);
+
+            for (uint32_t i = 0; i < idCount; ++i)
+            {
+                foundElements[i] = FindElementByIdImpl(ids[i]);
+            }
+
+            foundElements.Detach(elementCount, elements);
+        });
+}
+
+IFACEMETHODIMP CanvasSvgDocument::get_CacheElements(boolean* value)
+{
+    return ExceptionBoundary(
+        [=]
+        {
+            CheckInPointer(value);
+
+            GetResource();
+
+            auto elementCache = GetElementCache();
+            *value = elementCache && elementCache->GetCachesWrappers();
+        });
+}
+
+IFACEMETHODIMP CanvasSvgDocument::put_CacheElements(boolean value)
+{
+    return ExceptionBoundary(
+        [=]
+        {
+            GetResource();
+
+            if (auto elementCache = GetElementCache())
+                elementCache->SetCachesWrappers(!!value);
+        });
+}
+
+IFACEMETHODIMP CanvasSvgDocument::get_IndexElementIds(boolean* value)
+{
+    return ExceptionBoundary(
+        [=]
+        {
+            CheckInPointer(value);
+
+            GetResource();
+
+            auto elementCache = GetElementCache();
+            *value = elementCache && elementCache->GetIndexesIds();
+        });
+}
+
+IFACEMETHODIMP CanvasSvgDocument::put_IndexElementIds(boolean value)
+{
+    return ExceptionBoundary(
+        [=]
+        {
+            auto& resource = GetResource();
+
+            auto elementCache = GetElementCache();
+            if (!elementCache)
+                return;
+
+            if (value)
+            {
+                ComPtr<ID2D1SvgElement> d2dRoot;
+                resource->GetRoot(&d2dRoot);
+
+                elementCache->EnableIdIndex(d2dRoot.Get());
+            }
+            else
+            {
+                elementCache->DisableIdIndex();
+            }
+        });
+}
+
 void CanvasSvgDocument::CreatePaintAttributeImpl(D2D1_SVG_PAINT_TYPE d2dSvgPaintType, D2D1_COLOR_F d2dColor, wchar_t const* id, ICanvasSvgPaintAttribute** result)
 {
     auto& resource = GetResource();
@@ -6,6 +6,8 @@
 
 #if WINVER > _WIN32_WINNT_WINBLUE
 
+#include "SvgElementCache.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Svg
 {
     class CanvasSvgDocument : RESOURCE_WRAPPER_RUNTIME_CLASS(
@@ -18,6 +20,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ClosablePtr<ICanvasDevice> m_canvasDevice;
 
+        // Reset when the document is closed.  Accessed with atomic_load /
+        // atomic_exchange, since elements on other threads may be reading it.
+        std::shared_ptr<SvgElementCache> m_elementCache;
+
     public:
         
         static ComPtr<CanvasSvgDocument> CreateNew(ICanvasResourceCreator* resourceCreator, IStream* stream);
@@ -34,6 +40,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         IFACEMETHOD(SaveAsync(IRandomAccessStream* stream, IAsyncAction** asyncAction)) override;
 
+        IFACEMETHOD(WriteXmlToBuffer)(IBuffer* buffer, uint32_t* byteCount) override;
+
         IFACEMETHOD(put_Root)(ICanvasSvgNamedElement* root) override;
 
         IFACEMETHOD(get_Root)(ICanvasSvgNamedElement** root) override;
@@ -56,10 +64,26 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         IFACEMETHOD(CreateStrokeDashArrayAttributeWithDefaults)(ICanvasSvgStrokeDashArrayAttribute **) override;
         IFACEMETHOD(CreateStrokeDashArrayAttribute)(UINT32, float*, UINT32, CanvasSvgLengthUnits*, ICanvasSvgStrokeDashArrayAttribute **) override;
 
+        IFACEMETHOD(get_CacheElements)(boolean* value) override;
+        IFACEMETHOD(put_CacheElements)(boolean value) override;
+
+        IFACEMETHOD(get_IndexElementIds)(boolean* value) override;
+        IFACEMETHOD(put_IndexElementIds)(boolean value) override;
+
+        IFACEMETHOD(FindElementsById)(
+            uint32_t idCount,
+            HSTRING* ids,
+            uint32_t* elementCount,
+            ICanvasSvgNamedElement*** elements) override;
+
         // No exception boundary
         ComPtr<ICanvasDevice> GetDevice() { return m_canvasDevice.EnsureNotClosed(); }
 
+        std::shared_ptr<SvgElementCache> GetElementCache() { return std::atomic_load(&m_elementCache); }
+
     private:
+        ComPtr<ICanvasSvgNamedElement> FindElementByIdImpl(HSTRING id);
+
         void CreatePaintAttributeImpl(D2D1_SVG_PAINT_TYPE d2dSvgPaintType, D2D1_COLOR_F d2dColor, wchar_t const* id, ICanvasSvgPaintAttribute** result);
 
         void CreatePathDataAttributeImpl(
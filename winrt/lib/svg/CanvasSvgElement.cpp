@@ -14,24 +14,57 @@
 using namespace ABI::Microsoft::Graphics::Canvas::Svg;
 using namespace Microsoft::WRL::Wrappers;
 
-static 
-ComPtr<ICanvasSvgElement> WrapElementFromD2DResource(ICanvasDevice* canvasDevice, ID2D1SvgElement* d2dResource)
+static bool IsElementWrapperClosed(ICanvasSvgElement* wrapper)
 {
+    auto namedElement = MaybeAs<ICanvasSvgNamedElement>(wrapper);
+    if (namedElement)
+        return !static_cast<CanvasSvgNamedElement*>(namedElement.Get())->HasResource();
+
+    auto textElement = As<ICanvasSvgTextElement>(wrapper);
+    return !static_cast<CanvasSvgTextElement*>(textElement.Get())->HasResource();
+}
+
+ComPtr<ICanvasSvgElement> ABI::Microsoft::Graphics::Canvas::Svg::WrapElementFromD2DResource(
+    ICanvasDevice* canvasDevice,
+    ID2D1SvgElement* d2dResource,
+    std::weak_ptr<SvgElementCache> const& elementCache)
+{
+    auto cache = elementCache.lock();
+
+    if (cache)
+    {
+        auto cachedElement = cache->TryGetWrapper(d2dResource);
+
+        // An app may have closed the cached wrapper, in which case it is
+        // replaced by a new one.
+        if (cachedElement && !IsElementWrapperClosed(cachedElement.Get()))
+            return cachedElement;
+    }
+
     ComPtr<ICanvasSvgElement> result;
 
     if (d2dResource->IsTextContent())
     {
         auto textElement = ResourceManager::GetOrCreate<ICanvasSvgTextElement>(canvasDevice, d2dResource);
         ThrowIfFailed(textElement.As(&result));
+
+        if (cache)
+            static_cast<CanvasSvgTextElement*>(textElement.Get())->SetElementCache(cache);
     }
     else
     {
         auto namedElement = ResourceManager::GetOrCreate<ICanvasSvgNamedElement>(canvasDevice, d2dResource);
         ThrowIfFailed(namedElement.As(&result));
+
+        if (cache)
+            static_cast<CanvasSvgNamedElement*>(namedElement.Get())->SetElementCache(cache);
     }
 
     CheckMakeResult(result);
 
+    if (cache)
+        cache->AddWrapper(d2dResource, result.Get());
+
     return result;
 }
 
@@ -78,7 +111,7 @@ ComPtr<ICanvasSvgElement> ABI::Microsoft::Graphics::Canvas::Svg::CreateNewElemen
 
     auto device = parent->GetDevice().Get();
 
-    return WrapElementFromD2DResource(device, d2dSvgElement.Get());
+    return WrapElementFromD2DResource(device, d2dSvgElement.Get(), parent->GetElementCache());
 }
 
 ComPtr<CanvasSvgNamedElement> ABI::Microsoft::Graphics::Canvas::Svg::CreateNewNamedElementFromStream(CanvasSvgDocument* parent, IStream* stream)
@@ -88,7 +121,17 @@ ComPtr<CanvasSvgNamedElement> ABI::Microsoft::Graphics::Canvas::Svg::CreateNewNa
 
     auto device = parent->GetDevice().Get();
 
-    return Make<CanvasSvgNamedElement>(device, d2dSvgElement.Get());
+    auto newElement = Make<CanvasSvgNamedElement>(device, d2dSvgElement.Get());
+    CheckMakeResult(newElement);
+
+    auto elementCache = parent->GetElementCache();
+    if (elementCache)
+    {
+        newElement->SetElementCache(elementCache);
+        elementCache->AddWrapper(d2dSvgElement.Get(), newElement.Get());
+    }
+
+    return newElement;
 }
 
 CanvasSvgNamedElement::CanvasSvgNamedElement(
@@ -105,6 +148,27 @@ IFACEMETHODIMP CanvasSvgNamedElement::Close()
     return ResourceWrapper::Close();
 }
 
+// A single lock is shared by every element, rather than giving each one a
+// mutex of its own, since documents can easily contain tens of thousands of
+// elements and the lock is only held long enough to copy a weak_ptr.
+static std::mutex& GetElementCacheMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::weak_ptr<SvgElementCache> CanvasSvgNamedElement::GetElementCache()
+{
+    Lock lock(GetElementCacheMutex());
+    return m_elementCache;
+}
+
+void CanvasSvgNamedElement::SetElementCache(std::weak_ptr<SvgElementCache> const& elementCache)
+{
+    Lock lock(GetElementCacheMutex());
+    m_elementCache = elementCache;
+}
+
 static ComPtr<ID2D1SvgElement> VerifyDeviceBoundaryAndGetNativeResource(
     ClosablePtr<ICanvasDevice> thisDevice,
     ICanvasSvgElement* svgElement)
@@ -140,6 +204,9 @@ IFACEMETHODIMP CanvasSvgNamedElement::AppendChild(ICanvasSvgElement* child)
             auto nativeResource = VerifyDeviceBoundaryAndGetNativeResource(m_canvasDevice, child);
             
             ThrowIfFailed(resource->AppendChild(nativeResource.Get()));
+
+            if (auto elementCache = GetElementCache().lock())
+                elementCache->AddSubtreeToIdIndex(nativeResource.Get());
         });
 }
 
@@ -157,7 +224,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::CreateAndAppendNamedChildElement(HSTRING e
             ComPtr<ID2D1SvgElement> newD2DChild;
             ThrowIfFailed(resource->CreateChild(GetStringBuffer(elementName), &newD2DChild));
 
-            auto newCanvasElement = WrapElementFromD2DResource(device.Get(), newD2DChild.Get());
+            auto newCanvasElement = WrapElementFromD2DResource(device.Get(), newD2DChild.Get(), GetElementCache());
             ThrowIfFailed(newCanvasElement.CopyTo(newElement));
         });
 }
@@ -180,7 +247,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::CreateAndAppendTextChildElement(HSTRING te
             auto textBuffer = GetStringBuffer(text, &textLength);
             ThrowIfFailed(newD2DChild->SetTextValue(textBuffer, textLength));
 
-            auto newCanvasElement = WrapElementFromD2DResource(device.Get(), newD2DChild.Get());
+            auto newCanvasElement = WrapElementFromD2DResource(device.Get(), newD2DChild.Get(), GetElementCache());
             ThrowIfFailed(newCanvasElement.CopyTo(newElement));
         });
 }
@@ -201,7 +268,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
             if (d2dElement)
             {
-                auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get());
+                auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get(), GetElementCache());
                 ThrowIfFailed(newCanvasElement.CopyTo(result));
             }
         });
@@ -223,7 +290,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 if (d2dElement)
                 {
-                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get());
+                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get(), GetElementCache());
                     ThrowIfFailed(newCanvasElement.CopyTo(result));
                 }
             });
@@ -248,7 +315,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 if (d2dElement)
                 {
-                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get());
+                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get(), GetElementCache());
                     ThrowIfFailed(newCanvasElement.CopyTo(result));
                 }
             });
@@ -273,7 +340,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 if (d2dElement)
                 {
-                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get());
+                    auto newCanvasElement = WrapElementFromD2DResource(device.Get(), d2dElement.Get(), GetElementCache());
                     ThrowIfFailed(newCanvasElement.CopyTo(result));
                 }
             });
@@ -310,6 +377,18 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
             });
     }
 
+    static WinString GetTagName(ID2D1SvgElement* d2dElement)
+    {
+        uint32_t tagNameLength = d2dElement->GetTagNameLength();
+        uint32_t bufferSize = tagNameLength + 1;
+        WinStringBuilder stringBuilder;
+        auto buffer = stringBuilder.Allocate(bufferSize);
+
+        ThrowIfFailed(d2dElement->GetTagName(buffer, bufferSize));
+
+        return stringBuilder.Get();
+    }
+
     IFACEMETHODIMP CanvasSvgNamedElement::get_Tag(HSTRING* result)
     {
         return ExceptionBoundary(
@@ -319,14 +398,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 auto& resource = GetResource();
 
-                uint32_t tagNameLength = resource->GetTagNameLength();
-                uint32_t bufferSize = tagNameLength + 1;
-                WinStringBuilder stringBuilder;
-                auto buffer = stringBuilder.Allocate(bufferSize);
-
-                ThrowIfFailed(resource->GetTagName(buffer, bufferSize));
-
-                stringBuilder.Get().CopyTo(result);
+                GetTagName(resource.Get()).CopyTo(result);
             });
     }
 
@@ -358,6 +430,9 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 ComPtr<ID2D1SvgElement> d2dElement;
                 ThrowIfFailed(resource->InsertChildBefore(d2dNewChild.Get(), d2dReference.Get()));
+
+                if (auto elementCache = GetElementCache().lock())
+                    elementCache->AddSubtreeToIdIndex(d2dNewChild.Get());
             });
     }
 
@@ -398,6 +473,8 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
                 auto& resource = GetResource();
 
                 ThrowIfFailed(resource->RemoveAttribute(GetStringBuffer(attributeName)));
+
+                UpdateIdIndex(attributeName, L"");
             });
     }
 
@@ -414,6 +491,12 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 ComPtr<ID2D1SvgElement> d2dElement;
                 ThrowIfFailed(resource->RemoveChild(d2dChild.Get()));
+
+                if (auto elementCache = GetElementCache().lock())
+                {
+                    elementCache->RemoveSubtreeWrappers(d2dChild.Get());
+                    elementCache->RemoveSubtreeFromIdIndex(d2dChild.Get());
+                }
             });
     }
 
@@ -432,6 +515,13 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 ComPtr<ID2D1SvgElement> d2dElement;
                 ThrowIfFailed(resource->ReplaceChild(d2dNewChild.Get(), d2dOldChild.Get()));
+
+                if (auto elementCache = GetElementCache().lock())
+                {
+                    elementCache->RemoveSubtreeWrappers(d2dOldChild.Get());
+                    elementCache->RemoveSubtreeFromIdIndex(d2dOldChild.Get());
+                    elementCache->AddSubtreeToIdIndex(d2dNewChild.Get());
+                }
             });
     }
 
@@ -467,14 +557,18 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
             });
     }
 
-    static void GetParentImpl(ICanvasSvgNamedElement** parent, ID2D1SvgElement* d2dResource, ICanvasDevice* device)
+    static void GetParentImpl(
+        ICanvasSvgNamedElement** parent,
+        ID2D1SvgElement* d2dResource,
+        ICanvasDevice* device,
+        std::weak_ptr<SvgElementCache> const& elementCache)
     {
         ComPtr<ID2D1SvgElement> d2dElement;
         d2dResource->GetParent(&d2dElement);
 
         if (d2dElement) // Allowed to be null
         {
-            ComPtr<ICanvasSvgNamedElement> wrapped = ResourceManager::GetOrCreate<ICanvasSvgNamedElement>(device, d2dElement.Get());
+            auto wrapped = As<ICanvasSvgNamedElement>(WrapElementFromD2DResource(device, d2dElement.Get(), elementCache));
             ThrowIfFailed(wrapped.CopyTo(parent));
         }
     }
@@ -488,7 +582,7 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
 
                 auto& device = m_canvasDevice.EnsureNotClosed();
 
-                GetParentImpl(parent, GetResource().Get(), device.Get());
+                GetParentImpl(parent, GetResource().Get(), device.Get(), GetElementCache());
             });
     }
 
@@ -528,18 +622,12 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
             });
     }
 
-    void CanvasSvgNamedElement::GetStringAttributeImpl(HSTRING attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType, HSTRING* attributeValue)
+    static WinString GetStringAttributeValue(ID2D1SvgElement* d2dElement, wchar_t const* attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType)
     {
-        CheckInPointer(attributeValue);
-
-        auto& resource = GetResource();
-
         uint32_t attributeValueLength;
 
-        auto attributeNameBuffer = GetStringBuffer(attributeName);
-
-        ThrowIfFailed(resource->GetAttributeValueLength(
-            attributeNameBuffer,
+        ThrowIfFailed(d2dElement->GetAttributeValueLength(
+            attributeName,
             stringType,
             &attributeValueLength));
 
@@ -547,13 +635,22 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
         WinStringBuilder stringBuilder;
         auto buffer = stringBuilder.Allocate(bufferSize);
 
-        ThrowIfFailed(resource->GetAttributeValue(
-            attributeNameBuffer,
+        ThrowIfFailed(d2dElement->GetAttributeValue(
+            attributeName,
             stringType,
             buffer,
             bufferSize));
 
-        stringBuilder.Get().CopyTo(attributeValue);
+        return stringBuilder.Get();
+    }
+
+    void CanvasSvgNamedElement::GetStringAttributeImpl(HSTRING attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType, HSTRING* attributeValue)
+    {
+        CheckInPointer(attributeValue);
+
+        auto& resource = GetResource();
+
+        GetStringAttributeValue(resource.Get(), GetStringBuffer(attributeName), stringType).CopyTo(attributeValue);
     }
 
     void CanvasSvgNamedElement::SetStringAttributeImpl(HSTRING attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType, HSTRING attributeValue)
@@ -564,6 +661,17 @@ IFACEMETHODIMP CanvasSvgNamedElement::get_FirstChild(ICanvasSvgElement** result)
             GetStringBuffer(attributeName),
             stringType,
             GetStringBuffer(attributeValue)));
+
+        UpdateIdIndex(attributeName, GetStringBuffer(attributeValue));
+    }
+
+    void CanvasSvgNamedElement::UpdateIdIndex(HSTRING attributeName, wchar_t const* newId)
+    {
+        if (wcscmp(GetStringBuffer(attributeName), L"id") != 0)
+            return;
+
+        if (auto elementCache = GetElementCache().lock())
+            elementCache->SetIndexedId(GetResource().Get(), newId);
     }
 
     IFACEMETHODIMP CanvasSvgNamedElement::SetIdAttribute(HSTRING attributeName, HSTRING attributeValue)
@@ -838,6 +946,117 @@ IFACEMETHODIMP CanvasSvgNamedElement::GetLengthAttribute(HSTRING attributeName,
             });
     }
 
+    IFACEMETHODIMP CanvasSvgNamedElement::CaptureSubtree(
+        UINT32 attributeNameCount,
+        HSTRING* attributeNames,
+        UINT32* parentIndexCount,
+        INT32** parentIndices,
+        UINT32* tagCount,
+        HSTRING** tags,
+        UINT32* attributeValueCount,
+        HSTRING** attributeValues)
+    {
+        return ExceptionBoundary(
+            [&]
+            {
+                if (attributeNameCount > 0)
+                    CheckInPointer(attributeNames);
+                CheckInPointer(parentIndexCount);
+                CheckAndClearOutPointer(parentIndices);
+                CheckInPointer(tagCount);
+                CheckAndClearOutPointer(tags);
+                CheckInPointer(attributeValueCount);
+                CheckAndClearOutPointer(attributeValues);
+
+                auto& resource = GetResource();
+
+                std::vector<wchar_t const*> attributeNameBuffers;
+                attributeNameBuffers.reserve(attributeNameCount);
+
+                for (uint32_t i = 0; i < attributeNameCount; ++i)
+                {
+                    attributeNameBuffers.push_back(GetStringBuffer(attributeNames[i]));
+                }
+
+                std::vector<int32_t> capturedParentIndices;
+                std::vector<WinString> capturedTags;
+                std::vector<WinString> capturedAttributeValues;
+
+                // Elements still to be visited.  An element's next sibling is
+                // pushed before its first child, so the whole subtree under
+                // the element is visited before the sibling is, giving
+                // document order.  The parent is kept so that the sibling
+                // can be found.
+                struct PendingElement
+                {
+                    ComPtr<ID2D1SvgElement> Element;
+                    ComPtr<ID2D1SvgElement> Parent;
+                    int32_t ParentIndex;
+                };
+
+                std::vector<PendingElement> pendingElements;
+                pendingElements.push_back(PendingElement{ resource, nullptr, -1 });
+
+                while (!pendingElements.empty())
+                {
+                    auto current = std::move(pendingElements.back());
+                    pendingElements.pop_back();
+
+                    auto currentIndex = static_cast<int32_t>(capturedParentIndices.size());
+                    capturedParentIndices.push_back(current.ParentIndex);
+
+                    bool isTextContent = !!current.Element->IsTextContent();
+
+                    if (isTextContent)
+                    {
+                        capturedTags.emplace_back();
+                        capturedAttributeValues.resize(capturedAttributeValues.size() + attributeNameCount);
+                    }
+                    else
+                    {
+                        capturedTags.push_back(GetTagName(current.Element.Get()));
+
+                        for (auto attributeName : attributeNameBuffers)
+                        {
+                            if (current.Element->IsAttributeSpecified(attributeName, nullptr))
+                                capturedAttributeValues.push_back(GetStringAttributeValue(current.Element.Get(), attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE_SVG));
+                            else
+                                capturedAttributeValues.emplace_back();
+                        }
+                    }
+
+                    // Siblings of the element CaptureSubtree was called on are
+                    // not part of its subtree.
+                    if (current.Parent)
+                    {
+                        ComPtr<ID2D1SvgElement> nextSibling;
+                        ThrowIfFailed(current.Parent->GetNextChild(current.Element.Get(), &nextSibling));
+
+                        if (nextSibling)
+                            pendingElements.push_back(PendingElement{ nextSibling, current.Parent, current.ParentIndex });
+                    }
+
+                    if (!isTextContent)
+                    {
+                        ComPtr<ID2D1SvgElement> firstChild;
+                        current.Element->GetFirstChild(&firstChild);
+
+                        if (firstChild)
+                            pendingElements.push_back(PendingElement{ firstChild, current.Element, currentIndex });
+                    }
+                }
+
+                ComArray<int32_t> parentIndexArray(capturedParentIndices.begin(), capturedParentIndices.end());
+
+                ComArray<WinString> tagArray(capturedTags.begin(), capturedTags.end());
+                ComArray<WinString> attributeValueArray(capturedAttributeValues.begin(), capturedAttributeValues.end());
+
+                parentIndexArray.Detach(parentIndexCount, parentIndices);
+                tagArray.Detach(tagCount, tags);
+                attributeValueArray.Detach(attributeValueCount, attributeValues);
+            });
+    }
+
     IFACEMETHODIMP CanvasSvgNamedElement::get_Device(ICanvasDevice** device)
     {
         return ExceptionBoundary(
@@ -901,6 +1120,18 @@ IFACEMETHODIMP CanvasSvgTextElement::Close()
     return ResourceWrapper::Close();
 }
 
+std::weak_ptr<SvgElementCache> CanvasSvgTextElement::GetElementCache()
+{
+    Lock lock(GetElementCacheMutex());
+    return m_elementCache;
+}
+
+void CanvasSvgTextElement::SetElementCache(std::weak_ptr<SvgElementCache> const& elementCache)
+{
+    Lock lock(GetElementCacheMutex());
+    m_elementCache = elementCache;
+}
+
 IFACEMETHODIMP CanvasSvgTextElement::get_Text(HSTRING* result)
 {
     return ExceptionBoundary(
@@ -957,7 +1188,7 @@ IFACEMETHODIMP CanvasSvgTextElement::get_Parent(ICanvasSvgNamedElement** parent)
 
             auto& device = m_canvasDevice.EnsureNotClosed();
 
-            GetParentImpl(parent, GetResource().Get(), device.Get());
+            GetParentImpl(parent, GetResource().Get(), device.Get(), GetElementCache());
         });
 }
 
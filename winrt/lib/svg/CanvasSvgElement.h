@@ -6,6 +6,8 @@
 
 #if WINVER > _WIN32_WINNT_WINBLUE
 
+#include "SvgElementCache.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Svg
 {
     using namespace ABI::Microsoft::Graphics::Canvas;
@@ -30,6 +32,11 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ClosablePtr<ICanvasDevice> m_canvasDevice;
 
+        // Cache of the document this element was handed out by, kept up to
+        // date as the tree is changed through this element.  Guarded by a
+        // lock shared by all elements, see GetElementCache.
+        std::weak_ptr<SvgElementCache> m_elementCache;
+
     public:
         CanvasSvgNamedElement(
             ICanvasDevice* canvasDevice,
@@ -96,16 +103,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         IFACEMETHOD(GetLengthAttribute)(HSTRING, CanvasSvgLengthUnits*, float*);
         IFACEMETHOD(SetAspectRatioAttribute)(HSTRING, CanvasSvgAspectAlignment, CanvasSvgAspectScaling);
         IFACEMETHOD(GetAspectRatioAttribute)(HSTRING, CanvasSvgAspectScaling*, CanvasSvgAspectAlignment*);
+
+        IFACEMETHOD(CaptureSubtree)(UINT32, HSTRING*, UINT32*, INT32**, UINT32*, HSTRING**, UINT32*, HSTRING**);
         
         IFACEMETHOD(get_Device)(ICanvasDevice**);
 
         // No exception boundary
         ComPtr<ICanvasDevice> GetDevice() { return m_canvasDevice.EnsureNotClosed(); }
 
+        std::weak_ptr<SvgElementCache> GetElementCache();
+        void SetElementCache(std::weak_ptr<SvgElementCache> const& elementCache);
+
     private:
         void IsAttributeSpecifiedImpl(HSTRING attributeName, boolean* isSpecified, boolean* isInherited);
         void GetStringAttributeImpl(HSTRING attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType, HSTRING* attributeValue);
         void SetStringAttributeImpl(HSTRING attributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE stringType, HSTRING attributeValue);
+        void UpdateIdIndex(HSTRING attributeName, wchar_t const* newId);
     };
 
     class CanvasSvgTextElement : 
@@ -124,6 +137,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ClosablePtr<ICanvasDevice> m_canvasDevice;
 
+        // Cache of the document this element was handed out by, so that its
+        // parent is looked up there too.  See CanvasSvgNamedElement.
+        std::weak_ptr<SvgElementCache> m_elementCache;
+
     public:
 
         CanvasSvgTextElement(
@@ -140,8 +157,19 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         // No exception boundary
         ComPtr<ICanvasDevice> GetDevice() { return m_canvasDevice.EnsureNotClosed(); }
+
+        std::weak_ptr<SvgElementCache> GetElementCache();
+        void SetElementCache(std::weak_ptr<SvgElementCache> const& elementCache);
     };
 
+    // Returns the wrapper for a D2D element.  If an element cache is given,
+    // wrappers are looked up in and added to it, and named elements are told
+    // about it so that elements reached through them are cached too.
+    ComPtr<ICanvasSvgElement> WrapElementFromD2DResource(
+        ICanvasDevice* canvasDevice,
+        ID2D1SvgElement* d2dResource,
+        std::weak_ptr<SvgElementCache> const& elementCache);
+
     ComPtr<ICanvasSvgElement> CreateNewElementFromStream(CanvasSvgDocument* parent, IStream* stream);
     ComPtr<CanvasSvgNamedElement> CreateNewNamedElementFromStream(CanvasSvgDocument* parent, IStream* stream);
 
@@ -0,0 +1,376 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include "SvgElementCache.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas::Svg;
+
+static wchar_t const* IdAttributeName = L"id";
+
+// Returns an empty string if the element has no id.
+static std::wstring GetElementId(ID2D1SvgElement* d2dElement)
+{
+    if (d2dElement->IsTextContent() || !d2dElement->IsAttributeSpecified(IdAttributeName, nullptr))
+        return std::wstring();
+
+    uint32_t idLength;
+    ThrowIfFailed(d2dElement->GetAttributeValueLength(IdAttributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE_SVG, &idLength));
+
+    std::wstring id(idLength + 1, L'\0'); // Account for null
+    ThrowIfFailed(d2dElement->GetAttributeValue(IdAttributeName, D2D1_SVG_ATTRIBUTE_STRING_TYPE_SVG, &id[0], idLength + 1));
+    id.resize(idLength);
+
+    return id;
+}
+
+// Calls fn for d2dElement and each of its descendants, including text content,
+// in document order.
+template<typename FN>
+static void ForEachElement(ID2D1SvgElement* d2dElement, FN&& fn)
+{
+    fn(d2dElement);
+
+    // Text content never has children.
+    if (d2dElement->IsTextContent())
+        return;
+
+    ComPtr<ID2D1SvgElement> child;
+    d2dElement->GetFirstChild(&child);
+
+    while (child)
+    {
+        ForEachElement(child.Get(), fn);
+
+        ComPtr<ID2D1SvgElement> nextChild;
+        ThrowIfFailed(d2dElement->GetNextChild(child.Get(), &nextChild));
+        child = nextChild;
+    }
+}
+
+// As ForEachElement, but skips text content.
+template<typename FN>
+static void ForEachNamedElement(ID2D1SvgElement* d2dElement, FN&& fn)
+{
+    ForEachElement(d2dElement,
+        [&](ID2D1SvgElement* element)
+        {
+            if (!element->IsTextContent())
+                fn(element);
+        });
+}
+
+static bool IsInTree(ID2D1SvgElement* d2dElement, ID2D1SvgElement* root)
+{
+    ComPtr<ID2D1SvgElement> current = d2dElement;
+
+    while (current)
+    {
+        if (current.Get() == root)
+            return true;
+
+        ComPtr<ID2D1SvgElement> parent;
+        current->GetParent(&parent);
+        current = parent;
+    }
+
+    return false;
+}
+
+SvgElementCache::SvgElementCache()
+    : m_cachesWrappers(false)
+    , m_indexesIds(false)
+{
+}
+
+bool SvgElementCache::GetCachesWrappers()
+{
+    Lock lock(m_mutex);
+    return m_cachesWrappers;
+}
+
+void SvgElementCache::SetCachesWrappers(bool value)
+{
+    std::unordered_map<ID2D1SvgElement*, Entry> removed;
+
+    {
+        Lock lock(m_mutex);
+
+        m_cachesWrappers = value;
+
+        if (!value)
+            std::swap(removed, m_wrappers);
+    }
+
+    // The wrappers are released here, outside the lock, since releasing them
+    // may run arbitrary destructors.
+}
+
+ComPtr<ICanvasSvgElement> SvgElementCache::TryGetWrapper(ID2D1SvgElement* d2dElement)
+{
+    Lock lock(m_mutex);
+
+    auto it = m_wrappers.find(d2dElement);
+
+    if (it == m_wrappers.end())
+        return nullptr;
+
+    return it->second.Wrapper;
+}
+
+void SvgElementCache::AddWrapper(ID2D1SvgElement* d2dElement, ICanvasSvgElement* wrapper)
+{
+    Lock lock(m_mutex);
+
+    if (!m_cachesWrappers)
+        return;
+
+    auto& entry = m_wrappers[d2dElement];
+    entry.Resource = d2dElement;
+    entry.Wrapper = wrapper;
+}
+
+void SvgElementCache::RemoveWrapper(ID2D1SvgElement* d2dElement)
+{
+    Entry removed;
+
+    {
+        Lock lock(m_mutex);
+
+        auto it = m_wrappers.find(d2dElement);
+
+        if (it == m_wrappers.end())
+            return;
+
+        removed = std::move(it->second);
+        m_wrappers.erase(it);
+    }
+}
+
+void SvgElementCache::RemoveSubtreeWrappers(ID2D1SvgElement* d2dElement)
+{
+    if (GetWrapperCount() == 0)
+        return;
+
+    std::vector<Entry> removed;
+
+    ForEachElement(d2dElement,
+        [&](ID2D1SvgElement* descendant)
+        {
+            Lock lock(m_mutex);
+
+            auto it = m_wrappers.find(descendant);
+
+            if (it != m_wrappers.end())
+            {
+                removed.push_back(std::move(it->second));
+                m_wrappers.erase(it);
+            }
+        });
+
+    // The wrappers are released here, outside the lock.
+}
+
+size_t SvgElementCache::GetWrapperCount()
+{
+    Lock lock(m_mutex);
+    return m_wrappers.size();
+}
+
+bool SvgElementCache::GetIndexesIds()
+{
+    Lock lock(m_mutex);
+    return m_indexesIds;
+}
+
+void SvgElementCache::EnableIdIndex(ID2D1SvgElement* root)
+{
+    // The tree is walked without holding the lock.  Where several elements
+    // share an id the first one in document order wins, which matches what
+    // Direct2D's FindElementById returns.
+    std::unordered_map<std::wstring, ComPtr<ID2D1SvgElement>> elementsById;
+    std::unordered_map<ID2D1SvgElement*, std::wstring> idsByElement;
+
+    if (root)
+    {
+        ForEachNamedElement(root,
+            [&](ID2D1SvgElement* d2dElement)
+            {
+                auto id = GetElementId(d2dElement);
+
+                if (!id.empty() && elementsById.emplace(id, d2dElement).second)
+                    idsByElement.emplace(d2dElement, std::move(id));
+            });
+    }
+
+    Lock lock(m_mutex);
+
+    m_indexesIds = true;
+    std::swap(m_elementsById, elementsById);
+    std::swap(m_idsByElement, idsByElement);
+}
+
+void SvgElementCache::DisableIdIndex()
+{
+    std::unordered_map<std::wstring, ComPtr<ID2D1SvgElement>> removed;
+
+    Lock lock(m_mutex);
+
+    m_indexesIds = false;
+    std::swap(m_elementsById, removed);
+    m_idsByElement.clear();
+}
+
+void SvgElementCache::AddSubtreeToIdIndex(ID2D1SvgElement* d2dElement)
+{
+    if (!GetIndexesIds())
+        return;
+
+    std::vector<std::pair<ComPtr<ID2D1SvgElement>, std::wstring>> ids;
+
+    ForEachNamedElement(d2dElement,
+        [&](ID2D1SvgElement* descendant)
+        {
+            auto id = GetElementId(descendant);
+
+            if (!id.empty())
+                ids.emplace_back(descendant, std::move(id));
+        });
+
+    for (auto& elementAndId : ids)
+    {
+        SetIndexedId(elementAndId.first.Get(), elementAndId.second.c_str());
+    }
+}
+
+void SvgElementCache::RemoveSubtreeFromIdIndex(ID2D1SvgElement* d2dElement)
+{
+    if (!GetIndexesIds())
+        return;
+
+    ForEachNamedElement(d2dElement,
+        [&](ID2D1SvgElement* descendant)
+        {
+            SetIndexedId(descendant, L"");
+        });
+}
+
+void SvgElementCache::SetIndexedId(ID2D1SvgElement* d2dElement, wchar_t const* id)
+{
+    ComPtr<ID2D1SvgElement> removed;
+
+    Lock lock(m_mutex);
+
+    if (!m_indexesIds)
+        return;
+
+    auto previousId = m_idsByElement.find(d2dElement);
+
+    if (previousId != m_idsByElement.end())
+    {
+        auto previousElement = m_elementsById.find(previousId->second);
+
+        if (previousElement != m_elementsById.end() && previousElement->second.Get() == d2dElement)
+        {
+            removed = std::move(previousElement->second);
+            m_elementsById.erase(previousElement);
+        }
+
+        m_idsByElement.erase(previousId);
+    }
+
+    if (!id || !*id)
+        return;
+
+    auto indexedElement = m_elementsById.find(id);
+
+    if (indexedElement != m_elementsById.end())
+    {
+        // Another element already has this id.  Direct2D returns whichever
+        // comes first in the document, which we can't tell without walking
+        // the tree, so the id is dropped from the index and FindElementById
+        // asks Direct2D instead.
+        m_idsByElement.erase(indexedElement->second.Get());
+        removed = std::move(indexedElement->second);
+        m_elementsById.erase(indexedElement);
+        return;
+    }
+
+    m_elementsById.emplace(id, d2dElement);
+    m_idsByElement[d2dElement] = id;
+}
+
+ComPtr<ID2D1SvgElement> SvgElementCache::FindElementById(ID2D1SvgDocument* d2dDocument, wchar_t const* id)
+{
+    bool indexesIds;
+    ComPtr<ID2D1SvgElement> indexedElement;
+
+    {
+        Lock lock(m_mutex);
+
+        indexesIds = m_indexesIds;
+
+        if (indexesIds)
+        {
+            auto it = m_elementsById.find(id);
+
+            if (it != m_elementsById.end())
+                indexedElement = it->second;
+        }
+    }
+
+    if (indexedElement)
+    {
+        ComPtr<ID2D1SvgElement> root;
+        d2dDocument->GetRoot(&root);
+
+        if (GetElementId(indexedElement.Get()) == id && IsInTree(indexedElement.Get(), root.Get()))
+            return indexedElement;
+    }
+
+    ComPtr<ID2D1SvgElement> foundElement;
+    ThrowIfFailed(d2dDocument->FindElementById(id, &foundElement));
+
+    if (indexesIds)
+    {
+        // Bring the index up to date with whatever Direct2D found.  The
+        // indexed element failed the check above, so it is no longer trusted
+        // for any id; it is indexed again if it is found by its new one.
+        if (indexedElement)
+            SetIndexedId(indexedElement.Get(), L"");
+
+        if (foundElement)
+            SetIndexedId(foundElement.Get(), id);
+    }
+
+    return foundElement;
+}
+
+size_t SvgElementCache::GetIndexedIdCount()
+{
+    Lock lock(m_mutex);
+    return m_elementsById.size();
+}
+
+void SvgElementCache::Clear()
+{
+    std::unordered_map<ID2D1SvgElement*, Entry> removedWrappers;
+    std::unordered_map<std::wstring, ComPtr<ID2D1SvgElement>> removedElements;
+
+    {
+        Lock lock(m_mutex);
+
+        m_cachesWrappers = false;
+        m_indexesIds = false;
+
+        std::swap(removedWrappers, m_wrappers);
+        std::swap(removedElements, m_elementsById);
+        m_idsByElement.clear();
+    }
+}
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Svg
+{
+    //
+    // Per document cache of element lookups.  Every CanvasSvgDocument owns
+    // one, and the named elements it hands out keep a weak_ptr to it so that
+    // they can keep it up to date as the tree changes.  Both halves are off
+    // until the app asks for them.
+    //
+    // The wrapper cache (CanvasSvgDocument.CacheElements) holds on to element
+    // wrappers.  ResourceManager only keeps weak references to wrappers, so
+    // an app that walks a large tree, dropping each element as it goes,
+    // otherwise creates a new wrapper for every node on every walk.
+    //
+    // The id index (CanvasSvgDocument.IndexElementIds) maps id attributes to
+    // elements, so that FindElementById doesn't have to search the tree.
+    // Ids can change in ways the index doesn't hear about (eg. through
+    // SetStringAttribute, or interop), so an indexed element is checked
+    // before it is returned, and Direct2D is asked when the check fails.
+    //
+    // Elements only ever hold a weak_ptr to the cache, so the strong
+    // references held here cannot keep the cache itself alive.
+    //
+    class SvgElementCache
+    {
+        struct Entry
+        {
+            ComPtr<ID2D1SvgElement> Resource;   // Keeps the key from being reused
+            ComPtr<ICanvasSvgElement> Wrapper;
+        };
+
+        std::mutex m_mutex;
+
+        bool m_cachesWrappers;
+        std::unordered_map<ID2D1SvgElement*, Entry> m_wrappers;
+
+        bool m_indexesIds;
+        std::unordered_map<std::wstring, ComPtr<ID2D1SvgElement>> m_elementsById;
+        std::unordered_map<ID2D1SvgElement*, std::wstring> m_idsByElement;
+
+    public:
+        SvgElementCache();
+
+        //
+        // Wrapper cache
+        //
+
+        bool GetCachesWrappers();
+        void SetCachesWrappers(bool value);
+
+        ComPtr<ICanvasSvgElement> TryGetWrapper(ID2D1SvgElement* d2dElement);
+
+        // Does nothing unless wrappers are being cached.
+        void AddWrapper(ID2D1SvgElement* d2dElement, ICanvasSvgElement* wrapper);
+
+        void RemoveWrapper(ID2D1SvgElement* d2dElement);
+
+        // Removes the wrappers of an element and everything under it, eg.
+        // when it is taken out of the tree.
+        void RemoveSubtreeWrappers(ID2D1SvgElement* d2dElement);
+
+        size_t GetWrapperCount();
+
+        //
+        // Id index.  The Add/Remove/Set methods do nothing unless the index
+        // is enabled.
+        //
+
+        bool GetIndexesIds();
+
+        // (Re)builds the index from the tree under root.
+        void EnableIdIndex(ID2D1SvgElement* root);
+        void DisableIdIndex();
+
+        void AddSubtreeToIdIndex(ID2D1SvgElement* d2dElement);
+        void RemoveSubtreeFromIdIndex(ID2D1SvgElement* d2dElement);
+
+        // If a different element is already indexed under this id, neither
+        // is kept, since only Direct2D knows which of them comes first.
+        void SetIndexedId(ID2D1SvgElement* d2dElement, wchar_t const* id);
+
+        // Returns null if no element in the document has this id.
+        ComPtr<ID2D1SvgElement> FindElementById(ID2D1SvgDocument* d2dDocument, wchar_t const* id);
+
+        size_t GetIndexedIdCount();
+
+        // Drops all cached wrappers and indexed ids, and turns both off.
+        void Clear();
+    };
+}}}}}
+
+#endif
@@ -10,6 +10,7 @@
 #include "CanvasFontFace.h"
 #include "CanvasTypography.h"
 #include "CanvasNumberSubstitution.h"
+#include "utils/ParallelUtilities.h"
 
 using namespace ABI::Microsoft::Graphics::Canvas;
 using namespace ABI::Microsoft::Graphics::Canvas::Text;
@@ -247,7 +248,7 @@ STDMETHODIMP DWriteTextAnalysisSink::SetLineBreakpoints(
 
             for (uint32_t i = 0; i < textLength; ++i)
             {
-                auto& b = m_analyzedLineBreakpoints[textPosition + i];
+                auto& b = m_analyzedLineBreakpoints[textPosition - m_textPosition + i];
 
                 b.BreakBefore = ToCanvasLineBreakCondition(dwriteLineBreakpoint[i].breakConditionBefore);
                 b.BreakAfter = ToCanvasLineBreakCondition(dwriteLineBreakpoint[i].breakConditionAfter);
@@ -428,6 +429,7 @@ CanvasTextAnalyzer::CanvasTextAnalyzer(
     , m_defaultVerticalGlyphOrientation(CanvasVerticalGlyphOrientation::Default)
     , m_defaultBidiLevel(0)
     , m_customFontManager(CustomFontManager::GetInstance())
+    , m_analyzeParagraphsInParallel(false)
 {
     CreateTextAnalysisSourceAndSink();
 }
@@ -444,6 +446,7 @@ CanvasTextAnalyzer::CanvasTextAnalyzer(
     , m_defaultNumberSubstitution(numberSubstitution)
     , m_defaultVerticalGlyphOrientation(verticalGlyphOrientation)
     , m_customFontManager(CustomFontManager::GetInstance())
+    , m_analyzeParagraphsInParallel(false)
 {
     if (bidiLevel > UINT8_MAX)
         ThrowHR(E_INVALIDARG);
@@ -466,7 +469,18 @@ void CanvasTextAnalyzer::CreateTextAnalysisSourceAndSink()
     uint32_t textLength;
     WindowsGetStringRawBuffer(m_text, &textLength);
 
-    m_dwriteTextAnalysisSource = Make<DWriteTextAnalysisSource>(
+    m_dwriteTextAnalysisSource = CreateTextAnalysisSource(WinString());
+
+    m_dwriteTextAnalysisSink = Make<DWriteTextAnalysisSink>(textLength);
+    CheckMakeResult(m_dwriteTextAnalysisSink);
+}
+
+ComPtr<DWriteTextAnalysisSource> CanvasTextAnalyzer::CreateTextAnalysisSource(WinString const& localeName)
+{
+    uint32_t textLength;
+    WindowsGetStringRawBuffer(m_text, &textLength);
+
+    auto source = Make<DWriteTextAnalysisSource>(
         m_text,
         textLength,
         m_textDirection,
@@ -474,10 +488,429 @@ void CanvasTextAnalyzer::CreateTextAnalysisSourceAndSink()
         m_defaultNumberSubstitution,
         m_defaultVerticalGlyphOrientation,
         m_defaultBidiLevel);
-    CheckMakeResult(m_dwriteTextAnalysisSource);
+    CheckMakeResult(source);
 
-    m_dwriteTextAnalysisSink = Make<DWriteTextAnalysisSink>(textLength);
-    CheckMakeResult(m_dwriteTextAnalysisSink);
+    source->SetLocaleName(localeName);
+
+    return source;
+}
+
+//
+// Text is only split up for parallel analysis when each chunk would be at
+// least this long; below that, starting the workers and repairing the seams
+// between chunks costs more than it saves.
+//
+static uint32_t const MinParallelChunkLength = 16 * 1024;
+
+std::vector<TextChunk> CanvasTextAnalyzer::GetParallelChunks()
+{
+    uint32_t textLength;
+    auto text = WindowsGetStringRawBuffer(m_text, &textLength);
+
+    if (!m_analyzeParagraphsInParallel)
+        return std::vector<TextChunk>{ TextChunk{ 0, textLength } };
+
+    auto maxChunkCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    return SplitTextAtParagraphs(text, textLength, maxChunkCount, MinParallelChunkLength);
+}
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // The result of one IDWriteFontFallback::MapCharacters call.  Font is
+    // null for text that no font could be found for.
+    //
+    struct MappedFontRange
+    {
+        uint32_t Start;
+        uint32_t Length;
+        ComPtr<IDWriteFont> Font;
+        float ScaleFactor;
+    };
+
+    //
+    // Maps text to fonts the way GetFonts does, for any text analysis
+    // source.  MapCharacters is given the rest of the text each time, so
+    // that the runs it returns match those of mapping the whole text.
+    //
+    class FontMapper
+    {
+        ComPtr<IDWriteFontFallback> m_fontFallback;
+        ComPtr<IDWriteFontCollection> m_fontCollection;
+        ComPtr<IDWriteTextFormat> m_textFormat;
+        std::wstring m_familyName;
+
+    public:
+        FontMapper(
+            IDWriteFontFallback* fontFallback,
+            IDWriteFontCollection* fontCollection,
+            IDWriteTextFormat* textFormat)
+            : m_fontFallback(fontFallback)
+            , m_fontCollection(fontCollection)
+            , m_textFormat(textFormat)
+        {
+            m_familyName.resize(textFormat->GetFontFamilyNameLength() + 1);
+            ThrowIfFailed(textFormat->GetFontFamilyName(&m_familyName[0], static_cast<uint32_t>(m_familyName.size())));
+        }
+
+        MappedFontRange Map(IDWriteTextAnalysisSource* source, uint32_t position, uint32_t textLength) const
+        {
+            MappedFontRange range{ position };
+
+            ThrowIfFailed(m_fontFallback->MapCharacters(
+                source,
+                position,
+                textLength - position,
+                m_fontCollection.Get(),
+                m_familyName.c_str(),
+                m_textFormat->GetFontWeight(),
+                m_textFormat->GetFontStyle(),
+                m_textFormat->GetFontStretch(),
+                &range.Length,
+                &range.Font,
+                &range.ScaleFactor));
+
+            return range;
+        }
+
+        // Maps runs starting from position until one reaches end.
+        void MapUntil(IDWriteTextAnalysisSource* source, uint32_t position, uint32_t end, uint32_t textLength, std::vector<MappedFontRange>* ranges) const
+        {
+            while (position < end)
+            {
+                ranges->push_back(Map(source, position, textLength));
+                position += ranges->back().Length;
+            }
+        }
+    };
+}}}}}
+
+std::vector<MappedFontRange> CanvasTextAnalyzer::MapFontsInParallel(
+    std::vector<TextChunk> const& chunks,
+    WinString const& localeName,
+    FontMapper const& fontMapper)
+{
+    auto textLength = chunks.back().End;
+
+    std::vector<std::vector<MappedFontRange>> chunkRanges(chunks.size());
+
+    RunTasksInParallel(static_cast<uint32_t>(chunks.size()),
+        [&](size_t i)
+        {
+            auto source = CreateTextAnalysisSource(localeName);
+
+            fontMapper.MapUntil(source.Get(), chunks[i].Start, chunks[i].End, textLength, &chunkRanges[i]);
+        });
+
+    //
+    // A chunk mapped on its own starts a new run at its first character, and
+    // its last run may stop short of where mapping the whole text would have
+    // taken it.  So each seam is repaired by mapping serially again from the
+    // start of the last run before it, until a run starts exactly where one
+    // of the next chunk's own runs does; from there on the chunk's runs are
+    // the same as the serial ones.
+    //
+    auto source = CreateTextAnalysisSource(localeName);
+
+    std::vector<MappedFontRange> ranges = std::move(chunkRanges[0]);
+
+    for (size_t i = 1; i < chunks.size(); ++i)
+    {
+        auto& nextRanges = chunkRanges[i];
+        auto nextRange = nextRanges.begin();
+
+        uint32_t position = ranges.back().Start;
+        ranges.pop_back();
+
+        for (;;)
+        {
+            while (nextRange != nextRanges.end() && nextRange->Start < position)
+                ++nextRange;
+
+            if (position >= chunks[i].End)
+                break;
+
+            if (nextRange != nextRanges.end() && nextRange->Start == position)
+                break;
+
+            ranges.push_back(fontMapper.Map(source.Get(), position, textLength));
+            position += ranges.back().Length;
+        }
+
+        ranges.insert(ranges.end(), std::make_move_iterator(nextRange), std::make_move_iterator(nextRanges.end()));
+    }
+
+    return ranges;
+}
+
+//
+// Helpers for analyzing parts of the text separately (in parallel, or just
+// the paragraphs changed by ReplaceText) and then joining up their results.
+//
+
+typedef HRESULT (STDMETHODCALLTYPE IDWriteTextAnalyzer::*AnalyzeTextMethod)(IDWriteTextAnalysisSource*, uint32_t, uint32_t, IDWriteTextAnalysisSink*);
+
+static ComPtr<DWriteTextAnalysisSink> AnalyzeTextRange(
+    IDWriteTextAnalyzer* textAnalyzer,
+    AnalyzeTextMethod analyze,
+    IDWriteTextAnalysisSource* source,
+    uint32_t start,
+    uint32_t end)
+{
+    auto sink = Make<DWriteTextAnalysisSink>(start, end - start);
+    CheckMakeResult(sink);
+
+    ThrowIfFailed((textAnalyzer->*analyze)(source, start, end - start, sink.Get()));
+
+    return sink;
+}
+
+static bool IsSameAnalysis(CanvasAnalyzedBidi const& a, CanvasAnalyzedBidi const& b)
+{
+    return a.ExplicitLevel == b.ExplicitLevel &&
+           a.ResolvedLevel == b.ResolvedLevel;
+}
+
+static bool IsSameAnalysis(CanvasAnalyzedScript const& a, CanvasAnalyzedScript const& b)
+{
+    return a.ScriptIdentifier == b.ScriptIdentifier &&
+           a.Shape == b.Shape;
+}
+
+template<typename T>
+static std::vector<AnalyzedRange<T>> GetAnalyzedRanges(Vector<IKeyValuePair<CanvasCharacterRange, T>*>* vector)
+{
+    uint32_t size;
+    ThrowIfFailed(vector->get_Size(&size));
+
+    std::vector<AnalyzedRange<T>> ranges;
+    ranges.reserve(size);
+
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        ComPtr<IKeyValuePair<CanvasCharacterRange, T>> element;
+        ThrowIfFailed(vector->GetAt(i, &element));
+
+        CanvasCharacterRange characterRange;
+        ThrowIfFailed(element->get_Key(&characterRange));
+
+        T value;
+        ThrowIfFailed(element->get_Value(&value));
+
+        auto start = static_cast<uint32_t>(characterRange.CharacterIndex);
+        ranges.push_back(AnalyzedRange<T>{ start, start + static_cast<uint32_t>(characterRange.CharacterCount), value });
+    }
+
+    return ranges;
+}
+
+//
+// Analyzing the whole text at once would have reported one range where the
+// ranges either side of a seam have the same value, so these are merged.
+//
+template<typename T>
+static void AppendAnalyzedRange(std::vector<AnalyzedRange<T>>* ranges, AnalyzedRange<T> const& range)
+{
+    if (range.Start == range.End)
+        return;
+
+    if (!ranges->empty() && ranges->back().End == range.Start && IsSameAnalysis(ranges->back().Value, range.Value))
+        ranges->back().End = range.End;
+    else
+        ranges->push_back(range);
+}
+
+template<typename T>
+static ComPtr<Vector<IKeyValuePair<CanvasCharacterRange, T>*>> MakeAnalyzedRangeVector(std::vector<AnalyzedRange<T>> const& ranges)
+{
+    auto vector = Make<Vector<IKeyValuePair<CanvasCharacterRange, T>*>>();
+    CheckMakeResult(vector);
+
+    for (auto const& range : ranges)
+    {
+        auto newPair = MakeCharacterRangeKeyValue(range.Start, range.End - range.Start, range.Value);
+
+        ThrowIfFailed(vector->Append(newPair.Get()));
+    }
+
+    return vector;
+}
+
+//
+// How far either side of a seam JoinScriptRanges first looks when it
+// analyzes the seam again.
+//
+static uint32_t const ScriptSeamWindowLength = 256;
+
+//
+// Appends nextRanges, which were analyzed without the text before them, to
+// ranges.
+//
+// Unlike bidi levels, script carries over from one paragraph to the next:
+// characters such as digits and punctuation take the script of the text
+// before them.  Analyzed on their own, any of these at the start of
+// nextRanges instead take the script of the text after them.  So, where the
+// scripts either side of the seam differ, a window around it is analyzed
+// again with enough of the text before it to establish its script, and
+// enough of the text after it to reach where nextRanges' own first script
+// starts.  Beyond that point the results don't depend on what came before.
+//
+static void JoinScriptRanges(
+    IDWriteTextAnalyzer* textAnalyzer,
+    IDWriteTextAnalysisSource* source,
+    std::vector<AnalyzedRange<CanvasAnalyzedScript>>* ranges,
+    std::vector<AnalyzedRange<CanvasAnalyzedScript>> const& nextRanges)
+{
+    if (nextRanges.empty())
+        return;
+
+    auto firstRange = nextRanges.front();
+
+    if (ranges->empty() || IsSameAnalysis(ranges->back().Value, firstRange.Value))
+    {
+        AppendAnalyzedRange(ranges, firstRange);
+    }
+    else
+    {
+        auto lastRange = ranges->back();
+        auto seam = firstRange.Start;
+
+        auto analyzeWindow =
+            [&](uint32_t windowStart, uint32_t windowEnd)
+            {
+                auto sink = AnalyzeTextRange(textAnalyzer, &IDWriteTextAnalyzer::AnalyzeScript, source, windowStart, windowEnd);
+
+                return GetAnalyzedRanges(sink->GetAnalyzedScript().Get());
+            };
+
+        auto windowStart = std::max(lastRange.Start, seam > ScriptSeamWindowLength ? seam - ScriptSeamWindowLength : 0);
+        auto windowEnd = std::min(firstRange.End, seam + ScriptSeamWindowLength);
+
+        auto window = analyzeWindow(windowStart, windowEnd);
+
+        auto rangeBeforeSeam = std::find_if(window.begin(), window.end(),
+            [=](AnalyzedRange<CanvasAnalyzedScript> const& range) { return range.End >= seam; });
+
+        bool windowIsLongEnough =
+            rangeBeforeSeam != window.end() &&
+            IsSameAnalysis(rangeBeforeSeam->Value, lastRange.Value) &&
+            (windowEnd == firstRange.End || IsSameAnalysis(window.back().Value, firstRange.Value));
+
+        if (!windowIsLongEnough)
+        {
+            windowStart = lastRange.Start;
+            windowEnd = firstRange.End;
+
+            window = analyzeWindow(windowStart, windowEnd);
+        }
+
+        for (auto const& range : window)
+        {
+            if (range.End > seam)
+                AppendAnalyzedRange(ranges, AnalyzedRange<CanvasAnalyzedScript>{ std::max(range.Start, seam), range.End, range.Value });
+        }
+
+        AppendAnalyzedRange(ranges, AnalyzedRange<CanvasAnalyzedScript>{ windowEnd, firstRange.End, firstRange.Value });
+    }
+
+    for (size_t i = 1; i < nextRanges.size(); ++i)
+        AppendAnalyzedRange(ranges, nextRanges[i]);
+}
+
+std::vector<AnalyzedRange<CanvasAnalyzedBidi>> CanvasTextAnalyzer::GetBidiInParallel(
+    std::vector<TextChunk> const& chunks,
+    WinString const& localeName)
+{
+    ComPtr<IDWriteTextAnalyzer> textAnalyzer = m_customFontManager->GetTextAnalyzer();
+
+    std::vector<std::vector<AnalyzedRange<CanvasAnalyzedBidi>>> chunkRanges(chunks.size());
+
+    RunTasksInParallel(static_cast<uint32_t>(chunks.size()),
+        [&](size_t i)
+        {
+            auto source = CreateTextAnalysisSource(localeName);
+            auto sink = AnalyzeTextRange(textAnalyzer.Get(), &IDWriteTextAnalyzer::AnalyzeBidi, source.Get(), chunks[i].Start, chunks[i].End);
+
+            chunkRanges[i] = GetAnalyzedRanges(sink->GetAnalyzedBidi().Get());
+        });
+
+    //
+    // The bidi algorithm resolves each paragraph independently of the
+    // others, so the chunks' results just need joining up.
+    //
+    std::vector<AnalyzedRange<CanvasAnalyzedBidi>> ranges;
+
+    for (auto const& chunk : chunkRanges)
+    {
+        for (auto const& range : chunk)
+            AppendAnalyzedRange(&ranges, range);
+    }
+
+    return ranges;
+}
+
+//
+// Each chunk's first character was analyzed as the start of the text, which
+// is never broken before.  It actually follows a paragraph separator, so
+// takes the break condition after that instead.
+//
+static void FixBreakpointAtSeam(std::vector<CanvasAnalyzedBreakpoint>* breakpoints, uint32_t seam)
+{
+    if (seam > 0 && seam < breakpoints->size())
+        (*breakpoints)[seam].BreakBefore = (*breakpoints)[seam - 1].BreakAfter;
+}
+
+std::vector<CanvasAnalyzedBreakpoint> CanvasTextAnalyzer::GetBreakpointsInParallel(
+    std::vector<TextChunk> const& chunks,
+    WinString const& localeName)
+{
+    ComPtr<IDWriteTextAnalyzer> textAnalyzer = m_customFontManager->GetTextAnalyzer();
+
+    std::vector<CanvasAnalyzedBreakpoint> breakpoints(chunks.back().End);
+
+    RunTasksInParallel(static_cast<uint32_t>(chunks.size()),
+        [&](size_t i)
+        {
+            auto source = CreateTextAnalysisSource(localeName);
+            auto sink = AnalyzeTextRange(textAnalyzer.Get(), &IDWriteTextAnalyzer::AnalyzeLineBreakpoints, source.Get(), chunks[i].Start, chunks[i].End);
+
+            auto chunkBreakpoints = sink->GetAnalyzedLineBreakpoints();
+
+            std::copy(begin(chunkBreakpoints), end(chunkBreakpoints), breakpoints.begin() + chunks[i].Start);
+        });
+
+    for (size_t i = 1; i < chunks.size(); ++i)
+        FixBreakpointAtSeam(&breakpoints, chunks[i].Start);
+
+    return breakpoints;
+}
+
+std::vector<AnalyzedRange<CanvasAnalyzedScript>> CanvasTextAnalyzer::GetScriptInParallel(
+    std::vector<TextChunk> const& chunks,
+    WinString const& localeName)
+{
+    ComPtr<IDWriteTextAnalyzer> textAnalyzer = m_customFontManager->GetTextAnalyzer();
+
+    std::vector<std::vector<AnalyzedRange<CanvasAnalyzedScript>>> chunkRanges(chunks.size());
+
+    RunTasksInParallel(static_cast<uint32_t>(chunks.size()),
+        [&](size_t i)
+        {
+            auto source = CreateTextAnalysisSource(localeName);
+            auto sink = AnalyzeTextRange(textAnalyzer.Get(), &IDWriteTextAnalyzer::AnalyzeScript, source.Get(), chunks[i].Start, chunks[i].End);
+
+            chunkRanges[i] = GetAnalyzedRanges(sink->GetAnalyzedScript().Get());
+        });
+
+    auto source = CreateTextAnalysisSource(localeName);
+
+    std::vector<AnalyzedRange<CanvasAnalyzedScript>> ranges;
+
+    for (auto const& chunk : chunkRanges)
+        JoinScriptRanges(textAnalyzer.Get(), source.Get(), &ranges, chunk);
+
+    return ranges;
 }
 
 IFACEMETHODIMP CanvasTextAnalyzer::GetFonts(
@@ -491,15 +924,13 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetFonts(
             CheckInPointer(textFormat);
             CheckAndClearOutPointer(result);
 
-            auto dwriteTextFormat = GetWrappedResource<IDWriteTextFormat>(textFormat);
+            auto dwriteTextFormat = As<ICanvasTextFormatInternal>(textFormat)->GetSharedRealizedTextFormat();
 
             WinString localeNameString = GetLocaleName(dwriteTextFormat.Get());
 
             uint32_t textLength;
             WindowsGetStringRawBuffer(m_text, &textLength);
 
-            m_dwriteTextAnalysisSource->SetLocaleName(localeNameString);
-
             ComPtr<IDWriteFontCollection> dwriteFontCollection;
 
             if (requestedFontSet)
@@ -521,53 +952,46 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetFonts(
                 ThrowIfFailed(factory->GetSystemFontCollection(&dwriteFontCollection));
             }
 
-            std::wstring familyNameString;
-            familyNameString.resize(dwriteTextFormat->GetFontFamilyNameLength() + 1);
-            ThrowIfFailed(dwriteTextFormat->GetFontFamilyName(&familyNameString[0], static_cast<uint32_t>(familyNameString.size())));
+            FontMapper fontMapper(
+                m_customFontManager->GetSystemFontFallback().Get(),
+                dwriteFontCollection.Get(),
+                dwriteTextFormat.Get());
 
-            uint32_t characterIndex = 0;
-            uint32_t charactersLeft = textLength;
+            std::vector<MappedFontRange> mappedRanges;
+
+            auto chunks = GetParallelChunks();
+
+            if (chunks.size() > 1)
+            {
+                mappedRanges = MapFontsInParallel(chunks, localeNameString, fontMapper);
+            }
+            else
+            {
+                m_dwriteTextAnalysisSource->SetLocaleName(localeNameString);
 
-            uint32_t mappedLength;
-            ComPtr<IDWriteFont> mappedFont;
-            float scaleFactor;
+                fontMapper.MapUntil(m_dwriteTextAnalysisSource.Get(), 0, textLength, textLength, &mappedRanges);
+            }
 
             auto vector = Make<Vector<IKeyValuePair<CanvasCharacterRange, CanvasScaledFont*>*>>();
 
-            while (charactersLeft > 0)
+            for (auto const& mappedRange : mappedRanges)
             {
-                ThrowIfFailed(m_customFontManager->GetSystemFontFallback()->MapCharacters(
-                    m_dwriteTextAnalysisSource.Get(),
-                    characterIndex,
-                    charactersLeft,
-                    dwriteFontCollection.Get(),
-                    &familyNameString[0],
-                    dwriteTextFormat->GetFontWeight(),
-                    dwriteTextFormat->GetFontStyle(),
-                    dwriteTextFormat->GetFontStretch(),
-                    &mappedLength,
-                    &mappedFont,
-                    &scaleFactor));
-
-                if (mappedFont)
-                {
+                if (!mappedRange.Font)
+                    continue;
+
 #if WINVER > _WIN32_WINNT_WINBLUE
-                    ComPtr<IDWriteFontFaceReference> fontFaceReference;
-                    ThrowIfFailed(As<IDWriteFont3>(mappedFont)->GetFontFaceReference(&fontFaceReference));
-                    auto canvasFontFace = ResourceManager::GetOrCreate<ICanvasFontFace>(fontFaceReference.Get());
+                ComPtr<IDWriteFontFaceReference> fontFaceReference;
+                ThrowIfFailed(As<IDWriteFont3>(mappedRange.Font)->GetFontFaceReference(&fontFaceReference));
+                auto canvasFontFace = ResourceManager::GetOrCreate<ICanvasFontFace>(fontFaceReference.Get());
 #else
-                    auto canvasFontFace = ResourceManager::GetOrCreate<ICanvasFontFace>(mappedFont.Get());
+                auto canvasFontFace = ResourceManager::GetOrCreate<ICanvasFontFace>(mappedRange.Font.Get());
 #endif
-                    auto canvasScaledFont = Make<CanvasScaledFont>(canvasFontFace.Get(), scaleFactor);
-                    CheckMakeResult(canvasScaledFont);
-
-                    auto newPair = MakeCharacterRangeKeyValue<CanvasScaledFont*, ICanvasScaledFont*>(characterIndex, mappedLength, canvasScaledFont.Get());
+                auto canvasScaledFont = Make<CanvasScaledFont>(canvasFontFace.Get(), mappedRange.ScaleFactor);
+                CheckMakeResult(canvasScaledFont);
 
-                    ThrowIfFailed(vector->Append(newPair.Get()));
-                }
+                auto newPair = MakeCharacterRangeKeyValue<CanvasScaledFont*, ICanvasScaledFont*>(mappedRange.Start, mappedRange.Length, canvasScaledFont.Get());
 
-                characterIndex += mappedLength;
-                charactersLeft -= mappedLength;
+                ThrowIfFailed(vector->Append(newPair.Get()));
             }
 
             ThrowIfFailed(vector->GetView(result));
@@ -590,14 +1014,33 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetBidiWithLocale(
             CheckAndClearOutPointer(values);
 
             WinString localeString(locale);
-            m_dwriteTextAnalysisSource->SetLocaleName(localeString);
 
-            uint32_t textLength;
-            WindowsGetStringRawBuffer(m_text, &textLength);
-            
-            ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeBidi(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
+            if (!m_retainedBidi.IsValid || !m_retainedBidi.LocaleName.Equals(localeString))
+            {
+                std::vector<AnalyzedRange<CanvasAnalyzedBidi>> ranges;
+
+                auto chunks = GetParallelChunks();
 
-            ThrowIfFailed(m_dwriteTextAnalysisSink->GetAnalyzedBidi()->GetView(values));
+                if (chunks.size() > 1)
+                {
+                    ranges = GetBidiInParallel(chunks, localeString);
+                }
+                else
+                {
+                    m_dwriteTextAnalysisSource->SetLocaleName(localeString);
+
+                    uint32_t textLength;
+                    WindowsGetStringRawBuffer(m_text, &textLength);
+
+                    ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeBidi(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
+
+                    ranges = GetAnalyzedRanges(m_dwriteTextAnalysisSink->GetAnalyzedBidi().Get());
+                }
+
+                m_retainedBidi.Retain(localeString, std::move(ranges));
+            }
+
+            ThrowIfFailed(MakeAnalyzedRangeVector(m_retainedBidi.Results)->GetView(values));
         });
 }
 
@@ -620,16 +1063,39 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetBreakpointsWithLocale(
             CheckAndClearOutPointer(valueElements);
 
             WinString localeString(locale);
-            m_dwriteTextAnalysisSource->SetLocaleName(localeString);
 
-            uint32_t textLength;
-            WindowsGetStringRawBuffer(m_text, &textLength);
+            if (!m_retainedBreakpoints.IsValid || !m_retainedBreakpoints.LocaleName.Equals(localeString))
+            {
+                std::vector<CanvasAnalyzedBreakpoint> breakpoints;
+
+                auto chunks = GetParallelChunks();
+
+                if (chunks.size() > 1)
+                {
+                    breakpoints = GetBreakpointsInParallel(chunks, localeString);
+                }
+                else
+                {
+                    m_dwriteTextAnalysisSource->SetLocaleName(localeString);
+
+                    uint32_t textLength;
+                    WindowsGetStringRawBuffer(m_text, &textLength);
+
+                    ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeLineBreakpoints(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
 
-            ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeLineBreakpoints(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
+                    auto analyzedBreakpoints = m_dwriteTextAnalysisSink->GetAnalyzedLineBreakpoints();
 
-            auto analyzedBreakpoints = m_dwriteTextAnalysisSink->GetAnalyzedLineBreakpoints();
+                    breakpoints.assign(begin(analyzedBreakpoints), end(analyzedBreakpoints));
+                }
+
+                m_retainedBreakpoints.Retain(localeString, std::move(breakpoints));
+            }
 
-            analyzedBreakpoints.Detach(valueCount, valueElements);
+            auto& breakpoints = m_retainedBreakpoints.Results;
+
+            ComArray<CanvasAnalyzedBreakpoint> result(breakpoints.begin(), breakpoints.end());
+
+            result.Detach(valueCount, valueElements);
         });
 }
 
@@ -666,14 +1132,33 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetScriptWithLocale(
             CheckAndClearOutPointer(values);
 
             WinString localeString(locale);
-            m_dwriteTextAnalysisSource->SetLocaleName(localeString);
 
-            uint32_t textLength;
-            WindowsGetStringRawBuffer(m_text, &textLength);
+            if (!m_retainedScript.IsValid || !m_retainedScript.LocaleName.Equals(localeString))
+            {
+                std::vector<AnalyzedRange<CanvasAnalyzedScript>> ranges;
+
+                auto chunks = GetParallelChunks();
+
+                if (chunks.size() > 1)
+                {
+                    ranges = GetScriptInParallel(chunks, localeString);
+                }
+                else
+                {
+                    m_dwriteTextAnalysisSource->SetLocaleName(localeString);
 
-            ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeScript(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
+                    uint32_t textLength;
+                    WindowsGetStringRawBuffer(m_text, &textLength);
 
-            ThrowIfFailed(m_dwriteTextAnalysisSink->GetAnalyzedScript()->GetView(values));
+                    ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->AnalyzeScript(m_dwriteTextAnalysisSource.Get(), 0, textLength, m_dwriteTextAnalysisSink.Get()));
+
+                    ranges = GetAnalyzedRanges(m_dwriteTextAnalysisSink->GetAnalyzedScript().Get());
+                }
+
+                m_retainedScript.Retain(localeString, std::move(ranges));
+            }
+
+            ThrowIfFailed(MakeAnalyzedRangeVector(m_retainedScript.Results)->GetView(values));
         });
 }
 
@@ -904,6 +1389,73 @@ static void ThrowIfInvalidCharacterRange(uint32_t textLength, CanvasCharacterRan
         ThrowHR(E_INVALIDARG);
 }
 
+//
+// Buffers reused by each thread's calls to GetGlyphsWithAllOptions, so that
+// shaping text that isn't in the GlyphShapingCache doesn't need to allocate
+// once these have grown large enough.
+//
+struct GlyphShapingScratch
+{
+    GlyphShapingKey Key;
+    ShapedGlyphRun Run;
+};
+
+static GlyphShapingScratch& GetGlyphShapingScratch()
+{
+    static thread_local GlyphShapingScratch scratch;
+    return scratch;
+}
+
+static void MakeGlyphShapingKey(
+    wchar_t const* text,
+    uint32_t textLength,
+    IDWriteFontFace* fontFace,
+    float fontSize,
+    boolean isSideways,
+    boolean isRightToLeft,
+    DWRITE_SCRIPT_ANALYSIS const& scriptAnalysis,
+    HSTRING locale,
+    IDWriteNumberSubstitution* numberSubstitution,
+    uint32_t typographyRangeCount,
+    DWriteTypographyRangeData const& typographyRangeData,
+    GlyphShapingKey* key)
+{
+    key->Reset();
+
+    key->AddValue(textLength);
+    key->AddBytes(text, textLength * sizeof(wchar_t));
+
+    key->AddValue(fontFace);
+    key->AddValue(fontSize);
+    key->AddValue(isSideways);
+    key->AddValue(isRightToLeft);
+
+    // Added field by field, since DWRITE_SCRIPT_ANALYSIS has padding.
+    key->AddValue(scriptAnalysis.script);
+    key->AddValue(scriptAnalysis.shapes);
+
+    uint32_t localeLength;
+    auto localeBuffer = WindowsGetStringRawBuffer(locale, &localeLength);
+    key->AddValue(localeLength);
+    key->AddBytes(localeBuffer, localeLength * sizeof(wchar_t));
+
+    key->AddValue(numberSubstitution);
+
+    key->AddValue(typographyRangeCount);
+
+    for (uint32_t i = 0; i < typographyRangeCount; ++i)
+    {
+        auto features = typographyRangeData.FeatureDataPointers[i];
+        uint32_t featureCount = features ? features->featureCount : 0;
+
+        key->AddValue(typographyRangeData.FeatureRangeLengths[i]);
+        key->AddValue(featureCount);
+
+        if (featureCount > 0)
+            key->AddBytes(features->features, featureCount * sizeof(DWRITE_FONT_FEATURE));
+    }
+}
+
 IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
     CanvasCharacterRange characterRange,
     ICanvasFontFace* fontFace,
@@ -944,12 +1496,6 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
 
             auto dwriteScriptAnalysis = ToDWriteScriptAnalysis(script);
 
-            std::vector<uint16_t> clusterMap;
-            clusterMap.resize(textLength);
-
-            std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> shapingTextProperties;
-            shapingTextProperties.resize(textLength);
-
             auto dwriteFontFace = As<ICanvasFontFaceInternal>(fontFace)->GetRealizedFontFace();
             
             ComPtr<IDWriteNumberSubstitution> dwriteNumberSubstitution;
@@ -963,80 +1509,115 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
                 GetDWriteTypographyRanges(characterRange, typographyRanges, &typographyRangeCount, &dwriteTypographyRangeData);
             }
 
-            std::vector<DWRITE_TYPOGRAPHIC_FEATURES> featuresPerSpan;
+            auto& scratch = GetGlyphShapingScratch();
+            auto& glyphShapingCache = m_customFontManager->GetGlyphShapingCache();
 
-            std::vector<uint16_t> glyphIndices;
+            bool isCacheable = textLength <= GlyphShapingCache::MaxTextLength;
 
-            std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> shapingGlyphProperties;
+            std::shared_ptr<ShapedGlyphRun const> cachedRun;
 
-            uint32_t actualGlyphCount{};    
-            RetryWithIncreasingGlyphCount(
-                textLength,
-                [&](uint32_t maxGlyphCount)
-                {
-                    glyphIndices.resize(maxGlyphCount);
+            if (isCacheable)
+            {
+                MakeGlyphShapingKey(
+                    text,
+                    textLength,
+                    dwriteFontFace.Get(),
+                    fontSize,
+                    isSideways,
+                    isRightToLeft,
+                    dwriteScriptAnalysis,
+                    locale,
+                    dwriteNumberSubstitution.Get(),
+                    typographyRangeCount,
+                    dwriteTypographyRangeData,
+                    &scratch.Key);
+
+                cachedRun = glyphShapingCache.TryGet(scratch.Key);
+            }
 
-                    shapingGlyphProperties.resize(maxGlyphCount);
+            ShapedGlyphRun const* run = cachedRun.get();
 
-                    return m_customFontManager->GetTextAnalyzer()->GetGlyphs(
-                        text,
-                        textLength,
-                        dwriteFontFace.Get(),
-                        isSideways,
-                        isRightToLeft,
-                        &dwriteScriptAnalysis,
-                        WindowsGetStringRawBuffer(locale, nullptr),
-                        dwriteNumberSubstitution.Get(),
-                        typographyRanges ? dwriteTypographyRangeData.FeatureDataPointers.data() : nullptr,
-                        typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
-                        typographyRangeCount,
-                        maxGlyphCount,
-                        clusterMap.data(),
-                        shapingTextProperties.data(),
-                        glyphIndices.data(),
-                        shapingGlyphProperties.data(),
-                        &actualGlyphCount);
-                });
+            if (!run)
+            {
+                auto& shapedRun = scratch.Run;
 
-            std::vector<float> glyphAdvances;
-            glyphAdvances.resize(actualGlyphCount);
+                shapedRun.ClusterMap.resize(textLength);
+                shapedRun.ShapingTextProperties.resize(textLength);
 
-            std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
-            glyphOffsets.resize(actualGlyphCount);
+                uint32_t actualGlyphCount{};    
+                RetryWithIncreasingGlyphCount(
+                    textLength,
+                    [&](uint32_t maxGlyphCount)
+                    {
+                        shapedRun.GlyphIndices.resize(maxGlyphCount);
+
+                        shapedRun.ShapingGlyphProperties.resize(maxGlyphCount);
+
+                        return m_customFontManager->GetTextAnalyzer()->GetGlyphs(
+                            text,
+                            textLength,
+                            dwriteFontFace.Get(),
+                            isSideways,
+                            isRightToLeft,
+                            &dwriteScriptAnalysis,
+                            WindowsGetStringRawBuffer(locale, nullptr),
+                            dwriteNumberSubstitution.Get(),
+                            typographyRanges ? dwriteTypographyRangeData.FeatureDataPointers.data() : nullptr,
+                            typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
+                            typographyRangeCount,
+                            maxGlyphCount,
+                            shapedRun.ClusterMap.data(),
+                            shapedRun.ShapingTextProperties.data(),
+                            shapedRun.GlyphIndices.data(),
+                            shapedRun.ShapingGlyphProperties.data(),
+                            &actualGlyphCount);
+                    });
 
-            ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->GetGlyphPlacements(
-                text,
-                clusterMap.data(),
-                shapingTextProperties.data(),
-                textLength,
-                glyphIndices.data(),
-                shapingGlyphProperties.data(),
-                actualGlyphCount,
-                dwriteFontFace.Get(),
-                fontSize,
-                isSideways,
-                isRightToLeft,
-                &dwriteScriptAnalysis,
-                WindowsGetStringRawBuffer(locale, nullptr),
-                typographyRanges ? dwriteTypographyRangeData.FeatureDataPointers.data() : nullptr,
-                typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
-                typographyRangeCount,
-                glyphAdvances.data(),
-                glyphOffsets.data()));
-
-            ComArray<CanvasGlyph> glyphs(actualGlyphCount);
-            for (uint32_t i = 0; i < actualGlyphCount; ++i)
+                shapedRun.GlyphCount = actualGlyphCount;
+                shapedRun.GlyphAdvances.resize(actualGlyphCount);
+                shapedRun.GlyphOffsets.resize(actualGlyphCount);
+
+                ThrowIfFailed(m_customFontManager->GetTextAnalyzer()->GetGlyphPlacements(
+                    text,
+                    shapedRun.ClusterMap.data(),
+                    shapedRun.ShapingTextProperties.data(),
+                    textLength,
+                    shapedRun.GlyphIndices.data(),
+                    shapedRun.ShapingGlyphProperties.data(),
+                    actualGlyphCount,
+                    dwriteFontFace.Get(),
+                    fontSize,
+                    isSideways,
+                    isRightToLeft,
+                    &dwriteScriptAnalysis,
+                    WindowsGetStringRawBuffer(locale, nullptr),
+                    typographyRanges ? dwriteTypographyRangeData.FeatureDataPointers.data() : nullptr,
+                    typographyRanges ? dwriteTypographyRangeData.FeatureRangeLengths.data() : nullptr,
+                    typographyRangeCount,
+                    shapedRun.GlyphAdvances.data(),
+                    shapedRun.GlyphOffsets.data()));
+
+                if (isCacheable)
+                    glyphShapingCache.Add(scratch.Key, dwriteFontFace.Get(), dwriteNumberSubstitution.Get(), shapedRun);
+
+                run = &shapedRun;
+            }
+
+            auto glyphCount = run->GlyphCount;
+
+            ComArray<CanvasGlyph> glyphs(glyphCount);
+            for (uint32_t i = 0; i < glyphCount; ++i)
             {
-                glyphs[i].Index = glyphIndices[i];
-                glyphs[i].Advance = glyphAdvances[i];
-                glyphs[i].AdvanceOffset = glyphOffsets[i].advanceOffset;
-                glyphs[i].AscenderOffset = glyphOffsets[i].ascenderOffset;
+                glyphs[i].Index = run->GlyphIndices[i];
+                glyphs[i].Advance = run->GlyphAdvances[i];
+                glyphs[i].AdvanceOffset = run->GlyphOffsets[i].advanceOffset;
+                glyphs[i].AscenderOffset = run->GlyphOffsets[i].ascenderOffset;
             }
             glyphs.Detach(valueCount, valueElements);
 
             if (clusterMapIndexElements)
             {
-                auto clusterMapResult = TransformToComArray<int>(clusterMap.begin(), clusterMap.end(), 
+                auto clusterMapResult = TransformToComArray<int>(run->ClusterMap.begin(), run->ClusterMap.end(), 
                     [](uint16_t value)
                     {
                         return static_cast<int>(value);
@@ -1046,7 +1627,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
 
             if (isShapedAloneElements)
             {
-                auto isShapedAloneResult = TransformToComArray<boolean>(shapingTextProperties.begin(), shapingTextProperties.end(),
+                auto isShapedAloneResult = TransformToComArray<boolean>(run->ShapingTextProperties.begin(), run->ShapingTextProperties.end(),
                     [](DWRITE_SHAPING_TEXT_PROPERTIES const& value)
                     {
                         return !!value.isShapedAlone;
@@ -1056,7 +1637,7 @@ IFACEMETHODIMP CanvasTextAnalyzer::GetGlyphsWithAllOptions(
 
             if (glyphShapingElements)
             {
-                auto glyphShaping = TransformToComArray<CanvasGlyphShaping>(shapingGlyphProperties.begin(), shapingGlyphProperties.begin() + actualGlyphCount,
+                auto glyphShaping = TransformToComArray<CanvasGlyphShaping>(run->ShapingGlyphProperties.begin(), run->ShapingGlyphProperties.begin() + glyphCount,
                     [](DWRITE_SHAPING_GLYPH_PROPERTIES const& dwriteValue)
                     {
                         CanvasGlyphShaping result{};
@@ -1384,6 +1965,187 @@ IFACEMETHODIMP CanvasTextAnalyzer::AddGlyphsAfterJustificationWithClusterMap(
         });
 }
 
+IFACEMETHODIMP CanvasTextAnalyzer::get_AnalyzeParagraphsInParallel(boolean* value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(value);
+
+            *value = m_analyzeParagraphsInParallel;
+        });
+}
+
+IFACEMETHODIMP CanvasTextAnalyzer::put_AnalyzeParagraphsInParallel(boolean value)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            m_analyzeParagraphsInParallel = !!value;
+        });
+}
+
+IFACEMETHODIMP CanvasTextAnalyzer::ReplaceText(
+    CanvasCharacterRange characterRange,
+    HSTRING newText)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            ThrowIfNegative(characterRange.CharacterIndex);
+            ThrowIfNegative(characterRange.CharacterCount);
+
+            uint32_t textLength;
+            auto text = WindowsGetStringRawBuffer(m_text, &textLength);
+
+            // Unlike elsewhere, the range may be empty at the very end of the
+            // text, for appending.
+            if (static_cast<uint32_t>(characterRange.CharacterIndex) + static_cast<uint32_t>(characterRange.CharacterCount) > textLength)
+                ThrowHR(E_INVALIDARG);
+
+            uint32_t insertedLength;
+            auto inserted = WindowsGetStringRawBuffer(newText, &insertedLength);
+
+            uint32_t editStart = characterRange.CharacterIndex;
+            uint32_t oldEditEnd = editStart + characterRange.CharacterCount;
+            uint32_t newEditEnd = editStart + insertedLength;
+
+            std::wstring editedText;
+            editedText.reserve(textLength - characterRange.CharacterCount + insertedLength);
+            editedText.append(text, editStart);
+            editedText.append(inserted, insertedLength);
+            editedText.append(text + oldEditEnd, textLength - oldEditEnd);
+
+            m_text = WinString(editedText.data(), editedText.data() + editedText.size());
+
+            CreateTextAnalysisSourceAndSink();
+
+            auto paragraphs = GetEditedParagraphs(editedText.data(), static_cast<uint32_t>(editedText.size()), editStart, newEditEnd);
+
+            // The edited paragraphs used to end here.
+            uint32_t oldParagraphsEnd = paragraphs.End - newEditEnd + oldEditEnd;
+
+            UpdateRetainedBidi(paragraphs, oldParagraphsEnd);
+            UpdateRetainedBreakpoints(paragraphs, oldParagraphsEnd);
+            UpdateRetainedScript(paragraphs, oldParagraphsEnd);
+        });
+}
+
+//
+// Splits retained ranges into those before start, and those after
+// oldEnd moved to where they are after an edit that now ends at newEnd.
+//
+template<typename T>
+static void SplitRetainedRanges(
+    std::vector<AnalyzedRange<T>> const& ranges,
+    uint32_t start,
+    uint32_t oldEnd,
+    uint32_t newEnd,
+    std::vector<AnalyzedRange<T>>* rangesBefore,
+    std::vector<AnalyzedRange<T>>* rangesAfter)
+{
+    for (auto const& range : ranges)
+    {
+        if (range.Start < start)
+            rangesBefore->push_back(AnalyzedRange<T>{ range.Start, std::min(range.End, start), range.Value });
+
+        if (range.End > oldEnd)
+            rangesAfter->push_back(AnalyzedRange<T>{ std::max(range.Start, oldEnd) - oldEnd + newEnd, range.End - oldEnd + newEnd, range.Value });
+    }
+}
+
+void CanvasTextAnalyzer::UpdateRetainedBidi(TextChunk const& paragraphs, uint32_t oldParagraphsEnd)
+{
+    if (!m_retainedBidi.IsValid)
+        return;
+
+    // Dropped, rather than left out of date, if this fails part way.
+    m_retainedBidi.IsValid = false;
+
+    std::vector<AnalyzedRange<CanvasAnalyzedBidi>> ranges;
+    std::vector<AnalyzedRange<CanvasAnalyzedBidi>> rangesAfter;
+    SplitRetainedRanges(m_retainedBidi.Results, paragraphs.Start, oldParagraphsEnd, paragraphs.End, &ranges, &rangesAfter);
+
+    // Paragraphs are resolved independently, so only the edited ones change.
+    if (paragraphs.Start < paragraphs.End)
+    {
+        auto source = CreateTextAnalysisSource(m_retainedBidi.LocaleName);
+        auto sink = AnalyzeTextRange(m_customFontManager->GetTextAnalyzer().Get(), &IDWriteTextAnalyzer::AnalyzeBidi, source.Get(), paragraphs.Start, paragraphs.End);
+
+        for (auto const& range : GetAnalyzedRanges(sink->GetAnalyzedBidi().Get()))
+            AppendAnalyzedRange(&ranges, range);
+    }
+
+    for (auto const& range : rangesAfter)
+        AppendAnalyzedRange(&ranges, range);
+
+    m_retainedBidi.Results = std::move(ranges);
+    m_retainedBidi.IsValid = true;
+}
+
+void CanvasTextAnalyzer::UpdateRetainedBreakpoints(TextChunk const& paragraphs, uint32_t oldParagraphsEnd)
+{
+    if (!m_retainedBreakpoints.IsValid)
+        return;
+
+    // Dropped, rather than left out of date, if this fails part way.
+    m_retainedBreakpoints.IsValid = false;
+
+    auto const& oldBreakpoints = m_retainedBreakpoints.Results;
+
+    std::vector<CanvasAnalyzedBreakpoint> breakpoints;
+    breakpoints.reserve(paragraphs.End + oldBreakpoints.size() - oldParagraphsEnd);
+
+    breakpoints.insert(breakpoints.end(), oldBreakpoints.begin(), oldBreakpoints.begin() + paragraphs.Start);
+
+    if (paragraphs.Start < paragraphs.End)
+    {
+        auto source = CreateTextAnalysisSource(m_retainedBreakpoints.LocaleName);
+        auto sink = AnalyzeTextRange(m_customFontManager->GetTextAnalyzer().Get(), &IDWriteTextAnalyzer::AnalyzeLineBreakpoints, source.Get(), paragraphs.Start, paragraphs.End);
+
+        auto editedBreakpoints = sink->GetAnalyzedLineBreakpoints();
+
+        breakpoints.insert(breakpoints.end(), begin(editedBreakpoints), end(editedBreakpoints));
+    }
+
+    breakpoints.insert(breakpoints.end(), oldBreakpoints.begin() + oldParagraphsEnd, oldBreakpoints.end());
+
+    FixBreakpointAtSeam(&breakpoints, paragraphs.Start);
+
+    m_retainedBreakpoints.Results = std::move(breakpoints);
+    m_retainedBreakpoints.IsValid = true;
+}
+
+void CanvasTextAnalyzer::UpdateRetainedScript(TextChunk const& paragraphs, uint32_t oldParagraphsEnd)
+{
+    if (!m_retainedScript.IsValid)
+        return;
+
+    // Dropped, rather than left out of date, if this fails part way.
+    m_retainedScript.IsValid = false;
+
+    std::vector<AnalyzedRange<CanvasAnalyzedScript>> ranges;
+    std::vector<AnalyzedRange<CanvasAnalyzedScript>> rangesAfter;
+    SplitRetainedRanges(m_retainedScript.Results, paragraphs.Start, oldParagraphsEnd, paragraphs.End, &ranges, &rangesAfter);
+
+    ComPtr<IDWriteTextAnalyzer> textAnalyzer = m_customFontManager->GetTextAnalyzer();
+    auto source = CreateTextAnalysisSource(m_retainedScript.LocaleName);
+
+    // Script carries across paragraphs, so both ends of the edited
+    // paragraphs are joined up as seams.
+    if (paragraphs.Start < paragraphs.End)
+    {
+        auto sink = AnalyzeTextRange(textAnalyzer.Get(), &IDWriteTextAnalyzer::AnalyzeScript, source.Get(), paragraphs.Start, paragraphs.End);
+
+        JoinScriptRanges(textAnalyzer.Get(), source.Get(), &ranges, GetAnalyzedRanges(sink->GetAnalyzedScript().Get()));
+    }
+
+    JoinScriptRanges(textAnalyzer.Get(), source.Get(), &ranges, rangesAfter);
+
+    m_retainedScript.Results = std::move(ranges);
+    m_retainedScript.IsValid = true;
+}
+
 HRESULT CanvasTextAnalyzerFactory::Create(
     HSTRING text,
     CanvasTextDirection textDirection,
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "TextAnalysisChunks.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
     class DWriteTextAnalysisSource : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IDWriteTextAnalysisSource1>,
@@ -67,6 +69,7 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     class DWriteTextAnalysisSink : public RuntimeClass<RuntimeClassFlags<ClassicCom>, IDWriteTextAnalysisSink1>,
         private LifespanTracker<DWriteTextAnalysisSink>
     {
+        uint32_t m_textPosition;
         uint32_t m_textLength;
 
         ComPtr<Vector<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>*>> m_analyzedBidi;
@@ -76,7 +79,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<Vector<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedGlyphOrientation>*>> m_analyzedGlyphOrientation;
 
     public:
-        DWriteTextAnalysisSink(uint32_t textLength) : m_textLength(textLength) {}
+        DWriteTextAnalysisSink(uint32_t textLength) : m_textPosition(0), m_textLength(textLength) {}
+
+        // Receives results for just [textPosition, textPosition + textLength).
+        DWriteTextAnalysisSink(uint32_t textPosition, uint32_t textLength) : m_textPosition(textPosition), m_textLength(textLength) {}
 
         STDMETHOD(SetBidiLevel)(
             uint32_t textPosition,
@@ -131,6 +137,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
     };
 
+    struct MappedFontRange;
+    class FontMapper;
+
     class CanvasTextAnalyzer : public RuntimeClass<
         RuntimeClassFlags<WinRtClassicComMix>,
         ICanvasTextAnalyzer>,
@@ -150,6 +159,35 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<DWriteTextAnalysisSource> m_dwriteTextAnalysisSource;
         ComPtr<DWriteTextAnalysisSink> m_dwriteTextAnalysisSink;
 
+        bool m_analyzeParagraphsInParallel;
+
+        //
+        // The most recent results of GetBidi, GetBreakpoints and GetScript,
+        // kept so that asking again doesn't analyze the text again, and so
+        // that ReplaceText can update them by analyzing just the paragraphs
+        // it changes.
+        //
+        template<typename T>
+        struct RetainedAnalysis
+        {
+            bool IsValid;
+            WinString LocaleName;
+            T Results;
+
+            RetainedAnalysis() : IsValid(false) {}
+
+            void Retain(WinString const& localeName, T&& results)
+            {
+                IsValid = true;
+                LocaleName = localeName;
+                Results = std::move(results);
+            }
+        };
+
+        RetainedAnalysis<std::vector<AnalyzedRange<CanvasAnalyzedBidi>>> m_retainedBidi;
+        RetainedAnalysis<std::vector<CanvasAnalyzedBreakpoint>> m_retainedBreakpoints;
+        RetainedAnalysis<std::vector<AnalyzedRange<CanvasAnalyzedScript>>> m_retainedScript;
+
     public:
         CanvasTextAnalyzer(
             HSTRING text,
@@ -291,9 +329,34 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             uint32_t* valueCount,
             CanvasGlyph** valueElements) override;
 
+        IFACEMETHOD(get_AnalyzeParagraphsInParallel)(boolean* value) override;
+        IFACEMETHOD(put_AnalyzeParagraphsInParallel)(boolean value) override;
+
+        IFACEMETHOD(ReplaceText)(
+            CanvasCharacterRange characterRange,
+            HSTRING newText) override;
+
     private:
         void CreateTextAnalysisSourceAndSink();
 
+        ComPtr<DWriteTextAnalysisSource> CreateTextAnalysisSource(WinString const& localeName);
+
+        std::vector<TextChunk> GetParallelChunks();
+
+        std::vector<MappedFontRange> MapFontsInParallel(std::vector<TextChunk> const& chunks, WinString const& localeName, FontMapper const& fontMapper);
+
+        std::vector<AnalyzedRange<CanvasAnalyzedBidi>> GetBidiInParallel(std::vector<TextChunk> const& chunks, WinString const& localeName);
+
+        std::vector<CanvasAnalyzedBreakpoint> GetBreakpointsInParallel(std::vector<TextChunk> const& chunks, WinString const& localeName);
+
+        std::vector<AnalyzedRange<CanvasAnalyzedScript>> GetScriptInParallel(std::vector<TextChunk> const& chunks, WinString const& localeName);
+
+        void UpdateRetainedBidi(TextChunk const& paragraphs, uint32_t oldParagraphsEnd);
+
+        void UpdateRetainedBreakpoints(TextChunk const& paragraphs, uint32_t oldParagraphsEnd);
+
+        void UpdateRetainedScript(TextChunk const& paragraphs, uint32_t oldParagraphsEnd);
+
     };
 
 
@@ -167,6 +167,72 @@ ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetRealizedTextFormat()
 {
     auto lock = GetLock();
 
+    return GetOrCreateRealizedTextFormat(lock);
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetSharedRealizedTextFormat()
+{
+    auto lock = GetLock();
+
+    ThrowIfClosed();
+
+    if (auto sharedFormat = GetCachedRealizedTextFormat(lock))
+        return sharedFormat;
+
+    return GetOrCreateRealizedTextFormat(lock);
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::TryGetSharedRealizedTextFormat()
+{
+    auto lock = GetLock();
+
+    ThrowIfClosed();
+
+    return GetCachedRealizedTextFormat(lock);
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetCachedRealizedTextFormat(Lock const& lock)
+{
+    MustOwnLock(lock);
+
+    //
+    // Once this format has its own IDWriteTextFormat, that is always used
+    // since interop may have changed it.  Trimming signs are inline objects
+    // that belong to one particular format, so formats with a trimming sign
+    // are never shared.
+    //
+    bool hasTrimmingSign =
+        m_trimmingSignInformation.GetTrimmingSignShadowState() != CanvasTrimmingSign::None ||
+        m_trimmingSignInformation.GetCustomTrimmingSignShadowState();
+
+    if (HasResource() || hasTrimmingSign)
+        return nullptr;
+
+    //
+    // Otherwise, this format's properties are all in its shadow state, and
+    // any format realized from the same properties can be shared.  Note that
+    // this doesn't call SetResource, so property changes on this format
+    // never need to touch the shared format.
+    //
+    auto key = GetRealizedTextFormatKey();
+    auto& cache = m_customFontManager->GetRealizedTextFormatCache();
+
+    if (auto cachedFormat = cache.TryGet(key))
+        return cachedFormat;
+
+    auto newFormat = CreateRealizedTextFormat();
+
+    return cache.Add(key, newFormat.Get());
+}
+
+
+ComPtr<IDWriteTextFormat1> CanvasTextFormat::GetOrCreateRealizedTextFormat(Lock const& lock)
+{
+    MustOwnLock(lock);
+
     auto& existingResource = MaybeGetResource();
 
     if (existingResource)
@@ -265,6 +331,39 @@ ComPtr<IDWriteTextFormat> CanvasTextFormat::GetRealizedTextFormatClone(CanvasWor
 }
 
 
+RealizedTextFormatKey CanvasTextFormat::GetRealizedTextFormatKey()
+{
+    auto uriAndFontFamily = GetUriAndFontFamily(m_fontFamilyName);
+
+    RealizedTextFormatProperties properties{};
+    properties.FontSize                 = m_fontSize;
+    properties.IncrementalTabStop       = m_incrementalTabStop;
+    properties.LineSpacing              = m_lineSpacing;
+    properties.LineSpacingBaseline      = m_lineSpacingBaseline;
+    properties.LineSpacingMode          = static_cast<uint32_t>(m_lineSpacingMode);
+    properties.Direction                = m_direction;
+    properties.FontStretch              = m_fontStretch;
+    properties.FontStyle                = m_fontStyle;
+    properties.FontWeight               = m_fontWeight.Weight;
+    properties.VerticalAlignment        = m_verticalAlignment;
+    properties.HorizontalAlignment      = m_horizontalAlignment;
+    properties.TrimmingGranularity      = m_trimmingGranularity;
+    properties.TrimmingDelimiterCount   = m_trimmingDelimiterCount;
+    properties.WordWrapping             = m_wordWrapping;
+    properties.VerticalGlyphOrientation = m_verticalGlyphOrientation;
+    properties.OpticalAlignment         = m_opticalAlignment;
+    properties.LastLineWrapping         = m_lastLineWrapping;
+
+    return RealizedTextFormatKey(
+        m_fontCollection.Get(),
+        uriAndFontFamily.first,
+        uriAndFontFamily.second,
+        m_localeName,
+        m_trimmingDelimiter,
+        properties);
+}
+
+
 D2D1_DRAW_TEXT_OPTIONS CanvasTextFormat::GetDrawTextOptions()
 {
     return static_cast<D2D1_DRAW_TEXT_OPTIONS>(m_drawTextOptions);
@@ -55,6 +55,15 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
     public:
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() = 0;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) = 0;
+
+        // Returns a realized format that may be shared with other
+        // CanvasTextFormats, so it must only be read from.
+        virtual ComPtr<IDWriteTextFormat1> GetSharedRealizedTextFormat() = 0;
+
+        // As GetSharedRealizedTextFormat, but returns null rather than this
+        // format's own IDWriteTextFormat when that is the one that would be
+        // used.  Formats returned from here never change.
+        virtual ComPtr<IDWriteTextFormat1> TryGetSharedRealizedTextFormat() = 0;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() = 0;
     };
 
@@ -179,6 +188,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         virtual ComPtr<IDWriteTextFormat1> GetRealizedTextFormat() override;
         virtual ComPtr<IDWriteTextFormat> GetRealizedTextFormatClone(CanvasWordWrapping overrideWordWrapping) override;
+        virtual ComPtr<IDWriteTextFormat1> GetSharedRealizedTextFormat() override;
+        virtual ComPtr<IDWriteTextFormat1> TryGetSharedRealizedTextFormat() override;
         virtual D2D1_DRAW_TEXT_OPTIONS GetDrawTextOptions() override;
 
         //
@@ -221,7 +232,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         void RealizeTrimmingSign(IDWriteTextFormat1* textFormat);
         void RealizeCustomTrimmingSign(IDWriteTextFormat1* textFormat);
 
+        ComPtr<IDWriteTextFormat1> GetOrCreateRealizedTextFormat(Lock const& lock);
+        ComPtr<IDWriteTextFormat1> GetCachedRealizedTextFormat(Lock const& lock);
         ComPtr<IDWriteTextFormat1> CreateRealizedTextFormat(bool skipWordWrapping = false);
+        RealizedTextFormatKey GetRealizedTextFormatKey();
 };
 
 
@@ -10,6 +10,7 @@
 #include "brushes/CanvasImageBrush.h"
 
 #include "CanvasTextLayout.h"
+#include "TextLayoutCache.h"
 #include "CanvasFontFace.h"
 #include "TextUtilities.h"
 #include "InternalDWriteTextRenderer.h"
@@ -72,7 +73,7 @@ ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
     ThrowIfFailed(dwriteFactory->CreateTextLayout(
         textBuffer,
         textLength,
-        GetWrappedResource<IDWriteTextFormat>(textFormat).Get(),
+        As<ICanvasTextFormatInternal>(textFormat)->GetSharedRealizedTextFormat().Get(),
         requestedWidth,
         requestedHeight,
         &dwriteTextLayout));
@@ -80,19 +81,102 @@ ComPtr<CanvasTextLayout> CanvasTextLayout::CreateNew(
     ComPtr<ICanvasDevice> device;
     ThrowIfFailed(resourceCreator->get_Device(&device));
 
-    auto textLayout = Make<CanvasTextLayout>(
-        device.Get(),
-        As<DWriteTextLayoutType>(dwriteTextLayout).Get());
-    CheckMakeResult(textLayout);
-
     CanvasLineSpacingMode lineSpacingMode{};
 #if WINVER > _WIN32_WINNT_WINBLUE
     ThrowIfFailed(textFormat->get_LineSpacingMode(&lineSpacingMode));
 #endif
-    textLayout->SetLineSpacingModeInternal(lineSpacingMode);
 
     CanvasTrimmingSign trimmingSign;
     ThrowIfFailed(textFormat->get_TrimmingSign(&trimmingSign));
+
+    return CreateWrapper(device.Get(), dwriteTextLayout.Get(), lineSpacingMode, trimmingSign);
+}
+
+
+ComPtr<ICanvasTextLayout> CanvasTextLayout::CreateCached(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING text,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth,
+    float requestedHeight,
+    CanvasDrawTextOptions options)
+{
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto cache = As<ICanvasDeviceInternal>(device)->GetTextLayoutCache();
+    ThrowIfNullPointer(cache.get(), RO_E_CLOSED);
+
+    CanvasLineSpacingMode lineSpacingMode{};
+#if WINVER > _WIN32_WINNT_WINBLUE
+    ThrowIfFailed(textFormat->get_LineSpacingMode(&lineSpacingMode));
+#endif
+
+    auto createWrapper = [&](IDWriteTextLayout* dwriteTextLayout) -> ComPtr<ICanvasTextLayout>
+    {
+        // Formats with a trimming sign are never shared, so cached layouts
+        // don't have one.
+        auto textLayout = CreateWrapper(device.Get(), dwriteTextLayout, lineSpacingMode, CanvasTrimmingSign::None);
+        textLayout->m_drawTextOptions = options;
+        textLayout->m_isShared = true;
+        return textLayout;
+    };
+
+    //
+    // Only layouts made from a shared realized format can be cached, since
+    // any other format's IDWriteTextFormat may change after the layout has
+    // been created.  Layouts that can't be cached still behave like cached
+    // ones, so that apps see the same thing whichever they get.
+    //
+    auto dwriteTextFormat = As<ICanvasTextFormatInternal>(textFormat)->TryGetSharedRealizedTextFormat();
+
+    if (!dwriteTextFormat)
+    {
+        auto textLayout = CreateNew(resourceCreator, text, textFormat, requestedWidth, requestedHeight);
+        textLayout->m_drawTextOptions = options;
+        textLayout->m_isShared = true;
+        return textLayout;
+    }
+
+    auto customFontManager = CustomFontManager::GetInstance();
+    auto fontCollectionGeneration = customFontManager->GetFontCollectionGeneration();
+
+    TextLayoutCacheKey key(WinString(text), dwriteTextFormat.Get(), requestedWidth, requestedHeight, options);
+
+    if (auto cachedTextLayout = cache->TryGet(key, fontCollectionGeneration, createWrapper))
+        return cachedTextLayout;
+
+    uint32_t textLength;
+    auto textBuffer = WindowsGetStringRawBuffer(text, &textLength);
+    ThrowIfNullPointer(textBuffer, E_INVALIDARG);
+
+    ComPtr<IDWriteTextLayout> dwriteTextLayout;
+    ThrowIfFailed(customFontManager->GetSharedFactory()->CreateTextLayout(
+        textBuffer,
+        textLength,
+        dwriteTextFormat.Get(),
+        requestedWidth,
+        requestedHeight,
+        &dwriteTextLayout));
+
+    auto textLayout = createWrapper(dwriteTextLayout.Get());
+
+    return cache->Add(key, fontCollectionGeneration, dwriteTextLayout.Get(), textLayout.Get());
+}
+
+
+ComPtr<CanvasTextLayout> CanvasTextLayout::CreateWrapper(
+    ICanvasDevice* device,
+    IDWriteTextLayout* dwriteTextLayout,
+    CanvasLineSpacingMode lineSpacingMode,
+    CanvasTrimmingSign trimmingSign)
+{
+    auto textLayout = Make<CanvasTextLayout>(
+        device,
+        As<DWriteTextLayoutType>(dwriteTextLayout).Get());
+    CheckMakeResult(textLayout);
+
+    textLayout->SetLineSpacingModeInternal(lineSpacingMode);
     textLayout->SetTrimmingSignInternal(trimmingSign);
 
     return textLayout;
@@ -129,6 +213,81 @@ IFACEMETHODIMP CanvasTextLayoutFactory::Create(
 }
 
 
+IFACEMETHODIMP CanvasTextLayoutFactory::CreateCached(
+    ICanvasResourceCreator* resourceCreator,
+    HSTRING textString,
+    ICanvasTextFormat* textFormat,
+    float requestedWidth,
+    float requestedHeight,
+    CanvasDrawTextOptions options,
+    ICanvasTextLayout** textLayout)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckInPointer(textFormat);
+            CheckAndClearOutPointer(textLayout);
+
+            auto cachedTextLayout = CanvasTextLayout::CreateCached(
+                resourceCreator,
+                textString,
+                textFormat,
+                requestedWidth,
+                requestedHeight,
+                options);
+
+            ThrowIfFailed(cachedTextLayout.CopyTo(textLayout));
+        });
+}
+
+
+static std::shared_ptr<TextLayoutCache> GetTextLayoutCache(ICanvasResourceCreator* resourceCreator)
+{
+    ComPtr<ICanvasDevice> device;
+    ThrowIfFailed(resourceCreator->get_Device(&device));
+
+    auto cache = As<ICanvasDeviceInternal>(device)->GetTextLayoutCache();
+    ThrowIfNullPointer(cache.get(), RO_E_CLOSED);
+
+    return cache;
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::GetCacheStatistics(
+    ICanvasResourceCreator* resourceCreator,
+    CanvasTextLayoutCacheStatistics* statistics)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+            CheckInPointer(statistics);
+
+            auto cacheStatistics = GetTextLayoutCache(resourceCreator)->GetStatistics();
+
+            statistics->HitCount = cacheStatistics.HitCount;
+            statistics->MissCount = cacheStatistics.MissCount;
+            statistics->EvictedCount = cacheStatistics.EvictedCount;
+            statistics->ByteCount = cacheStatistics.ByteCount;
+        });
+}
+
+
+IFACEMETHODIMP CanvasTextLayoutFactory::SetCacheMaximumByteCount(
+    ICanvasResourceCreator* resourceCreator,
+    uint64_t maximumByteCount)
+{
+    return ExceptionBoundary(
+        [&]
+        {
+            CheckInPointer(resourceCreator);
+
+            GetTextLayoutCache(resourceCreator)->SetMaximumByteCount(maximumByteCount);
+        });
+}
+
+
 IFACEMETHODIMP CanvasTextLayoutFactory::GetGlyphOrientationTransform(
     CanvasGlyphOrientation glyphOrientation,
     boolean isSideways,
@@ -163,10 +322,22 @@ CanvasTextLayout::CanvasTextLayout(
     , m_device(device)
     , m_customFontManager(CustomFontManager::GetInstance())
     , m_lineSpacingMode(CanvasLineSpacingMode::Default)
+    , m_isShared(false)
 {
     EnsureCustomTrimmingSignDevice(layout, device);
 }
 
+
+ComPtr<DWriteTextLayoutType> const& CanvasTextLayout::GetMutableResource()
+{
+    auto& resource = GetResource();
+
+    if (m_isShared)
+        ThrowHR(E_ILLEGAL_METHOD_CALL, Strings::CachedTextLayoutIsImmutable);
+
+    return resource;
+}
+
 IFACEMETHODIMP CanvasTextLayout::GetFormatChangeIndices(
     uint32_t* positionCount,
     int32_t** positions)
@@ -236,7 +407,7 @@ IFACEMETHODIMP CanvasTextLayout::##name(valueType value)            \
     return ExceptionBoundary(                                       \
         [&]                                                         \
         {                                                           \
-            auto& resource = GetResource();                         \
+            auto& resource = GetMutableResource();                  \
                                                                     \
             ThrowIfInvalid(value);                                  \
             resource->dwriteMethod(conversionFunc(value));          \
@@ -299,7 +470,7 @@ IFACEMETHODIMP CanvasTextLayout::put_Direction(CanvasTextDirection value)
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
             auto entry = DWriteToCanvasTextDirection::Lookup(value);
             ThrowIfFailed(resource->SetReadingDirection(entry->ReadingDirection));
             ThrowIfFailed(resource->SetFlowDirection(entry->FlowDirection));
@@ -343,7 +514,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacing(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWriteLineSpacing originalSpacing(resource.Get());
 
@@ -390,7 +561,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacingBaseline(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             //
             // The Win10 IDWriteTextLayout3 interface definition omits a 'using' while
@@ -433,7 +604,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LineSpacingMode(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             DWriteLineSpacing originalSpacing(resource.Get());
 
@@ -474,7 +645,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingGranularity(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -513,7 +684,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingDelimiter(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource(); 
+            auto& resource = GetMutableResource(); 
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -554,7 +725,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingDelimiterCount(
         [&]
         {
             ThrowIfNegative(value);
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             DWRITE_TRIMMING trimming;
             ComPtr<IDWriteInlineObject> inlineObject;
@@ -587,7 +758,7 @@ IFACEMETHODIMP CanvasTextLayout::put_Options(
     return ExceptionBoundary(
         [&]
         {
-            GetResource(); 
+            GetMutableResource(); 
 
             m_drawTextOptions = value;
         });
@@ -614,7 +785,7 @@ IFACEMETHODIMP CanvasTextLayout::put_RequestedSize(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetMaxWidth(value.Width));
             ThrowIfFailed(resource->SetMaxHeight(value.Height));
@@ -811,7 +982,7 @@ IFACEMETHODIMP CanvasTextLayout::SetColor(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto textRange = ToDWriteTextRange(characterIndex, characterCount);
 
@@ -845,7 +1016,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontFamily(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto uriAndFontFamily = GetUriAndFontFamily(WinString(fontFamilyName));
             auto const& uri = uriAndFontFamily.first;
@@ -868,7 +1039,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontSize(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontSize(fontSize, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -882,7 +1053,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontStretch(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontStretch(ToFontStretch(fontStretch), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -896,7 +1067,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontStyle(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontStyle(ToFontStyle(fontStyle), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -910,7 +1081,7 @@ IFACEMETHODIMP CanvasTextLayout::SetFontWeight(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetFontWeight(ToFontWeight(fontWeight), ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -924,7 +1095,7 @@ IFACEMETHODIMP CanvasTextLayout::SetLocaleName(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             const wchar_t* localeNameBuffer = WindowsGetStringRawBuffer(name, nullptr);
 
@@ -940,7 +1111,7 @@ IFACEMETHODIMP CanvasTextLayout::SetStrikethrough(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetStrikethrough(hasStrikethrough, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -954,7 +1125,7 @@ IFACEMETHODIMP CanvasTextLayout::SetUnderline(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetUnderline(hasUnderline, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -988,7 +1159,7 @@ IFACEMETHODIMP CanvasTextLayout::SetPairKerning(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetPairKerning(hasPairKerning, ToDWriteTextRange(characterIndex, characterCount)));
         });
@@ -1064,7 +1235,7 @@ IFACEMETHODIMP CanvasTextLayout::SetCharacterSpacing(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetCharacterSpacing(
                 leadingSpacing, 
@@ -1094,7 +1265,7 @@ IFACEMETHODIMP CanvasTextLayout::put_VerticalGlyphOrientation(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetVerticalGlyphOrientation(ToVerticalGlyphOrientation(value)));
 
@@ -1122,7 +1293,7 @@ IFACEMETHODIMP CanvasTextLayout::put_OpticalAlignment(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetOpticalAlignment(ToOpticalAlignment(value)));
 
@@ -1151,7 +1322,7 @@ IFACEMETHODIMP CanvasTextLayout::put_LastLineWrapping(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ThrowIfFailed(resource->SetLastLineWrapping(value));
 
@@ -1179,7 +1350,7 @@ IFACEMETHODIMP CanvasTextLayout::put_TrimmingSign(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             m_trimmingSignInformation.SetTrimmingSignOnResource(value, resource.Get());
         });
@@ -1211,7 +1382,7 @@ IFACEMETHODIMP CanvasTextLayout::put_CustomTrimmingSign(
     return ExceptionBoundary(
         [&]
         {
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             auto dwriteInlineObject = Make<InternalDWriteInlineObject>(value, m_device.EnsureNotClosed());
             CheckMakeResult(dwriteInlineObject);
@@ -1553,7 +1724,7 @@ IFACEMETHODIMP CanvasTextLayout::SetInlineObject(
             ThrowIfNegative(characterIndex);
             ThrowIfNegative(characterCount);
 
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ComPtr<IDWriteInlineObject> dwriteInlineObject;
             if (inlineObject)
@@ -1747,7 +1918,7 @@ void CanvasTextLayout::SetCustomBrushInternal(
     int32_t characterCount, 
     IInspectable* brush)
 {
-    auto& resource = GetResource();
+    auto& resource = GetMutableResource();
 
     auto textRange = ToDWriteTextRange(characterIndex, characterCount);
 
@@ -1818,7 +1989,7 @@ IFACEMETHODIMP CanvasTextLayout::SetTypography(
             ThrowIfNegative(characterIndex);
             ThrowIfNegative(characterCount);
 
-            auto& resource = GetResource();
+            auto& resource = GetMutableResource();
 
             ComPtr<IDWriteTypography> dwriteTypography;
 
@@ -1831,6 +2002,10 @@ IFACEMETHODIMP CanvasTextLayout::SetTypography(
 
 IFACEMETHODIMP CanvasTextLayout::Close()
 {
+    // Other callers of CreateCached may be using this same object.
+    if (m_isShared)
+        return S_OK;
+
     m_device.Close();
 
     return ResourceWrapper::Close();
@@ -37,6 +37,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         TrimmingSignInformation m_trimmingSignInformation;
 
+        // Set for layouts that came from CreateCached, which may be shared
+        // between several callers and so must not change.
+        bool m_isShared;
+
     public:
         static ComPtr<CanvasTextLayout> CreateNew(
             ICanvasResourceCreator* resourceCreator,
@@ -45,6 +49,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             float requestedWidth,
             float requestedHeight);
 
+        static ComPtr<ICanvasTextLayout> CreateCached(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING textString,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth,
+            float requestedHeight,
+            CanvasDrawTextOptions options);
+
         CanvasTextLayout(
             ICanvasDevice* device,
             DWriteTextLayoutType* layout);
@@ -423,6 +435,14 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         void EnsureCustomTrimmingSignDevice(IDWriteTextLayout2* layout, ICanvasDevice* device);
 
     private:
+        static ComPtr<CanvasTextLayout> CreateWrapper(
+            ICanvasDevice* device,
+            IDWriteTextLayout* dwriteTextLayout,
+            CanvasLineSpacingMode lineSpacingMode,
+            CanvasTrimmingSign trimmingSign);
+
+        ComPtr<DWriteTextLayoutType> const& GetMutableResource();
+
         ComPtr<IInspectable> GetCustomBrushInternal(int32_t characterIndex);
 
         void SetCustomBrushInternal(
@@ -456,5 +476,22 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
             boolean isSideways,
             Vector2 position,
             Matrix3x2* transform) override;
+
+        IFACEMETHOD(CreateCached)(
+            ICanvasResourceCreator* resourceCreator,
+            HSTRING textString,
+            ICanvasTextFormat* textFormat,
+            float requestedWidth,
+            float requestedHeight,
+            CanvasDrawTextOptions options,
+            ICanvasTextLayout** textLayout) override;
+
+        IFACEMETHOD(GetCacheStatistics)(
+            ICanvasResourceCreator* resourceCreator,
+            CanvasTextLayoutCacheStatistics* statistics) override;
+
+        IFACEMETHOD(SetCacheMaximumByteCount)(
+            ICanvasResourceCreator* resourceCreator,
+            uint64_t maximumByteCount) override;
     };
 }}}}}
@@ -96,6 +96,7 @@ public:
 
 CustomFontManager::CustomFontManager()
     : m_adapter(CustomFontManagerAdapter::GetInstance())
+    , m_fontCollectionGeneration(0)
 {
     ThrowIfFailed(GetActivationFactory(
         HStringReference(RuntimeClass_Windows_Foundation_Uri).Get(),
@@ -165,7 +166,18 @@ ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromUri(IUriRu
 {
     auto path = GetAbsolutePathFromUri(uri);
 
-    return GetFontCollectionFromPath(path);
+    auto collection = GetFontCollectionFromPath(path);
+
+    //
+    // This is how CanvasFontSet loads fonts from a URI, which is when an app
+    // would pick up font files that it has changed.  Shared text formats that
+    // name a URI may have been realized against the old files, so they are
+    // realized again the next time they are needed.
+    //
+    m_realizedTextFormatCache.InvalidateFontCollectionUris();
+    ++m_fontCollectionGeneration;
+
+    return collection;
 }
 
 ComPtr<IDWriteFontCollection> CustomFontManager::GetFontCollectionFromPath(WinString& path)
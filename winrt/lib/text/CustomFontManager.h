@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include "GlyphShapingCache.h"
+#include "RealizedTextFormatCache.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
 {
     class DefaultCustomFontManagerAdapter;
@@ -41,6 +44,13 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
         ComPtr<IDWriteTextAnalyzer2> m_textAnalyzer;
         ComPtr<IDWriteFontFallback> m_systemFontFallback;
 
+        GlyphShapingCache m_glyphShapingCache;
+        RealizedTextFormatCache m_realizedTextFormatCache;
+
+        // Bumped whenever fonts are loaded from a URI, so that caches of
+        // objects laid out with the old fonts can tell they are stale.
+        std::atomic<uint64_t> m_fontCollectionGeneration;
+
     public:
         CustomFontManager();
 
@@ -56,6 +66,12 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { na
 
         ComPtr<IDWriteFontFallback> const& GetSystemFontFallback();
 
+        GlyphShapingCache& GetGlyphShapingCache() { return m_glyphShapingCache; }
+
+        RealizedTextFormatCache& GetRealizedTextFormatCache() { return m_realizedTextFormatCache; }
+
+        uint64_t GetFontCollectionGeneration() const { return m_fontCollectionGeneration; }
+
     private:
         ComPtr<IDWriteFactory> const& GetIsolatedFactory();
 
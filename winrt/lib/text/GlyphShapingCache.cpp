@@ -0,0 +1,188 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "GlyphShapingCache.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // ShapedGlyphRun
+    //
+
+    ShapedGlyphRun::ShapedGlyphRun()
+        : GlyphCount(0)
+    {
+    }
+
+
+    std::shared_ptr<ShapedGlyphRun> ShapedGlyphRun::CreateTrimmedCopy(ShapedGlyphRun const& run)
+    {
+        auto copy = std::make_shared<ShapedGlyphRun>();
+
+        auto glyphCount = run.GlyphCount;
+
+        copy->GlyphCount = glyphCount;
+        copy->ClusterMap = run.ClusterMap;
+        copy->ShapingTextProperties = run.ShapingTextProperties;
+        copy->GlyphIndices.assign(run.GlyphIndices.begin(), run.GlyphIndices.begin() + glyphCount);
+        copy->ShapingGlyphProperties.assign(run.ShapingGlyphProperties.begin(), run.ShapingGlyphProperties.begin() + glyphCount);
+        copy->GlyphAdvances.assign(run.GlyphAdvances.begin(), run.GlyphAdvances.begin() + glyphCount);
+        copy->GlyphOffsets.assign(run.GlyphOffsets.begin(), run.GlyphOffsets.begin() + glyphCount);
+
+        return copy;
+    }
+
+
+    //
+    // GlyphShapingKey
+    //
+
+    GlyphShapingKey::GlyphShapingKey()
+        : m_hash(FnvHashOffsetBasis)
+    {
+    }
+
+
+    void GlyphShapingKey::AddBytes(void const* data, size_t size)
+    {
+        auto bytes = static_cast<uint8_t const*>(data);
+
+        m_data.insert(m_data.end(), bytes, bytes + size);
+
+        HashBytes(&m_hash, data, size);
+    }
+
+
+    void GlyphShapingKey::Reset()
+    {
+        m_data.clear();
+        m_hash = FnvHashOffsetBasis;
+    }
+
+
+    bool GlyphShapingKey::operator==(GlyphShapingKey const& other) const
+    {
+        return m_hash == other.m_hash &&
+               m_data == other.m_data;
+    }
+
+
+    //
+    // GlyphShapingCache
+    //
+
+    GlyphShapingCache::GlyphShapingCache(size_t capacity)
+        : m_capacity(capacity)
+        , m_statistics{}
+    {
+    }
+
+
+    std::shared_ptr<ShapedGlyphRun const> GlyphShapingCache::TryGet(GlyphShapingKey const& key)
+    {
+        auto lock = Lock(m_mutex);
+
+        auto entry = m_entries.Find(key);
+
+        if (entry == m_entries.end())
+        {
+            ++m_statistics.MissCount;
+            return nullptr;
+        }
+
+        m_entries.MarkAsMostRecentlyUsed(entry);
+
+        ++m_statistics.HitCount;
+
+        return entry->Value.Run;
+    }
+
+
+    void GlyphShapingCache::Add(
+        GlyphShapingKey const& key,
+        IDWriteFontFace* fontFace,
+        IDWriteNumberSubstitution* numberSubstitution,
+        ShapedGlyphRun const& run)
+    {
+        // Copy the run before taking the lock.
+        std::shared_ptr<ShapedGlyphRun const> cachedRun = ShapedGlyphRun::CreateTrimmedCopy(run);
+
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        if (m_capacity == 0)
+            return;
+
+        // Another thread may have shaped the same run in the meantime.
+        if (m_entries.Find(key) != m_entries.end())
+            return;
+
+        m_entries.AddAsMostRecentlyUsed(key, CachedRun{ fontFace, numberSubstitution, std::move(cachedRun) });
+
+        evicted = TrimToCapacity(lock);
+    }
+
+
+    void GlyphShapingCache::Clear()
+    {
+        EntryList removed;
+
+        auto lock = Lock(m_mutex);
+
+        m_entries.Clear(removed);
+    }
+
+
+    size_t GlyphShapingCache::GetCount()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_entries.size();
+    }
+
+
+    size_t GlyphShapingCache::GetCapacity()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_capacity;
+    }
+
+
+    void GlyphShapingCache::SetCapacity(size_t capacity)
+    {
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        m_capacity = capacity;
+
+        evicted = TrimToCapacity(lock);
+    }
+
+
+    GlyphShapingCacheStatistics GlyphShapingCache::GetStatistics()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_statistics;
+    }
+
+
+    // Evicted entries are returned rather than destroyed here, so their font
+    // faces are released after the caller drops the lock.
+    GlyphShapingCache::EntryList GlyphShapingCache::TrimToCapacity(Lock const& lock)
+    {
+        MustOwnLock(lock);
+
+        EntryList evicted;
+
+        m_statistics.EvictedCount += m_entries.TrimToCount(m_capacity, evicted);
+
+        return evicted;
+    }
+}}}}}
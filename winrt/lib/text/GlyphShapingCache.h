@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/CacheUtilities.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // The output of IDWriteTextAnalyzer::GetGlyphs and GetGlyphPlacements
+    // for one run of text.
+    //
+    // ClusterMap and ShapingTextProperties have one element per character.
+    // The glyph arrays have at least GlyphCount elements; when a run is used
+    // as a scratch buffer they keep whatever extra capacity GetGlyphs needed.
+    //
+    struct ShapedGlyphRun
+    {
+        uint32_t GlyphCount;
+        std::vector<uint16_t> ClusterMap;
+        std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> ShapingTextProperties;
+        std::vector<uint16_t> GlyphIndices;
+        std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> ShapingGlyphProperties;
+        std::vector<float> GlyphAdvances;
+        std::vector<DWRITE_GLYPH_OFFSET> GlyphOffsets;
+
+        ShapedGlyphRun();
+
+        // Copies just the used part of another run.
+        static std::shared_ptr<ShapedGlyphRun> CreateTrimmedCopy(ShapedGlyphRun const& run);
+    };
+
+
+    //
+    // Identifies the inputs to GetGlyphs / GetGlyphPlacements: the text,
+    // font face, size, orientation, script, locale, number substitution and
+    // typographic features.  The font face and number substitution are
+    // identified by pointer; GlyphShapingCache keeps references to them so
+    // these pointers cannot be reused while the key is cached.
+    //
+    class GlyphShapingKey
+    {
+        std::vector<uint8_t> m_data;
+        size_t m_hash;
+
+    public:
+        GlyphShapingKey();
+
+        template<typename T>
+        void AddValue(T const& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Keys can only contain plain data");
+            AddBytes(&value, sizeof(T));
+        }
+
+        void AddBytes(void const* data, size_t size);
+
+        // Empties the key, keeping its buffer so that it can be rebuilt
+        // without allocating.
+        void Reset();
+
+        size_t GetHash() const { return m_hash; }
+
+        bool operator==(GlyphShapingKey const& other) const;
+        bool operator!=(GlyphShapingKey const& other) const { return !(*this == other); }
+    };
+
+
+    struct GlyphShapingCacheStatistics
+    {
+        uint64_t HitCount;              // TryGet found a shaped run
+        uint64_t MissCount;             // TryGet found nothing
+        uint64_t EvictedCount;          // Runs dropped to stay within capacity
+    };
+
+
+    //
+    // Process wide cache of shaped glyph runs, owned by the CustomFontManager,
+    // that lets CanvasTextAnalyzer.GetGlyphs skip DirectWrite when the same
+    // text is shaped again with the same options.  This is aimed at short
+    // strings that are reshaped often; runs longer than MaxTextLength are
+    // never cached.
+    //
+    // Cached runs are immutable and shared, so a caller can keep using one
+    // after it has been evicted.  Least recently used entries are evicted
+    // once the cache is full.
+    //
+    class GlyphShapingCache
+    {
+        struct CachedRun
+        {
+            ComPtr<IDWriteFontFace> FontFace;
+            ComPtr<IDWriteNumberSubstitution> NumberSubstitution;
+            std::shared_ptr<ShapedGlyphRun const> Run;
+        };
+
+        typedef LruCache<GlyphShapingKey, CachedRun> EntryCache;
+        typedef EntryCache::EntryList EntryList;
+
+        std::mutex m_mutex;
+
+        size_t m_capacity;
+        EntryCache m_entries;
+
+        GlyphShapingCacheStatistics m_statistics;
+
+    public:
+        static size_t const DefaultCapacity = 256;
+        static uint32_t const MaxTextLength = 256;
+
+        explicit GlyphShapingCache(size_t capacity = DefaultCapacity);
+
+        GlyphShapingCache(GlyphShapingCache const&) = delete;
+        GlyphShapingCache& operator=(GlyphShapingCache const&) = delete;
+
+        std::shared_ptr<ShapedGlyphRun const> TryGet(GlyphShapingKey const& key);
+
+        void Add(
+            GlyphShapingKey const& key,
+            IDWriteFontFace* fontFace,
+            IDWriteNumberSubstitution* numberSubstitution,
+            ShapedGlyphRun const& run);
+
+        void Clear();
+
+        size_t GetCount();
+        size_t GetCapacity();
+        void SetCapacity(size_t capacity);
+
+        GlyphShapingCacheStatistics GetStatistics();
+
+    private:
+        EntryList TrimToCapacity(Lock const& lock);
+    };
+}}}}}
@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "RealizedTextFormatCache.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    static_assert(sizeof(RealizedTextFormatProperties) == 17 * 4, "RealizedTextFormatProperties must not contain padding");
+
+
+    //
+    // RealizedTextFormatKey
+    //
+
+    static void HashString(size_t* hash, WinString const& value)
+    {
+        auto first = begin(value);
+        auto length = static_cast<uint32_t>(std::distance(first, end(value)));
+
+        // The length keeps adjacent strings from running into each other.
+        HashBytes(hash, &length, sizeof(length));
+        HashBytes(hash, first, length * sizeof(wchar_t));
+    }
+
+
+    RealizedTextFormatKey::RealizedTextFormatKey(
+        IDWriteFontCollection* fontCollection,
+        WinString const& fontCollectionUri,
+        WinString const& fontFamilyName,
+        WinString const& localeName,
+        WinString const& trimmingDelimiter,
+        RealizedTextFormatProperties const& properties)
+        : m_fontCollection(fontCollection)
+        , m_fontCollectionUri(fontCollectionUri)
+        , m_fontFamilyName(fontFamilyName)
+        , m_localeName(localeName)
+        , m_trimmingDelimiter(trimmingDelimiter)
+        , m_properties(properties)
+        , m_hash(FnvHashOffsetBasis)
+    {
+        HashBytes(&m_hash, &fontCollection, sizeof(fontCollection));
+        HashString(&m_hash, fontCollectionUri);
+        HashString(&m_hash, fontFamilyName);
+        HashString(&m_hash, localeName);
+        HashString(&m_hash, trimmingDelimiter);
+        HashBytes(&m_hash, &properties, sizeof(properties));
+    }
+
+
+    bool RealizedTextFormatKey::UsesFontCollectionUri() const
+    {
+        return !m_fontCollection && m_fontCollectionUri != WinString();
+    }
+
+
+    bool RealizedTextFormatKey::operator==(RealizedTextFormatKey const& other) const
+    {
+        return m_hash == other.m_hash &&
+               m_fontCollection == other.m_fontCollection &&
+               m_fontCollectionUri.Equals(other.m_fontCollectionUri) &&
+               m_fontFamilyName.Equals(other.m_fontFamilyName) &&
+               m_localeName.Equals(other.m_localeName) &&
+               m_trimmingDelimiter.Equals(other.m_trimmingDelimiter) &&
+               memcmp(&m_properties, &other.m_properties, sizeof(m_properties)) == 0;
+    }
+
+
+    //
+    // RealizedTextFormatCache
+    //
+
+    RealizedTextFormatCache::RealizedTextFormatCache(size_t capacity)
+        : m_capacity(capacity)
+        , m_statistics{}
+    {
+    }
+
+
+    ComPtr<IDWriteTextFormat1> RealizedTextFormatCache::TryGet(RealizedTextFormatKey const& key)
+    {
+        auto lock = Lock(m_mutex);
+
+        auto entry = m_entries.Find(key);
+
+        if (entry == m_entries.end())
+        {
+            ++m_statistics.MissCount;
+            return nullptr;
+        }
+
+        m_entries.MarkAsMostRecentlyUsed(entry);
+
+        ++m_statistics.HitCount;
+
+        return entry->Value;
+    }
+
+
+    ComPtr<IDWriteTextFormat1> RealizedTextFormatCache::Add(RealizedTextFormatKey const& key, IDWriteTextFormat1* textFormat)
+    {
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        if (m_capacity == 0)
+            return textFormat;
+
+        // Another thread may have realized the same format in the meantime,
+        // in which case everyone should share the one that got there first.
+        auto existing = m_entries.Find(key);
+
+        if (existing != m_entries.end())
+            return existing->Value;
+
+        m_entries.AddAsMostRecentlyUsed(key, textFormat);
+
+        evicted = TrimToCapacity(lock);
+
+        return textFormat;
+    }
+
+
+    void RealizedTextFormatCache::InvalidateFontCollectionUris()
+    {
+        EntryList removed;
+
+        auto lock = Lock(m_mutex);
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); )
+        {
+            auto entry = it++;
+
+            if (entry->Key.UsesFontCollectionUri())
+            {
+                m_entries.Remove(entry, removed);
+
+                ++m_statistics.InvalidatedCount;
+            }
+        }
+    }
+
+
+    void RealizedTextFormatCache::Clear()
+    {
+        EntryList removed;
+
+        auto lock = Lock(m_mutex);
+
+        m_entries.Clear(removed);
+    }
+
+
+    size_t RealizedTextFormatCache::GetCount()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_entries.size();
+    }
+
+
+    size_t RealizedTextFormatCache::GetCapacity()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_capacity;
+    }
+
+
+    void RealizedTextFormatCache::SetCapacity(size_t capacity)
+    {
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        m_capacity = capacity;
+
+        evicted = TrimToCapacity(lock);
+    }
+
+
+    RealizedTextFormatCacheStatistics RealizedTextFormatCache::GetStatistics()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_statistics;
+    }
+
+
+    // Evicted entries are returned rather than destroyed here, so their
+    // formats and font collections are released after the caller drops the
+    // lock.
+    RealizedTextFormatCache::EntryList RealizedTextFormatCache::TrimToCapacity(Lock const& lock)
+    {
+        MustOwnLock(lock);
+
+        EntryList evicted;
+
+        m_statistics.EvictedCount += m_entries.TrimToCount(m_capacity, evicted);
+
+        return evicted;
+    }
+}}}}}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/CacheUtilities.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // The plain valued CanvasTextFormat properties that are realized on an
+    // IDWriteTextFormat.  Every member is four bytes so that there is no
+    // padding, which lets keys compare and hash these as raw bytes.
+    //
+    struct RealizedTextFormatProperties
+    {
+        float FontSize;
+        float IncrementalTabStop;
+        float LineSpacing;
+        float LineSpacingBaseline;
+        uint32_t LineSpacingMode;       // CanvasLineSpacingMode is not available on 8.1
+        CanvasTextDirection Direction;
+        ABI::Windows::UI::Text::FontStretch FontStretch;
+        ABI::Windows::UI::Text::FontStyle FontStyle;
+        uint32_t FontWeight;
+        CanvasVerticalAlignment VerticalAlignment;
+        CanvasHorizontalAlignment HorizontalAlignment;
+        CanvasTextTrimmingGranularity TrimmingGranularity;
+        int32_t TrimmingDelimiterCount;
+        CanvasWordWrapping WordWrapping;
+        CanvasVerticalGlyphOrientation VerticalGlyphOrientation;
+        CanvasOpticalAlignment OpticalAlignment;
+        uint32_t LastLineWrapping;
+    };
+
+
+    //
+    // Identifies a realized IDWriteTextFormat by everything that goes into
+    // creating it.  The font collection is either an explicit collection
+    // (eg. from a wrapped IDWriteTextFormat), which the key keeps a reference
+    // to so that the pointer cannot be reused, or is loaded from the URI part
+    // of the font family name.
+    //
+    class RealizedTextFormatKey
+    {
+        ComPtr<IDWriteFontCollection> m_fontCollection;
+        WinString m_fontCollectionUri;
+        WinString m_fontFamilyName;
+        WinString m_localeName;
+        WinString m_trimmingDelimiter;
+        RealizedTextFormatProperties m_properties;
+        size_t m_hash;
+
+    public:
+        RealizedTextFormatKey(
+            IDWriteFontCollection* fontCollection,
+            WinString const& fontCollectionUri,
+            WinString const& fontFamilyName,
+            WinString const& localeName,
+            WinString const& trimmingDelimiter,
+            RealizedTextFormatProperties const& properties);
+
+        size_t GetHash() const { return m_hash; }
+
+        bool UsesFontCollectionUri() const;
+
+        bool operator==(RealizedTextFormatKey const& other) const;
+        bool operator!=(RealizedTextFormatKey const& other) const { return !(*this == other); }
+    };
+
+
+    struct RealizedTextFormatCacheStatistics
+    {
+        uint64_t HitCount;              // TryGet found a realized format
+        uint64_t MissCount;             // TryGet found nothing
+        uint64_t EvictedCount;          // Formats dropped to stay within capacity
+        uint64_t InvalidatedCount;      // Formats dropped because their fonts were reloaded
+    };
+
+
+    //
+    // Process wide cache of realized IDWriteTextFormats, owned by the
+    // CustomFontManager, so that CanvasTextFormats with identical properties
+    // share one DirectWrite object rather than each creating their own.
+    //
+    // Cached formats are shared between threads and CanvasTextFormats, so they
+    // must never be modified.  They are only handed to code that reads from
+    // them (eg. to create a text layout) and are never returned through
+    // interop.  Least recently used entries are evicted once the cache is full.
+    //
+    class RealizedTextFormatCache
+    {
+        typedef LruCache<RealizedTextFormatKey, ComPtr<IDWriteTextFormat1>> EntryCache;
+        typedef EntryCache::EntryList EntryList;
+
+        std::mutex m_mutex;
+
+        size_t m_capacity;
+        EntryCache m_entries;
+
+        RealizedTextFormatCacheStatistics m_statistics;
+
+    public:
+        static size_t const DefaultCapacity = 64;
+
+        explicit RealizedTextFormatCache(size_t capacity = DefaultCapacity);
+
+        RealizedTextFormatCache(RealizedTextFormatCache const&) = delete;
+        RealizedTextFormatCache& operator=(RealizedTextFormatCache const&) = delete;
+
+        ComPtr<IDWriteTextFormat1> TryGet(RealizedTextFormatKey const& key);
+
+        // Returns the cached format, which is the one passed in unless another
+        // thread added a format for the same key first.
+        ComPtr<IDWriteTextFormat1> Add(RealizedTextFormatKey const& key, IDWriteTextFormat1* textFormat);
+
+        // Drops formats whose font collection was loaded from a URI, since
+        // the font files may have changed since they were realized.
+        void InvalidateFontCollectionUris();
+
+        void Clear();
+
+        size_t GetCount();
+        size_t GetCapacity();
+        void SetCapacity(size_t capacity);
+
+        RealizedTextFormatCacheStatistics GetStatistics();
+
+    private:
+        EntryList TrimToCapacity(Lock const& lock);
+    };
+}}}}}
@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextAnalysisChunks.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    bool IsParagraphSeparator(wchar_t character)
+    {
+        switch (character)
+        {
+        case 0x000A:    // line feed
+        case 0x000D:    // carriage return
+        case 0x0085:    // next line
+        case 0x2029:    // paragraph separator
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+
+    std::vector<TextChunk> SplitTextAtParagraphs(
+        wchar_t const* text,
+        uint32_t textLength,
+        uint32_t maxChunkCount,
+        uint32_t minChunkLength)
+    {
+        uint32_t chunkCount = maxChunkCount;
+
+        if (minChunkLength > 0)
+            chunkCount = std::min(chunkCount, textLength / minChunkLength);
+
+        chunkCount = std::max(chunkCount, 1u);
+
+        auto targetChunkLength = std::max(textLength / chunkCount, 1u);
+
+        std::vector<TextChunk> chunks;
+        chunks.reserve(chunkCount);
+
+        uint32_t start = 0;
+
+        do
+        {
+            uint32_t end = textLength;
+
+            if (chunks.size() + 1 < chunkCount)
+            {
+                // End the chunk after the first paragraph separator at or
+                // beyond the target length.
+                for (auto i = start + targetChunkLength - 1; i < textLength; ++i)
+                {
+                    if (IsParagraphSeparator(text[i]))
+                    {
+                        end = i + 1;
+
+                        if (text[i] == L'\r' && end < textLength && text[end] == L'\n')
+                            ++end;
+
+                        break;
+                    }
+                }
+
+                // Rather than leave a short chunk at the end, the last
+                // chunk takes the rest of the text.
+                if (textLength - end < minChunkLength)
+                    end = textLength;
+            }
+
+            chunks.push_back(TextChunk{ start, end });
+
+            start = end;
+
+        } while (start < textLength);
+
+        return chunks;
+    }
+
+
+    TextChunk GetEditedParagraphs(
+        wchar_t const* text,
+        uint32_t textLength,
+        uint32_t editStart,
+        uint32_t editEnd)
+    {
+        uint32_t start = editStart;
+
+        // A CR just before the edit may have been split from, or joined up
+        // with, a LF, which changes how the paragraph before it ends.
+        if (start > 0 && text[start - 1] == L'\r')
+            --start;
+
+        while (start > 0 && !IsParagraphSeparator(text[start - 1]))
+            --start;
+
+        uint32_t end = editEnd;
+
+        while (end < textLength && !IsParagraphSeparator(text[end]))
+            ++end;
+
+        if (end < textLength)
+        {
+            ++end;
+
+            if (text[end - 1] == L'\r' && end < textLength && text[end] == L'\n')
+                ++end;
+        }
+
+        return TextChunk{ start, end };
+    }
+}}}}}
@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // A span of text, [Start, End), that CanvasTextAnalyzer analyzes
+    // independently of the rest, either because AnalyzeParagraphsInParallel
+    // is set or because ReplaceText changed it.
+    //
+    struct TextChunk
+    {
+        uint32_t Start;
+        uint32_t End;
+    };
+
+
+    //
+    // One range of bidi or script analysis results, as CanvasTextAnalyzer
+    // keeps them while joining up results for separately analyzed text.
+    //
+    template<typename T>
+    struct AnalyzedRange
+    {
+        uint32_t Start;
+        uint32_t End;
+        T Value;
+    };
+
+
+    //
+    // Returns true for characters that end a paragraph, both for the bidi
+    // algorithm (class B) and for line breaking (a mandatory break).
+    //
+    bool IsParagraphSeparator(wchar_t character);
+
+
+    //
+    // Splits text into at most maxChunkCount chunks, each at least
+    // minChunkLength characters long, that end just after a paragraph
+    // separator (or at the end of the text).  A CR LF pair is never split.
+    // Text with no suitable paragraph separators is returned as one chunk.
+    //
+    std::vector<TextChunk> SplitTextAtParagraphs(
+        wchar_t const* text,
+        uint32_t textLength,
+        uint32_t maxChunkCount,
+        uint32_t minChunkLength);
+
+
+    //
+    // Returns the paragraphs that an edit, which left [editStart, editEnd)
+    // of text holding the new characters, needs analyzing again.  This
+    // includes the paragraph starting at editEnd, since the edit may have
+    // split it from the one before.
+    //
+    TextChunk GetEditedParagraphs(
+        wchar_t const* text,
+        uint32_t textLength,
+        uint32_t editStart,
+        uint32_t editEnd);
+}}}}}
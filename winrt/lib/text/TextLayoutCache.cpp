@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "TextLayoutCache.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // TextLayoutCacheKey
+    //
+
+    TextLayoutCacheKey::TextLayoutCacheKey(
+        WinString const& text,
+        IDWriteTextFormat1* textFormat,
+        float requestedWidth,
+        float requestedHeight,
+        CanvasDrawTextOptions options)
+        : m_text(text)
+        , m_textFormat(textFormat)
+        , m_requestedWidth(requestedWidth)
+        , m_requestedHeight(requestedHeight)
+        , m_options(options)
+        , m_hash(FnvHashOffsetBasis)
+    {
+        HashBytes(&m_hash, begin(text), GetTextLength() * sizeof(wchar_t));
+        HashBytes(&m_hash, &textFormat, sizeof(textFormat));
+        HashBytes(&m_hash, &requestedWidth, sizeof(requestedWidth));
+        HashBytes(&m_hash, &requestedHeight, sizeof(requestedHeight));
+        HashBytes(&m_hash, &options, sizeof(options));
+    }
+
+
+    uint32_t TextLayoutCacheKey::GetTextLength() const
+    {
+        return static_cast<uint32_t>(std::distance(begin(m_text), end(m_text)));
+    }
+
+
+    bool TextLayoutCacheKey::operator==(TextLayoutCacheKey const& other) const
+    {
+        return m_hash == other.m_hash &&
+               m_textFormat == other.m_textFormat &&
+               m_requestedWidth == other.m_requestedWidth &&
+               m_requestedHeight == other.m_requestedHeight &&
+               m_options == other.m_options &&
+               m_text.Equals(other.m_text);
+    }
+
+
+    //
+    // TextLayoutCache
+    //
+
+    TextLayoutCache::TextLayoutCache(uint64_t maximumByteCount)
+        : m_maximumByteCount(maximumByteCount)
+        , m_fontCollectionGeneration(0)
+        , m_statistics{}
+    {
+    }
+
+
+    //
+    // DirectWrite keeps a copy of the text plus per character cluster, glyph
+    // and line information, on top of a fixed amount per layout.  These
+    // numbers are in the right ballpark for typical UI labels; they only need
+    // to be good enough for the budget to bound the cache's memory use.
+    //
+    static uint64_t const EstimatedLayoutOverhead = 2048;
+    static uint64_t const EstimatedBytesPerCharacter = 64;
+
+    uint64_t TextLayoutCache::EstimateByteCount(uint32_t textLength)
+    {
+        return EstimatedLayoutOverhead + textLength * (EstimatedBytesPerCharacter + sizeof(wchar_t));
+    }
+
+
+    ComPtr<ICanvasTextLayout> TextLayoutCache::TryGet(
+        TextLayoutCacheKey const& key,
+        uint64_t fontCollectionGeneration,
+        WrapperFactory const& createWrapper)
+    {
+        EntryList stale;
+
+        auto lock = Lock(m_mutex);
+
+        stale = ValidateFontCollectionGeneration(lock, fontCollectionGeneration);
+
+        auto entry = m_entries.Find(key);
+
+        if (entry == m_entries.end())
+        {
+            ++m_statistics.MissCount;
+            return nullptr;
+        }
+
+        m_entries.MarkAsMostRecentlyUsed(entry);
+
+        ++m_statistics.HitCount;
+
+        auto& cached = entry->Value;
+        auto wrapper = LockWeakRef<ICanvasTextLayout>(cached.Wrapper);
+
+        if (!wrapper)
+        {
+            wrapper = createWrapper(cached.TextLayout.Get());
+            cached.Wrapper = AsWeak(wrapper.Get());
+        }
+
+        return wrapper;
+    }
+
+
+    ComPtr<ICanvasTextLayout> TextLayoutCache::Add(
+        TextLayoutCacheKey const& key,
+        uint64_t fontCollectionGeneration,
+        IDWriteTextLayout* textLayout,
+        ICanvasTextLayout* wrapper)
+    {
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        evicted = ValidateFontCollectionGeneration(lock, fontCollectionGeneration);
+
+        auto byteCount = EstimateByteCount(key.GetTextLength());
+
+        if (byteCount > m_maximumByteCount)
+            return wrapper;
+
+        // Another thread may have laid out the same text in the meantime.  If
+        // its wrapper is still alive then everyone should share that one,
+        // otherwise this layout takes over the entry.
+        auto existing = m_entries.Find(key);
+
+        if (existing != m_entries.end())
+        {
+            if (auto existingWrapper = LockWeakRef<ICanvasTextLayout>(existing->Value.Wrapper))
+                return existingWrapper;
+
+            Remove(lock, existing, evicted);
+        }
+
+        m_entries.AddAsMostRecentlyUsed(key, CachedLayout{ textLayout, AsWeak(wrapper), byteCount });
+        m_statistics.ByteCount += byteCount;
+
+        auto trimmed = TrimToBudget(lock);
+        evicted.splice(evicted.end(), trimmed);
+
+        return wrapper;
+    }
+
+
+    void TextLayoutCache::Clear()
+    {
+        EntryList removed;
+
+        auto lock = Lock(m_mutex);
+
+        m_entries.Clear(removed);
+        m_statistics.ByteCount = 0;
+    }
+
+
+    size_t TextLayoutCache::GetCount()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_entries.size();
+    }
+
+
+    uint64_t TextLayoutCache::GetMaximumByteCount()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_maximumByteCount;
+    }
+
+
+    void TextLayoutCache::SetMaximumByteCount(uint64_t maximumByteCount)
+    {
+        EntryList evicted;
+
+        auto lock = Lock(m_mutex);
+
+        m_maximumByteCount = maximumByteCount;
+
+        evicted = TrimToBudget(lock);
+    }
+
+
+    TextLayoutCacheStatistics TextLayoutCache::GetStatistics()
+    {
+        auto lock = Lock(m_mutex);
+
+        return m_statistics;
+    }
+
+
+    // Layouts that were made before fonts were last loaded from a URI may
+    // have been laid out against font files that have since changed.
+    TextLayoutCache::EntryList TextLayoutCache::ValidateFontCollectionGeneration(Lock const& lock, uint64_t fontCollectionGeneration)
+    {
+        MustOwnLock(lock);
+
+        EntryList stale;
+
+        if (fontCollectionGeneration != m_fontCollectionGeneration)
+        {
+            m_entries.Clear(stale);
+            m_statistics.ByteCount = 0;
+
+            m_fontCollectionGeneration = fontCollectionGeneration;
+        }
+
+        return stale;
+    }
+
+
+    // Evicted entries are returned rather than destroyed here, so their
+    // layouts are released after the caller drops the lock.
+    TextLayoutCache::EntryList TextLayoutCache::TrimToBudget(Lock const& lock)
+    {
+        MustOwnLock(lock);
+
+        EntryList evicted;
+
+        while (!m_entries.empty() && m_statistics.ByteCount > m_maximumByteCount)
+        {
+            Remove(lock, m_entries.GetLeastRecentlyUsed(), evicted);
+
+            ++m_statistics.EvictedCount;
+        }
+
+        return evicted;
+    }
+
+
+    void TextLayoutCache::Remove(Lock const& lock, EntryCache::iterator entry, EntryList& removed)
+    {
+        MustOwnLock(lock);
+
+        m_statistics.ByteCount -= entry->Value.ByteCount;
+        m_entries.Remove(entry, removed);
+    }
+}}}}}
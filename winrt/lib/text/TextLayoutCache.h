@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include "utils/CacheUtilities.h"
+#include "utils/LockUtilities.h"
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas { namespace Text
+{
+    //
+    // Identifies a cached text layout by everything that goes into creating
+    // it.  The realized text format comes from the RealizedTextFormatCache,
+    // so identical CanvasTextFormats share one pointer; the key keeps a
+    // reference to it so that the pointer cannot be reused.  The draw text
+    // options are not part of the DirectWrite layout, but the layout's
+    // wrapper carries them so they must match too.
+    //
+    class TextLayoutCacheKey
+    {
+        WinString m_text;
+        ComPtr<IDWriteTextFormat1> m_textFormat;
+        float m_requestedWidth;
+        float m_requestedHeight;
+        CanvasDrawTextOptions m_options;
+        size_t m_hash;
+
+    public:
+        TextLayoutCacheKey(
+            WinString const& text,
+            IDWriteTextFormat1* textFormat,
+            float requestedWidth,
+            float requestedHeight,
+            CanvasDrawTextOptions options);
+
+        size_t GetHash() const { return m_hash; }
+
+        uint32_t GetTextLength() const;
+
+        bool operator==(TextLayoutCacheKey const& other) const;
+        bool operator!=(TextLayoutCacheKey const& other) const { return !(*this == other); }
+    };
+
+
+    struct TextLayoutCacheStatistics
+    {
+        uint64_t HitCount;              // TryGet found a cached layout
+        uint64_t MissCount;             // TryGet found nothing
+        uint64_t EvictedCount;          // Layouts dropped to stay within the byte budget
+        uint64_t ByteCount;             // Estimated size of the layouts currently cached
+    };
+
+
+    //
+    // Per device cache of immutable CanvasTextLayouts, used by
+    // CanvasTextLayout.CreateCached so that apps that rebuild the same labels
+    // every frame don't pay for DirectWrite layout each time.
+    //
+    // Entries own the DirectWrite layout but only hold a weak reference to
+    // its CanvasTextLayout, since the layout itself holds a reference to the
+    // device that owns this cache.  When the wrapper has gone away a new one
+    // is made around the same DirectWrite layout.
+    //
+    // The DirectWrite memory used by a layout isn't available, so sizes are
+    // estimated from the length of the text.  Least recently used layouts are
+    // evicted once the estimate goes over the budget, and everything is
+    // dropped when fonts are reloaded.
+    //
+    class TextLayoutCache
+    {
+    public:
+        typedef std::function<ComPtr<ICanvasTextLayout>(IDWriteTextLayout*)> WrapperFactory;
+
+    private:
+        struct CachedLayout
+        {
+            ComPtr<IDWriteTextLayout> TextLayout;
+            WeakRef Wrapper;
+            uint64_t ByteCount;
+        };
+
+        typedef LruCache<TextLayoutCacheKey, CachedLayout> EntryCache;
+        typedef EntryCache::EntryList EntryList;
+
+        std::mutex m_mutex;
+
+        uint64_t m_maximumByteCount;
+        uint64_t m_fontCollectionGeneration;
+
+        EntryCache m_entries;
+
+        TextLayoutCacheStatistics m_statistics;
+
+    public:
+        static uint64_t const DefaultMaximumByteCount = 4 * 1024 * 1024;
+
+        explicit TextLayoutCache(uint64_t maximumByteCount = DefaultMaximumByteCount);
+
+        TextLayoutCache(TextLayoutCache const&) = delete;
+        TextLayoutCache& operator=(TextLayoutCache const&) = delete;
+
+        static uint64_t EstimateByteCount(uint32_t textLength);
+
+        // Returns the cached layout's wrapper, calling createWrapper to make a
+        // new one if the previous wrapper has been released.  createWrapper
+        // is called with the cache locked, so that two threads cannot both
+        // wrap the same DirectWrite layout.
+        ComPtr<ICanvasTextLayout> TryGet(
+            TextLayoutCacheKey const& key,
+            uint64_t fontCollectionGeneration,
+            WrapperFactory const& createWrapper);
+
+        // Returns the wrapper to use, which is the one passed in unless
+        // another thread cached a layout for the same key first.
+        ComPtr<ICanvasTextLayout> Add(
+            TextLayoutCacheKey const& key,
+            uint64_t fontCollectionGeneration,
+            IDWriteTextLayout* textLayout,
+            ICanvasTextLayout* wrapper);
+
+        void Clear();
+
+        size_t GetCount();
+        uint64_t GetMaximumByteCount();
+        void SetMaximumByteCount(uint64_t maximumByteCount);
+
+        TextLayoutCacheStatistics GetStatistics();
+
+    private:
+        EntryList ValidateFontCollectionGeneration(Lock const& lock, uint64_t fontCollectionGeneration);
+        EntryList TrimToBudget(Lock const& lock);
+        void Remove(Lock const& lock, EntryCache::iterator entry, EntryList& removed);
+    };
+}}}}}
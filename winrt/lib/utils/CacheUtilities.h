@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include <list>
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // FNV-1a, used to hash cache keys.  It is cheap to update incrementally
+    // as values are added to a key.  Start from FnvHashOffsetBasis.
+    //
+
+#ifdef _WIN64
+    size_t const FnvHashOffsetBasis = 14695981039346656037ULL;
+    size_t const FnvHashPrime = 1099511628211ULL;
+#else
+    size_t const FnvHashOffsetBasis = 2166136261U;
+    size_t const FnvHashPrime = 16777619U;
+#endif
+
+    inline void HashBytes(size_t* hash, void const* data, size_t size)
+    {
+        auto bytes = static_cast<uint8_t const*>(data);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            *hash = (*hash ^ bytes[i]) * FnvHashPrime;
+        }
+    }
+
+
+    //
+    // Entries ordered from most to least recently used, with an index from
+    // key to entry.  TKey must have a GetHash() method and operator==.
+    //
+    // This is the storage behind the text caches, which each add their own
+    // locking, statistics and eviction policy.  It does no locking of its
+    // own.  Entries are never destroyed here: anything removed is moved into
+    // a list supplied by the caller, who can then destroy it after dropping
+    // their lock.  That way the entries' COM objects are never released with
+    // the lock held.
+    //
+    template<typename TKey, typename TValue>
+    class LruCache
+    {
+    public:
+        struct Entry
+        {
+            TKey Key;
+            TValue Value;
+        };
+
+        typedef std::list<Entry> EntryList;
+        typedef typename EntryList::iterator iterator;
+
+    private:
+        EntryList m_entries;
+        std::unordered_multimap<size_t, iterator> m_index;
+
+    public:
+        iterator begin() { return m_entries.begin(); }
+        iterator end() { return m_entries.end(); }
+
+        size_t size() const { return m_entries.size(); }
+        bool empty() const { return m_entries.empty(); }
+
+        // Returns end() if there is no entry with this key.
+        iterator Find(TKey const& key)
+        {
+            auto range = m_index.equal_range(key.GetHash());
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second->Key == key)
+                    return it->second;
+            }
+
+            return m_entries.end();
+        }
+
+        void MarkAsMostRecentlyUsed(iterator entry)
+        {
+            m_entries.splice(m_entries.begin(), m_entries, entry);
+        }
+
+        // Does not check for an existing entry with the same key.
+        iterator AddAsMostRecentlyUsed(TKey key, TValue value)
+        {
+            auto hash = key.GetHash();
+
+            m_entries.push_front(Entry{ std::move(key), std::move(value) });
+            m_index.emplace(hash, m_entries.begin());
+
+            return m_entries.begin();
+        }
+
+        iterator GetLeastRecentlyUsed()
+        {
+            assert(!m_entries.empty());
+
+            return std::prev(m_entries.end());
+        }
+
+        void Remove(iterator entry, EntryList& removed)
+        {
+            auto range = m_index.equal_range(entry->Key.GetHash());
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == entry)
+                {
+                    m_index.erase(it);
+                    break;
+                }
+            }
+
+            removed.splice(removed.end(), m_entries, entry);
+        }
+
+        // Removes least recently used entries until at most maxCount remain.
+        // Returns how many were removed.
+        size_t TrimToCount(size_t maxCount, EntryList& removed)
+        {
+            size_t removedCount = 0;
+
+            while (m_entries.size() > maxCount)
+            {
+                Remove(GetLeastRecentlyUsed(), removed);
+                ++removedCount;
+            }
+
+            return removedCount;
+        }
+
+        void Clear(EntryList& removed)
+        {
+            removed.splice(removed.end(), m_entries);
+            m_index.clear();
+        }
+    };
+}}}}
@@ -4,6 +4,8 @@
 
 #include "pch.h"
 
+#include "PixelSwizzle.h"
+
 namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 {
     ComPtr<ID3D11Texture2D> GetTexture2DForDXGISurface(IDXGISurface2* dxgiSurface)
@@ -183,18 +185,29 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     }
 
 
+    // Windows::UI::Color is four bytes, stored in the order A, R, G, B, so an
+    // array of them can be converted with the byte swizzling kernels.
+    static_assert(sizeof(Color) == 4, "Color must be tightly packed");
+    static_assert(offsetof(Color, A) == 0 && offsetof(Color, R) == 1 && offsetof(Color, G) == 2 && offsetof(Color, B) == 3, "Color must be stored as A, R, G, B");
+
+    uint8_t const* GetColorBytes(Color const* colors)
+    {
+        return reinterpret_cast<uint8_t const*>(colors);
+    }
+
+    uint8_t* GetColorBytes(Color* colors)
+    {
+        return reinterpret_cast<uint8_t*>(colors);
+    }
+
+
     // Converts color array to bytes according to the default format, B8G8R8A8_UNORM.
     std::vector<uint8_t> ConvertColorsToBgra(uint32_t colorCount, Color* colors)
     {
         std::vector<uint8_t> convertedBytes(colorCount * 4);
 
-        for (uint32_t i = 0; i < colorCount; i++)
-        {
-            convertedBytes[i * 4 + 0] = colors[i].B;
-            convertedBytes[i * 4 + 1] = colors[i].G;
-            convertedBytes[i * 4 + 2] = colors[i].R;
-            convertedBytes[i * 4 + 3] = colors[i].A;
-        }
+        if (colorCount)
+            SwizzlePixels(PixelSwizzle::ReverseBytes, GetColorBytes(colors), convertedBytes.data(), colorCount);
 
         assert(convertedBytes.size() <= UINT_MAX);
 
@@ -207,13 +220,8 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     {
         std::vector<uint8_t> convertedBytes(colorCount * 4);
 
-        for (uint32_t i = 0; i < colorCount; i++)
-        {
-            convertedBytes[i * 4 + 0] = colors[i].R;
-            convertedBytes[i * 4 + 1] = colors[i].G;
-            convertedBytes[i * 4 + 2] = colors[i].B;
-            convertedBytes[i * 4 + 3] = colors[i].A;
-        }
+        if (colorCount)
+            SwizzlePixels(PixelSwizzle::ArgbToRgba, GetColorBytes(colors), convertedBytes.data(), colorCount);
 
         assert(convertedBytes.size() <= UINT_MAX);
 
@@ -73,6 +73,9 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
     unsigned GetBlockSize(DXGI_FORMAT format);
     unsigned GetBytesPerBlock(DXGI_FORMAT format);
 
+    uint8_t const* GetColorBytes(Windows::UI::Color const* colors);
+    uint8_t* GetColorBytes(Windows::UI::Color* colors);
+
     std::vector<uint8_t> ConvertColorsToBgra(uint32_t colorCount, Windows::UI::Color* colors);
     std::vector<uint8_t> ConvertColorsToRgba(uint32_t colorCount, Windows::UI::Color* colors);
 
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // A fixed number of slots, each either empty or holding one T, that
+    // threads can put values into and take values out of without taking a
+    // lock.  This is the storage behind the pools of objects that are
+    // expensive to create, such as DeviceContextPool and HistogramEffectPool.
+    //
+    // Each thread starts looking from its own 'home' slot, so in the common
+    // case where a thread takes a value and puts it back before another
+    // thread does the same, threads don't contend with each other.  A slot is
+    // claimed by an atomic compare-exchange on its state, and a slot that
+    // another thread is part way through filling or emptying is skipped
+    // rather than waited for.  Values live in the slots themselves, so
+    // putting and taking never allocate.  T must be default constructible,
+    // and moving from a T must leave it empty (as it does for ComPtr), so
+    // that an empty slot holds no references.
+    //
+    template<typename T>
+    class LockFreeSlotArray
+    {
+        enum class SlotState : uint32_t
+        {
+            Empty,
+            Busy,
+            Full
+        };
+
+        // Each slot starts on its own cache line so that threads using
+        // neighbouring slots don't cause false sharing.
+        struct alignas(64) Slot
+        {
+            std::atomic<SlotState> State;
+            T Value;
+        };
+
+        // new[] doesn't honour alignas before C++17, so the slots are
+        // allocated with _aligned_malloc and destroyed by hand.
+        class SlotDeleter
+        {
+            uint32_t m_slotCount;
+
+        public:
+            explicit SlotDeleter(uint32_t slotCount = 0)
+                : m_slotCount(slotCount)
+            {
+            }
+
+            void operator()(Slot* slots) const
+            {
+                for (uint32_t i = 0; i < m_slotCount; ++i)
+                    slots[i].~Slot();
+
+                _aligned_free(slots);
+            }
+        };
+
+        uint32_t const m_slotCount;
+        std::unique_ptr<Slot, SlotDeleter> m_slots;
+
+    public:
+        explicit LockFreeSlotArray(uint32_t slotCount)
+            : m_slotCount(std::max(slotCount, 1U))
+            , m_slots(AllocateSlots(m_slotCount), SlotDeleter(m_slotCount))
+        {
+        }
+
+        LockFreeSlotArray(LockFreeSlotArray const&) = delete;
+        LockFreeSlotArray& operator=(LockFreeSlotArray const&) = delete;
+
+        uint32_t GetSlotCount() const
+        {
+            return m_slotCount;
+        }
+
+        // Moves a value out of a full slot into 'value'.  The search starts
+        // from this thread's home slot among the first homeSlotRange slots, but
+        // covers every slot.  Returns false if they are all empty.
+        bool TryTake(T& value, uint32_t homeSlotRange)
+        {
+            auto home = GetHomeSlot(homeSlotRange);
+
+            for (uint32_t i = 0; i < m_slotCount; ++i)
+            {
+                auto& slot = m_slots.get()[(home + i) % m_slotCount];
+
+                // Cheap check before the exchange, to avoid dirtying cache
+                // lines of slots that are empty.
+                if (slot.State.load(std::memory_order_relaxed) != SlotState::Full)
+                    continue;
+
+                if (TryTakeFromSlot(slot, value))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool TryTake(T& value)
+        {
+            return TryTake(value, m_slotCount);
+        }
+
+        // Moves 'value' into an empty slot among the first slotLimit slots.
+        // Returns false, leaving 'value' alone, if none of them are empty.
+        bool TryPut(T& value, uint32_t slotLimit)
+        {
+            slotLimit = std::min(slotLimit, m_slotCount);
+
+            if (slotLimit == 0)
+                return false;
+
+            auto home = GetHomeSlot(slotLimit);
+
+            for (uint32_t i = 0; i < slotLimit; ++i)
+            {
+                auto& slot = m_slots.get()[(home + i) % slotLimit];
+
+                if (slot.State.load(std::memory_order_relaxed) != SlotState::Empty)
+                    continue;
+
+                if (TryPutInSlot(slot, value))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool TryPut(T& value)
+        {
+            return TryPut(value, m_slotCount);
+        }
+
+        uint32_t GetFullCount() const
+        {
+            uint32_t count = 0;
+
+            for (uint32_t i = 0; i < m_slotCount; ++i)
+            {
+                if (m_slots.get()[i].State.load(std::memory_order_relaxed) == SlotState::Full)
+                    ++count;
+            }
+
+            return count;
+        }
+
+        // Releases the values in every slot from firstSlot onwards.  A slot
+        // that another thread is filling at the same time keeps its value.
+        void Clear(uint32_t firstSlot = 0)
+        {
+            for (uint32_t i = firstSlot; i < m_slotCount; ++i)
+            {
+                T removed;
+                TryTakeFromSlot(m_slots.get()[i], removed);
+            }
+        }
+
+    private:
+        static Slot* AllocateSlots(uint32_t slotCount)
+        {
+            auto slots = static_cast<Slot*>(_aligned_malloc(sizeof(Slot) * slotCount, alignof(Slot)));
+
+            if (!slots)
+                ThrowHR(E_OUTOFMEMORY);
+
+            for (uint32_t i = 0; i < slotCount; ++i)
+            {
+                new (&slots[i]) Slot();
+                slots[i].State.store(SlotState::Empty, std::memory_order_relaxed);
+            }
+
+            return slots;
+        }
+
+        uint32_t GetHomeSlot(uint32_t slotRange) const
+        {
+            static thread_local size_t threadHash = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+            return static_cast<uint32_t>(threadHash % std::max(std::min(slotRange, m_slotCount), 1U));
+        }
+
+        static bool TryTakeFromSlot(Slot& slot, T& value)
+        {
+            auto expected = SlotState::Full;
+
+            if (!slot.State.compare_exchange_strong(expected, SlotState::Busy, std::memory_order_acquire, std::memory_order_relaxed))
+                return false;
+
+            value = std::move(slot.Value);
+            slot.State.store(SlotState::Empty, std::memory_order_release);
+            return true;
+        }
+
+        static bool TryPutInSlot(Slot& slot, T& value)
+        {
+            auto expected = SlotState::Empty;
+
+            if (!slot.State.compare_exchange_strong(expected, SlotState::Busy, std::memory_order_acquire, std::memory_order_relaxed))
+                return false;
+
+            slot.Value = std::move(value);
+            slot.State.store(SlotState::Full, std::memory_order_release);
+            return true;
+        }
+    };
+}}}}
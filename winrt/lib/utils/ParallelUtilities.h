@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Calls fn(taskIndex) for each task in [0, taskCount).  Task 0 runs on the
+    // calling thread and the rest on worker threads started with std::async.
+    // This waits for every task to finish, even if some of them throw, and
+    // then rethrows the first exception.
+    //
+    // Starting a worker costs tens of microseconds, so callers should only
+    // ask for more than one task when each has enough work to be worth it.
+    //
+    template<typename FN>
+    void RunTasksInParallel(uint32_t taskCount, FN&& fn)
+    {
+        std::vector<std::future<void>> workers;
+        workers.reserve(taskCount);
+
+        for (uint32_t i = 1; i < taskCount; ++i)
+        {
+            workers.push_back(std::async(std::launch::async, [&fn, i] { fn(i); }));
+        }
+
+        std::exception_ptr firstError;
+
+        try
+        {
+            if (taskCount > 0)
+                fn(0u);
+        }
+        catch (...)
+        {
+            firstError = std::current_exception();
+        }
+
+        for (auto& worker : workers)
+        {
+            try
+            {
+                worker.get();
+            }
+            catch (...)
+            {
+                if (!firstError)
+                    firstError = std::current_exception();
+            }
+        }
+
+        if (firstError)
+            std::rethrow_exception(firstError);
+    }
+
+
+    //
+    // Splits [0, itemCount) into rangeCount contiguous ranges of nearly equal
+    // size and calls fn(begin, end) for each of them, as RunTasksInParallel
+    // does.  rangeCount is clamped to [1, itemCount], so no range is empty.
+    //
+    template<typename FN>
+    void ForEachRangeInParallel(uint32_t itemCount, uint32_t rangeCount, FN&& fn)
+    {
+        if (itemCount == 0)
+            return;
+
+        rangeCount = std::min(std::max(rangeCount, 1u), itemCount);
+
+        auto rangeBegin = [=](uint32_t range) { return static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * range / rangeCount); };
+
+        RunTasksInParallel(rangeCount,
+            [&](uint32_t range)
+            {
+                fn(rangeBegin(range), rangeBegin(range + 1));
+            });
+    }
+}}}}
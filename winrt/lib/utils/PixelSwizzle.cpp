@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "PixelSwizzle.h"
+#include "ParallelUtilities.h"
+
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define PIXEL_SWIZZLE_SSSE3
+    #include <tmmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(_M_ARM) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define PIXEL_SWIZZLE_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(PIXEL_SWIZZLE_SSSE3) && !defined(_MSC_VER)
+    // GCC and clang only allow SSSE3 intrinsics in functions built for SSSE3.
+    #define PIXEL_SWIZZLE_SSSE3_FUNCTION __attribute__((target("ssse3")))
+#else
+    #define PIXEL_SWIZZLE_SSSE3_FUNCTION
+#endif
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    // For each destination byte, the index of the source byte within the same
+    // 16 byte (four pixel) block.
+    static uint8_t const* GetShuffleMask(PixelSwizzle swizzle)
+    {
+        static uint8_t const swapRedBlue[16]  = { 2, 1, 0, 3,  6, 5, 4, 7,  10,  9,  8, 11,  14, 13, 12, 15 };
+        static uint8_t const reverseBytes[16] = { 3, 2, 1, 0,  7, 6, 5, 4,  11, 10,  9,  8,  15, 14, 13, 12 };
+        static uint8_t const argbToRgba[16]   = { 1, 2, 3, 0,  5, 6, 7, 4,   9, 10, 11,  8,  13, 14, 15, 12 };
+
+        switch (swizzle)
+        {
+        case PixelSwizzle::SwapRedBlue:  return swapRedBlue;
+        case PixelSwizzle::ReverseBytes: return reverseBytes;
+        case PixelSwizzle::ArgbToRgba:   return argbToRgba;
+        }
+
+        assert(false);
+        return reverseBytes;
+    }
+
+
+    void SwizzlePixelsScalar(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount)
+    {
+        auto mask = GetShuffleMask(swizzle);
+
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            uint8_t pixel[4];
+            memcpy(pixel, source + i * 4, 4);
+
+            destination[i * 4 + 0] = pixel[mask[0]];
+            destination[i * 4 + 1] = pixel[mask[1]];
+            destination[i * 4 + 2] = pixel[mask[2]];
+            destination[i * 4 + 3] = pixel[mask[3]];
+        }
+    }
+
+
+#if defined(PIXEL_SWIZZLE_SSSE3)
+
+    static bool DetectSsse3()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (ecx & bit_SSSE3) != 0;
+#endif
+    }
+
+    bool IsVectorPixelSwizzleSupported()
+    {
+        static bool const isSupported = DetectSsse3();
+        return isSupported;
+    }
+
+    PIXEL_SWIZZLE_SSSE3_FUNCTION
+    static size_t SwizzlePixelsVector(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount)
+    {
+        auto mask = _mm_loadu_si128(reinterpret_cast<__m128i const*>(GetShuffleMask(swizzle)));
+
+        size_t i = 0;
+
+        // Four blocks per iteration, to give the CPU some independent work.
+        for (; i + 16 <= pixelCount; i += 16)
+        {
+            auto s = reinterpret_cast<__m128i const*>(source + i * 4);
+            auto d = reinterpret_cast<__m128i*>(destination + i * 4);
+
+            auto p0 = _mm_loadu_si128(s + 0);
+            auto p1 = _mm_loadu_si128(s + 1);
+            auto p2 = _mm_loadu_si128(s + 2);
+            auto p3 = _mm_loadu_si128(s + 3);
+
+            _mm_storeu_si128(d + 0, _mm_shuffle_epi8(p0, mask));
+            _mm_storeu_si128(d + 1, _mm_shuffle_epi8(p1, mask));
+            _mm_storeu_si128(d + 2, _mm_shuffle_epi8(p2, mask));
+            _mm_storeu_si128(d + 3, _mm_shuffle_epi8(p3, mask));
+        }
+
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            auto p = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_shuffle_epi8(p, mask));
+        }
+
+        return i;
+    }
+
+#elif defined(PIXEL_SWIZZLE_NEON)
+
+    bool IsVectorPixelSwizzleSupported()
+    {
+        // NEON is always available on the ARM platforms Windows supports.
+        return true;
+    }
+
+    static size_t SwizzlePixelsVector(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount)
+    {
+        auto maskBytes = GetShuffleMask(swizzle);
+
+        size_t i = 0;
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+        auto mask = vld1q_u8(maskBytes);
+
+        for (; i + 4 <= pixelCount; i += 4)
+        {
+            auto p = vld1q_u8(source + i * 4);
+            vst1q_u8(destination + i * 4, vqtbl1q_u8(p, mask));
+        }
+#else
+        // 32 bit ARM only has 64 bit table lookups, so this does two pixels at
+        // a time using the first half of the mask.
+        auto mask = vld1_u8(maskBytes);
+
+        for (; i + 2 <= pixelCount; i += 2)
+        {
+            auto p = vld1_u8(source + i * 4);
+            vst1_u8(destination + i * 4, vtbl1_u8(p, mask));
+        }
+#endif
+
+        return i;
+    }
+
+#else
+
+    bool IsVectorPixelSwizzleSupported()
+    {
+        return false;
+    }
+
+    static size_t SwizzlePixelsVector(PixelSwizzle, uint8_t const*, uint8_t*, size_t)
+    {
+        return 0;
+    }
+
+#endif
+
+
+    void SwizzlePixels(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount)
+    {
+        size_t done = 0;
+
+        if (IsVectorPixelSwizzleSupported())
+            done = SwizzlePixelsVector(swizzle, source, destination, pixelCount);
+
+        SwizzlePixelsScalar(swizzle, source + done * 4, destination + done * 4, pixelCount - done);
+    }
+
+
+    static void SwizzleRowRange(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        size_t sourceStride,
+        uint8_t* destination,
+        size_t destinationStride,
+        uint32_t width,
+        uint32_t firstRow,
+        uint32_t endRow)
+    {
+        // Tightly packed rows can be converted as one long run.
+        if (sourceStride == width * 4u && destinationStride == width * 4u)
+        {
+            SwizzlePixels(
+                swizzle,
+                source + firstRow * sourceStride,
+                destination + firstRow * destinationStride,
+                static_cast<size_t>(width) * (endRow - firstRow));
+            return;
+        }
+
+        for (auto y = firstRow; y < endRow; ++y)
+        {
+            SwizzlePixels(swizzle, source + y * sourceStride, destination + y * destinationStride, width);
+        }
+    }
+
+
+    void SwizzlePixelRows(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        size_t sourceStride,
+        uint8_t* destination,
+        size_t destinationStride,
+        uint32_t width,
+        uint32_t height)
+    {
+        // Below this size the cost of starting up worker threads outweighs
+        // the conversion itself.
+        const size_t minPixelsPerBand = 256 * 1024;
+
+        auto pixelCount = static_cast<size_t>(width) * height;
+
+        auto bandCount = static_cast<uint32_t>(std::min<size_t>(
+            std::min<size_t>(std::thread::hardware_concurrency(), height),
+            pixelCount / minPixelsPerBand));
+
+        ForEachRangeInParallel(height, bandCount,
+            [=](uint32_t firstRow, uint32_t endRow)
+            {
+                SwizzleRowRange(swizzle, source, sourceStride, destination, destinationStride, width, firstRow, endRow);
+            });
+    }
+
+}}}}
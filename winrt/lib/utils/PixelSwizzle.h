@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Reorders the bytes within each 32 bit pixel.  Used to convert between
+    // DXGI pixel layouts and Windows::UI::Color, which is stored as A, R, G, B.
+    //
+    // Uses SSSE3 (pshufb) or NEON (vtbl) when available, and plain scalar code
+    // otherwise.  This has no dependencies on Windows or D2D types, so it can
+    // be built and tested on its own.
+    //
+
+    enum class PixelSwizzle
+    {
+        SwapRedBlue,    // B, G, R, A <-> R, G, B, A
+        ReverseBytes,   // B, G, R, A <-> A, R, G, B   (B8G8R8A8 <-> Windows::UI::Color)
+        ArgbToRgba,     // A, R, G, B  -> R, G, B, A   (Windows::UI::Color -> R8G8B8A8)
+    };
+
+    // Source and destination may be the same buffer, but must not otherwise overlap.
+    void SwizzlePixels(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount);
+
+    // Converts a rectangle of pixels.  Large rectangles are split into bands of
+    // rows which are converted in parallel.
+    void SwizzlePixelRows(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        size_t sourceStride,
+        uint8_t* destination,
+        size_t destinationStride,
+        uint32_t width,
+        uint32_t height);
+
+    // Exposed for tests, so that the scalar fallback can be compared against
+    // whichever vector implementation SwizzlePixels picked.
+    void SwizzlePixelsScalar(
+        PixelSwizzle swizzle,
+        uint8_t const* source,
+        uint8_t* destination,
+        size_t pixelCount);
+
+    bool IsVectorPixelSwizzleSupported();
+
+}}}}
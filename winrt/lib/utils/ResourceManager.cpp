@@ -27,15 +27,16 @@
 #include "svg/CanvasSvgStrokeDashArrayAttribute.h"
 
 
-std::unordered_map<IUnknown*, WeakRef> ResourceManager::m_resources;
-std::recursive_mutex ResourceManager::m_mutex;
+ResourceManager::Shard ResourceManager::m_shards[ResourceManager::ShardCount];
+std::mutex ResourceManager::m_typeCacheMutex;
+std::unordered_map<void const*, size_t> ResourceManager::m_typeCache;
 
 // When adding new types here, please also update the "Types that support interop" table in winrt\docsrc\Interop.aml.
-std::vector<ResourceManager::TryCreateFunction> ResourceManager::tryCreateFunctions =
+std::vector<ResourceManager::TypeRegistration> ResourceManager::tryCreateFunctions =
 {
     TryCreate<ID2D1Device1,                CanvasDevice,                      MakeWrapper>,
     TryCreate<ID2D1DeviceContext1,         CanvasDrawingSession,              MakeWrapper>,
-    TryCreate<ID2D1Bitmap1,                CanvasRenderTarget,                MakeWrapperWithDevice,  IsRenderTargetBitmap>,
+  { TryCreate<ID2D1Bitmap1,                CanvasRenderTarget,                MakeWrapperWithDevice,  IsRenderTargetBitmap>, InstanceSpecific },
     TryCreate<ID2D1Bitmap1,                CanvasBitmap,                      MakeWrapperWithDevice>,
     TryCreate<ID2D1CommandList,            CanvasCommandList,                 MakeWrapperWithDevice>,
     TryCreate<IDXGISwapChain1,             CanvasSwapChain,                   MakeWrapperWithDeviceAndDpi>,
@@ -58,7 +59,7 @@ std::vector<ResourceManager::TryCreateFunction> ResourceManager::tryCreateFuncti
     TryCreate<IDWriteFontSet,              CanvasFontSet,                     MakeWrapper>,
     TryCreate<IDWriteFontFaceReference,    CanvasFontFace,                    MakeWrapper>,
     TryCreate<ID2D1SvgDocument,            CanvasSvgDocument,                 MakeWrapperWithDevice>,
-    TryCreate<ID2D1SvgElement,             CanvasSvgTextElement,              MakeWrapperWithDevice,  IsSvgTextElement>,
+  { TryCreate<ID2D1SvgElement,             CanvasSvgTextElement,              MakeWrapperWithDevice,  IsSvgTextElement>, InstanceSpecific },
     TryCreate<ID2D1SvgElement,             CanvasSvgNamedElement,             MakeWrapperWithDevice>,
 
     TryCreate<ID2D1SvgPaint,               CanvasSvgPaintAttribute,           MakeWrapperWithDevice>,
@@ -76,18 +77,34 @@ std::vector<ResourceManager::TryCreateFunction> ResourceManager::tryCreateFuncti
 
     // Effects get their very own try-create function. These are special because ID2D1Effect
     // can map to many different Win2D wrapper types depending on its D2D1_PROPERTY_CLSID.
-    CanvasEffect::TryCreateEffect
+    { CanvasEffect::TryCreateEffect, InstanceSpecific }
 };
 
 
+ResourceManager::Shard& ResourceManager::GetShard(IUnknown* resourceIdentity)
+{
+    // COM objects are heap allocated, so the low bits of their addresses carry
+    // little information.  Mix the whole pointer before picking a shard.
+    auto hash = reinterpret_cast<uintptr_t>(resourceIdentity);
+
+    hash ^= hash >> 17;
+    hash *= static_cast<uintptr_t>(0x9E3779B97F4A7C15ull);
+    hash ^= hash >> 15;
+
+    return m_shards[hash % ShardCount];
+}
+
+
 // Called by the ResourceWrapper constructor, to add itself to the interop mapping table.
 void ResourceManager::Add(IUnknown* resource, IInspectable* wrapper)
 {
     ComPtr<IUnknown> resourceIdentity = AsUnknown(resource);
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto& shard = GetShard(resourceIdentity.Get());
 
-    auto result = m_resources.insert(std::make_pair(resourceIdentity.Get(), AsWeak(wrapper)));
+    std::lock_guard<std::recursive_mutex> lock(shard.Mutex);
+
+    auto result = shard.Resources.insert(std::make_pair(resourceIdentity.Get(), AsWeak(wrapper)));
 
     if (!result.second)
         ThrowHR(E_UNEXPECTED);
@@ -99,46 +116,75 @@ void ResourceManager::Remove(IUnknown* resource)
 {
     ComPtr<IUnknown> resourceIdentity = AsUnknown(resource);
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto& shard = GetShard(resourceIdentity.Get());
+
+    std::lock_guard<std::recursive_mutex> lock(shard.Mutex);
 
-    auto result = m_resources.erase(resourceIdentity.Get());
+    auto result = shard.Resources.erase(resourceIdentity.Get());
 
     if (result != 1)
         ThrowHR(E_UNEXPECTED);
 }
 
 
-ComPtr<IInspectable> ResourceManager::GetOrCreate(ICanvasDevice* device, IUnknown* resource, float dpi)
+ComPtr<IInspectable> ResourceManager::TryGetExisting(IUnknown* resourceIdentity)
 {
-    ComPtr<IUnknown> resourceIdentity = AsUnknown(resource);
+    // Declared outside the lock, so that if this happens to be the last
+    // reference the wrapper isn't destroyed (and removed from the map) while
+    // we hold the shard lock.
     ComPtr<IInspectable> wrapper;
 
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto& shard = GetShard(resourceIdentity);
 
-    // Do we already have a wrapper around this resource?
-    auto it = m_resources.find(resourceIdentity.Get());
+    std::lock_guard<std::recursive_mutex> lock(shard.Mutex);
+
+    auto it = shard.Resources.find(resourceIdentity);
 
-    if (it != m_resources.end())
+    if (it != shard.Resources.end())
     {
         wrapper = LockWeakRef<IInspectable>(it->second);
     }
 
-    // Create a new wrapper instance?
+    return wrapper;
+}
+
+
+ComPtr<IInspectable> ResourceManager::GetOrCreate(ICanvasDevice* device, IUnknown* resource, float dpi)
+{
+    return GetOrCreate(device, resource, dpi, true);
+}
+
+
+ComPtr<IInspectable> ResourceManager::GetOrCreateFromInterop(ICanvasDevice* device, IUnknown* resource, float dpi)
+{
+    return GetOrCreate(device, resource, dpi, false);
+}
+
+
+ComPtr<IInspectable> ResourceManager::GetOrCreate(ICanvasDevice* device, IUnknown* resource, float dpi, bool useTypeCache)
+{
+    ComPtr<IUnknown> resourceIdentity = AsUnknown(resource);
+
+    // Do we already have a wrapper around this resource?
+    auto wrapper = TryGetExisting(resourceIdentity.Get());
+
+    // Create a new wrapper instance?  If another thread is already creating one
+    // for this resource, BeginCreation waits for it and returns that instead.
     if (!wrapper)
     {
-        for (auto& tryCreateFunction : tryCreateFunctions)
+        auto& shard = GetShard(resourceIdentity.Get());
+
+        if (BeginCreation(shard, resourceIdentity.Get(), &wrapper))
         {
-            if (tryCreateFunction(device, resource, dpi, &wrapper))
+            auto endCreation = MakeScopeWarden([&] { EndCreation(shard, resourceIdentity.Get()); });
+
+            if (!(useTypeCache && TryCreateFromTypeCache(device, resource, dpi, &wrapper)) &&
+                !TryCreateFromAllTypes(device, resource, dpi, useTypeCache, &wrapper))
             {
-                break;
+                // Fail if we did not find a way to wrap this type.
+                ThrowHR(E_NOINTERFACE, Strings::ResourceManagerUnknownType);
             }
         }
-
-        // Fail if we did not find a way to wrap this type.
-        if (!wrapper)
-        {
-            ThrowHR(E_NOINTERFACE, Strings::ResourceManagerUnknownType);
-        }
     }
 
     // Validate that the object we got back reports the expected device and DPI.
@@ -149,6 +195,115 @@ ComPtr<IInspectable> ResourceManager::GetOrCreate(ICanvasDevice* device, IUnknow
 }
 
 
+// Returns true if the caller should create a wrapper for this resource, in which
+// case it must call EndCreation afterwards.  Otherwise existingWrapper is set to
+// the wrapper that already exists, or that another thread has just finished
+// creating.
+bool ResourceManager::BeginCreation(Shard& shard, IUnknown* resourceIdentity, ComPtr<IInspectable>* existingWrapper)
+{
+    std::unique_lock<std::recursive_mutex> lock(shard.Mutex);
+
+    for (;;)
+    {
+        auto it = shard.Resources.find(resourceIdentity);
+
+        if (it != shard.Resources.end())
+        {
+            *existingWrapper = LockWeakRef<IInspectable>(it->second);
+
+            if (*existingWrapper)
+                return false;
+        }
+
+        auto pending = shard.PendingCreations.find(resourceIdentity);
+
+        if (pending == shard.PendingCreations.end())
+        {
+            shard.PendingCreations.emplace(resourceIdentity, std::this_thread::get_id());
+            return true;
+        }
+
+        // A wrapper whose construction asks for a second wrapper around its own
+        // resource would otherwise wait for itself forever.
+        if (pending->second == std::this_thread::get_id())
+            ThrowHR(E_UNEXPECTED);
+
+        shard.CreationFinished.wait(lock);
+    }
+}
+
+
+void ResourceManager::EndCreation(Shard& shard, IUnknown* resourceIdentity)
+{
+    {
+        std::lock_guard<std::recursive_mutex> lock(shard.Mutex);
+
+        shard.PendingCreations.erase(resourceIdentity);
+    }
+
+    shard.CreationFinished.notify_all();
+}
+
+
+// Resources with the same vtable are instances of the same class.  See
+// m_typeCache for when that means they respond to QueryInterface alike.
+void const* ResourceManager::GetTypeKey(IUnknown* resource)
+{
+    return *reinterpret_cast<void const* const*>(resource);
+}
+
+
+bool ResourceManager::TryCreateFromTypeCache(ICanvasDevice* device, IUnknown* resource, float dpi, ComPtr<IInspectable>* result)
+{
+    size_t cachedIndex;
+
+    {
+        std::lock_guard<std::mutex> lock(m_typeCacheMutex);
+
+        auto it = m_typeCache.find(GetTypeKey(resource));
+
+        if (it == m_typeCache.end())
+            return false;
+
+        cachedIndex = it->second;
+    }
+
+    // Earlier entries that only look at the type are known to have failed for
+    // this type, but instance specific ones might succeed for this particular
+    // resource so still need to be given the chance.
+    for (size_t i = 0; i < cachedIndex; ++i)
+    {
+        if (tryCreateFunctions[i].IsInstanceSpecific &&
+            tryCreateFunctions[i].TryCreate(device, resource, dpi, result))
+        {
+            return true;
+        }
+    }
+
+    return tryCreateFunctions[cachedIndex].TryCreate(device, resource, dpi, result);
+}
+
+
+bool ResourceManager::TryCreateFromAllTypes(ICanvasDevice* device, IUnknown* resource, float dpi, bool useTypeCache, ComPtr<IInspectable>* result)
+{
+    for (size_t i = 0; i < tryCreateFunctions.size(); ++i)
+    {
+        if (tryCreateFunctions[i].TryCreate(device, resource, dpi, result))
+        {
+            if (useTypeCache)
+            {
+                std::lock_guard<std::mutex> lock(m_typeCacheMutex);
+                m_typeCache[GetTypeKey(resource)] = i;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
 // Validation rules:
 //  - If the caller specified a device or dpi, and the wrapper has device/dpi, these must match.
 //  - If the caller specified device or dpi but the wrapper has no device/dpi, we'll allow that, ignoring the parameter.
@@ -207,19 +362,27 @@ void ResourceManager::ValidateDpi(ICanvasResourceWrapperWithDpi* wrapper, float
 }
 
 
-void ResourceManager::RegisterType(TryCreateFunction tryCreate)
+void ResourceManager::RegisterType(TryCreateFunction tryCreate, bool isInstanceSpecific)
 {
-    assert(std::find(tryCreateFunctions.begin(), tryCreateFunctions.end(), tryCreate) == tryCreateFunctions.end());
+    std::lock_guard<std::mutex> lock(m_typeCacheMutex);
+
+    assert(std::find_if(tryCreateFunctions.begin(), tryCreateFunctions.end(), [=](TypeRegistration const& t) { return t.TryCreate == tryCreate; }) == tryCreateFunctions.end());
 
-    tryCreateFunctions.push_back(tryCreate);
+    tryCreateFunctions.push_back(TypeRegistration(tryCreate, isInstanceSpecific));
+
+    m_typeCache.clear();
 }
 
 
 void ResourceManager::UnregisterType(TryCreateFunction tryCreate)
 {
-    auto it = std::find(tryCreateFunctions.begin(), tryCreateFunctions.end(), tryCreate);
+    std::lock_guard<std::mutex> lock(m_typeCacheMutex);
+
+    auto it = std::find_if(tryCreateFunctions.begin(), tryCreateFunctions.end(), [=](TypeRegistration const& t) { return t.TryCreate == tryCreate; });
 
     assert(it != tryCreateFunctions.end());
 
     tryCreateFunctions.erase(it);
+
+    m_typeCache.clear();
 }
@@ -33,6 +33,10 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         // Used internally, and exposed to apps via CanvasDeviceFactory::GetOrCreate and Microsoft.Graphics.Canvas.native.h.
         static ComPtr<IInspectable> GetOrCreate(ICanvasDevice* device, IUnknown* resource, float dpi);
 
+        // Used by CanvasDeviceFactory::GetOrCreate for resources passed in by apps.  These may be
+        // implemented by the app rather than by D2D, DWrite or DXGI, so they don't use the type cache.
+        static ComPtr<IInspectable> GetOrCreateFromInterop(ICanvasDevice* device, IUnknown* resource, float dpi);
+
 
         // Convenience helpers.
         template<typename T>
@@ -64,8 +68,27 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
         typedef bool(*TryCreateFunction)(ICanvasDevice* device, IUnknown* resource, float dpi, ComPtr<IInspectable>* result);
 
 
-        // Allow unit tests to inject additional try-create functions.
-        static void RegisterType(TryCreateFunction tryCreate);
+        // Most try-create functions succeed or fail purely based on the COM type of the resource, so once
+        // we know which one wraps a given type we can skip straight to it next time.  Entries that also
+        // look at the individual resource (eg. using a custom tester, or effects which check their CLSID)
+        // are marked as instance specific, so the type cache knows it must still run them.
+        struct TypeRegistration
+        {
+            TypeRegistration(TryCreateFunction tryCreate, bool isInstanceSpecific = false)
+                : TryCreate(tryCreate)
+                , IsInstanceSpecific(isInstanceSpecific)
+            { }
+
+            TryCreateFunction TryCreate;
+            bool IsInstanceSpecific;
+        };
+
+        static bool const InstanceSpecific = true;
+
+
+        // Allow unit tests to inject additional try-create functions.  These must not be called
+        // while other threads might be creating wrappers.
+        static void RegisterType(TryCreateFunction tryCreate, bool isInstanceSpecific = false);
         static void UnregisterType(TryCreateFunction tryCreate);
 
 
@@ -154,11 +177,47 @@ namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
 
 
     private:
-        // Native resource -> WinRT wrapper map, shared by all active resources.
-        static std::unordered_map<IUnknown*, WeakRef> m_resources;
-        static std::recursive_mutex m_mutex;
+        // Native resource -> WinRT wrapper map, shared by all active resources.  This is split into
+        // shards, selected by a hash of the resource pointer, so that threads adding, removing or
+        // looking up unrelated resources don't all contend on the same lock.
+        //
+        // Each shard also records which of its resources are having a wrapper created, and by which
+        // thread.  Only one thread at a time creates a wrapper for a given resource; any others that
+        // want it wait on CreationFinished and then use that wrapper.  No lock is held while a wrapper
+        // is being created, since wrapper constructors can call back into GetOrCreate for other
+        // resources.  (Waiting can only deadlock if two resources' wrappers each need the other to be
+        // created first, and no Win2D types do that.)
+        struct Shard
+        {
+            std::recursive_mutex Mutex;
+            std::condition_variable_any CreationFinished;
+            std::unordered_map<IUnknown*, WeakRef> Resources;
+            std::unordered_map<IUnknown*, std::thread::id> PendingCreations;
+        };
+
+        static const size_t ShardCount = 16;
+        static Shard m_shards[ShardCount];
+
+        static Shard& GetShard(IUnknown* resourceIdentity);
+        static ComPtr<IInspectable> TryGetExisting(IUnknown* resourceIdentity);
+
+        static ComPtr<IInspectable> GetOrCreate(ICanvasDevice* device, IUnknown* resource, float dpi, bool useTypeCache);
+        static bool BeginCreation(Shard& shard, IUnknown* resourceIdentity, ComPtr<IInspectable>* existingWrapper);
+        static void EndCreation(Shard& shard, IUnknown* resourceIdentity);
 
         // Table of try-create functions, one per type.
-        static std::vector<TryCreateFunction> tryCreateFunctions;
+        static std::vector<TypeRegistration> tryCreateFunctions;
+
+        // Vtable of a resource -> index of the try-create function that wrapped it.  This relies on
+        // resources with the same vtable responding to QueryInterface in the same way, which holds
+        // for the classes D2D, DWrite and DXGI implement their resources with, but not necessarily
+        // for objects implemented by apps.  So it is only used for resources that Win2D got back
+        // from those APIs, and never for ones passed in through interop.
+        static std::mutex m_typeCacheMutex;
+        static std::unordered_map<void const*, size_t> m_typeCache;
+
+        static bool TryCreateFromTypeCache(ICanvasDevice* device, IUnknown* resource, float dpi, ComPtr<IInspectable>* result);
+        static bool TryCreateFromAllTypes(ICanvasDevice* device, IUnknown* resource, float dpi, bool useTypeCache, ComPtr<IInspectable>* result);
+        static void const* GetTypeKey(IUnknown* resource);
     };
 }}}}
@@ -0,0 +1,359 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+// This file doesn't use the precompiled header, so that it only depends on
+// DirectXMath and the CRT and can be built and tested on its own.
+
+#include "SpriteTransforms.h"
+
+#include <assert.h>
+#include <DirectXMath.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define SPRITE_TRANSFORMS_AVX2
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#if defined(SPRITE_TRANSFORMS_AVX2) && !defined(_MSC_VER)
+    // GCC and clang only allow AVX2 intrinsics in functions built for AVX2.
+    #define SPRITE_TRANSFORMS_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+    #define SPRITE_TRANSFORMS_AVX2_FUNCTION
+#endif
+
+using namespace ::DirectX;
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Expanding translate(-o) * rotate(r) * scale(s) * translate(t), using
+    // the row-vector convention D2D uses, gives:
+    //
+    //     m11 =  cos * sx       m12 = sin * sy
+    //     m21 = -sin * sx       m22 = cos * sy
+    //     dx  =  sx * (oy * sin - ox * cos) + tx
+    //     dy  = -sy * (ox * sin + oy * cos) + ty
+    //
+
+    void ComputeSpriteTransform(
+        float offsetX, float offsetY,
+        float originX, float originY,
+        float rotation,
+        float scaleX, float scaleY,
+        SinCosMode mode,
+        float* transform)
+    {
+        float sine = 0;
+        float cosine = 1;
+
+        if (rotation != 0)
+        {
+            if (mode == SinCosMode::Fast)
+                XMScalarSinCosEst(&sine, &cosine, rotation);
+            else
+                XMScalarSinCos(&sine, &cosine, rotation);
+        }
+
+        transform[0] =  cosine * scaleX;
+        transform[1] =  sine * scaleY;
+        transform[2] = -sine * scaleX;
+        transform[3] =  cosine * scaleY;
+        transform[4] =  scaleX * (originY * sine - originX * cosine) + offsetX;
+        transform[5] = -scaleY * (originX * sine + originY * cosine) + offsetY;
+    }
+
+
+    static float* TransformAt(float* transforms, size_t transformStrideInBytes, uint32_t i)
+    {
+        return reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(transforms) + i * transformStrideInBytes);
+    }
+
+
+#if defined(SPRITE_TRANSFORMS_AVX2)
+
+    static bool DetectAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+        bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+        bool hasAvx = (info[2] & (1 << 28)) != 0;
+        if (!hasOsxsave || !hasAvx)
+            return false;
+
+        // The OS must also save the upper halves of the YMM registers.
+        if ((_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return false;
+
+        if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+            return false;
+
+        unsigned int xcrLow, xcrHigh;
+        __asm__("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+        if ((xcrLow & 6) != 6)
+            return false;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return false;
+
+        return (ebx & bit_AVX2) != 0;
+#endif
+    }
+
+    bool IsAvx2SpriteTransformSupported()
+    {
+        static bool const isSupported = DetectAvx2();
+        return isSupported;
+    }
+
+    // Loads eight (x, y) pairs and splits them into a vector of x's and a
+    // vector of y's.
+    SPRITE_TRANSFORMS_AVX2_FUNCTION
+    static void LoadPairs8(float const* pairs, __m256* x, __m256* y)
+    {
+        auto xy0123 = _mm256_loadu_ps(pairs);
+        auto xy4567 = _mm256_loadu_ps(pairs + 8);
+
+        // Shuffles work within 128 bit lanes, giving x0 x1 x4 x5 x2 x3 x6 x7,
+        // so the middle 64 bit quarters then need swapping.
+        auto xs = _mm256_shuffle_ps(xy0123, xy4567, _MM_SHUFFLE(2, 0, 2, 0));
+        auto ys = _mm256_shuffle_ps(xy0123, xy4567, _MM_SHUFFLE(3, 1, 3, 1));
+
+        *x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(xs), _MM_SHUFFLE(3, 1, 2, 0)));
+        *y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(ys), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    SPRITE_TRANSFORMS_AVX2_FUNCTION
+    static __m256 MultiplyAdd8(__m256 a, __m256 b, float c)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(a, b), _mm256_set1_ps(c));
+    }
+
+    // Eight wide version of XMVectorSinCos / XMVectorSinCosEst, using the
+    // same range reduction and polynomials.
+    SPRITE_TRANSFORMS_AVX2_FUNCTION
+    static void SinCos8(__m256 angle, SinCosMode mode, __m256* sine, __m256* cosine)
+    {
+        // Reduce to [-pi, pi].
+        auto quotient = _mm256_round_ps(_mm256_mul_ps(angle, _mm256_set1_ps(XM_1DIV2PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        auto x = _mm256_sub_ps(angle, _mm256_mul_ps(quotient, _mm256_set1_ps(XM_2PI)));
+
+        // Map to y in [-pi/2, pi/2], with sin(y) = sin(x) and cos(y) = sign * cos(x).
+        auto signBit = _mm256_and_ps(x, _mm256_set1_ps(-0.0f));
+        auto reflected = _mm256_sub_ps(_mm256_or_ps(_mm256_set1_ps(XM_PI), signBit), x);
+        auto isInRange = _mm256_cmp_ps(_mm256_andnot_ps(signBit, x), _mm256_set1_ps(XM_PIDIV2), _CMP_LE_OQ);
+
+        auto y = _mm256_blendv_ps(reflected, x, isInRange);
+        auto sign = _mm256_blendv_ps(_mm256_set1_ps(-1.0f), _mm256_set1_ps(1.0f), isInRange);
+        auto y2 = _mm256_mul_ps(y, y);
+
+        __m256 s, c;
+
+        if (mode == SinCosMode::Fast)
+        {
+            s = MultiplyAdd8(_mm256_set1_ps(-0.00018524670f), y2, 0.0083139502f);
+            s = MultiplyAdd8(s, y2, -0.16665852f);
+            s = MultiplyAdd8(s, y2, 1.0f);
+
+            c = MultiplyAdd8(_mm256_set1_ps(-0.0012712436f), y2, 0.041493919f);
+            c = MultiplyAdd8(c, y2, -0.49992746f);
+            c = MultiplyAdd8(c, y2, 1.0f);
+        }
+        else
+        {
+            s = MultiplyAdd8(_mm256_set1_ps(-2.3889859e-08f), y2, 2.7525562e-06f);
+            s = MultiplyAdd8(s, y2, -0.00019840874f);
+            s = MultiplyAdd8(s, y2, 0.0083333310f);
+            s = MultiplyAdd8(s, y2, -0.16666667f);
+            s = MultiplyAdd8(s, y2, 1.0f);
+
+            c = MultiplyAdd8(_mm256_set1_ps(-2.6051615e-07f), y2, 2.4760495e-05f);
+            c = MultiplyAdd8(c, y2, -0.0013888378f);
+            c = MultiplyAdd8(c, y2, 0.041666638f);
+            c = MultiplyAdd8(c, y2, -0.5f);
+            c = MultiplyAdd8(c, y2, 1.0f);
+        }
+
+        *sine = _mm256_mul_ps(s, y);
+        *cosine = _mm256_mul_ps(c, sign);
+    }
+
+    // Does as many groups of eight sprites as there are, and returns how many
+    // sprites that covered.
+    SPRITE_TRANSFORMS_AVX2_FUNCTION
+    static uint32_t ComputeSpriteTransformsAvx2(
+        SpriteTransformInputs const& inputs,
+        SinCosMode mode,
+        float* transforms,
+        size_t transformStrideInBytes)
+    {
+        auto negativeZero = _mm256_set1_ps(-0.0f);
+
+        uint32_t i = 0;
+
+        for (; i + 8 <= inputs.Count; i += 8)
+        {
+            __m256 tx, ty;
+            LoadPairs8(inputs.Offsets + i * 2, &tx, &ty);
+
+            __m256 ox = _mm256_setzero_ps();
+            __m256 oy = _mm256_setzero_ps();
+            if (inputs.Origins)
+                LoadPairs8(inputs.Origins + i * 2, &ox, &oy);
+
+            __m256 sx = _mm256_set1_ps(1.0f);
+            __m256 sy = _mm256_set1_ps(1.0f);
+            if (inputs.Scales)
+                LoadPairs8(inputs.Scales + i * 2, &sx, &sy);
+
+            __m256 sine = _mm256_setzero_ps();
+            __m256 cosine = _mm256_set1_ps(1.0f);
+            if (inputs.Rotations)
+                SinCos8(_mm256_loadu_ps(inputs.Rotations + i), mode, &sine, &cosine);
+
+            alignas(32) float m[6][8];
+            _mm256_store_ps(m[0], _mm256_mul_ps(cosine, sx));
+            _mm256_store_ps(m[1], _mm256_mul_ps(sine, sy));
+            _mm256_store_ps(m[2], _mm256_xor_ps(_mm256_mul_ps(sine, sx), negativeZero));
+            _mm256_store_ps(m[3], _mm256_mul_ps(cosine, sy));
+            _mm256_store_ps(m[4], _mm256_add_ps(_mm256_mul_ps(sx, _mm256_sub_ps(_mm256_mul_ps(oy, sine), _mm256_mul_ps(ox, cosine))), tx));
+            _mm256_store_ps(m[5], _mm256_sub_ps(ty, _mm256_mul_ps(sy, _mm256_add_ps(_mm256_mul_ps(ox, sine), _mm256_mul_ps(oy, cosine)))));
+
+            for (uint32_t j = 0; j < 8; ++j)
+            {
+                auto transform = TransformAt(transforms, transformStrideInBytes, i + j);
+
+                for (int k = 0; k < 6; ++k)
+                    transform[k] = m[k][j];
+            }
+        }
+
+        // Avoid AVX to SSE transition stalls in the code that follows.
+        _mm256_zeroupper();
+
+        return i;
+    }
+
+#else
+
+    bool IsAvx2SpriteTransformSupported()
+    {
+        return false;
+    }
+
+    static uint32_t ComputeSpriteTransformsAvx2(SpriteTransformInputs const&, SinCosMode, float*, size_t)
+    {
+        return 0;
+    }
+
+#endif
+
+
+    // Loads four (x, y) pairs and splits them into a vector of x's and a
+    // vector of y's.
+    static void LoadPairs(float const* pairs, XMVECTOR* x, XMVECTOR* y)
+    {
+        auto xy01 = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(pairs));
+        auto xy23 = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(pairs + 4));
+
+        *x = XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Z, XM_PERMUTE_1X, XM_PERMUTE_1Z>(xy01, xy23);
+        *y = XMVectorPermute<XM_PERMUTE_0Y, XM_PERMUTE_0W, XM_PERMUTE_1Y, XM_PERMUTE_1W>(xy01, xy23);
+    }
+
+
+    void ComputeSpriteTransforms(
+        SpriteTransformInputs const& inputs,
+        SinCosMode mode,
+        float* transforms,
+        size_t transformStrideInBytes)
+    {
+        assert(inputs.Count == 0 || (inputs.Offsets && transforms));
+
+        uint32_t i = 0;
+
+        if (IsAvx2SpriteTransformSupported())
+            i = ComputeSpriteTransformsAvx2(inputs, mode, transforms, transformStrideInBytes);
+
+        for (; i + 4 <= inputs.Count; i += 4)
+        {
+            XMVECTOR tx, ty;
+            LoadPairs(inputs.Offsets + i * 2, &tx, &ty);
+
+            XMVECTOR ox = XMVectorZero();
+            XMVECTOR oy = XMVectorZero();
+            if (inputs.Origins)
+                LoadPairs(inputs.Origins + i * 2, &ox, &oy);
+
+            XMVECTOR sx = XMVectorSplatOne();
+            XMVECTOR sy = XMVectorSplatOne();
+            if (inputs.Scales)
+                LoadPairs(inputs.Scales + i * 2, &sx, &sy);
+
+            XMVECTOR sine = XMVectorZero();
+            XMVECTOR cosine = XMVectorSplatOne();
+            if (inputs.Rotations)
+            {
+                auto rotation = XMLoadFloat4(reinterpret_cast<XMFLOAT4 const*>(inputs.Rotations + i));
+
+                if (mode == SinCosMode::Fast)
+                    XMVectorSinCosEst(&sine, &cosine, XMVectorModAngles(rotation));
+                else
+                    XMVectorSinCos(&sine, &cosine, rotation);
+            }
+
+            XMFLOAT4A m[6];
+            XMStoreFloat4A(&m[0], XMVectorMultiply(cosine, sx));
+            XMStoreFloat4A(&m[1], XMVectorMultiply(sine, sy));
+            XMStoreFloat4A(&m[2], XMVectorNegate(XMVectorMultiply(sine, sx)));
+            XMStoreFloat4A(&m[3], XMVectorMultiply(cosine, sy));
+            XMStoreFloat4A(&m[4], XMVectorMultiplyAdd(sx, XMVectorSubtract(XMVectorMultiply(oy, sine), XMVectorMultiply(ox, cosine)), tx));
+            XMStoreFloat4A(&m[5], XMVectorNegativeMultiplySubtract(sy, XMVectorMultiplyAdd(ox, sine, XMVectorMultiply(oy, cosine)), ty));
+
+            //
+            // Transpose from six vectors of four sprites to four matrices.
+            //
+
+            float const* columns[6] = { &m[0].x, &m[1].x, &m[2].x, &m[3].x, &m[4].x, &m[5].x };
+
+            for (uint32_t j = 0; j < 4; ++j)
+            {
+                auto transform = TransformAt(transforms, transformStrideInBytes, i + j);
+
+                for (int k = 0; k < 6; ++k)
+                    transform[k] = columns[k][j];
+            }
+        }
+
+        for (; i < inputs.Count; ++i)
+        {
+            ComputeSpriteTransform(
+                inputs.Offsets[i * 2],
+                inputs.Offsets[i * 2 + 1],
+                inputs.Origins ? inputs.Origins[i * 2] : 0.0f,
+                inputs.Origins ? inputs.Origins[i * 2 + 1] : 0.0f,
+                inputs.Rotations ? inputs.Rotations[i] : 0.0f,
+                inputs.Scales ? inputs.Scales[i * 2] : 1.0f,
+                inputs.Scales ? inputs.Scales[i * 2 + 1] : 1.0f,
+                mode,
+                TransformAt(transforms, transformStrideInBytes, i));
+        }
+    }
+}}}}
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ABI { namespace Microsoft { namespace Graphics { namespace Canvas
+{
+    //
+    // Builds the per-sprite transform
+    //
+    //     translate(-origin) * rotate(rotation) * scale(scale) * translate(offset)
+    //
+    // for many sprites at once.  The inputs are plain float arrays and the
+    // output is written as 3x2 matrices (m11, m12, m21, m22, dx, dy) with a
+    // caller-specified stride, so it can write straight into sprite storage.
+    //
+    // The bulk version processes eight sprites at a time with AVX2 on CPUs
+    // that support it, then four at a time using DirectXMath, which compiles
+    // to SSE2 or NEON as appropriate and falls back to scalar code when
+    // neither is available.  This has no dependencies on Windows or D2D
+    // types, so it can be built and tested on its own.
+    //
+
+    enum class SinCosMode
+    {
+        Accurate,   // Full precision sin / cos
+        Fast        // Lower order polynomial approximation of sin / cos
+    };
+
+    struct SpriteTransformInputs
+    {
+        uint32_t Count;
+        float const* Offsets;   // Count (x, y) pairs
+        float const* Origins;   // Count (x, y) pairs, or null for (0, 0)
+        float const* Rotations; // Count angles in radians, or null for no rotation
+        float const* Scales;    // Count (x, y) pairs, or null for (1, 1)
+    };
+
+    void ComputeSpriteTransforms(
+        SpriteTransformInputs const& inputs,
+        SinCosMode mode,
+        float* transforms,
+        size_t transformStrideInBytes);
+
+    // Reference implementation of a single transform; ComputeSpriteTransforms
+    // uses this for the sprites left over after the last group of four.
+    void ComputeSpriteTransform(
+        float offsetX, float offsetY,
+        float originX, float originY,
+        float rotation,
+        float scaleX, float scaleY,
+        SinCosMode mode,
+        float* transform);
+
+    // Exposed for tests, to report which implementation was used.
+    bool IsAvx2SpriteTransformSupported();
+
+}}}}
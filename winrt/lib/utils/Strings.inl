@@ -14,6 +14,7 @@ STRING(AutoFileFormatNotAllowed, L"The option CanvasFileFormat.Auto is not allow
 STRING(BitmapFormatsDiffer, L"Bitmaps are not the same pixel format.")
 STRING(BlockCompressedDimensionsMustBeMultipleOf4, L"Block compressed image width & height must be a multiple of 4 pixels.")
 STRING(BlockCompressedSubRectangleMustBeAligned, L"Subrectangles from block compressed images must be aligned to a multiple of 4 pixels.")
+STRING(CachedTextLayoutIsImmutable, L"This CanvasTextLayout was returned by CanvasTextLayout.CreateCached, and may be shared, so it cannot be modified. Use CanvasTextLayout's constructor to create a layout that can be changed.")
 STRING(CacheOnDemandNotSet, L"This method may only be called if the CanvasVirtualBitmap was created with CanvasVirtualBitmapOptions.CacheOnDemand.")
 STRING(CannotCreateDrawingSessionUntilPreviousOneClosed, L"The last drawing session returned by CreateDrawingSession must be disposed before a new one can be created.")
 STRING(CanOnlyAddPathDataWhileInFigure, L"This operation is only allowed after a successful call to CanvasPathBuilder.BeginFigure.")
@@ -60,12 +61,15 @@ STRING(PathBuilderAddGeometryMidFigure, L"CanvasPathBuilder.AddGeometry may not
 STRING(PathBuilderClosedMidFigure, L"There was an attempt to use a CanvasPathBuilder, which was missing a call to CanvasPathBuilder.EndFigure.")
 STRING(PixelColorsFormatRestriction, L"This method only supports resources with pixel format DirectXPixelFormat.B8G8R8A8UIntNormalized.")
 STRING(PoppedWrongLayer, L"Attempting to close a CanvasActiveLayer that is not top of the stack. The most recently created layer must be closed first.")
+STRING(ReadbackQueueFull, L"Every staging bitmap in this CanvasBitmapReadbackQueue is in use. Close some of the CanvasMappedPixels it returned before starting another readback.")
+STRING(ReadbackQueueWrongDevice, L"This CanvasBitmap was created on a different device from the CanvasBitmapReadbackQueue.")
 STRING(RemoteFontUnavailable, L"The requested font is not locally available.")
 STRING(ResourceManagerNoDevice, L"To wrap this resource type, a device parameter must be passed to GetOrCreate.")
 STRING(ResourceManagerNoDpi, L"To wrap this resource type, a dpi parameter must be passed to GetOrCreate.")
 STRING(ResourceManagerUnknownType, L"Unsupported type. Win2D is not able to wrap the specified resource.")
 STRING(ResourceManagerWrongDevice, L"Existing resource wrapper is associated with a different device.")
 STRING(ResourceManagerWrongDpi, L"Existing resource wrapper has a different DPI.")
+STRING(RetainedSpriteBatchWrongDevice, L"This CanvasRetainedSpriteBatch was created on a different device to the drawing session it is being drawn with.")
 STRING(SetFilledRegionDeterminationAfterBeginFigure, L"This operation is not allowed after the first call to CanvasPathBuilder.BeginFigure.")
 STRING(SetPageCountCalledBeforePreviewing, L"CanvasPrintDocument.SetPageCount or CanvasPrintDocument.SetIntermediatePageCount cannot be called until the Paginate event has been raised.")
 STRING(SharedDeviceWrongDebugLevel, L"CanvasDevice.DebugLevel has changed since this shared device was created. The debug level must be set before the first call to GetSharedDevice.")
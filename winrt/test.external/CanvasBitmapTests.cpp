@@ -4,6 +4,8 @@
 
 #include "pch.h"
 
+#include <robuffer.h>
+
 using Platform::String;
 using namespace Microsoft::Graphics::Canvas;
 using namespace Microsoft::WRL::Wrappers;
@@ -1187,6 +1189,125 @@ public:
         }
     }
 
+    static uint8_t* GetMappedPixelData(CanvasMappedPixels^ mappedPixels)
+    {
+        Microsoft::WRL::ComPtr<::Windows::Storage::Streams::IBufferByteAccess> byteAccess;
+        ThrowIfFailed(reinterpret_cast<IInspectable*>(mappedPixels)->QueryInterface(IID_PPV_ARGS(&byteAccess)));
+
+        uint8_t* data;
+        ThrowIfFailed(byteAccess->Buffer(&data));
+        return data;
+    }
+
+    CanvasBitmap^ CreateIndexedBitmap(int width, int height)
+    {
+        auto imageData = ref new Platform::Array<byte>(width * height * 4);
+        for (auto i = 0u; i < imageData->Length; i++)
+        {
+            imageData[i] = static_cast<byte>(i);
+        }
+
+        return CanvasBitmap::CreateFromBytes(
+            m_sharedDevice,
+            imageData,
+            width,
+            height,
+            DirectXPixelFormat::B8G8R8A8UIntNormalized,
+            DEFAULT_DPI,
+            CanvasAlphaMode::Premultiplied);
+    }
+
+    TEST_METHOD(CanvasBitmap_MapPixels_Read_MatchesGetPixelBytes)
+    {
+        const int width = 8;
+        const int height = 9;
+        auto canvasBitmap = CreateIndexedBitmap(width, height);
+
+        auto expected = canvasBitmap->GetPixelBytes(2, 3, 4, 5);
+
+        auto mappedPixels = canvasBitmap->MapPixels(CanvasBitmapMapAccess::Read, 2, 3, 4, 5);
+
+        Assert::AreEqual(4u, mappedPixels->Width);
+        Assert::AreEqual(5u, mappedPixels->Height);
+        Assert::IsTrue(DirectXPixelFormat::B8G8R8A8UIntNormalized == mappedPixels->Format);
+        Assert::IsTrue(CanvasBitmapMapAccess::Read == mappedPixels->Access);
+        Assert::IsTrue(mappedPixels->Stride >= 4u * 4);
+
+        auto buffer = static_cast<IBuffer^>(mappedPixels);
+        Assert::IsTrue(buffer->Length >= mappedPixels->Stride * 4 + 4 * 4);
+
+        auto data = GetMappedPixelData(mappedPixels);
+
+        for (auto y = 0u; y < 5; y++)
+        {
+            for (auto x = 0u; x < 4 * 4; x++)
+            {
+                Assert::AreEqual(expected[y * 4 * 4 + x], data[y * mappedPixels->Stride + x]);
+            }
+        }
+
+        delete mappedPixels;
+
+        Assert::AreEqual(0u, buffer->Length);
+        Assert::ExpectException<Platform::ObjectDisposedException^>([&] { GetMappedPixelData(mappedPixels); });
+        Assert::ExpectException<Platform::ObjectDisposedException^>([&] { mappedPixels->Stride; });
+    }
+
+    TEST_METHOD(CanvasBitmap_MapPixels_ReadWrite_WritesBackOnClose)
+    {
+        const int width = 8;
+        const int height = 9;
+        auto canvasBitmap = CreateIndexedBitmap(width, height);
+
+        auto original = canvasBitmap->GetPixelBytes();
+
+        auto mappedPixels = canvasBitmap->MapPixels(CanvasBitmapMapAccess::ReadWrite, 1, 1, 2, 2);
+        auto data = GetMappedPixelData(mappedPixels);
+
+        for (auto y = 0u; y < 2; y++)
+        {
+            for (auto x = 0u; x < 2 * 4; x++)
+            {
+                data[y * mappedPixels->Stride + x] = 0xAB;
+            }
+        }
+
+        // Nothing is written back until the view is closed.
+        Assert::AreEqual(original[(width + 1) * 4], canvasBitmap->GetPixelBytes()[(width + 1) * 4]);
+
+        delete mappedPixels;
+
+        auto updated = canvasBitmap->GetPixelBytes();
+
+        for (auto y = 0; y < height; y++)
+        {
+            for (auto x = 0; x < width * 4; x++)
+            {
+                auto i = y * width * 4 + x;
+                bool isInside = (y >= 1 && y < 3 && x >= 4 && x < 3 * 4);
+
+                Assert::AreEqual(isInside ? static_cast<byte>(0xAB) : original[i], updated[i]);
+            }
+        }
+    }
+
+    TEST_METHOD(CanvasBitmap_MapPixels_InvalidArguments)
+    {
+        auto canvasBitmap = ref new CanvasRenderTarget(m_sharedDevice, 1, 1, DEFAULT_DPI);
+
+        Assert::ExpectException<Platform::InvalidArgumentException^>(
+            [&]
+            {
+                canvasBitmap->MapPixels(static_cast<CanvasBitmapMapAccess>(-1));
+            });
+
+        Assert::ExpectException<Platform::InvalidArgumentException^>(
+            [&]
+            {
+                canvasBitmap->MapPixels(CanvasBitmapMapAccess::Read, 0, 0, 2, 2);
+            });
+    }
+
     TEST_METHOD(CanvasRenderTarget_SetPixelBytes_InvalidArraySize_ThrowsDescriptiveException)
     {
         auto rt = ref new CanvasRenderTarget(m_sharedDevice, 2, 2, DEFAULT_DPI);
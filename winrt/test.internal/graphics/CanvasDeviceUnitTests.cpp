@@ -485,6 +485,57 @@ public:
 
         Assert::IsTrue(IsSameInstance(d2dBitmap.Get(), actualBitmap.Get()));
     }
+
+    TEST_METHOD_EX(CanvasDevice_DeviceContextPool_SizeAndStatistics)
+    {
+        auto factory = Make<CanvasDeviceFactory>();
+        auto d2dDevice = Make<MockD2DDevice>();
+        auto canvasDevice = Make<StubCanvasDevice>(d2dDevice);
+
+        d2dDevice->MockCreateDeviceContext =
+            [&](D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** value)
+            {
+                ThrowIfFailed(Make<MockD2DDeviceContext>().CopyTo(value));
+            };
+
+        uint32_t maximumSize;
+        CanvasDeviceContextPoolStatistics statistics;
+
+        Assert::AreEqual(E_INVALIDARG, factory->GetDeviceContextPoolMaximumSize(nullptr, &maximumSize));
+        Assert::AreEqual(E_INVALIDARG, factory->GetDeviceContextPoolMaximumSize(canvasDevice.Get(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->SetDeviceContextPoolMaximumSize(nullptr, 1));
+        Assert::AreEqual(E_INVALIDARG, factory->GetDeviceContextPoolStatistics(nullptr, &statistics));
+        Assert::AreEqual(E_INVALIDARG, factory->GetDeviceContextPoolStatistics(canvasDevice.Get(), nullptr));
+
+        ThrowIfFailed(factory->GetDeviceContextPoolMaximumSize(canvasDevice.Get(), &maximumSize));
+        Assert::AreEqual(DeviceContextPool::DefaultMaxPoolSize(), maximumSize);
+
+        ThrowIfFailed(factory->SetDeviceContextPoolMaximumSize(canvasDevice.Get(), 3));
+        Assert::AreEqual(3u, canvasDevice->GetDeviceContextPool()->GetMaxPoolSize());
+
+        Assert::AreEqual(E_INVALIDARG, factory->SetDeviceContextPoolMaximumSize(canvasDevice.Get(), DeviceContextPool::MaxPoolSizeLimit + 1));
+
+        {
+            auto lease1 = canvasDevice->GetResourceCreationDeviceContext();
+            auto lease2 = canvasDevice->GetResourceCreationDeviceContext();
+        }
+        canvasDevice->GetResourceCreationDeviceContext();
+
+        ThrowIfFailed(factory->GetDeviceContextPoolStatistics(canvasDevice.Get(), &statistics));
+        Assert::AreEqual<uint64_t>(3, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(2, statistics.MissCount);
+        Assert::AreEqual<uint64_t>(2, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(0, statistics.DiscardedCount);
+        Assert::AreEqual(0u, statistics.ActiveLeaseCount);
+        Assert::AreEqual(2u, statistics.PeakActiveLeaseCount);
+
+        // Closed devices have no pool.
+        canvasDevice->GetDeviceContextPoolMethod.AllowAnyCall([] { return static_cast<DeviceContextPool*>(nullptr); });
+
+        Assert::AreEqual(RO_E_CLOSED, factory->GetDeviceContextPoolMaximumSize(canvasDevice.Get(), &maximumSize));
+        Assert::AreEqual(RO_E_CLOSED, factory->SetDeviceContextPoolMaximumSize(canvasDevice.Get(), 1));
+        Assert::AreEqual(RO_E_CLOSED, factory->GetDeviceContextPoolStatistics(canvasDevice.Get(), &statistics));
+    }
 };
 
 TEST_CLASS(DefaultDeviceAdapterTests)
@@ -1426,6 +1426,305 @@ public:
         CallDrawImageOverloads<Fixture>(OverloadFilter().Matches(TAKES_DRECT | TAKES_IMAGE | TAKES_INTERPOLATION), 2);
     }
 
+    TEST_METHOD_EX(CanvasDrawingSession_DrawImage_ReusesHelperEffectsAcrossDraws)
+    {
+        DrawImageBitmapFixture f;
+
+        f.DeviceContext->GetTransformMethod.AllowAnyCall();
+        f.DeviceContext->SetTransformMethod.AllowAnyCall();
+
+        std::vector<ComPtr<StubD2DEffect>> createdEffects;
+
+        // Border, DpiCompensation and ColorMatrix, created by the first draw only.
+        f.DeviceContext->CreateEffectMethod.SetExpectedCalls(3,
+            [&](IID const& iid, ID2D1Effect** effect)
+            {
+                auto stubEffect = Make<StubD2DEffect>(iid);
+                createdEffects.push_back(stubEffect);
+                return stubEffect.CopyTo(effect);
+            });
+
+        std::vector<ID2D1Image*> drawnImages;
+
+        f.DeviceContext->DrawImageMethod.AllowAnyCall(
+            [&](ID2D1Image* image, D2D1_POINT_2F const*, D2D1_RECT_F const*, D2D1_INTERPOLATION_MODE, D2D1_COMPOSITE_MODE)
+            {
+                drawnImages.push_back(image);
+            });
+
+        ComPtr<ICanvasBitmap> otherBitmap = f.MakeBitmap();
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto& bitmap = (i % 2) ? otherBitmap : f.Bitmap;
+
+            ThrowIfFailed(f.DS->DrawImageToRectWithSourceRectAndOpacityAndInterpolation(bitmap.Get(), Rect{ 0, 0, 1, 1 }, Rect{ 0, 0, 1, 1 }, 0.5f, CanvasImageInterpolation::Cubic));
+
+            // The pooled DPI compensation effect is re-pointed at each new bitmap.
+            ComPtr<ID2D1Image> compensatedBitmap;
+            createdEffects[1]->GetInput(0, &compensatedBitmap);
+            Assert::IsTrue(IsSameInstance(GetWrappedResource<ID2D1Bitmap>(bitmap).Get(), compensatedBitmap.Get()));
+        }
+
+        Assert::AreEqual<size_t>(4, drawnImages.size());
+
+        for (auto image : drawnImages)
+        {
+            Assert::IsTrue(IsSameInstance(createdEffects[2].Get(), image));
+        }
+
+        auto& statistics = f.DS->GetDrawImageEffectStatistics();
+        Assert::AreEqual<uint64_t>(3, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(9, statistics.ReusedCount);
+    }
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+    struct BatchBitmapDrawsFixture : public DrawImageBitmapFixture
+    {
+        struct SpriteBatchDraw
+        {
+            uint32_t StartIndex;
+            uint32_t SpriteCount;
+            ID2D1Bitmap* Bitmap;
+        };
+
+        ComPtr<MockD2DSpriteBatch> SpriteBatch;
+        std::vector<D2D1_RECT_F> AddedDestinationRects;
+        std::vector<D2D1_RECT_U> AddedSourceRects;
+        std::vector<D2D1_COLOR_F> AddedColors;
+        std::vector<SpriteBatchDraw> SpriteBatchDraws;
+        std::vector<std::wstring> Calls;
+
+        BatchBitmapDrawsFixture()
+            : SpriteBatch(Make<MockD2DSpriteBatch>())
+        {
+            CanvasDevice->IsSpriteBatchQuirkRequiredMethod.AllowAnyCall([] { return false; });
+            DeviceContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_ALIASED; });
+
+            ThrowIfFailed(DS->put_BatchBitmapDraws(true));
+        }
+
+        void ExpectSpriteBatch(uint32_t expectedSpriteCount, uint32_t expectedDrawCount)
+        {
+            DeviceContext->CreateSpriteBatchMethod.SetExpectedCalls(1,
+                [=](ID2D1SpriteBatch** value)
+                {
+                    return SpriteBatch.CopyTo(value);
+                });
+
+            SpriteBatch->AddSpritesMethod.SetExpectedCalls(1,
+                [=](UINT32 count, D2D1_RECT_F const* destinationRects, D2D1_RECT_U const* sourceRects, D2D1_COLOR_F const* colors, D2D1_MATRIX_3X2_F const*, UINT32 destinationRectsStride, UINT32 sourceRectsStride, UINT32 colorsStride, UINT32)
+                {
+                    Assert::AreEqual(expectedSpriteCount, count);
+
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        AddedDestinationRects.push_back(*reinterpret_cast<D2D1_RECT_F const*>(reinterpret_cast<uint8_t const*>(destinationRects) + i * destinationRectsStride));
+                        AddedSourceRects.push_back(*reinterpret_cast<D2D1_RECT_U const*>(reinterpret_cast<uint8_t const*>(sourceRects) + i * sourceRectsStride));
+                        AddedColors.push_back(*reinterpret_cast<D2D1_COLOR_F const*>(reinterpret_cast<uint8_t const*>(colors) + i * colorsStride));
+                    }
+
+                    return S_OK;
+                });
+
+            DeviceContext->DrawSpriteBatchMethod.SetExpectedCalls(expectedDrawCount,
+                [=](ID2D1SpriteBatch* spriteBatch, UINT32 startIndex, UINT32 spriteCount, ID2D1Bitmap* bitmap, D2D1_BITMAP_INTERPOLATION_MODE interpolationMode, D2D1_SPRITE_OPTIONS spriteOptions)
+                {
+                    Assert::IsTrue(IsSameInstance(SpriteBatch.Get(), spriteBatch));
+                    Assert::AreEqual(D2D1_BITMAP_INTERPOLATION_MODE_LINEAR, interpolationMode);
+                    Assert::AreEqual(D2D1_SPRITE_OPTIONS_NONE, spriteOptions);
+
+                    SpriteBatchDraws.push_back(SpriteBatchDraw{ startIndex, spriteCount, bitmap });
+                    Calls.push_back(L"DrawSpriteBatch");
+                });
+        }
+    };
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_DefaultsToFalse)
+    {
+        CanvasDrawingSessionFixture f;
+
+        boolean value = true;
+        ThrowIfFailed(f.DS->get_BatchBitmapDraws(&value));
+        Assert::IsFalse(!!value);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_DrawsHeldBackBitmapsAsRunsOfOneSpriteBatch)
+    {
+        BatchBitmapDrawsFixture f;
+
+        boolean value = false;
+        ThrowIfFailed(f.DS->get_BatchBitmapDraws(&value));
+        Assert::IsTrue(!!value);
+
+        ComPtr<ICanvasBitmap> otherBitmap = f.MakeBitmap();
+        auto otherD2DBitmap = GetWrappedResource<ID2D1Bitmap>(otherBitmap);
+
+        // Nothing reaches the device context while the draws are being made.
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 0, 0 }));
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 10, 0 }));
+        ThrowIfFailed(f.DS->DrawImageAtOffsetWithSourceRectAndOpacity(As<ICanvasImage>(otherBitmap).Get(), Vector2{ 20, 0 }, Rect{ 1, 2, 3, 4 }, 0.5f));
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 30, 0 }));
+
+        f.ExpectSpriteBatch(4, 3);
+
+        ThrowIfFailed(f.DS->Close());
+
+        Assert::AreEqual<size_t>(3, f.SpriteBatchDraws.size());
+
+        // Consecutive draws of the same bitmap share a DrawSpriteBatch call,
+        // but the overall draw order is preserved.
+        Assert::AreEqual(0U, f.SpriteBatchDraws[0].StartIndex);
+        Assert::AreEqual(2U, f.SpriteBatchDraws[0].SpriteCount);
+        Assert::IsTrue(IsSameInstance(f.D2DBitmap.Get(), f.SpriteBatchDraws[0].Bitmap));
+
+        Assert::AreEqual(2U, f.SpriteBatchDraws[1].StartIndex);
+        Assert::AreEqual(1U, f.SpriteBatchDraws[1].SpriteCount);
+        Assert::IsTrue(IsSameInstance(otherD2DBitmap.Get(), f.SpriteBatchDraws[1].Bitmap));
+
+        Assert::AreEqual(3U, f.SpriteBatchDraws[2].StartIndex);
+        Assert::AreEqual(1U, f.SpriteBatchDraws[2].SpriteCount);
+        Assert::IsTrue(IsSameInstance(f.D2DBitmap.Get(), f.SpriteBatchDraws[2].Bitmap));
+
+        Assert::AreEqual(D2D1_RECT_F{ 10, 0, 10 + f.BitmapSize.width, f.BitmapSize.height }, f.AddedDestinationRects[1]);
+        Assert::AreEqual(D2D1_RECT_U{ 0, 0, f.BitmapPixelSize.width, f.BitmapPixelSize.height }, f.AddedSourceRects[1]);
+        Assert::AreEqual(D2D1_COLOR_F{ 1, 1, 1, 1 }, f.AddedColors[1]);
+
+        Assert::AreEqual(D2D1_RECT_F{ 20, 0, 23, 4 }, f.AddedDestinationRects[2]);
+        Assert::AreEqual(D2D1_RECT_U{ 1, 2, 4, 6 }, f.AddedSourceRects[2]);
+        Assert::AreEqual(D2D1_COLOR_F{ 1, 1, 1, 0.5f }, f.AddedColors[2]);
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_StateChangesFlushHeldBackBitmapsFirst)
+    {
+        BatchBitmapDrawsFixture f;
+
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 0, 0 }));
+
+        f.ExpectSpriteBatch(1, 1);
+
+        f.DeviceContext->SetTransformMethod.SetExpectedCalls(1,
+            [&](D2D1_MATRIX_3X2_F const*)
+            {
+                f.Calls.push_back(L"SetTransform");
+            });
+
+        ThrowIfFailed(f.DS->put_Transform(Matrix3x2{ 1, 0, 0, 1, 2, 3 }));
+
+        Assert::AreEqual<size_t>(2, f.Calls.size());
+        Assert::AreEqual(L"DrawSpriteBatch", f.Calls[0].c_str());
+        Assert::AreEqual(L"SetTransform", f.Calls[1].c_str());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_BitmapsThatAreNotSpritesFlushAndDrawDirectly)
+    {
+        BatchBitmapDrawsFixture f;
+
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 0, 0 }));
+
+        f.ExpectSpriteBatch(1, 1);
+
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1,
+            [&](ID2D1Bitmap*, D2D1_RECT_F const*, FLOAT, D2D1_INTERPOLATION_MODE, D2D1_RECT_F const* sourceRect, D2D1_MATRIX_4X4_F const*)
+            {
+                Assert::AreEqual(D2D1_RECT_F{ 0.5f, 0, 1.5f, 1 }, *sourceRect);
+                f.Calls.push_back(L"DrawBitmap");
+            });
+
+        // A source rectangle that doesn't fall on pixel boundaries can't be a sprite.
+        ThrowIfFailed(f.DS->DrawImageAtOffsetWithSourceRect(f.Image.Get(), Vector2{ 0, 0 }, Rect{ 0.5f, 0, 1, 1 }));
+
+        Assert::AreEqual<size_t>(2, f.Calls.size());
+        Assert::AreEqual(L"DrawSpriteBatch", f.Calls[0].c_str());
+        Assert::AreEqual(L"DrawBitmap", f.Calls[1].c_str());
+
+        // Nothing is left to draw when the session closes.
+        ThrowIfFailed(f.DS->Close());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_AntialiasedDrawsOffPixelBoundariesAreDrawnDirectly)
+    {
+        BatchBitmapDrawsFixture f;
+
+        f.DeviceContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_PER_PRIMITIVE; });
+        f.DeviceContext->SetAntialiasModeMethod.AllowAnyCall();
+        f.DeviceContext->GetDpiMethod.AllowAnyCall([](float* dpiX, float* dpiY) { *dpiX = *dpiY = DEFAULT_DPI; });
+        f.DeviceContext->GetTransformMethod.AllowAnyCall([](D2D1_MATRIX_3X2_F* transform) { *transform = D2D1::Matrix3x2F::Scale(2, 2); });
+
+        // Scaled up by two, half a DIP is a whole pixel, so antialiasing makes no difference.
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 0.5f, 0 }));
+
+        f.ExpectSpriteBatch(1, 1);
+
+        f.DeviceContext->DrawBitmapMethod.SetExpectedCalls(1,
+            [&](ID2D1Bitmap*, D2D1_RECT_F const*, FLOAT, D2D1_INTERPOLATION_MODE, D2D1_RECT_F const*, D2D1_MATRIX_4X4_F const*)
+            {
+                f.Calls.push_back(L"DrawBitmap");
+            });
+
+        // But a quarter of a DIP isn't, and a sprite would lose the antialiased edge.
+        ThrowIfFailed(f.DS->DrawImageAtOffset(f.Image.Get(), Vector2{ 0.25f, 0 }));
+
+        Assert::AreEqual<size_t>(2, f.Calls.size());
+        Assert::AreEqual(L"DrawSpriteBatch", f.Calls[0].c_str());
+        Assert::AreEqual(L"DrawBitmap", f.Calls[1].c_str());
+    }
+
+    TEST_METHOD_EX(CanvasDrawingSession_BatchBitmapDraws_ChangingABitmapFlushesHeldBackDrawsOfIt)
+    {
+        BatchBitmapDrawsFixture f;
+
+        auto makeBitmap = [&](ComPtr<StubD2DBitmap>* d2dBitmap)
+        {
+            *d2dBitmap = Make<StubD2DBitmap>();
+            (*d2dBitmap)->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 4, 4 }; });
+            (*d2dBitmap)->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 4, 4 }; });
+            (*d2dBitmap)->GetPixelFormatMethod.AllowAnyCall([] { return D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM); });
+
+            return As<ICanvasBitmap>(Make<CanvasBitmap>(f.CanvasDevice.Get(), d2dBitmap->Get()));
+        };
+
+        ComPtr<StubD2DBitmap> drawnD2DBitmap;
+        ComPtr<StubD2DBitmap> otherD2DBitmap;
+
+        auto drawnBitmap = makeBitmap(&drawnD2DBitmap);
+        auto otherBitmap = makeBitmap(&otherD2DBitmap);
+
+        ThrowIfFailed(f.DS->DrawImageAtOrigin(As<ICanvasImage>(drawnBitmap).Get()));
+
+        // Changing a bitmap that isn't being drawn leaves the batch alone.
+        otherD2DBitmap->CopyFromBitmapMethod.SetExpectedCalls(1,
+            [&](D2D1_POINT_2U const*, ID2D1Bitmap*, D2D1_RECT_U const*)
+            {
+                f.Calls.push_back(L"CopyFromBitmap (other)");
+                return S_OK;
+            });
+
+        ThrowIfFailed(otherBitmap->CopyPixelsFromBitmap(drawnBitmap.Get()));
+
+        f.ExpectSpriteBatch(1, 1);
+
+        drawnD2DBitmap->CopyFromBitmapMethod.SetExpectedCalls(1,
+            [&](D2D1_POINT_2U const*, ID2D1Bitmap*, D2D1_RECT_U const*)
+            {
+                f.Calls.push_back(L"CopyFromBitmap (drawn)");
+                return S_OK;
+            });
+
+        ThrowIfFailed(drawnBitmap->CopyPixelsFromBitmap(otherBitmap.Get()));
+
+        Assert::AreEqual<size_t>(3, f.Calls.size());
+        Assert::AreEqual(L"CopyFromBitmap (other)", f.Calls[0].c_str());
+        Assert::AreEqual(L"DrawSpriteBatch", f.Calls[1].c_str());
+        Assert::AreEqual(L"CopyFromBitmap (drawn)", f.Calls[2].c_str());
+
+        // Nothing is left to draw when the session closes.
+        ThrowIfFailed(f.DS->Close());
+    }
+
+#endif
+
 
     TEST_METHOD_EX(CanvasDrawingSession_DrawImage_GaussianBlurEffect)
     {
@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <random>
+
+#include <lib/geometry/CanvasGeometryIndex.h>
+#include "../mocks/MockD2DRectangleGeometry.h"
+#include "utils/BenchmarkHelpers.h"
+
+//
+// Measures how long it takes to hit-test a large set of geometries with and
+// without a CanvasGeometryIndex.
+//
+// There's no real D2D here, so the geometries are star shaped polygons whose
+// containment test is done on the CPU by the mock.  This measures how much
+// work the index saves by culling, not how expensive D2D's own tests are.
+//
+
+TEST_CLASS(CanvasGeometryIndexBenchmarks)
+{
+    static void Log(wchar_t const* name, size_t geometryCount, size_t pointCount, double milliseconds)
+    {
+        LogBenchmarkMessage(
+            L"%s: %Iu geometries, %Iu points, %.3fms (%.3fms/point)\n",
+            name,
+            geometryCount,
+            pointCount,
+            milliseconds,
+            pointCount > 0 ? milliseconds / pointCount : 0.0);
+    }
+
+    // Even-odd ray casting.
+    static bool PolygonContainsPoint(std::vector<D2D1_POINT_2F> const& vertices, D2D1_POINT_2F const& point)
+    {
+        bool inside = false;
+
+        for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+        {
+            auto& a = vertices[i];
+            auto& b = vertices[j];
+
+            if ((a.y > point.y) != (b.y > point.y) &&
+                point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+            {
+                inside = !inside;
+            }
+        }
+
+        return inside;
+    }
+
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        std::vector<ComPtr<ICanvasGeometry>> Geometries;
+        std::vector<D2D1_POINT_2F> Points;
+
+        Fixture(size_t geometryCount, size_t pointCount)
+            : Device(Make<StubCanvasDevice>())
+        {
+            const float areaSize = 4096;
+
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> position(0, areaSize);
+            std::uniform_real_distribution<float> radius(4, 32);
+            std::uniform_int_distribution<int> pointsOnStar(4, 8);
+
+            for (size_t i = 0; i < geometryCount; ++i)
+            {
+                auto vertices = std::make_shared<std::vector<D2D1_POINT_2F>>(
+                    MakeStar(position(random), position(random), radius(random), pointsOnStar(random)));
+
+                auto bounds = D2D1_RECT_F{ FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+                for (auto& vertex : *vertices)
+                {
+                    bounds.left = std::min(bounds.left, vertex.x);
+                    bounds.top = std::min(bounds.top, vertex.y);
+                    bounds.right = std::max(bounds.right, vertex.x);
+                    bounds.bottom = std::max(bounds.bottom, vertex.y);
+                }
+
+                auto d2dGeometry = Make<MockD2DRectangleGeometry>();
+
+                d2dGeometry->GetBoundsMethod.AllowAnyCall(
+                    [=](CONST D2D1_MATRIX_3X2_F*, D2D1_RECT_F* result)
+                    {
+                        *result = bounds;
+                        return S_OK;
+                    });
+
+                d2dGeometry->FillContainsPointMethod.AllowAnyCall(
+                    [=](D2D1_POINT_2F point, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+                    {
+                        *contains = PolygonContainsPoint(*vertices, point);
+                        return S_OK;
+                    });
+
+                Geometries.push_back(Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get()));
+            }
+
+            for (size_t i = 0; i < pointCount; ++i)
+            {
+                Points.push_back(D2D1_POINT_2F{ position(random), position(random) });
+            }
+        }
+
+        static std::vector<D2D1_POINT_2F> MakeStar(float x, float y, float outerRadius, int pointCount)
+        {
+            std::vector<D2D1_POINT_2F> vertices;
+
+            for (int i = 0; i < pointCount * 2; ++i)
+            {
+                float angle = i * DirectX::XM_PI / pointCount;
+                float r = (i % 2) ? outerRadius / 2 : outerRadius;
+
+                vertices.push_back(D2D1_POINT_2F{ x + r * cosf(angle), y + r * sinf(angle) });
+            }
+
+            return vertices;
+        }
+
+        std::vector<ICanvasGeometry*> GetGeometries()
+        {
+            std::vector<ICanvasGeometry*> geometries;
+
+            for (auto& geometry : Geometries)
+                geometries.push_back(geometry.Get());
+
+            return geometries;
+        }
+    };
+
+    void RunBenchmark(size_t geometryCount, size_t pointCount)
+    {
+        Fixture f(geometryCount, pointCount);
+
+        // Hit-test every geometry, one at a time.
+        std::vector<std::vector<int32_t>> expected(pointCount);
+
+        auto start = BenchmarkClock::now();
+
+        for (size_t i = 0; i < pointCount; ++i)
+        {
+            Vector2 point{ f.Points[i].x, f.Points[i].y };
+
+            for (size_t j = 0; j < geometryCount; ++j)
+            {
+                boolean containsPoint;
+                ThrowIfFailed(f.Geometries[j]->FillContainsPoint(point, &containsPoint));
+
+                if (containsPoint)
+                    expected[i].push_back(static_cast<int32_t>(j));
+            }
+        }
+
+        Log(L"Linear scan", geometryCount, pointCount, ElapsedMilliseconds(start));
+
+        // Build an index, and use it for the same hit-tests.
+        auto geometries = f.GetGeometries();
+        auto factory = Make<CanvasGeometryIndexFactory>();
+
+        start = BenchmarkClock::now();
+
+        ComPtr<ICanvasGeometryIndex> index;
+        ThrowIfFailed(factory->Create(static_cast<uint32_t>(geometries.size()), geometries.data(), &index));
+
+        Log(L"Index creation", geometryCount, 0, ElapsedMilliseconds(start));
+
+        std::vector<std::vector<int32_t>> actual(pointCount);
+
+        start = BenchmarkClock::now();
+
+        for (size_t i = 0; i < pointCount; ++i)
+        {
+            ComArray<int32_t> indices;
+            ThrowIfFailed(index->FindGeometriesContainingPoint(Vector2{ f.Points[i].x, f.Points[i].y }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+
+            actual[i].assign(indices.GetData(), indices.GetData() + indices.GetSize());
+        }
+
+        Log(L"Indexed", geometryCount, pointCount, ElapsedMilliseconds(start));
+
+        Assert::IsTrue(expected == actual);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndexBenchmarks_FindGeometriesContainingPoint)
+    {
+        RunBenchmark(1000, 1000);
+        RunBenchmark(20000, 200);
+    }
+};
@@ -0,0 +1,546 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <random>
+
+#include <lib/geometry/CanvasGeometryIndex.h>
+#include "mocks/MockD2DRectangleGeometry.h"
+
+static const D2D1_MATRIX_3X2_F sc_someD2DTransform = { 1, 2, 3, 4, 5, 6 };
+static const Matrix3x2 sc_someTransform = { 1, 2, 3, 4, 5, 6 };
+
+TEST_CLASS(BoundsTreeTests)
+{
+    static std::vector<uint32_t> FindItems(BoundsTree const& tree, D2D1_RECT_F const& query)
+    {
+        std::vector<uint32_t> items;
+
+        tree.ForEachItemIntersecting(query,
+            [&](uint32_t item, D2D1_RECT_F const&)
+            {
+                items.push_back(item);
+            });
+
+        std::sort(items.begin(), items.end());
+        return items;
+    }
+
+    static std::vector<uint32_t> FindItemsByBruteForce(std::vector<D2D1_RECT_F> const& itemBounds, D2D1_RECT_F const& query)
+    {
+        std::vector<uint32_t> items;
+
+        for (uint32_t i = 0; i < itemBounds.size(); ++i)
+        {
+            if (BoundsTree::Intersects(itemBounds[i], query))
+                items.push_back(i);
+        }
+
+        return items;
+    }
+
+    static D2D1_RECT_F MakeRandomRect(std::mt19937& random, float areaSize, float maximumRectSize)
+    {
+        std::uniform_real_distribution<float> position(0, areaSize);
+        std::uniform_real_distribution<float> size(0, 1);
+
+        auto x = position(random);
+        auto y = position(random);
+
+        return D2D1_RECT_F{ x, y, x + size(random) * maximumRectSize, y + size(random) * maximumRectSize };
+    }
+
+    TEST_METHOD_EX(BoundsTree_WhenEmpty_FindsNothing)
+    {
+        BoundsTree tree;
+
+        Assert::AreEqual(0u, tree.GetItemCount());
+        Assert::IsTrue(FindItems(tree, D2D1_RECT_F{ -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX }).empty());
+
+        BoundsTree treeOfNothing(std::vector<D2D1_RECT_F>{});
+
+        Assert::AreEqual(0u, treeOfNothing.GetItemCount());
+        Assert::IsTrue(FindItems(treeOfNothing, D2D1_RECT_F{ -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX }).empty());
+    }
+
+    TEST_METHOD_EX(BoundsTree_WithOneItem_FindsItWhenQueryTouchesIt)
+    {
+        BoundsTree tree(std::vector<D2D1_RECT_F>{ D2D1_RECT_F{ 10, 10, 20, 20 } });
+
+        Assert::AreEqual(1u, tree.GetItemCount());
+
+        Assert::AreEqual<size_t>(1, FindItems(tree, D2D1_RECT_F{ 15, 15, 15, 15 }).size());
+        Assert::AreEqual<size_t>(1, FindItems(tree, D2D1_RECT_F{ 0, 0, 10, 10 }).size());
+        Assert::AreEqual<size_t>(1, FindItems(tree, D2D1_RECT_F{ 0, 0, 100, 100 }).size());
+        Assert::AreEqual<size_t>(0, FindItems(tree, D2D1_RECT_F{ 21, 10, 30, 20 }).size());
+        Assert::AreEqual<size_t>(0, FindItems(tree, D2D1_RECT_F{ 10, 0, 20, 9 }).size());
+    }
+
+    TEST_METHOD_EX(BoundsTree_EmptyBoundsAndEmptyQueries_NeverMatch)
+    {
+        const float inf = std::numeric_limits<float>::infinity();
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+
+        BoundsTree tree(std::vector<D2D1_RECT_F>
+        {
+            D2D1_RECT_F{ inf, inf, -inf, -inf },    // What D2D reports for empty geometry
+            D2D1_RECT_F{ 10, 10, 0, 0 },
+            D2D1_RECT_F{ nan, nan, nan, nan },
+            D2D1_RECT_F{ 0, 0, 10, 10 },
+        });
+
+        auto items = FindItems(tree, D2D1_RECT_F{ -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX });
+        Assert::AreEqual<size_t>(1, items.size());
+        Assert::AreEqual(3u, items[0]);
+
+        Assert::IsTrue(FindItems(tree, D2D1_RECT_F{ 10, 10, 0, 0 }).empty());
+        Assert::IsTrue(FindItems(tree, D2D1_RECT_F{ nan, nan, nan, nan }).empty());
+    }
+
+    TEST_METHOD_EX(BoundsTree_FindsSameItemsAsBruteForce)
+    {
+        std::mt19937 random(1234);
+
+        // Sizes either side of each multiple of NodeCapacity, so that trees
+        // with partly filled nodes at every level are covered.
+        for (size_t itemCount : { 2, 15, 16, 17, 255, 256, 257, 5000 })
+        {
+            std::vector<D2D1_RECT_F> itemBounds;
+
+            for (size_t i = 0; i < itemCount; ++i)
+            {
+                itemBounds.push_back(MakeRandomRect(random, 1000, 50));
+            }
+
+            BoundsTree tree(itemBounds);
+            Assert::AreEqual(static_cast<uint32_t>(itemCount), tree.GetItemCount());
+
+            for (int i = 0; i < 100; ++i)
+            {
+                auto query = MakeRandomRect(random, 1000, (i % 2) ? 0.0f : 200.0f);
+
+                auto expected = FindItemsByBruteForce(itemBounds, query);
+                auto actual = FindItems(tree, query);
+
+                Assert::IsTrue(expected == actual);
+            }
+        }
+    }
+};
+
+TEST_CLASS(CanvasGeometryIndexTests)
+{
+    // Creates rectangle geometry for the exact tests in FindGeometriesIntersectingRectangle.
+    class D2DFactoryWithRectangleGeometry : public MockD2DFactory
+    {
+    public:
+        ComPtr<MockD2DRectangleGeometry> RectangleGeometry;
+        D2D1_RECT_F LastRectangle;
+        int CreateRectangleGeometryCount;
+
+        D2DFactoryWithRectangleGeometry()
+            : RectangleGeometry(Make<MockD2DRectangleGeometry>())
+            , LastRectangle{}
+            , CreateRectangleGeometryCount(0)
+        {
+        }
+
+        STDMETHOD(CreateRectangleGeometry)(
+            _In_ CONST D2D1_RECT_F* rectangle,
+            _Outptr_ ID2D1RectangleGeometry** rectangleGeometry) override
+        {
+            LastRectangle = *rectangle;
+            ++CreateRectangleGeometryCount;
+            return RectangleGeometry.CopyTo(rectangleGeometry);
+        }
+    };
+
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<CanvasGeometryIndexFactory> IndexFactory;
+        ComPtr<D2DFactoryWithRectangleGeometry> D2DFactory;
+
+        std::vector<ComPtr<MockD2DRectangleGeometry>> D2DGeometries;
+        std::vector<ComPtr<ICanvasGeometry>> Geometries;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , IndexFactory(Make<CanvasGeometryIndexFactory>())
+            , D2DFactory(Make<D2DFactoryWithRectangleGeometry>())
+        {
+        }
+
+        void AddGeometry(D2D1_RECT_F const& bounds)
+        {
+            auto d2dGeometry = Make<MockD2DRectangleGeometry>();
+
+            d2dGeometry->GetBoundsMethod.AllowAnyCall(
+                [=](CONST D2D1_MATRIX_3X2_F*, D2D1_RECT_F* result)
+                {
+                    *result = bounds;
+                    return S_OK;
+                });
+
+            auto d2dFactory = D2DFactory;
+
+            d2dGeometry->GetFactoryMethod.AllowAnyCall(
+                [=](ID2D1Factory** factory)
+                {
+                    d2dFactory.CopyTo(factory);
+                });
+
+            D2DGeometries.push_back(d2dGeometry);
+            Geometries.push_back(Make<CanvasGeometry>(Device.Get(), d2dGeometry.Get()));
+        }
+
+        std::vector<ICanvasGeometry*> GetGeometries()
+        {
+            std::vector<ICanvasGeometry*> geometries;
+
+            for (auto& geometry : Geometries)
+                geometries.push_back(geometry.Get());
+
+            return geometries;
+        }
+
+        ComPtr<ICanvasGeometryIndex> CreateIndex()
+        {
+            auto geometries = GetGeometries();
+
+            ComPtr<ICanvasGeometryIndex> index;
+            ThrowIfFailed(IndexFactory->Create(static_cast<uint32_t>(geometries.size()), geometries.data(), &index));
+            return index;
+        }
+
+        // Three geometries: two side by side, and a third overlapping both.
+        void AddThreeGeometries()
+        {
+            AddGeometry(D2D1_RECT_F{ 0, 0, 10, 10 });
+            AddGeometry(D2D1_RECT_F{ 20, 0, 30, 10 });
+            AddGeometry(D2D1_RECT_F{ 5, 5, 25, 8 });
+        }
+    };
+
+    static void AssertIndicesEqual(std::vector<int32_t> const& expected, ComArray<int32_t>& actual)
+    {
+        Assert::AreEqual(static_cast<uint32_t>(expected.size()), actual.GetSize());
+
+        for (uint32_t i = 0; i < actual.GetSize(); ++i)
+        {
+            Assert::AreEqual(expected[i], actual[i]);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_ImplementsExpectedInterfaces)
+    {
+        Fixture f;
+
+        auto index = f.CreateIndex();
+
+        ASSERT_IMPLEMENTS_INTERFACE(index, ICanvasGeometryIndex);
+        ASSERT_IMPLEMENTS_INTERFACE(index, ABI::Windows::Foundation::IClosable);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Create_NullArgs)
+    {
+        Fixture f;
+        f.AddGeometry(D2D1_RECT_F{ 0, 0, 1, 1 });
+
+        ICanvasGeometry* geometries[] = { f.Geometries[0].Get() };
+        ICanvasGeometry* nullGeometries[] = { nullptr };
+        ComPtr<ICanvasGeometryIndex> index;
+
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->Create(1, nullptr, &index));
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->Create(1, nullGeometries, &index));
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->Create(1, geometries, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(1, nullptr, Matrix3x2{}, 0, &index));
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(1, nullGeometries, Matrix3x2{}, 0, &index));
+        Assert::AreEqual(E_INVALIDARG, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(1, geometries, Matrix3x2{}, 0, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Create_WithNoGeometries_FindsNothing)
+    {
+        Fixture f;
+        auto index = f.CreateIndex();
+
+        int32_t count;
+        Assert::AreEqual(S_OK, index->get_Count(&count));
+        Assert::AreEqual(0, count);
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{}, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        Assert::AreEqual(0u, indices.GetSize());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Create_WhenGeometryIsClosed_ReturnsRoClosed)
+    {
+        Fixture f;
+        f.AddThreeGeometries();
+
+        Assert::AreEqual(S_OK, As<IClosable>(f.Geometries[1])->Close());
+
+        auto geometries = f.GetGeometries();
+        ComPtr<ICanvasGeometryIndex> index;
+
+        Assert::AreEqual(RO_E_CLOSED, f.IndexFactory->Create(3, geometries.data(), &index));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Create_ComputesBoundsWithTransform)
+    {
+        Fixture f;
+        f.AddGeometry(D2D1_RECT_F{ 0, 0, 1, 1 });
+
+        f.D2DGeometries[0]->GetBoundsMethod.SetExpectedCalls(1,
+            [](CONST D2D1_MATRIX_3X2_F* transform, D2D1_RECT_F* bounds)
+            {
+                Assert::AreEqual(sc_someD2DTransform, *transform);
+                *bounds = D2D1_RECT_F{ 0, 0, 1, 1 };
+                return S_OK;
+            });
+
+        auto geometries = f.GetGeometries();
+        ComPtr<ICanvasGeometryIndex> index;
+        Assert::AreEqual(S_OK, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(1, geometries.data(), sc_someTransform, 2.0f, &index));
+
+        int32_t count;
+        Assert::AreEqual(S_OK, index->get_Count(&count));
+        Assert::AreEqual(1, count);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_KeepsWorkingAfterGeometriesAreClosed)
+    {
+        Fixture f;
+        f.AddThreeGeometries();
+
+        auto index = f.CreateIndex();
+
+        for (auto& geometry : f.Geometries)
+            Assert::AreEqual(S_OK, As<IClosable>(geometry)->Close());
+
+        f.D2DGeometries[0]->FillContainsPointMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+            {
+                *contains = TRUE;
+                return S_OK;
+            });
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{ 1, 1 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({ 0 }, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesContainingPoint_OnlyTestsGeometriesWhoseBoundsContainThePoint)
+    {
+        Fixture f;
+        f.AddThreeGeometries();
+
+        auto geometries = f.GetGeometries();
+        ComPtr<ICanvasGeometryIndex> index;
+        Assert::AreEqual(S_OK, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(3, geometries.data(), sc_someTransform, 0.5f, &index));
+
+        // The point is within the bounds of geometries 0 and 2, but only
+        // geometry 2 actually contains it.  Geometry 1 is never tested.
+        f.D2DGeometries[0]->FillContainsPointMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F point, CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, BOOL* contains)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 7, 6 }, point);
+                Assert::AreEqual(sc_someD2DTransform, *transform);
+                Assert::AreEqual(0.5f, tol);
+                *contains = FALSE;
+                return S_OK;
+            });
+
+        f.D2DGeometries[2]->FillContainsPointMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+            {
+                *contains = TRUE;
+                return S_OK;
+            });
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{ 7, 6 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({ 2 }, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesContainingPoint_ReturnsIndicesInIncreasingOrder)
+    {
+        Fixture f;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            f.AddGeometry(D2D1_RECT_F{ 0, 0, 10, 10 });
+
+            f.D2DGeometries.back()->FillContainsPointMethod.SetExpectedCalls(1,
+                [=](D2D1_POINT_2F, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+                {
+                    *contains = (i % 3) == 0;
+                    return S_OK;
+                });
+        }
+
+        auto index = f.CreateIndex();
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{ 5, 5 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+
+        std::vector<int32_t> expected;
+        for (int i = 0; i < 100; i += 3)
+            expected.push_back(i);
+
+        AssertIndicesEqual(expected, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesContainingPoint_IncludesGeometryWithinFlatteningTolerance)
+    {
+        Fixture f;
+        f.AddGeometry(D2D1_RECT_F{ 0, 0, 10, 10 });
+
+        auto geometries = f.GetGeometries();
+        ComPtr<ICanvasGeometryIndex> index;
+        Assert::AreEqual(S_OK, f.IndexFactory->CreateWithTransformAndFlatteningTolerance(1, geometries.data(), sc_someTransform, 2.0f, &index));
+
+        f.D2DGeometries[0]->FillContainsPointMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+            {
+                *contains = TRUE;
+                return S_OK;
+            });
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{ 11, 5 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({ 0 }, indices);
+
+        Assert::AreEqual(S_OK, index->FindGeometriesContainingPoint(Vector2{ 13, 5 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({}, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesWithStrokeContainingPoint_SearchesAsFarAsTheStrokeCanReach)
+    {
+        Fixture f;
+        f.AddGeometry(D2D1_RECT_F{ 0, 0, 10, 10 });
+
+        auto index = f.CreateIndex();
+
+        f.D2DGeometries[0]->StrokeContainsPointMethod.SetExpectedCalls(1,
+            [](D2D1_POINT_2F point, FLOAT strokeWidth, ID2D1StrokeStyle* strokeStyle, CONST D2D1_MATRIX_3X2_F*, FLOAT tol, BOOL* contains)
+            {
+                Assert::AreEqual(D2D1_POINT_2F{ 19, 5 }, point);
+                Assert::AreEqual(2.0f, strokeWidth);
+                Assert::IsNull(strokeStyle);
+                Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tol);
+                *contains = TRUE;
+                return S_OK;
+            });
+
+        // With the default miter limit of 10, a stroke of width 2 can reach
+        // 10 units past the fill bounds, plus the flattening tolerance.
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesWithStrokeContainingPoint(Vector2{ 19, 5 }, 2.0f, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({ 0 }, indices);
+
+        Assert::AreEqual(S_OK, index->FindGeometriesWithStrokeContainingPoint(Vector2{ 21, 5 }, 2.0f, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({}, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesWithStrokeContainingPoint_UsesStrokeStyleToLimitSearch)
+    {
+        Fixture f;
+        f.AddGeometry(D2D1_RECT_F{ 0, 0, 10, 10 });
+
+        auto index = f.CreateIndex();
+
+        auto strokeStyle = Make<CanvasStrokeStyle>();
+        Assert::AreEqual(S_OK, strokeStyle->put_LineJoin(CanvasLineJoin::Round));
+
+        // Without miter joins the stroke can only reach sqrt(2) half widths
+        // past the fill bounds, so a point 2 units away is out of reach of a
+        // width 2 stroke and is never tested.
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesWithStrokeContainingPointWithStrokeStyle(Vector2{ 12, 5 }, 2.0f, strokeStyle.Get(), indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({}, indices);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_FindGeometriesIntersectingRectangle_OnlyTestsGeometriesThatStraddleTheEdge)
+    {
+        Fixture f;
+        f.AddThreeGeometries();
+        f.AddGeometry(D2D1_RECT_F{ 24, 0, 26, 2 });
+
+        auto index = f.CreateIndex();
+
+        // Geometry 0 is entirely inside the rectangle, geometry 3 entirely
+        // outside, and geometries 1 and 2 straddle its edge.  The straddling
+        // geometries share a D2D factory, so share one rectangle geometry.
+        std::vector<ID2D1Geometry*> compared;
+
+        f.D2DFactory->RectangleGeometry->CompareWithGeometryMethod.SetExpectedCalls(2,
+            [&](ID2D1Geometry* geometry, CONST D2D1_MATRIX_3X2_F*, FLOAT, D2D1_GEOMETRY_RELATION* relation)
+            {
+                compared.push_back(geometry);
+
+                *relation = (geometry == f.D2DGeometries[1].Get())
+                    ? D2D1_GEOMETRY_RELATION_DISJOINT
+                    : D2D1_GEOMETRY_RELATION_OVERLAP;
+
+                return S_OK;
+            });
+
+        ComArray<int32_t> indices;
+        Assert::AreEqual(S_OK, index->FindGeometriesIntersectingRectangle(Rect{ -1, -1, 22, 12 }, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        AssertIndicesEqual({ 0, 2 }, indices);
+
+        Assert::AreEqual(1, f.D2DFactory->CreateRectangleGeometryCount);
+        Assert::AreEqual(D2D1_RECT_F{ -1, -1, 21, 11 }, f.D2DFactory->LastRectangle);
+        Assert::AreEqual<size_t>(2, compared.size());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Queries_NullArgs)
+    {
+        Fixture f;
+        auto index = f.CreateIndex();
+
+        ComArray<int32_t> indices;
+
+        Assert::AreEqual(E_INVALIDARG, index->get_Count(nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesContainingPoint(Vector2{}, nullptr, indices.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesContainingPoint(Vector2{}, indices.GetAddressOfSize(), nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesWithStrokeContainingPoint(Vector2{}, 1, nullptr, indices.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesWithStrokeContainingPoint(Vector2{}, 1, indices.GetAddressOfSize(), nullptr));
+
+        auto strokeStyle = Make<CanvasStrokeStyle>();
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesWithStrokeContainingPointWithStrokeStyle(Vector2{}, 1, nullptr, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesWithStrokeContainingPointWithStrokeStyle(Vector2{}, 1, strokeStyle.Get(), nullptr, indices.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesWithStrokeContainingPointWithStrokeStyle(Vector2{}, 1, strokeStyle.Get(), indices.GetAddressOfSize(), nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesIntersectingRectangle(Rect{}, nullptr, indices.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, index->FindGeometriesIntersectingRectangle(Rect{}, indices.GetAddressOfSize(), nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryIndex_Closed)
+    {
+        Fixture f;
+        f.AddThreeGeometries();
+
+        auto index = f.CreateIndex();
+
+        Assert::AreEqual(S_OK, As<IClosable>(index)->Close());
+        Assert::AreEqual(S_OK, As<IClosable>(index)->Close());
+
+        int32_t count;
+        Assert::AreEqual(RO_E_CLOSED, index->get_Count(&count));
+
+        ComArray<int32_t> indices;
+        auto strokeStyle = Make<CanvasStrokeStyle>();
+
+        Assert::AreEqual(RO_E_CLOSED, index->FindGeometriesContainingPoint(Vector2{}, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        Assert::AreEqual(RO_E_CLOSED, index->FindGeometriesWithStrokeContainingPoint(Vector2{}, 1, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        Assert::AreEqual(RO_E_CLOSED, index->FindGeometriesWithStrokeContainingPointWithStrokeStyle(Vector2{}, 1, strokeStyle.Get(), indices.GetAddressOfSize(), indices.GetAddressOfData()));
+        Assert::AreEqual(RO_E_CLOSED, index->FindGeometriesIntersectingRectangle(Rect{}, indices.GetAddressOfSize(), indices.GetAddressOfData()));
+    }
+};
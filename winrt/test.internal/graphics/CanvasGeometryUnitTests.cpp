@@ -14,6 +14,7 @@
 #include "mocks/MockD2DGeometryGroup.h"
 #include "mocks/MockDWriteFont.h"
 #include "mocks/MockGeometryAdapter.h"
+#include "mocks/MockCanvasTriangleReceiver.h"
 #include "stubs/StubGeometrySink.h"
 #include "stubs/StubCanvasTextLayoutAdapter.h"
 
@@ -1228,6 +1229,116 @@ public:
 
         Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithTransformAndFlatteningTolerance(Matrix3x2{}, 0, nullptr, t.GetAddressOfData()));
         Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateWithTransformAndFlatteningTolerance(Matrix3x2{}, 0, t.GetAddressOfSize(), nullptr));
+
+        CanvasTriangleVertices buffer[1];
+        UINT32 writtenCount;
+        UINT32 trianglesCount;
+
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToBuffer(Matrix3x2{}, 0, 1, nullptr, &writtenCount, &trianglesCount));
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToBuffer(Matrix3x2{}, 0, 1, buffer, nullptr, &trianglesCount));
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToBuffer(Matrix3x2{}, 0, 1, buffer, &writtenCount, nullptr));
+
+        Assert::AreEqual(E_INVALIDARG, f.RectangleGeometry->TessellateToReceiver(Matrix3x2{}, 0, nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToBuffer_WritesTrianglesIntoBuffer)
+    {
+        TessellateFixture f;
+
+        const float expectedTolerance = 23;
+
+        f.ExpectOneTessellateCall(sc_someD2DTransform, expectedTolerance);
+
+        CanvasTriangleVertices buffer[4]{};
+        UINT32 writtenCount;
+        UINT32 trianglesCount;
+
+        ThrowIfFailed(f.RectangleGeometry->TessellateToBuffer(sc_someTransform, expectedTolerance, _countof(buffer), buffer, &writtenCount, &trianglesCount));
+
+        Assert::AreEqual(3u, writtenCount);
+        Assert::AreEqual(3u, trianglesCount);
+
+        Assert::AreEqual(sc_triangle1, *ReinterpretAs<D2D1_TRIANGLE const*>(&buffer[0]));
+        Assert::AreEqual(sc_triangle2, *ReinterpretAs<D2D1_TRIANGLE const*>(&buffer[1]));
+        Assert::AreEqual(sc_triangle3, *ReinterpretAs<D2D1_TRIANGLE const*>(&buffer[2]));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToBuffer_WhenBufferIsTooSmall_ReportsRequiredSize)
+    {
+        TessellateFixture f;
+        UINT32 writtenCount;
+        UINT32 trianglesCount;
+
+        // Size query.
+        f.ExpectOneTessellateCall(sc_someD2DTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        ThrowIfFailed(f.RectangleGeometry->TessellateToBuffer(sc_someTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE, 0, nullptr, &writtenCount, &trianglesCount));
+
+        Assert::AreEqual(0u, writtenCount);
+        Assert::AreEqual(3u, trianglesCount);
+
+        // Partially filled buffer.
+        f.ExpectOneTessellateCall(sc_someD2DTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        CanvasTriangleVertices buffer[2]{};
+
+        ThrowIfFailed(f.RectangleGeometry->TessellateToBuffer(sc_someTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE, _countof(buffer), buffer, &writtenCount, &trianglesCount));
+
+        Assert::AreEqual(2u, writtenCount);
+        Assert::AreEqual(3u, trianglesCount);
+
+        Assert::AreEqual(sc_triangle1, *ReinterpretAs<D2D1_TRIANGLE const*>(&buffer[0]));
+        Assert::AreEqual(sc_triangle2, *ReinterpretAs<D2D1_TRIANGLE const*>(&buffer[1]));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToReceiver_PassesOnEachBatch)
+    {
+        TessellateFixture f;
+        auto receiver = Make<MockCanvasTriangleReceiver>();
+
+        const float expectedTolerance = 23;
+
+        f.ExpectOneTessellateCall(sc_someD2DTransform, expectedTolerance);
+
+        int batch = 0;
+
+        receiver->AddTrianglesMethod.SetExpectedCalls(2,
+            [&](UINT32 trianglesCount, CanvasTriangleVertices* triangles)
+            {
+                switch (batch++)
+                {
+                case 0:
+                    Assert::AreEqual(1u, trianglesCount);
+                    Assert::AreEqual(sc_triangle1, *ReinterpretAs<D2D1_TRIANGLE const*>(&triangles[0]));
+                    break;
+
+                case 1:
+                    Assert::AreEqual(2u, trianglesCount);
+                    Assert::AreEqual(sc_triangle2, *ReinterpretAs<D2D1_TRIANGLE const*>(&triangles[0]));
+                    Assert::AreEqual(sc_triangle3, *ReinterpretAs<D2D1_TRIANGLE const*>(&triangles[1]));
+                    break;
+                }
+
+                return S_OK;
+            });
+
+        ThrowIfFailed(f.RectangleGeometry->TessellateToReceiver(sc_someTransform, expectedTolerance, receiver.Get()));
+    }
+
+    TEST_METHOD_EX(CanvasGeometry_TessellateToReceiver_WhenReceiverFails_StopsAndReturnsError)
+    {
+        TessellateFixture f;
+        auto receiver = Make<MockCanvasTriangleReceiver>();
+
+        f.ExpectOneTessellateCall(sc_someD2DTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE);
+
+        receiver->AddTrianglesMethod.SetExpectedCalls(1,
+            [](UINT32, CanvasTriangleVertices*)
+            {
+                return E_ABORT;
+            });
+
+        Assert::AreEqual(E_ABORT, f.RectangleGeometry->TessellateToReceiver(sc_someTransform, D2D1_DEFAULT_FLATTENING_TOLERANCE, receiver.Get()));
     }
 
     TEST_METHOD_EX(CanvasGeometry_Closure)
@@ -1295,6 +1406,11 @@ public:
         Assert::AreEqual(RO_E_CLOSED, canvasGeometry->Tessellate(t.GetAddressOfSize(), t.GetAddressOfData()));
         Assert::AreEqual(RO_E_CLOSED, canvasGeometry->TessellateWithTransformAndFlatteningTolerance(m, 0, t.GetAddressOfSize(), t.GetAddressOfData()));
 
+        UINT32 writtenCount;
+        UINT32 trianglesCount;
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometry->TessellateToBuffer(m, 0, 0, nullptr, &writtenCount, &trianglesCount));
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometry->TessellateToReceiver(m, 0, Make<MockCanvasTriangleReceiver>().Get()));
+
         auto geometrySink = Make<StubGeometrySink>();
         Assert::AreEqual(RO_E_CLOSED, canvasGeometry->SendPathTo(geometrySink.Get()));
 
@@ -1322,6 +1438,276 @@ public:
         Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->get_DefaultFlatteningTolerance(nullptr));
     }
 
+    TEST_METHOD_EX(CanvasGeometryFactory_BatchOperations_NullArgs)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        ICanvasGeometry* geometries[] = { f.RectangleGeometry.Get() };
+        ICanvasGeometry* nullGeometries[] = { nullptr };
+        Vector2 points[] = { Vector2{} };
+
+        ComArray<Rect> bounds;
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeBoundsOfGeometries(1, nullptr, bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeBoundsOfGeometries(1, nullGeometries, bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeBoundsOfGeometries(1, geometries, nullptr, bounds.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeBoundsOfGeometries(1, geometries, bounds.GetAddressOfSize(), nullptr));
+
+        ComArray<float> areas;
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeAreasOfGeometries(1, nullptr, areas.GetAddressOfSize(), areas.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeAreasOfGeometries(1, nullGeometries, areas.GetAddressOfSize(), areas.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeAreasOfGeometries(1, geometries, nullptr, areas.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->ComputeAreasOfGeometries(1, geometries, areas.GetAddressOfSize(), nullptr));
+
+        ComArray<boolean> results;
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->FillContainsPoints(1, nullptr, 1, points, results.GetAddressOfSize(), results.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->FillContainsPoints(1, nullGeometries, 1, points, results.GetAddressOfSize(), results.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->FillContainsPoints(1, geometries, 1, nullptr, results.GetAddressOfSize(), results.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->FillContainsPoints(1, geometries, 1, points, nullptr, results.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->FillContainsPoints(1, geometries, 1, points, results.GetAddressOfSize(), nullptr));
+
+        ComArray<CanvasGeometryRelation> relations;
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->CompareGeometriesWith(1, nullptr, f.EllipseGeometry.Get(), relations.GetAddressOfSize(), relations.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->CompareGeometriesWith(1, nullGeometries, f.EllipseGeometry.Get(), relations.GetAddressOfSize(), relations.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->CompareGeometriesWith(1, geometries, nullptr, relations.GetAddressOfSize(), relations.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->CompareGeometriesWith(1, geometries, f.EllipseGeometry.Get(), nullptr, relations.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, canvasGeometryFactory->CompareGeometriesWith(1, geometries, f.EllipseGeometry.Get(), relations.GetAddressOfSize(), nullptr));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_BatchOperations_WithNoGeometries_ReturnEmptyArrays)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        ComArray<Rect> bounds;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->ComputeBoundsOfGeometries(0, nullptr, bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+        Assert::AreEqual(0u, bounds.GetSize());
+
+        ComArray<boolean> results;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->FillContainsPoints(0, nullptr, 0, nullptr, results.GetAddressOfSize(), results.GetAddressOfData()));
+        Assert::AreEqual(0u, results.GetSize());
+
+        ComArray<CanvasGeometryRelation> relations;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->CompareGeometriesWith(0, nullptr, f.EllipseGeometry.Get(), relations.GetAddressOfSize(), relations.GetAddressOfData()));
+        Assert::AreEqual(0u, relations.GetSize());
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_BatchOperations_WhenGeometryIsClosed_ReturnRoClosed)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        ICanvasGeometry* geometries[] = { f.RectangleGeometry.Get(), f.EllipseGeometry.Get() };
+        Vector2 points[] = { Vector2{} };
+
+        Assert::AreEqual(S_OK, As<IClosable>(f.EllipseGeometry)->Close());
+
+        ComArray<Rect> bounds;
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometryFactory->ComputeBoundsOfGeometries(2, geometries, bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+
+        ComArray<float> areas;
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometryFactory->ComputeAreasOfGeometries(2, geometries, areas.GetAddressOfSize(), areas.GetAddressOfData()));
+
+        ComArray<boolean> results;
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometryFactory->FillContainsPoints(2, geometries, 1, points, results.GetAddressOfSize(), results.GetAddressOfData()));
+
+        ComArray<CanvasGeometryRelation> relations;
+        Assert::AreEqual(RO_E_CLOSED, canvasGeometryFactory->CompareGeometriesWith(1, geometries, f.EllipseGeometry.Get(), relations.GetAddressOfSize(), relations.GetAddressOfData()));
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_ComputeBoundsOfGeometries)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        f.D2DRectangleGeometry->GetBoundsMethod.SetExpectedCalls(1,
+            [=](CONST D2D1_MATRIX_3X2_F* transform, D2D1_RECT_F* bounds)
+            {
+                Assert::AreEqual(sc_identityD2DTransform, *transform);
+                *bounds = D2D1_RECT_F{ 1, 2, 1 + 3, 2 + 4 };
+                return S_OK;
+            });
+
+        f.D2DEllipseGeometry->GetBoundsMethod.SetExpectedCalls(1,
+            [=](CONST D2D1_MATRIX_3X2_F* transform, D2D1_RECT_F* bounds)
+            {
+                Assert::AreEqual(sc_identityD2DTransform, *transform);
+                *bounds = D2D1_RECT_F{ 5, 6, 5 + 7, 6 + 8 };
+                return S_OK;
+            });
+
+        ICanvasGeometry* geometries[] = { f.RectangleGeometry.Get(), f.EllipseGeometry.Get() };
+
+        ComArray<Rect> bounds;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->ComputeBoundsOfGeometries(2, geometries, bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+
+        Assert::AreEqual(2u, bounds.GetSize());
+        Assert::AreEqual(Rect{ 1, 2, 3, 4 }, bounds[0]);
+        Assert::AreEqual(Rect{ 5, 6, 7, 8 }, bounds[1]);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_ComputeAreasOfGeometries)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        f.D2DRectangleGeometry->ComputeAreaMethod.SetExpectedCalls(1,
+            [=](CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, float* area)
+            {
+                Assert::AreEqual(sc_identityD2DTransform, *transform);
+                Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tol);
+                *area = 123.0f;
+                return S_OK;
+            });
+
+        f.D2DEllipseGeometry->ComputeAreaMethod.SetExpectedCalls(1,
+            [=](CONST D2D1_MATRIX_3X2_F*, FLOAT, float* area)
+            {
+                *area = 456.0f;
+                return S_OK;
+            });
+
+        ICanvasGeometry* geometries[] = { f.EllipseGeometry.Get(), f.RectangleGeometry.Get() };
+
+        ComArray<float> areas;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->ComputeAreasOfGeometries(2, geometries, areas.GetAddressOfSize(), areas.GetAddressOfData()));
+
+        Assert::AreEqual(2u, areas.GetSize());
+        Assert::AreEqual(456.0f, areas[0]);
+        Assert::AreEqual(123.0f, areas[1]);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_FillContainsPoints_PacksResultsByGeometryThenPoint)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        // The rectangle contains points with x < 10, the ellipse points with y < 10.
+        f.D2DRectangleGeometry->FillContainsPointMethod.SetExpectedCalls(3,
+            [=](D2D1_POINT_2F point, CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, BOOL* contains)
+            {
+                Assert::AreEqual(sc_identityD2DTransform, *transform);
+                Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tol);
+                *contains = point.x < 10;
+                return S_OK;
+            });
+
+        f.D2DEllipseGeometry->FillContainsPointMethod.SetExpectedCalls(3,
+            [=](D2D1_POINT_2F point, CONST D2D1_MATRIX_3X2_F*, FLOAT, BOOL* contains)
+            {
+                *contains = point.y < 10;
+                return S_OK;
+            });
+
+        ICanvasGeometry* geometries[] = { f.RectangleGeometry.Get(), f.EllipseGeometry.Get() };
+        Vector2 points[] = { Vector2{ 0, 20 }, Vector2{ 20, 0 }, Vector2{ 20, 20 } };
+
+        ComArray<boolean> results;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->FillContainsPoints(2, geometries, 3, points, results.GetAddressOfSize(), results.GetAddressOfData()));
+
+        Assert::AreEqual(6u, results.GetSize());
+        Assert::IsTrue(!!results[0]);
+        Assert::IsFalse(!!results[1]);
+        Assert::IsFalse(!!results[2]);
+        Assert::IsFalse(!!results[3]);
+        Assert::IsTrue(!!results[4]);
+        Assert::IsFalse(!!results[5]);
+    }
+
+    TEST_METHOD_EX(CanvasGeometryFactory_CompareGeometriesWith)
+    {
+        GeometryOperationsFixture_DoesNotOutputToTempPathBuilder f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        auto otherGeometry = Make<CanvasGeometry>(f.Device.Get(), Make<MockD2DRectangleGeometry>().Get());
+        auto d2dOtherGeometry = GetWrappedResource<ID2D1Geometry>(otherGeometry);
+
+        f.D2DRectangleGeometry->CompareWithGeometryMethod.SetExpectedCalls(1,
+            [&](ID2D1Geometry* other, CONST D2D1_MATRIX_3X2_F* transform, FLOAT tol, D2D1_GEOMETRY_RELATION* relation)
+            {
+                Assert::AreEqual(d2dOtherGeometry.Get(), other);
+                Assert::AreEqual(sc_identityD2DTransform, *transform);
+                Assert::AreEqual(D2D1_DEFAULT_FLATTENING_TOLERANCE, tol);
+                *relation = D2D1_GEOMETRY_RELATION_CONTAINS;
+                return S_OK;
+            });
+
+        f.D2DEllipseGeometry->CompareWithGeometryMethod.SetExpectedCalls(1,
+            [&](ID2D1Geometry* other, CONST D2D1_MATRIX_3X2_F*, FLOAT, D2D1_GEOMETRY_RELATION* relation)
+            {
+                Assert::AreEqual(d2dOtherGeometry.Get(), other);
+                *relation = D2D1_GEOMETRY_RELATION_DISJOINT;
+                return S_OK;
+            });
+
+        ICanvasGeometry* geometries[] = { f.RectangleGeometry.Get(), f.EllipseGeometry.Get() };
+
+        ComArray<CanvasGeometryRelation> relations;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->CompareGeometriesWith(2, geometries, otherGeometry.Get(), relations.GetAddressOfSize(), relations.GetAddressOfData()));
+
+        Assert::AreEqual(2u, relations.GetSize());
+        Assert::AreEqual(CanvasGeometryRelation::Contains, relations[0]);
+        Assert::AreEqual(CanvasGeometryRelation::Disjoint, relations[1]);
+    }
+
+    // CallCounter isn't thread-safe, so geometries used by the multi-threaded
+    // tests override GetBounds directly rather than going through the mock.
+    class D2DGeometryWithFixedBounds : public MockD2DRectangleGeometry
+    {
+        D2D1_RECT_F m_bounds;
+        HRESULT m_hr;
+
+    public:
+        D2DGeometryWithFixedBounds(D2D1_RECT_F const& bounds, HRESULT hr = S_OK)
+            : m_bounds(bounds)
+            , m_hr(hr)
+        {
+        }
+
+        IFACEMETHODIMP GetBounds(CONST D2D1_MATRIX_3X2_F*, D2D1_RECT_F* bounds) const override
+        {
+            *bounds = m_bounds;
+            return m_hr;
+        }
+    };
+
+    TEST_METHOD_EX(CanvasGeometryFactory_ComputeBoundsOfGeometries_WithManyGeometries_ReturnsResultsInOrder)
+    {
+        Fixture f;
+        auto canvasGeometryFactory = Make<CanvasGeometryFactory>();
+
+        const uint32_t geometryCount = 10000;
+
+        std::vector<ComPtr<ICanvasGeometry>> geometries;
+        std::vector<ICanvasGeometry*> rawGeometries;
+
+        for (uint32_t i = 0; i < geometryCount; ++i)
+        {
+            auto x = static_cast<float>(i);
+            auto d2dGeometry = Make<D2DGeometryWithFixedBounds>(D2D1_RECT_F{ x, 0, x + 1, 1 });
+
+            geometries.push_back(Make<CanvasGeometry>(f.Device.Get(), d2dGeometry.Get()));
+            rawGeometries.push_back(geometries.back().Get());
+        }
+
+        ComArray<Rect> bounds;
+        Assert::AreEqual(S_OK, canvasGeometryFactory->ComputeBoundsOfGeometries(geometryCount, rawGeometries.data(), bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+
+        Assert::AreEqual(geometryCount, bounds.GetSize());
+
+        for (uint32_t i = 0; i < geometryCount; ++i)
+        {
+            Assert::AreEqual(Rect{ static_cast<float>(i), 0, 1, 1 }, bounds[i]);
+        }
+
+        // Errors from whichever thread processed the failing geometry are passed back to the caller.
+        auto failingGeometry = Make<D2DGeometryWithFixedBounds>(D2D1_RECT_F{}, E_NOTIMPL);
+        auto failingCanvasGeometry = Make<CanvasGeometry>(f.Device.Get(), failingGeometry.Get());
+        rawGeometries[geometryCount - 1] = failingCanvasGeometry.Get();
+
+        Assert::AreEqual(E_NOTIMPL, canvasGeometryFactory->ComputeBoundsOfGeometries(geometryCount, rawGeometries.data(), bounds.GetAddressOfSize(), bounds.GetAddressOfData()));
+    }
+
     TEST_METHOD_EX(CanvasGeometry_get_Device)
     {
         Fixture f;
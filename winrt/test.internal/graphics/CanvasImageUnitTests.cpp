@@ -831,6 +831,187 @@ TEST_CLASS(CanvasImageHistogramUnitTests)
         TestComputeHistogram(123);
     }
 
+    TEST_METHOD_EX(CanvasImage_ComputeHistograms_InvalidArgs)
+    {
+        auto factory = Make<CanvasImageFactory>();
+        auto canvasDevice = Make<StubCanvasDevice>();
+        auto bitmap = CreateStubCanvasBitmap();
+        Rect rects[] = { { 1, 2, 3, 4 } };
+        EffectChannelSelect channels[] = { EffectChannelSelect::Red };
+        ComArray<float> result;
+
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(nullptr,      1, rects,   canvasDevice.Get(), 1, channels, 64,   result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, nullptr, canvasDevice.Get(), 1, channels, 64,   result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   nullptr,            1, channels, 64,   result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   canvasDevice.Get(), 1, nullptr,  64,   result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   canvasDevice.Get(), 1, channels, 64,   nullptr,                   result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   canvasDevice.Get(), 1, channels, 64,   result.GetAddressOfSize(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   canvasDevice.Get(), 1, channels, 1,    result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(E_INVALIDARG, factory->ComputeHistograms(bitmap.Get(), 1, rects,   canvasDevice.Get(), 1, channels, 1025, result.GetAddressOfSize(), result.GetAddressOfData()));
+    }
+
+    TEST_METHOD_EX(CanvasImage_ComputeHistograms_WithNoRegionsOrChannels_ReturnsEmptyArray)
+    {
+        auto factory = Make<CanvasImageFactory>();
+        auto canvasDevice = Make<StubCanvasDevice>();
+        auto bitmap = CreateStubCanvasBitmap();
+        EffectChannelSelect channels[] = { EffectChannelSelect::Red };
+        ComArray<float> result;
+
+        ThrowIfFailed(factory->ComputeHistograms(bitmap.Get(), 0, nullptr, canvasDevice.Get(), 1, channels, 64, result.GetAddressOfSize(), result.GetAddressOfData()));
+        Assert::AreEqual(0u, result.GetSize());
+    }
+
+    TEST_METHOD_EX(CanvasImage_ComputeHistograms_BatchesDrawsAndPacksResults)
+    {
+        auto factory = Make<CanvasImageFactory>();
+        auto canvasDevice = Make<StubCanvasDevice>();
+        auto d2dContext = Make<MockD2DDeviceContext>();
+        auto canvasBitmap = CreateStubCanvasBitmap();
+        const int numBins = 3;
+
+        // 9 regions x 2 channels = 18 histograms, which takes two batches of at most 16.
+        std::vector<Rect> regions;
+
+        for (int i = 0; i < 9; i++)
+        {
+            regions.push_back(Rect{ static_cast<float>(i), 0, 1, 1 });
+        }
+
+        EffectChannelSelect channels[] = { EffectChannelSelect::Blue, EffectChannelSelect::Alpha };
+
+        canvasDevice->GetResourceCreationDeviceContextMethod.SetExpectedCalls(1, [&]
+        {
+            return DeviceContextLease(d2dContext);
+        });
+
+        std::vector<CanvasDevice::HistogramAndAtlasEffects> leased;
+
+        canvasDevice->LeaseHistogramEffectMethod.SetExpectedCalls(16, [&](ID2D1DeviceContext*)
+        {
+            auto histogramEffect = Make<MockD2DEffectThatCountsCalls>(CLSID_D2D1Histogram);
+            auto atlasEffect = Make<MockD2DEffectThatCountsCalls>(CLSID_D2D1Atlas);
+
+            atlasEffect->MockGetOutput = [atlas = atlasEffect.Get()](ID2D1Image** output)
+            {
+                atlas->AddRef();
+                *output = atlas;
+            };
+
+            // Report bins that identify which region and channel the histogram was configured for.
+            histogramEffect->MockGetValue = [histogram = histogramEffect.Get(), atlas = atlasEffect.Get()](UINT32 index, D2D1_PROPERTY_TYPE, BYTE* data, UINT32 dataSize)
+            {
+                Assert::AreEqual<uint32_t>(D2D1_HISTOGRAM_PROP_HISTOGRAM_OUTPUT, index);
+                Assert::AreEqual<size_t>(numBins * sizeof(float), dataSize);
+
+                auto rect = *reinterpret_cast<D2D1_RECT_F*>(atlas->m_properties[D2D1_ATLAS_PROP_INPUT_RECT].data());
+                auto channel = *reinterpret_cast<int*>(histogram->m_properties[D2D1_HISTOGRAM_PROP_CHANNEL_SELECT].data());
+
+                for (int i = 0; i < numBins; i++)
+                {
+                    reinterpret_cast<float*>(data)[i] = rect.left * 100 + channel * 10 + i;
+                }
+
+                return S_OK;
+            };
+
+            leased.push_back(CanvasDevice::HistogramAndAtlasEffects{ histogramEffect, atlasEffect });
+            return leased.back();
+        });
+
+        canvasDevice->ReleaseHistogramEffectMethod.SetExpectedCalls(16, [&](CanvasDevice::HistogramAndAtlasEffects releasing)
+        {
+            auto atlas = static_cast<MockD2DEffectThatCountsCalls*>(releasing.AtlasEffect.Get());
+            Assert::IsNull(atlas->m_inputs[0].Get());
+        });
+
+        d2dContext->BeginDrawMethod.SetExpectedCalls(2);
+        d2dContext->EndDrawMethod.SetExpectedCalls(2);
+        d2dContext->DrawImageMethod.SetExpectedCalls(18);
+
+        ComArray<float> result;
+        ThrowIfFailed(factory->ComputeHistograms(canvasBitmap.Get(), static_cast<uint32_t>(regions.size()), regions.data(), canvasDevice.Get(), _countof(channels), channels, numBins, result.GetAddressOfSize(), result.GetAddressOfData()));
+
+        Assert::AreEqual(9u * 2u * numBins, result.GetSize());
+
+        for (int region = 0; region < 9; region++)
+        {
+            for (int channel = 0; channel < 2; channel++)
+            {
+                for (int bin = 0; bin < numBins; bin++)
+                {
+                    auto expected = region * 100.0f + static_cast<int>(channels[channel]) * 10 + bin;
+                    Assert::AreEqual(expected, result[(region * 2 + channel) * numBins + bin]);
+                }
+            }
+        }
+
+        // Every histogram effect was only hooked up to its atlas effect once.
+        for (auto& effects : leased)
+        {
+            Assert::AreEqual(1, static_cast<MockD2DEffectThatCountsCalls*>(effects.HistogramEffect.Get())->m_setInputCalls);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasImage_ComputeReferenceHistogram)
+    {
+        // A 4x2 image whose red channel runs from black to white.
+        Color pixels[] =
+        {
+            { 255, 0,   0, 0 }, { 255, 85,  0, 0 }, { 255, 170, 0, 0 }, { 255, 255, 0, 0 },
+            { 255, 0,   0, 0 }, { 255, 0,   0, 0 }, { 255, 255, 0, 0 }, { 255, 255, 0, 0 },
+        };
+
+        float values[4];
+
+        // Whole image.
+        ComputeReferenceHistogram(pixels, 4, 2, Rect{ 0, 0, 4, 2 }, EffectChannelSelect::Red, 4, values);
+        Assert::AreEqual(3 / 8.0f, values[0]);
+        Assert::AreEqual(1 / 8.0f, values[1]);
+        Assert::AreEqual(1 / 8.0f, values[2]);
+        Assert::AreEqual(3 / 8.0f, values[3]);
+
+        // Only pixels whose centers are inside the region are counted.
+        ComputeReferenceHistogram(pixels, 4, 2, Rect{ 1.6f, 0, 2, 2.5f }, EffectChannelSelect::Red, 4, values);
+        Assert::AreEqual(0.0f,   values[0]);
+        Assert::AreEqual(0.0f,   values[1]);
+        Assert::AreEqual(0.25f,  values[2]);
+        Assert::AreEqual(0.75f,  values[3]);
+
+        // Alpha is fully opaque everywhere.
+        ComputeReferenceHistogram(pixels, 4, 2, Rect{ 0, 0, 4, 2 }, EffectChannelSelect::Alpha, 2, values);
+        Assert::AreEqual(0.0f, values[0]);
+        Assert::AreEqual(1.0f, values[1]);
+
+        // Empty regions produce empty histograms.
+        ComputeReferenceHistogram(pixels, 4, 2, Rect{ 10, 10, 1, 1 }, EffectChannelSelect::Red, 2, values);
+        Assert::AreEqual(0.0f, values[0]);
+        Assert::AreEqual(0.0f, values[1]);
+
+        ExpectHResultException(E_INVALIDARG, [&] { ComputeReferenceHistogram(pixels, 4, 2, Rect{ 0, 0, 4, 2 }, EffectChannelSelect::Red, 1, values); });
+    }
+
+    TEST_METHOD_EX(CanvasImage_ComputeReferenceHistogram_PremultipliesTranslucentPixels)
+    {
+        // Straight alpha red of 255 at alpha 255, 64 and 0.  Premultiplied, the
+        // reds are 255, 64 and 0.
+        Color pixels[] =
+        {
+            { 255, 255, 0, 0 }, { 64, 255, 0, 0 }, { 0, 255, 0, 0 },
+        };
+
+        float values[2];
+
+        ComputeReferenceHistogram(pixels, 3, 1, Rect{ 0, 0, 3, 1 }, EffectChannelSelect::Red, 2, values);
+        Assert::AreEqual(2 / 3.0f, values[0]);
+        Assert::AreEqual(1 / 3.0f, values[1]);
+
+        // Alpha itself is not affected.
+        ComputeReferenceHistogram(pixels, 3, 1, Rect{ 0, 0, 3, 1 }, EffectChannelSelect::Alpha, 2, values);
+        Assert::AreEqual(2 / 3.0f, values[0]);
+        Assert::AreEqual(1 / 3.0f, values[1]);
+    }
+
     TEST_METHOD_EX(CanvasImage_ComputeHistogram_ReusesHistogramEffect)
     {
         auto deviceAdapter = std::make_shared<TestDeviceAdapter>();
@@ -926,17 +1107,24 @@ TEST_CLASS(CanvasImageHistogramUnitTests)
         AssertExpectedRefCount(d2dAtlas1.Get(), 2);
         AssertExpectedRefCount(d2dAtlas2.Get(), 2);
 
-        // Releasing the second effects should swap them with the ones the device is currently holding.
+        // Releasing the second effects should pool them alongside the first.
         deviceInternal->ReleaseHistogramEffect(std::move(effects2));
 
         Assert::IsNull(effects2.HistogramEffect.Get());
         Assert::IsNull(effects2.AtlasEffect.Get());
 
-        AssertExpectedRefCount(d2dHistogram1.Get(), 1);
+        AssertExpectedRefCount(d2dHistogram1.Get(), 2);
         AssertExpectedRefCount(d2dHistogram2.Get(), 2);
-        AssertExpectedRefCount(d2dAtlas1.Get(), 1);
+        AssertExpectedRefCount(d2dAtlas1.Get(), 2);
         AssertExpectedRefCount(d2dAtlas2.Get(), 2);
 
+        auto statistics = deviceInternal->GetHistogramEffectPool()->GetStatistics();
+
+        Assert::AreEqual<uint64_t>(3, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(1, statistics.ReusedCount);
+        Assert::AreEqual<uint64_t>(2, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(0, statistics.DiscardedCount);
+
         // Closing the device should release everything.
         canvasDevice->Close();
 
@@ -946,6 +1134,52 @@ TEST_CLASS(CanvasImageHistogramUnitTests)
         AssertExpectedRefCount(d2dAtlas2.Get(), 1);
     }
 
+    TEST_METHOD_EX(CanvasImage_HistogramEffectPool_CapacityAndStatistics)
+    {
+        auto factory = Make<CanvasImageFactory>();
+        auto canvasDevice = Make<StubCanvasDevice>();
+        auto d2dContext = Make<MockD2DDeviceContext>();
+        auto pool = canvasDevice->GetHistogramEffectPool();
+
+        uint32_t capacity;
+        CanvasHistogramEffectPoolStatistics statistics;
+
+        Assert::AreEqual(E_INVALIDARG, factory->GetHistogramEffectPoolCapacity(nullptr, &capacity));
+        Assert::AreEqual(E_INVALIDARG, factory->GetHistogramEffectPoolCapacity(canvasDevice.Get(), nullptr));
+        Assert::AreEqual(E_INVALIDARG, factory->SetHistogramEffectPoolCapacity(nullptr, 1));
+        Assert::AreEqual(E_INVALIDARG, factory->GetHistogramEffectPoolStatistics(nullptr, &statistics));
+        Assert::AreEqual(E_INVALIDARG, factory->GetHistogramEffectPoolStatistics(canvasDevice.Get(), nullptr));
+
+        ThrowIfFailed(factory->GetHistogramEffectPoolCapacity(canvasDevice.Get(), &capacity));
+        Assert::AreEqual(static_cast<uint32_t>(HistogramEffectPool::DefaultCapacity), capacity);
+
+        ThrowIfFailed(factory->SetHistogramEffectPoolCapacity(canvasDevice.Get(), 3));
+        Assert::AreEqual(3u, pool->GetCapacity());
+
+        Assert::AreEqual(E_INVALIDARG, factory->SetHistogramEffectPoolCapacity(canvasDevice.Get(), HistogramEffectPool::MaximumCapacity + 1));
+
+        d2dContext->CreateEffectMethod.AllowAnyCall([](IID const& iid, ID2D1Effect** effect)
+        {
+            return Make<StubD2DEffect>(iid).CopyTo(effect);
+        });
+
+        pool->Release(pool->Lease(d2dContext.Get()));
+        pool->Release(pool->Lease(d2dContext.Get()));
+
+        ThrowIfFailed(factory->GetHistogramEffectPoolStatistics(canvasDevice.Get(), &statistics));
+        Assert::AreEqual<uint64_t>(2, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(1, statistics.ReusedCount);
+        Assert::AreEqual<uint64_t>(1, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(0, statistics.DiscardedCount);
+
+        // Closed devices have no pool.
+        canvasDevice->GetHistogramEffectPoolMethod.AllowAnyCall([] { return std::shared_ptr<HistogramEffectPool>(); });
+
+        Assert::AreEqual(RO_E_CLOSED, factory->GetHistogramEffectPoolCapacity(canvasDevice.Get(), &capacity));
+        Assert::AreEqual(RO_E_CLOSED, factory->SetHistogramEffectPoolCapacity(canvasDevice.Get(), 1));
+        Assert::AreEqual(RO_E_CLOSED, factory->GetHistogramEffectPoolStatistics(canvasDevice.Get(), &statistics));
+    }
+
     static void AssertExpectedRefCount(ID2D1Effect* ptr, unsigned long expected)
     {
         ptr->AddRef();
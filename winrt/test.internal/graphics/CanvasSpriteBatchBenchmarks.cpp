@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#if WINVER > _WIN32_WINNT_WINBLUE
+
+#include <lib/drawing/CanvasSpriteBatch.h>
+#include "../mocks/MockD2DSpriteBatch.h"
+#include "utils/BenchmarkHelpers.h"
+
+//
+// Measures how long it takes to sort and build up sprite batches.
+//
+
+TEST_CLASS(CanvasSpriteBatchBenchmarks)
+{
+    static void Log(wchar_t const* name, size_t spriteCount, size_t bitmapCount, double milliseconds)
+    {
+        LogBenchmarkMessage(
+            L"%s: %Iu sprites, %Iu bitmaps, %.3fms (%.1f sprites/us)\n",
+            name,
+            spriteCount,
+            bitmapCount,
+            milliseconds,
+            milliseconds > 0 ? spriteCount / (milliseconds * 1000.0) : 0.0);
+    }
+
+    struct Fixture
+    {
+        std::vector<ComPtr<StubD2DBitmap>> Bitmaps;
+
+        Fixture(size_t bitmapCount)
+        {
+            for (size_t i = 0; i < bitmapCount; ++i)
+                Bitmaps.push_back(Make<StubD2DBitmap>());
+        }
+
+        // Sprites cycle through the bitmaps in a fixed, but scrambled, order.
+        // The destination rect's left coordinate records the original index
+        // so that stability can be checked afterwards.
+        std::vector<Sprite> MakeSprites(size_t spriteCount)
+        {
+            std::vector<Sprite> sprites;
+            sprites.reserve(spriteCount);
+
+            for (size_t i = 0; i < spriteCount; ++i)
+            {
+                auto& bitmap = Bitmaps[(i * 7 + i / 3) % Bitmaps.size()];
+
+                sprites.emplace_back(
+                    As<ID2D1Bitmap>(bitmap),
+                    D2D1_RECT_F{ static_cast<float>(i), 0, 0, 0 },
+                    D2D1_RECT_U{ 0, 0, 1, 1 },
+                    Vector4{ 1, 1, 1, 1 });
+            }
+
+            return sprites;
+        }
+
+        static void Validate(std::vector<Sprite> const& sprites)
+        {
+            std::set<ID2D1Bitmap*> finishedBitmaps;
+
+            for (size_t i = 1; i < sprites.size(); ++i)
+            {
+                auto& previous = sprites[i - 1];
+                auto& current = sprites[i];
+
+                if (previous.Bitmap != current.Bitmap)
+                {
+                    // Each bitmap must appear in exactly one run
+                    Assert::IsTrue(finishedBitmaps.insert(previous.Bitmap.Get()).second);
+                    Assert::IsTrue(finishedBitmaps.find(current.Bitmap.Get()) == finishedBitmaps.end());
+                }
+                else
+                {
+                    // Sprites within a run must keep their original order
+                    Assert::IsTrue(previous.DestinationRect.left < current.DestinationRect.left);
+                }
+            }
+        }
+    };
+
+    static void BuildBatch(ID2D1SpriteBatch* spriteBatch, std::vector<Sprite> const& sprites)
+    {
+        auto firstSprite = &sprites.front();
+        auto stride = static_cast<uint32_t>(sizeof(Sprite));
+
+        ThrowIfFailed(spriteBatch->AddSprites(
+            static_cast<uint32_t>(sprites.size()),
+            &firstSprite->DestinationRect,
+            &firstSprite->SourceRect,
+            &firstSprite->Color,
+            &firstSprite->Transform,
+            stride,
+            stride,
+            stride,
+            stride));
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatchBenchmarks_SortByBitmap)
+    {
+        for (size_t bitmapCount : { 1, 4, 16 })
+        {
+            for (size_t spriteCount : { 1000, 100000 })
+            {
+                Fixture f(bitmapCount);
+
+                //
+                // The previous implementation, for comparison
+                //
+
+                auto sprites = f.MakeSprites(spriteCount);
+
+                auto start = BenchmarkClock::now();
+                std::stable_sort(sprites.begin(), sprites.end(),
+                    [] (auto const& a, auto const& b)
+                    {
+                        return a.Bitmap.Get() < b.Bitmap.Get();
+                    });
+                Log(L"std::stable_sort", spriteCount, bitmapCount, ElapsedMilliseconds(start));
+
+                Fixture::Validate(sprites);
+
+                //
+                // SortSpritesByBitmap
+                //
+
+                sprites = f.MakeSprites(spriteCount);
+
+                start = BenchmarkClock::now();
+                SortSpritesByBitmap(sprites);
+                Log(L"SortSpritesByBitmap", spriteCount, bitmapCount, ElapsedMilliseconds(start));
+
+                Fixture::Validate(sprites);
+            }
+        }
+    }
+
+    TEST_METHOD_EX(CanvasSpriteBatchBenchmarks_SortAndBuildBatch)
+    {
+        size_t const spriteCount = 100000;
+
+        for (size_t bitmapCount : { 1, 4, 16 })
+        {
+            Fixture f(bitmapCount);
+            auto sprites = f.MakeSprites(spriteCount);
+
+            auto d2dSpriteBatch = Make<MockD2DSpriteBatch>();
+            d2dSpriteBatch->AddSpritesMethod.SetExpectedCalls(1,
+                [=] (UINT32 count, D2D1_RECT_F const*, D2D1_RECT_U const*, D2D1_COLOR_F const*, D2D1_MATRIX_3X2_F const*, UINT32, UINT32, UINT32, UINT32)
+                {
+                    Assert::AreEqual(static_cast<UINT32>(spriteCount), count);
+                    return S_OK;
+                });
+
+            auto start = BenchmarkClock::now();
+            SortSpritesByBitmap(sprites);
+            BuildBatch(d2dSpriteBatch.Get(), sprites);
+            Log(L"Sort and build batch", spriteCount, bitmapCount, ElapsedMilliseconds(start));
+
+            Fixture::Validate(sprites);
+        }
+    }
+};
+
+#endif
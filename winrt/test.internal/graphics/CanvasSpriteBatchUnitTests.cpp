@@ -687,6 +687,8 @@ public:
         Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawFromSpriteSheetToRectWithTintAndFlip(nullptr, destRect, sourceRect, tint, flip)); 
         Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawFromSpriteSheetWithTransformAndTintAndFlip(nullptr, transform, sourceRect, tint, flip)); 
         Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawFromSpriteSheetAtOffsetWithTintAndTransform(nullptr, offset, sourceRect, tint, origin, rotation, scale, flip)); 
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyAtOffsets(nullptr, 1, &offset));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(nullptr, 1, &offset, 1, &sourceRect, 1, &tint, 1, &rotation, 1, &scale));
     }
 
 
@@ -725,6 +727,11 @@ public:
         Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawFromSpriteSheetToRectWithTintAndFlip(bitmap, destRect, sourceRect, tint, flip)); 
         Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawFromSpriteSheetWithTransformAndTintAndFlip(bitmap, transform, sourceRect, tint, flip)); 
         Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawFromSpriteSheetAtOffsetWithTintAndTransform(bitmap, offset, sourceRect, tint, origin, rotation, scale, flip));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyAtOffsets(bitmap, 1, &offset));
+        boolean useFastRotation;
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->get_UseFastRotation(&useFastRotation));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->put_UseFastRotation(true));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 1, &offset, 1, &sourceRect, 1, &tint, 1, &rotation, 1, &scale));
 
         ComPtr<ICanvasDevice> device;
         Assert::AreEqual(RO_E_CLOSED, As<ICanvasResourceCreator>(f.SpriteBatch)->get_Device(&device));
@@ -1176,6 +1183,128 @@ public:
     }
 
     
+    TEST_METHOD_EX(CanvasSpriteBatch_UseFastRotation)
+    {
+        DrawFixture f;
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->get_UseFastRotation(nullptr));
+
+        boolean value = true;
+        ThrowIfFailed(f.SpriteBatch->get_UseFastRotation(&value));
+        Assert::IsFalse(!!value);
+
+        ThrowIfFailed(f.SpriteBatch->put_UseFastRotation(true));
+        ThrowIfFailed(f.SpriteBatch->get_UseFastRotation(&value));
+        Assert::IsTrue(!!value);
+    }
+
+    
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyAtOffsets)
+    {
+        DrawFixture f;
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyAtOffsets(f.Bitmap.Get(), _countof(gOffsets), ReinterpretAs<Vector2*>(gOffsets)));
+
+        for (auto offset : gOffsets)
+        {
+            f.ExpectSprite(
+                f.FullBitmapDestRect(offset),
+                f.FullBitmapSourceRect());
+        }
+
+        f.Validate();
+    }
+
+    
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheet_WithSourceRectsAndTints)
+    {
+        DrawFixture f;
+
+        auto width = 30.0f;
+        auto height = 40.0f;
+        Rect sourceRects[] = { Rect{ 10.0f, 20.0f, width, height }, Rect{ 0.0f, 0.0f, width, height }, Rect{ 10.0f, 20.0f, width, height } };
+        static_assert(_countof(sourceRects) == _countof(gOffsets), "array sizes must match");
+        static_assert(_countof(gTints) == _countof(gOffsets), "array sizes must match");
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheet(
+            f.Bitmap.Get(),
+            _countof(gOffsets), ReinterpretAs<Vector2*>(gOffsets),
+            _countof(sourceRects), sourceRects,
+            _countof(gTints), gTints,
+            0, nullptr,
+            0, nullptr));
+
+        for (size_t i = 0; i < _countof(gOffsets); ++i)
+        {
+            auto offset = gOffsets[i];
+            auto left = static_cast<uint32_t>(sourceRects[i].X * 2);
+            auto top = static_cast<uint32_t>(sourceRects[i].Y * 2);
+
+            f.ExpectSprite(
+                D2D1_RECT_F{ offset.x, offset.y, offset.x + width, offset.y + height },
+                D2D1_RECT_U{ left, top, static_cast<uint32_t>(left + width * 2), static_cast<uint32_t>(top + height * 2) },
+                *ReinterpretAs<D2D1_COLOR_F*>(&gTints[i]));
+        }
+
+        f.Validate();
+    }
+
+    
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheet_WithScales_UsesTransform)
+    {
+        DrawFixture f;
+
+        Vector2 offsets[] = { Vector2{ 10.0f, 20.0f }, Vector2{ 30.0f, 40.0f } };
+        Vector2 scales[] = { Vector2{ 2.0f, 2.0f }, Vector2{ 3.0f, 4.0f } };
+
+        ThrowIfFailed(f.SpriteBatch->DrawManyFromSpriteSheet(
+            f.Bitmap.Get(),
+            _countof(offsets), offsets,
+            0, nullptr,
+            0, nullptr,
+            0, nullptr,
+            _countof(scales), scales));
+
+        for (size_t i = 0; i < _countof(offsets); ++i)
+        {
+            D2D1_MATRIX_3X2_F expectedTransform = {
+                scales[i].X, 0.0f,
+                0.0f, scales[i].Y,
+                offsets[i].X, offsets[i].Y
+            };
+
+            f.ExpectSprite(
+                f.FullBitmapDestRect(float2::zero()),
+                f.FullBitmapSourceRect(),
+                D2D1_COLOR_F{ 1, 1, 1, 1 },
+                expectedTransform);
+        }
+
+        f.Validate();
+    }
+
+    
+    TEST_METHOD_EX(CanvasSpriteBatch_DrawManyFromSpriteSheet_FailsWhenArraySizesDoNotMatch)
+    {
+        DrawFixture f;
+
+        Vector2 offsets[2]{};
+        Rect sourceRects[3]{};
+        Vector4 tints[1]{};
+        float rotations[3]{};
+        Vector2 scales[1]{};
+
+        auto bitmap = f.Bitmap.Get();
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, offsets, 3, sourceRects, 0, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, offsets, 0, nullptr, 1, tints, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, offsets, 0, nullptr, 0, nullptr, 3, rotations, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, offsets, 0, nullptr, 0, nullptr, 0, nullptr, 1, scales));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, nullptr, 0, nullptr, 0, nullptr, 0, nullptr, 0, nullptr));
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->DrawManyFromSpriteSheet(bitmap, 2, offsets, 2, nullptr, 0, nullptr, 0, nullptr, 0, nullptr));
+    }
+
+
     TEST_METHOD_EX(CanvasSpriteBatch_DrawFromSpriteSheet_NegativeCoordinatesAreClamped)
     {
         DrawFixture f;
@@ -1614,4 +1743,229 @@ public:
     }
 };
 
+
+TEST_CLASS(CanvasRetainedSpriteBatchUnitTests)
+{
+public:
+    struct Fixture
+    {
+        ComPtr<MockD2DDevice> D2DDevice;
+        ComPtr<MockCanvasDevice> Device;
+        ComPtr<MockD2DDeviceContext> ResourceCreationContext;
+        ComPtr<MockD2DSpriteBatch> D2DSpriteBatch;
+
+        ComPtr<MockD2DDeviceContext> DrawingContext;
+        ComPtr<CanvasDrawingSession> DrawingSession;
+
+        ComPtr<StubD2DBitmap> D2DBitmap;
+        ComPtr<CanvasBitmap> Bitmap;
+
+        ComPtr<ICanvasRetainedSpriteBatch> SpriteBatch;
+
+        Fixture()
+            : D2DDevice(Make<MockD2DDevice>())
+            , Device(Make<MockCanvasDevice>())
+            , ResourceCreationContext(Make<MockD2DDeviceContext>())
+            , D2DSpriteBatch(Make<MockD2DSpriteBatch>())
+            , DrawingContext(Make<MockD2DDeviceContext>())
+            , DrawingSession(Make<CanvasDrawingSession>(DrawingContext.Get()))
+            , D2DBitmap(Make<StubD2DBitmap>(D2D1_BITMAP_OPTIONS_NONE, DEFAULT_DPI))
+            , Bitmap(Make<CanvasBitmap>(Device.Get(), D2DBitmap.Get()))
+        {
+            D2DBitmap->GetSizeMethod.AllowAnyCall([] { return D2D1_SIZE_F{ 100.0f, 100.0f }; });
+            D2DBitmap->GetPixelSizeMethod.AllowAnyCall([] { return D2D1_SIZE_U{ 100U, 100U }; });
+
+            Device->MockGetD2DDevice = [=] { return D2DDevice; };
+            Device->IsSpriteBatchQuirkRequiredMethod.AllowAnyCall([] { return false; });
+
+            Device->GetResourceCreationDeviceContextMethod.AllowAnyCall(
+                [=]
+                {
+                    return DeviceContextLease(As<ID2D1DeviceContext1>(ResourceCreationContext));
+                });
+
+            ResourceCreationContext->CreateSpriteBatchMethod.SetExpectedCalls(1,
+                [=] (ID2D1SpriteBatch** value)
+                {
+                    return D2DSpriteBatch.CopyTo(value);
+                });
+
+            DrawingContext->GetDeviceMethod.AllowAnyCall(
+                [=] (ID2D1Device** value)
+                {
+                    D2DDevice.CopyTo(value);
+                });
+
+            DrawingContext->GetUnitModeMethod.AllowAnyCall([] { return D2D1_UNIT_MODE_DIPS; });
+            DrawingContext->GetAntialiasModeMethod.AllowAnyCall([] { return D2D1_ANTIALIAS_MODE_ALIASED; });
+            DrawingContext->SetUnitModeMethod.AllowAnyCall();
+            DrawingContext->DrawSpriteBatchMethod.AllowAnyCall();
+
+            ComPtr<ICanvasRetainedSpriteBatchStatics> factory;
+            ThrowIfFailed(MakeAndInitialize<CanvasRetainedSpriteBatchFactory>(&factory));
+            ThrowIfFailed(factory->Create(As<ICanvasResourceCreator>(Device).Get(), &SpriteBatch));
+        }
+
+        int32_t Add(float offset)
+        {
+            int32_t index;
+            ThrowIfFailed(SpriteBatch->AddToRect(Bitmap.Get(), Rect{ offset, offset, 10, 10 }, Rect{ 0, 0, 10, 10 }, gAnyTint, CanvasSpriteFlip::None, &index));
+            return index;
+        }
+
+        void Draw()
+        {
+            ThrowIfFailed(SpriteBatch->Draw(DrawingSession.Get()));
+        }
+
+        Fixture(Fixture const&) = delete;
+        Fixture& operator=(Fixture const&) = delete;
+    };
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Create_FailsWhenPassedInvalidInterpolationMode)
+    {
+        ComPtr<ICanvasRetainedSpriteBatchStatics> factory;
+        ThrowIfFailed(MakeAndInitialize<CanvasRetainedSpriteBatchFactory>(&factory));
+
+        for (auto interpolation : gInvalidInterpolations)
+        {
+            ComPtr<ICanvasRetainedSpriteBatch> spriteBatch;
+            Assert::AreEqual(E_INVALIDARG, factory->CreateWithInterpolationAndOptions(Make<MockCanvasDevice>().Get(), interpolation, CanvasSpriteOptions::None, &spriteBatch));
+            ValidateStoredErrorState(E_INVALIDARG, Strings::SpriteBatchInvalidInterpolation);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Add_ReturnsSequentialIndices)
+    {
+        Fixture f;
+
+        Assert::AreEqual(0, f.Add(0));
+        Assert::AreEqual(1, f.Add(1));
+        Assert::AreEqual(2, f.Add(2));
+
+        int32_t count;
+        ThrowIfFailed(f.SpriteBatch->get_Count(&count));
+        Assert::AreEqual(3, count);
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Draw_UploadsOnlyNewAndModifiedSprites)
+    {
+        Fixture f;
+
+        for (int i = 0; i < 10; ++i)
+            f.Add((float)i);
+
+        f.D2DSpriteBatch->AddSpritesMethod.SetExpectedCalls(1,
+            [] (UINT32 count, D2D1_RECT_F const*, D2D1_RECT_U const*, D2D1_COLOR_F const*, D2D1_MATRIX_3X2_F const*, UINT32, UINT32, UINT32, UINT32)
+            {
+                Assert::AreEqual(10U, count);
+                return S_OK;
+            });
+        f.Draw();
+
+        // Nothing changed, so nothing is uploaded
+        f.Draw();
+
+        Vector4 tints[] = { gAnyTint, gAnyTint };
+        ThrowIfFailed(f.SpriteBatch->SetTints(3, _countof(tints), tints));
+        ThrowIfFailed(f.SpriteBatch->SetToRect(4, f.Bitmap.Get(), gAnyRect, Rect{ 0, 0, 10, 10 }, gAnyTint, CanvasSpriteFlip::None));
+        ThrowIfFailed(f.SpriteBatch->SetTransforms(8, 1, gMatrices));
+        f.Add(10);
+
+        std::vector<std::pair<UINT32, UINT32>> setRanges;
+
+        f.D2DSpriteBatch->SetSpritesMethod.SetExpectedCalls(2,
+            [&] (UINT32 start, UINT32 count, D2D1_RECT_F const*, D2D1_RECT_U const*, D2D1_COLOR_F const*, D2D1_MATRIX_3X2_F const*, UINT32, UINT32, UINT32, UINT32)
+            {
+                setRanges.emplace_back(start, count);
+                return S_OK;
+            });
+
+        f.D2DSpriteBatch->AddSpritesMethod.SetExpectedCalls(1,
+            [] (UINT32 count, D2D1_RECT_F const*, D2D1_RECT_U const*, D2D1_COLOR_F const*, D2D1_MATRIX_3X2_F const*, UINT32, UINT32, UINT32, UINT32)
+            {
+                Assert::AreEqual(1U, count);
+                return S_OK;
+            });
+
+        f.Draw();
+
+        Assert::AreEqual<size_t>(2, setRanges.size());
+        Assert::AreEqual(3U, setRanges[0].first);
+        Assert::AreEqual(2U, setRanges[0].second);
+        Assert::AreEqual(8U, setRanges[1].first);
+        Assert::AreEqual(1U, setRanges[1].second);
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Clear_ClearsD2DSpriteBatchOnlyWhenSpritesWereUploaded)
+    {
+        Fixture f;
+
+        f.Add(0);
+        f.D2DSpriteBatch->ClearMethod.SetExpectedCalls(0);
+        ThrowIfFailed(f.SpriteBatch->Clear());
+
+        f.Add(0);
+        f.D2DSpriteBatch->AddSpritesMethod.SetExpectedCalls(1);
+        f.Draw();
+
+        f.D2DSpriteBatch->ClearMethod.SetExpectedCalls(1);
+        ThrowIfFailed(f.SpriteBatch->Clear());
+
+        int32_t count;
+        ThrowIfFailed(f.SpriteBatch->get_Count(&count));
+        Assert::AreEqual(0, count);
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Set_FailsWhenIndexIsOutOfRange)
+    {
+        Fixture f;
+
+        f.Add(0);
+        f.Add(1);
+
+        Assert::AreEqual(E_BOUNDS, f.SpriteBatch->SetToRect(-1, f.Bitmap.Get(), gAnyRect, gAnyRect, gAnyTint, CanvasSpriteFlip::None));
+        Assert::AreEqual(E_BOUNDS, f.SpriteBatch->SetToRect(2, f.Bitmap.Get(), gAnyRect, gAnyRect, gAnyTint, CanvasSpriteFlip::None));
+        Assert::AreEqual(E_BOUNDS, f.SpriteBatch->SetTransforms(1, 2, gMatrices));
+
+        Vector4 tints[] = { gAnyTint, gAnyTint, gAnyTint };
+        Assert::AreEqual(E_BOUNDS, f.SpriteBatch->SetTints(0, _countof(tints), tints));
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Draw_FailsWhenDrawingSessionIsOnDifferentDevice)
+    {
+        Fixture f;
+
+        f.Add(0);
+
+        auto otherContext = Make<MockD2DDeviceContext>();
+        otherContext->GetDeviceMethod.AllowAnyCall(
+            [] (ID2D1Device** value)
+            {
+                Make<MockD2DDevice>().CopyTo(value);
+            });
+
+        auto otherSession = Make<CanvasDrawingSession>(otherContext.Get());
+
+        Assert::AreEqual(E_INVALIDARG, f.SpriteBatch->Draw(otherSession.Get()));
+        ValidateStoredErrorState(E_INVALIDARG, Strings::RetainedSpriteBatchWrongDevice);
+    }
+
+    TEST_METHOD_EX(CanvasRetainedSpriteBatch_Closed_MethodsFail)
+    {
+        Fixture f;
+
+        ThrowIfFailed(As<IClosable>(f.SpriteBatch)->Close());
+
+        int32_t index;
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->AddToRect(f.Bitmap.Get(), gAnyRect, gAnyRect, gAnyTint, CanvasSpriteFlip::None, &index));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->get_Count(&index));
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->Clear());
+        Assert::AreEqual(RO_E_CLOSED, f.SpriteBatch->Draw(f.DrawingSession.Get()));
+
+        ComPtr<ICanvasDevice> device;
+        Assert::AreEqual(RO_E_CLOSED, As<ICanvasResourceCreator>(f.SpriteBatch)->get_Device(&device));
+    }
+};
+
 #endif
@@ -12,6 +12,7 @@
 #include <lib/svg/CanvasSvgPointsAttribute.h>
 #include <lib/svg/CanvasSvgPathAttribute.h>
 #include <lib/svg/CanvasSvgStrokeDashArrayAttribute.h>
+#include <lib/svg/BufferStreamWrapper.h>
 #include <AsyncOperation.h>
 #include <LifespanTracker.h>
 #include "mocks/MockD2DSvgDocument.h"
@@ -62,6 +63,101 @@ namespace canvas
 
             return mockD2DSvgElement;
         }
+
+        // Makes a mock element report an id attribute, which follows
+        // SetAttributeValue, and a place in a tree.
+        static void SetUpMockD2DElementWithId(
+            MockD2DSvgElement* element,
+            wchar_t const* initialId,
+            MockD2DSvgElement* parent,
+            std::vector<ComPtr<MockD2DSvgElement>> const& children = {})
+        {
+            auto id = std::make_shared<std::wstring>(initialId);
+
+            element->IsAttributeSpecifiedMethod.AllowAnyCall(
+                [=](PCWSTR name, BOOL*)
+                {
+                    return (wcscmp(name, L"id") == 0 && !id->empty()) ? TRUE : FALSE;
+                });
+
+            element->GetAttributeValueLengthMethod.AllowAnyCall(
+                [=](PCWSTR name, D2D1_SVG_ATTRIBUTE_STRING_TYPE, UINT32* length)
+                {
+                    Assert::AreEqual(L"id", name);
+                    *length = static_cast<UINT32>(id->size());
+                    return S_OK;
+                });
+
+            element->GetAttributeValue_String_Method.AllowAnyCall(
+                [=](PCWSTR name, D2D1_SVG_ATTRIBUTE_STRING_TYPE, PWSTR buffer, UINT32 bufferSize)
+                {
+                    Assert::AreEqual(L"id", name);
+                    wcscpy_s(buffer, bufferSize, id->c_str());
+                    return S_OK;
+                });
+
+            element->SetAttributeValue_String_Method.AllowAnyCall(
+                [=](PCWSTR name, D2D1_SVG_ATTRIBUTE_STRING_TYPE, PCWSTR value)
+                {
+                    Assert::AreEqual(L"id", name);
+                    *id = value;
+                    return S_OK;
+                });
+
+            element->GetParentMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    if (parent)
+                        ComPtr<ID2D1SvgElement>(parent).CopyTo(result);
+                });
+
+            element->GetFirstChildMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    if (!children.empty())
+                        children.front().CopyTo(result);
+                });
+
+            element->GetNextChildMethod.AllowAnyCall(
+                [=](ID2D1SvgElement* reference, ID2D1SvgElement** result)
+                {
+                    for (size_t i = 0; i + 1 < children.size(); ++i)
+                    {
+                        if (IsSameInstance(children[i].Get(), reference))
+                            return children[i + 1].CopyTo(result);
+                    }
+                    return S_OK;
+                });
+        }
+    };
+
+    // <svg id="root"><g id="a"/><g id="b"/></svg>
+    struct IdIndexFixture : public Fixture
+    {
+        ComPtr<MockD2DSvgElement> m_root;
+        ComPtr<MockD2DSvgElement> m_a;
+        ComPtr<MockD2DSvgElement> m_b;
+
+        IdIndexFixture()
+            : m_root(CreateMockD2DElement())
+            , m_a(CreateMockD2DElement())
+            , m_b(CreateMockD2DElement())
+        {
+            SetUpMockD2DElementWithId(m_root.Get(), L"root", nullptr, { m_a, m_b });
+            SetUpMockD2DElementWithId(m_a.Get(), L"a", m_root.Get());
+            SetUpMockD2DElementWithId(m_b.Get(), L"b", m_root.Get());
+
+            m_createdDocument->GetRootMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    m_root.CopyTo(result);
+                });
+        }
+
+        static ID2D1SvgElement* GetD2DElement(ICanvasSvgNamedElement* element)
+        {
+            return element ? static_cast<CanvasSvgNamedElement*>(element)->GetResource().Get() : nullptr;
+        }
     };
 
     TEST_CLASS(CanvasSvgDocumentTests)
@@ -93,6 +189,10 @@ namespace canvas
             IAsyncAction* action;
             Assert::AreEqual(RO_E_CLOSED, svgDocument->SaveAsync(fakeStream, &action));
 
+            IBuffer* fakeBuffer = reinterpret_cast<IBuffer*>(0x1234);
+            uint32_t byteCount;
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->WriteXmlToBuffer(fakeBuffer, &byteCount));
+
             ICanvasSvgNamedElement* fakeElement = reinterpret_cast<ICanvasSvgNamedElement*>(0x1234);
             Assert::AreEqual(RO_E_CLOSED, svgDocument->put_Root(fakeElement));
             Assert::AreEqual(RO_E_CLOSED, svgDocument->get_Root(&fakeElement));
@@ -104,6 +204,19 @@ namespace canvas
             Assert::AreEqual(RO_E_CLOSED, svgDocument->LoadElementAsync(fakeStream, &operation));
 
             Assert::AreEqual(RO_E_CLOSED, svgDocument->FindElementById(WinString(L"id"), &fakeElement));
+
+            boolean cacheElements;
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->get_CacheElements(&cacheElements));
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->put_CacheElements(true));
+
+            boolean indexElementIds;
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->get_IndexElementIds(&indexElementIds));
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->put_IndexElementIds(true));
+
+            HSTRING id = nullptr;
+            uint32_t elementCount;
+            ICanvasSvgNamedElement** elements;
+            Assert::AreEqual(RO_E_CLOSED, svgDocument->FindElementsById(1, &id, &elementCount, &elements));
         }
 
         TEST_METHOD_EX(CanvasSvgDocumentTests_NullArgs)
@@ -119,6 +232,11 @@ namespace canvas
             IAsyncAction* action;
             Assert::AreEqual(E_INVALIDARG, svgDocument->SaveAsync(nullptr, &action));
             Assert::AreEqual(E_INVALIDARG, svgDocument->SaveAsync(fakeStream, nullptr));
+
+            IBuffer* fakeBuffer = reinterpret_cast<IBuffer*>(0x1234);
+            uint32_t byteCount;
+            Assert::AreEqual(E_INVALIDARG, svgDocument->WriteXmlToBuffer(nullptr, &byteCount));
+            Assert::AreEqual(E_INVALIDARG, svgDocument->WriteXmlToBuffer(fakeBuffer, nullptr));
             
             Assert::AreEqual(E_INVALIDARG, svgDocument->put_Root(nullptr));
 
@@ -133,6 +251,17 @@ namespace canvas
             Assert::AreEqual(E_INVALIDARG, svgDocument->LoadElementAsync(fakeStream, nullptr));
 
             Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementById(WinString(L""), nullptr));
+
+            Assert::AreEqual(E_INVALIDARG, svgDocument->get_CacheElements(nullptr));
+
+            Assert::AreEqual(E_INVALIDARG, svgDocument->get_IndexElementIds(nullptr));
+
+            HSTRING id = nullptr;
+            uint32_t elementCount;
+            ICanvasSvgNamedElement** elements;
+            Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementsById(1, nullptr, &elementCount, &elements));
+            Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementsById(1, &id, nullptr, &elements));
+            Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementsById(1, &id, &elementCount, nullptr));
         }
 
         TEST_METHOD_EX(CanvasSvgDocumentTests_Device)
@@ -173,6 +302,72 @@ namespace canvas
             Assert::AreEqual(L"something", static_cast<wchar_t const*>(returnedXml));
         }
 
+        TEST_METHOD_EX(CanvasSvgDocumentTests_GetXml_ConvertsSequencesSplitAcrossWrites)
+        {
+            Fixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            f.m_createdDocument->SerializeMethod.SetExpectedCalls(1,
+                [=](IStream* stream, ID2D1SvgElement*)
+                {
+                    // U+20AC (3 bytes) split after its second byte, then U+1F600 (4 bytes) split after its first.
+                    char const* chunks[] = { "<a>\xE2\x82", "\xAC\xF0", "\x9F\x98\x80</a>" };
+
+                    for (auto chunk : chunks)
+                    {
+                        HRESULT writeResult = stream->Write(chunk, static_cast<ULONG>(strlen(chunk)), nullptr);
+
+                        if (FAILED(writeResult))
+                            return writeResult;
+                    }
+
+                    return S_OK;
+                });
+
+            WinString returnedXml;
+            Assert::AreEqual(S_OK, svgDocument->GetXml(returnedXml.GetAddressOf()));
+            Assert::AreEqual(L"<a>\u20AC\U0001F600</a>", static_cast<wchar_t const*>(returnedXml));
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_GetXml_FailsWhenNothingIsWritten)
+        {
+            Fixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            f.m_createdDocument->SerializeMethod.SetExpectedCalls(1,
+                [=](IStream*, ID2D1SvgElement*)
+                {
+                    return S_OK;
+                });
+
+            WinString returnedXml;
+            Assert::AreEqual(E_INVALIDARG, svgDocument->GetXml(returnedXml.GetAddressOf()));
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_FixedBufferStream_CountsBytesPastCapacity)
+        {
+            uint8_t buffer[8] = {};
+            auto stream = Make<FixedBufferStream>(buffer, 6);
+
+            ULONG bytesWritten;
+            Assert::AreEqual(S_OK, stream->Write("abcd", 4, &bytesWritten));
+            Assert::AreEqual(4ul, bytesWritten);
+            Assert::IsFalse(stream->HasOverflowed());
+
+            Assert::AreEqual(S_OK, stream->Write("efgh", 4, &bytesWritten));
+            Assert::AreEqual(4ul, bytesWritten);
+            Assert::IsTrue(stream->HasOverflowed());
+            Assert::AreEqual<uint64_t>(8, stream->GetPosition());
+
+            // Only the bytes that fit are written.
+            Assert::AreEqual(0, memcmp(buffer, "abcdef\0\0", 8));
+
+            ULARGE_INTEGER position;
+            Assert::AreEqual(S_OK, stream->Seek(LARGE_INTEGER{}, STREAM_SEEK_CUR, &position));
+            Assert::AreEqual<uint64_t>(8, position.QuadPart);
+            Assert::AreEqual(E_NOTIMPL, stream->Seek(LARGE_INTEGER{}, STREAM_SEEK_SET, &position));
+        }
+
         static ComPtr<CanvasSvgDocumentStatics> GetSvgDocumentStatics()
         {
             ComPtr<CanvasSvgDocumentStatics> svgDocumentStatics;
@@ -262,6 +457,153 @@ namespace canvas
                 static_cast<CanvasSvgNamedElement*>(retrievedElement.Get())->GetResource().Get()));
         }
 
+        TEST_METHOD_EX(CanvasSvgDocumentTests_CacheElements)
+        {
+            Fixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            boolean cacheElements = true;
+            Assert::AreEqual(S_OK, svgDocument->get_CacheElements(&cacheElements));
+            Assert::IsFalse(!!cacheElements);
+            Assert::IsFalse(svgDocument->GetElementCache()->GetCachesWrappers());
+
+            Assert::AreEqual(S_OK, svgDocument->put_CacheElements(true));
+            Assert::AreEqual(S_OK, svgDocument->get_CacheElements(&cacheElements));
+            Assert::IsTrue(!!cacheElements);
+
+            ComPtr<MockD2DSvgElement> mockD2DSvgElement = f.CreateMockD2DElement();
+
+            f.m_createdDocument->FindElementByIdMethod.AllowAnyCall(
+                [=](wchar_t const*, ID2D1SvgElement** result)
+                {
+                    return mockD2DSvgElement.CopyTo(result);
+                });
+
+            ComPtr<ICanvasSvgNamedElement> retrievedElement;
+            Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"Something"), &retrievedElement));
+            Assert::AreEqual<size_t>(1, svgDocument->GetElementCache()->GetWrapperCount());
+
+            // Closing the document releases everything it was holding on to.
+            auto elementCache = svgDocument->GetElementCache();
+            Assert::AreEqual(S_OK, svgDocument->Close());
+            Assert::AreEqual<size_t>(0, elementCache->GetWrapperCount());
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_IndexElementIds_FindsElementsWithoutSearching)
+        {
+            IdIndexFixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            Assert::AreEqual(S_OK, svgDocument->put_IndexElementIds(true));
+
+            boolean indexElementIds = false;
+            Assert::AreEqual(S_OK, svgDocument->get_IndexElementIds(&indexElementIds));
+            Assert::IsTrue(!!indexElementIds);
+            Assert::AreEqual<size_t>(3, svgDocument->GetElementCache()->GetIndexedIdCount());
+
+            // Only the id that isn't in the index goes to Direct2D.
+            f.m_createdDocument->FindElementByIdMethod.SetExpectedCalls(1,
+                [=](wchar_t const* id, ID2D1SvgElement**)
+                {
+                    Assert::AreEqual(L"missing", id);
+                    return S_OK;
+                });
+
+            ComPtr<ICanvasSvgNamedElement> element;
+            Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"a"), &element));
+            Assert::IsTrue(IsSameInstance(f.m_a.Get(), f.GetD2DElement(element.Get())));
+
+            WinString ids[] = { WinString(L"b"), WinString(L"missing"), WinString(L"root") };
+
+            ComArray<ComPtr<ICanvasSvgNamedElement>> elements;
+            Assert::AreEqual(S_OK, svgDocument->FindElementsById(3, ids[0].GetAddressOf(), elements.GetAddressOfSize(), elements.GetAddressOfData()));
+
+            Assert::AreEqual(3u, elements.GetSize());
+            Assert::IsTrue(IsSameInstance(f.m_b.Get(), f.GetD2DElement(elements[0].Get())));
+            Assert::IsNull(elements[1].Get());
+            Assert::IsTrue(IsSameInstance(f.m_root.Get(), f.GetD2DElement(elements[2].Get())));
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_IndexElementIds_FollowsIdChanges)
+        {
+            IdIndexFixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            Assert::AreEqual(S_OK, svgDocument->put_IndexElementIds(true));
+
+            f.m_createdDocument->FindElementByIdMethod.SetExpectedCalls(1,
+                [=](wchar_t const* id, ID2D1SvgElement**)
+                {
+                    Assert::AreEqual(L"a", id);
+                    return S_OK;
+                });
+
+            ComPtr<ICanvasSvgNamedElement> element;
+            Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"a"), &element));
+
+            Assert::AreEqual(S_OK, element->SetIdAttribute(WinString(L"id"), WinString(L"c")));
+
+            ComPtr<ICanvasSvgNamedElement> renamedElement;
+            Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"c"), &renamedElement));
+            Assert::IsTrue(IsSameInstance(f.m_a.Get(), f.GetD2DElement(renamedElement.Get())));
+
+            // "a" is no longer indexed, so this is the one call that reaches Direct2D.
+            Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementById(WinString(L"a"), &renamedElement));
+
+            Assert::AreEqual(S_OK, svgDocument->put_IndexElementIds(false));
+            Assert::AreEqual<size_t>(0, svgDocument->GetElementCache()->GetIndexedIdCount());
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_IndexElementIds_ChecksIndexedElementsAreStillInTheTree)
+        {
+            IdIndexFixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            Assert::AreEqual(S_OK, svgDocument->put_IndexElementIds(true));
+
+            // Detach "b" behind the index's back.
+            f.m_b->GetParentMethod.AllowAnyCall([](ID2D1SvgElement**) {});
+
+            f.m_createdDocument->FindElementByIdMethod.SetExpectedCalls(1,
+                [=](wchar_t const* id, ID2D1SvgElement**)
+                {
+                    Assert::AreEqual(L"b", id);
+                    return S_OK;
+                });
+
+            ComPtr<ICanvasSvgNamedElement> element;
+            Assert::AreEqual(E_INVALIDARG, svgDocument->FindElementById(WinString(L"b"), &element));
+        }
+
+        TEST_METHOD_EX(CanvasSvgDocumentTests_IndexElementIds_DuplicateIdsFindTheFirstElementInTheDocument)
+        {
+            IdIndexFixture f;
+            auto svgDocument = f.CreateSvgDocument();
+
+            Assert::AreEqual(S_OK, svgDocument->put_IndexElementIds(true));
+
+            ComPtr<ICanvasSvgNamedElement> b;
+            Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"b"), &b));
+
+            // Now both "a" and "b" have id "a".  Direct2D finds "a", since it
+            // comes first, so the index mustn't hand out the later element.
+            Assert::AreEqual(S_OK, b->SetIdAttribute(WinString(L"id"), WinString(L"a")));
+
+            f.m_createdDocument->FindElementByIdMethod.SetExpectedCalls(1,
+                [=](wchar_t const* id, ID2D1SvgElement** result)
+                {
+                    Assert::AreEqual(L"a", id);
+                    return f.m_a.CopyTo(result);
+                });
+
+            for (int i = 0; i < 2; ++i)
+            {
+                ComPtr<ICanvasSvgNamedElement> element;
+                Assert::AreEqual(S_OK, svgDocument->FindElementById(WinString(L"a"), &element));
+                Assert::IsTrue(IsSameInstance(f.m_a.Get(), f.GetD2DElement(element.Get())));
+            }
+        }
+
         TEST_METHOD_EX(CanvasSvgDocumentTests_CreatePaintAttributeWithDefaults)
         {
             Fixture f;
@@ -169,6 +169,9 @@ namespace canvas
             Assert::AreEqual(RO_E_CLOSED, svgElement->SetAspectRatioAttribute(string, alignment, scaling));
             Assert::AreEqual(RO_E_CLOSED, svgElement->GetAspectRatioAttribute(string, &scaling, &alignment));
 
+            INT32* intArray;
+            Assert::AreEqual(RO_E_CLOSED, svgElement->CaptureSubtree(0, nullptr, &u, &intArray, &u, &stringArray, &u, &stringArray));
+
             ComPtr<ICanvasDevice> device;
             Assert::AreEqual(RO_E_CLOSED, svgElement->get_Device(&device));
 
@@ -238,6 +241,15 @@ namespace canvas
             Assert::AreEqual(E_INVALIDARG, svgElement->GetLengthAttribute(string, &lengthUnits, nullptr));
             Assert::AreEqual(E_INVALIDARG, svgElement->GetAspectRatioAttribute(string, nullptr, &alignment));
             Assert::AreEqual(E_INVALIDARG, svgElement->GetAspectRatioAttribute(string, &scaling, nullptr));
+
+            INT32* intArray;
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(1, nullptr, &u, &intArray, &u, &stringArray, &u, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, nullptr, &intArray, &u, &stringArray, &u, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, &u, nullptr, &u, &stringArray, &u, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, &u, &intArray, nullptr, &stringArray, &u, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, &u, &intArray, &u, nullptr, &u, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, &u, &intArray, &u, &stringArray, nullptr, &stringArray));
+            Assert::AreEqual(E_INVALIDARG, svgElement->CaptureSubtree(0, nullptr, &u, &intArray, &u, &stringArray, &u, nullptr));
         }
 
         TEST_METHOD_EX(CanvasSvgElementTests_Device)
@@ -1221,6 +1233,203 @@ namespace canvas
 
             Assert::AreEqual(S_OK, svgElement->SetAspectRatioAttribute(WinString(L"ABC"), CanvasSvgAspectAlignment::XMaxYMax, CanvasSvgAspectScaling::Slice));
         }
+
+        // Makes a mock element that reports the given tag, id attribute and
+        // children.  A null id means the element does not specify one.
+        static void SetUpMockD2DElement(
+            MockD2DSvgElement* element,
+            wchar_t const* tag,
+            wchar_t const* id,
+            std::vector<ComPtr<MockD2DSvgElement>> const& children = {})
+        {
+            element->GetTagNameLengthMethod.AllowAnyCall(
+                [=]
+                {
+                    return static_cast<UINT32>(wcslen(tag));
+                });
+
+            element->GetTagNameMethod.AllowAnyCall(
+                [=](PWSTR buffer, UINT32 bufferSize)
+                {
+                    wcscpy_s(buffer, bufferSize, tag);
+                    return S_OK;
+                });
+
+            element->IsAttributeSpecifiedMethod.AllowAnyCall(
+                [=](PCWSTR name, BOOL*)
+                {
+                    return (id && wcscmp(name, L"id") == 0) ? TRUE : FALSE;
+                });
+
+            element->GetAttributeValueLengthMethod.AllowAnyCall(
+                [=](PCWSTR name, D2D1_SVG_ATTRIBUTE_STRING_TYPE, UINT32* length)
+                {
+                    Assert::AreEqual(L"id", name);
+                    *length = static_cast<UINT32>(wcslen(id));
+                    return S_OK;
+                });
+
+            element->GetAttributeValue_String_Method.AllowAnyCall(
+                [=](PCWSTR name, D2D1_SVG_ATTRIBUTE_STRING_TYPE type, PWSTR buffer, UINT32 bufferSize)
+                {
+                    Assert::AreEqual(L"id", name);
+                    Assert::IsTrue(type == D2D1_SVG_ATTRIBUTE_STRING_TYPE_SVG);
+                    wcscpy_s(buffer, bufferSize, id);
+                    return S_OK;
+                });
+
+            element->GetFirstChildMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    if (!children.empty())
+                        children.front().CopyTo(result);
+                });
+
+            element->GetNextChildMethod.AllowAnyCall(
+                [=](ID2D1SvgElement* reference, ID2D1SvgElement** result)
+                {
+                    for (size_t i = 0; i + 1 < children.size(); ++i)
+                    {
+                        if (IsSameInstance(children[i].Get(), reference))
+                            return children[i + 1].CopyTo(result);
+                    }
+                    return S_OK;
+                });
+        }
+
+        TEST_METHOD_EX(CanvasSvgElementTests_CaptureSubtree)
+        {
+            Fixture f;
+            auto svgElement = f.CreateSvgElement();
+
+            // <svg id="root">
+            //   <g id="group"><rect/></g>
+            //   text
+            // </svg>
+            auto rect = f.CreateMockD2DElement();
+            SetUpMockD2DElement(rect.Get(), L"rect", nullptr);
+
+            auto group = f.CreateMockD2DElement();
+            SetUpMockD2DElement(group.Get(), L"g", L"group", { rect });
+
+            auto text = f.CreateMockD2DElement(true);
+
+            SetUpMockD2DElement(f.m_mockD2DElement.Get(), L"svg", L"root", { group, text });
+
+            WinString attributeNames[] = { WinString(L"id") };
+
+            ComArray<INT32> parentIndices;
+            ComArray<WinString> tags;
+            ComArray<WinString> attributeValues;
+            Assert::AreEqual(S_OK, svgElement->CaptureSubtree(
+                1, attributeNames[0].GetAddressOf(),
+                parentIndices.GetAddressOfSize(), parentIndices.GetAddressOfData(),
+                tags.GetAddressOfSize(), tags.GetAddressOfData(),
+                attributeValues.GetAddressOfSize(), attributeValues.GetAddressOfData()));
+
+            int32_t expectedParentIndices[] = { -1, 0, 1, 0 };
+            wchar_t const* expectedTags[] = { L"svg", L"g", L"rect", L"" };
+            wchar_t const* expectedIds[] = { L"root", L"group", L"", L"" };
+
+            Assert::AreEqual(4u, parentIndices.GetSize());
+            Assert::AreEqual(4u, tags.GetSize());
+            Assert::AreEqual(4u, attributeValues.GetSize());
+
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                Assert::AreEqual(expectedParentIndices[i], parentIndices[i]);
+                Assert::AreEqual(expectedTags[i], WindowsGetStringRawBuffer(tags[i], nullptr));
+                Assert::AreEqual(expectedIds[i], WindowsGetStringRawBuffer(attributeValues[i], nullptr));
+            }
+        }
+
+        TEST_METHOD_EX(CanvasSvgElementTests_CacheElements_ReusesWrappersUntilTurnedOff)
+        {
+            Fixture f;
+            Assert::AreEqual(S_OK, f.m_svgDocument->put_CacheElements(true));
+
+            auto svgElement = f.CreateSvgElement();
+
+            auto mockD2DChild = f.CreateMockD2DElement();
+            f.m_mockD2DElement->GetFirstChildMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    mockD2DChild.CopyTo(result);
+                });
+
+            ComPtr<ICanvasSvgElement> child;
+            Assert::AreEqual(S_OK, svgElement->get_FirstChild(&child));
+
+            WeakRef weakChild;
+            ThrowIfFailed(AsWeak(child.Get(), &weakChild));
+            auto firstChild = child.Get();
+            child.Reset();
+
+            // The document is still holding on to the wrapper, so the same one
+            // comes back.
+            Assert::AreEqual(S_OK, svgElement->get_FirstChild(&child));
+            Assert::IsTrue(firstChild == child.Get());
+            child.Reset();
+
+            Assert::AreEqual(S_OK, f.m_svgDocument->put_CacheElements(false));
+
+            ComPtr<ICanvasSvgElement> resolvedChild;
+            Assert::AreEqual(S_OK, weakChild.As(&resolvedChild));
+            Assert::IsNull(resolvedChild.Get());
+        }
+
+        TEST_METHOD_EX(CanvasSvgElementTests_CacheElements_TextElementsUseTheDocumentCache)
+        {
+            Fixture f;
+            Assert::AreEqual(S_OK, f.m_svgDocument->put_CacheElements(true));
+
+            auto svgElement = f.CreateSvgElement();
+
+            // <svg>
+            //   <g>text</g>
+            // </svg>
+            auto text = f.CreateMockD2DElement(true);
+
+            auto group = f.CreateMockD2DElement();
+            SetUpMockD2DElement(group.Get(), L"g", nullptr, { text });
+
+            text->GetParentMethod.AllowAnyCall(
+                [=](ID2D1SvgElement** result)
+                {
+                    group.CopyTo(result);
+                });
+
+            SetUpMockD2DElement(f.m_mockD2DElement.Get(), L"svg", nullptr, { group });
+            f.m_mockD2DElement->RemoveChildMethod.AllowAnyCall();
+
+            ComPtr<ICanvasSvgElement> groupElement;
+            Assert::AreEqual(S_OK, svgElement->get_FirstChild(&groupElement));
+
+            ComPtr<ICanvasSvgElement> textElement;
+            Assert::AreEqual(S_OK, As<ICanvasSvgNamedElement>(groupElement)->get_FirstChild(&textElement));
+
+            // The text element finds its parent through the document's cache.
+            ComPtr<ICanvasSvgNamedElement> parent;
+            Assert::AreEqual(S_OK, As<ICanvasSvgTextElement>(textElement)->get_Parent(&parent));
+            Assert::IsTrue(IsSameInstance(groupElement.Get(), parent.Get()));
+            parent.Reset();
+
+            WeakRef weakGroup;
+            WeakRef weakText;
+            ThrowIfFailed(AsWeak(groupElement.Get(), &weakGroup));
+            ThrowIfFailed(AsWeak(textElement.Get(), &weakText));
+
+            // Removing the group drops the wrappers of everything under it.
+            Assert::AreEqual(S_OK, svgElement->RemoveChild(groupElement.Get()));
+            groupElement.Reset();
+            textElement.Reset();
+
+            ComPtr<ICanvasSvgElement> resolved;
+            Assert::AreEqual(S_OK, weakGroup.As(&resolved));
+            Assert::IsNull(resolved.Get());
+            Assert::AreEqual(S_OK, weakText.As(&resolved));
+            Assert::IsNull(resolved.Get());
+        }
     };
 }
 
@@ -2154,6 +2154,47 @@ TEST_CLASS(CanvasTextAnalyzerTests)
         f.GetGlyphsWithAllOptions(textAnalyzer);
     }
 
+    TEST_METHOD_EX(CanvasTextAnalyzer_GetGlyphs_RepeatedCallsReuseShapedRun)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        f.ExpectGetGlyphs();
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+
+        // The cache is shared between analyzers, so shaping the same text
+        // with the same options doesn't go back to DirectWrite.
+        auto otherTextAnalyzer = f.Create();
+
+        f.GetGlyphsWithAllOptions(otherTextAnalyzer);
+        f.GetGlyphs(otherTextAnalyzer);
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_GetGlyphs_ChangedOptionsAreShapedAgain)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        f.ExpectGetGlyphs();
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+
+        f.ExpectGetGlyphs();
+        f.Locale = L"xx-yy";
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+
+        f.ExpectGetGlyphs();
+        f.UseNumberSubstitution();
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+
+        f.ExpectGetGlyphs();
+        f.UseTypographyRanges();
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+
+        f.ExpectGetGlyphs();
+        f.FontSize += 1;
+        f.GetGlyphsWithAllOptions(textAnalyzer);
+    }
+
     TEST_METHOD_EX(CanvasGlyphJustification_Values)
     {
         Assert::AreEqual(0, static_cast<int>(CanvasGlyphJustification::None));
@@ -2298,6 +2339,536 @@ TEST_CLASS(CanvasTextAnalyzerTests)
         }
     }
 
+    TEST_METHOD_EX(CanvasTextAnalyzer_AnalyzeLineBreakpoints_SinkForPartOfText)
+    {
+        auto sink = Make<DWriteTextAnalysisSink>(10, 3);
+
+        std::vector<DWRITE_LINE_BREAKPOINT> dwriteLineBreakpoints;
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            dwriteLineBreakpoints.push_back(GetTestBreakpoint(i).DWriteBreakpoint);
+        }
+
+        Assert::AreEqual(S_OK, sink->SetLineBreakpoints(10, 3, dwriteLineBreakpoints.data()));
+
+        auto breakpoints = sink->GetAnalyzedLineBreakpoints();
+
+        Assert::AreEqual(3u, breakpoints.GetSize());
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            auto expected = GetTestBreakpoint(i).Breakpoint;
+            Assert::AreEqual(expected.BreakBefore, breakpoints[i].BreakBefore);
+            Assert::AreEqual(expected.BreakAfter, breakpoints[i].BreakAfter);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_AnalyzeParagraphsInParallel_DefaultsToFalse)
+    {
+        Fixture f;
+        auto textAnalyzer = f.Create();
+
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->get_AnalyzeParagraphsInParallel(nullptr));
+
+        boolean value;
+        Assert::AreEqual(S_OK, textAnalyzer->get_AnalyzeParagraphsInParallel(&value));
+        Assert::IsFalse(!!value);
+
+        Assert::AreEqual(S_OK, textAnalyzer->put_AnalyzeParagraphsInParallel(true));
+        Assert::AreEqual(S_OK, textAnalyzer->get_AnalyzeParagraphsInParallel(&value));
+        Assert::IsTrue(!!value);
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_AnalyzeParagraphsInParallel_ShortTextIsAnalyzedInOnePiece)
+    {
+        Fixture f;
+        f.Text = L"Some text\nin two paragraphs";
+        auto textAnalyzer = f.Create();
+
+        ThrowIfFailed(textAnalyzer->put_AnalyzeParagraphsInParallel(true));
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                Assert::AreEqual(0u, textPosition);
+                Assert::AreEqual(static_cast<uint32_t>(f.Text.length()), textLength);
+
+                ThrowIfFailed(sink->SetBidiLevel(textPosition, textLength, 1, 2));
+
+                return S_OK;
+            });
+
+        auto element = AssertUniformSpanAndReturnElement<CanvasAnalyzedBidi>(textAnalyzer, &ICanvasTextAnalyzer::GetBidi, static_cast<int>(f.Text.length()));
+
+        Assert::AreEqual(1u, element.ExplicitLevel);
+        Assert::AreEqual(2u, element.ResolvedLevel);
+    }
+
+    //
+    // Mock analysis that depends only on the characters analyzed, the way
+    // DirectWrite's does, so that analyzing the text in one piece and in
+    // parallel chunks must give the same results.  Arabic letters are right
+    // to left and have their own script and font (none, in fact); everything
+    // else is left to right.  Lines can break after spaces, and must break
+    // after paragraph separators.
+    //
+    struct ParallelAnalysisFixture : public Fixture
+    {
+        std::atomic<int> BidiCallCount;
+
+        ParallelAnalysisFixture()
+            : BidiCallCount(0)
+        {
+            std::wstring paragraph = L"Some text, \x0627\x0644\x0639\x0631\x0628\x064a\x0629 and more text.\n";
+
+            // Long enough to be split into several chunks of MinParallelChunkLength (16k).
+            while (Text.length() < 64 * 1024)
+                Text += paragraph;
+
+            Text += L"The end \x0627\x0644";
+
+            TextAnalyzer->AnalyzeBidiMethod.AllowAnyCall(
+                [=](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+                {
+                    ++BidiCallCount;
+
+                    ForEachRun(textPosition, textLength,
+                        [&](uint32_t start, uint32_t length, bool isArabic)
+                        {
+                            uint8_t level = isArabic ? 1 : 0;
+                            ThrowIfFailed(sink->SetBidiLevel(start, length, level, level));
+                        });
+
+                    return S_OK;
+                });
+
+            TextAnalyzer->AnalyzeScriptMethod.AllowAnyCall(
+                [=](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+                {
+                    ForEachRun(textPosition, textLength,
+                        [&](uint32_t start, uint32_t length, bool isArabic)
+                        {
+                            DWRITE_SCRIPT_ANALYSIS script{ static_cast<uint16_t>(isArabic ? 2 : 1), DWRITE_SCRIPT_SHAPES_DEFAULT };
+                            ThrowIfFailed(sink->SetScriptAnalysis(start, length, &script));
+                        });
+
+                    return S_OK;
+                });
+
+            TextAnalyzer->AnalyzeLineBreakpointsMethod.AllowAnyCall(
+                [=](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+                {
+                    std::vector<DWRITE_LINE_BREAKPOINT> breakpoints(textLength);
+
+                    for (uint32_t i = 0; i < textLength; ++i)
+                    {
+                        auto position = textPosition + i;
+
+                        // Nothing can break before the start of the analyzed text.
+                        breakpoints[i].breakConditionBefore = (i == 0) ? DWRITE_BREAK_CONDITION_MAY_NOT_BREAK : GetBreakAfter(position - 1);
+                        breakpoints[i].breakConditionAfter = GetBreakAfter(position);
+                        breakpoints[i].isWhitespace = iswspace(Text[position]) ? 1 : 0;
+                    }
+
+                    ThrowIfFailed(sink->SetLineBreakpoints(textPosition, textLength, breakpoints.data()));
+
+                    return S_OK;
+                });
+
+            m_mockSystemFontFallback->MapCharactersMethod.AllowAnyCall(
+                [=](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteFontCollection*, wchar_t const*, DWRITE_FONT_WEIGHT, DWRITE_FONT_STYLE, DWRITE_FONT_STRETCH, uint32_t* mappedLength, IDWriteFont** mappedFont, FLOAT* scale)
+                {
+                    bool isArabic = IsArabic(textPosition);
+
+                    *mappedLength = GetRunLength(textPosition, textLength);
+                    *scale = 1.0f;
+
+                    if (isArabic)
+                        *mappedFont = nullptr;
+                    else
+                        ThrowIfFailed(ReturnedFont.CopyTo(mappedFont));
+
+                    return S_OK;
+                });
+        }
+
+        bool IsArabic(uint32_t position) const
+        {
+            return Text[position] >= 0x600 && Text[position] <= 0x6FF;
+        }
+
+        uint32_t GetRunLength(uint32_t position, uint32_t maxLength) const
+        {
+            uint32_t length = 1;
+
+            while (length < maxLength && IsArabic(position + length) == IsArabic(position))
+                ++length;
+
+            return length;
+        }
+
+        template<typename FN>
+        void ForEachRun(uint32_t textPosition, uint32_t textLength, FN&& fn) const
+        {
+            auto end = textPosition + textLength;
+
+            for (auto position = textPosition; position < end; )
+            {
+                auto length = GetRunLength(position, end - position);
+                fn(position, length, IsArabic(position));
+                position += length;
+            }
+        }
+
+        DWRITE_BREAK_CONDITION GetBreakAfter(uint32_t position) const
+        {
+            switch (Text[position])
+            {
+            case L'\n': return DWRITE_BREAK_CONDITION_MUST_BREAK;
+            case L' ':  return DWRITE_BREAK_CONDITION_CAN_BREAK;
+            default:    return DWRITE_BREAK_CONDITION_MAY_NOT_BREAK;
+            }
+        }
+
+        ComPtr<ICanvasTextAnalyzer> Create(bool analyzeParagraphsInParallel)
+        {
+            auto textAnalyzer = Fixture::Create();
+            ThrowIfFailed(textAnalyzer->put_AnalyzeParagraphsInParallel(analyzeParagraphsInParallel));
+            return textAnalyzer;
+        }
+    };
+
+    template<typename T, typename FN>
+    static void AssertSameRanges(
+        IVectorView<IKeyValuePair<CanvasCharacterRange, T>*>* expected,
+        IVectorView<IKeyValuePair<CanvasCharacterRange, T>*>* actual,
+        FN&& assertSameValue)
+    {
+        uint32_t expectedSize;
+        uint32_t actualSize;
+        ThrowIfFailed(expected->get_Size(&expectedSize));
+        ThrowIfFailed(actual->get_Size(&actualSize));
+        Assert::AreEqual(expectedSize, actualSize);
+
+        for (uint32_t i = 0; i < expectedSize; ++i)
+        {
+            ComPtr<IKeyValuePair<CanvasCharacterRange, T>> expectedElement;
+            ComPtr<IKeyValuePair<CanvasCharacterRange, T>> actualElement;
+            ThrowIfFailed(expected->GetAt(i, &expectedElement));
+            ThrowIfFailed(actual->GetAt(i, &actualElement));
+
+            CanvasCharacterRange expectedRange;
+            CanvasCharacterRange actualRange;
+            ThrowIfFailed(expectedElement->get_Key(&expectedRange));
+            ThrowIfFailed(actualElement->get_Key(&actualRange));
+            Assert::AreEqual(expectedRange.CharacterIndex, actualRange.CharacterIndex);
+            Assert::AreEqual(expectedRange.CharacterCount, actualRange.CharacterCount);
+
+            assertSameValue(expectedElement.Get(), actualElement.Get());
+        }
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_AnalyzeParagraphsInParallel_GivesTheSameResultsAsSerialAnalysis)
+    {
+        ParallelAnalysisFixture f;
+
+        auto serialAnalyzer = f.Create(false);
+        auto parallelAnalyzer = f.Create(true);
+
+        // Bidi
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>*>> serialBidi;
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>*>> parallelBidi;
+
+        ThrowIfFailed(serialAnalyzer->GetBidi(&serialBidi));
+        Assert::AreEqual(1, f.BidiCallCount.load());
+
+        ThrowIfFailed(parallelAnalyzer->GetBidi(&parallelBidi));
+
+        // Only a single core machine analyzes the text in one piece.
+        if (std::thread::hardware_concurrency() > 1)
+            Assert::IsTrue(f.BidiCallCount.load() > 2);
+
+        AssertSameRanges(serialBidi.Get(), parallelBidi.Get(),
+            [](IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>* expected, IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>* actual)
+            {
+                CanvasAnalyzedBidi expectedValue, actualValue;
+                ThrowIfFailed(expected->get_Value(&expectedValue));
+                ThrowIfFailed(actual->get_Value(&actualValue));
+                Assert::AreEqual(expectedValue.ExplicitLevel, actualValue.ExplicitLevel);
+                Assert::AreEqual(expectedValue.ResolvedLevel, actualValue.ResolvedLevel);
+            });
+
+        // Script
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedScript>*>> serialScript;
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedScript>*>> parallelScript;
+
+        ThrowIfFailed(serialAnalyzer->GetScript(&serialScript));
+        ThrowIfFailed(parallelAnalyzer->GetScript(&parallelScript));
+
+        AssertSameRanges(serialScript.Get(), parallelScript.Get(),
+            [](IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedScript>* expected, IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedScript>* actual)
+            {
+                CanvasAnalyzedScript expectedValue, actualValue;
+                ThrowIfFailed(expected->get_Value(&expectedValue));
+                ThrowIfFailed(actual->get_Value(&actualValue));
+                Assert::AreEqual(expectedValue.ScriptIdentifier, actualValue.ScriptIdentifier);
+                Assert::AreEqual(expectedValue.Shape, actualValue.Shape);
+            });
+
+        // Fonts
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasScaledFont*>*>> serialFonts;
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasScaledFont*>*>> parallelFonts;
+
+        ThrowIfFailed(serialAnalyzer->GetFonts(f.TextFormat.Get(), nullptr, &serialFonts));
+        ThrowIfFailed(parallelAnalyzer->GetFonts(f.TextFormat.Get(), nullptr, &parallelFonts));
+
+        AssertSameRanges(serialFonts.Get(), parallelFonts.Get(),
+            [](IKeyValuePair<CanvasCharacterRange, CanvasScaledFont*>*, IKeyValuePair<CanvasCharacterRange, CanvasScaledFont*>*)
+            {
+                // Every range uses the same mock font.
+            });
+
+        // Breakpoints
+        ComArray<CanvasAnalyzedBreakpoint> serialBreakpoints;
+        ComArray<CanvasAnalyzedBreakpoint> parallelBreakpoints;
+
+        ThrowIfFailed(serialAnalyzer->GetBreakpoints(serialBreakpoints.GetAddressOfSize(), serialBreakpoints.GetAddressOfData()));
+        ThrowIfFailed(parallelAnalyzer->GetBreakpoints(parallelBreakpoints.GetAddressOfSize(), parallelBreakpoints.GetAddressOfData()));
+
+        Assert::AreEqual(static_cast<uint32_t>(f.Text.length()), serialBreakpoints.GetSize());
+        Assert::AreEqual(serialBreakpoints.GetSize(), parallelBreakpoints.GetSize());
+
+        for (uint32_t i = 0; i < serialBreakpoints.GetSize(); ++i)
+        {
+            Assert::AreEqual(serialBreakpoints[i].BreakBefore, parallelBreakpoints[i].BreakBefore);
+            Assert::AreEqual(serialBreakpoints[i].BreakAfter, parallelBreakpoints[i].BreakAfter);
+            Assert::AreEqual(serialBreakpoints[i].IsWhitespace, parallelBreakpoints[i].IsWhitespace);
+            Assert::AreEqual(serialBreakpoints[i].IsSoftHyphen, parallelBreakpoints[i].IsSoftHyphen);
+        }
+    }
+
+    static std::function<HRESULT(IDWriteTextAnalysisSource*, uint32_t, uint32_t, IDWriteTextAnalysisSink*)> ExpectBidiAnalysis(
+        uint32_t expectedPosition,
+        uint32_t expectedLength,
+        uint8_t level)
+    {
+        return
+            [=](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                Assert::AreEqual(expectedPosition, textPosition);
+                Assert::AreEqual(expectedLength, textLength);
+
+                ThrowIfFailed(sink->SetBidiLevel(textPosition, textLength, level, level));
+
+                return S_OK;
+            };
+    }
+
+    static void AssertBidiLevels(ComPtr<ICanvasTextAnalyzer> const& textAnalyzer, std::vector<std::pair<CanvasCharacterRange, uint32_t>> const& expected)
+    {
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>*>> result;
+        Assert::AreEqual(S_OK, textAnalyzer->GetBidi(&result));
+
+        uint32_t size;
+        ThrowIfFailed(result->get_Size(&size));
+        Assert::AreEqual(static_cast<uint32_t>(expected.size()), size);
+
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            ComPtr<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>> element;
+            ThrowIfFailed(result->GetAt(i, &element));
+
+            CanvasCharacterRange range;
+            ThrowIfFailed(element->get_Key(&range));
+
+            CanvasAnalyzedBidi bidi;
+            ThrowIfFailed(element->get_Value(&bidi));
+
+            Assert::AreEqual(expected[i].first.CharacterIndex, range.CharacterIndex);
+            Assert::AreEqual(expected[i].first.CharacterCount, range.CharacterCount);
+            Assert::AreEqual(expected[i].second, bidi.ResolvedLevel);
+        }
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_GetBidi_RepeatedCallsReuseResults)
+    {
+        Fixture f;
+        f.Text = L"aaa\nbbb";
+        auto textAnalyzer = f.Create();
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1, ExpectBidiAnalysis(0, 7, 1));
+
+        AssertBidiLevels(textAnalyzer, { { { 0, 7 }, 1 } });
+        AssertBidiLevels(textAnalyzer, { { { 0, 7 }, 1 } });
+
+        // A different locale is analyzed again.
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1, ExpectBidiAnalysis(0, 7, 2));
+
+        ComPtr<IVectorView<IKeyValuePair<CanvasCharacterRange, CanvasAnalyzedBidi>*>> result;
+        Assert::AreEqual(S_OK, textAnalyzer->GetBidiWithLocale(WinString(L"xx-yy"), &result));
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_ReplaceText_BadArgs)
+    {
+        Fixture f;
+        f.Text = L"aaa";
+        auto textAnalyzer = f.Create();
+
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->ReplaceText(CanvasCharacterRange{ -1, 1 }, WinString(L"b")));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->ReplaceText(CanvasCharacterRange{ 0, -1 }, WinString(L"b")));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->ReplaceText(CanvasCharacterRange{ 2, 2 }, WinString(L"b")));
+        Assert::AreEqual(E_INVALIDARG, textAnalyzer->ReplaceText(CanvasCharacterRange{ 4, 0 }, WinString(L"b")));
+
+        // Appending to the end is allowed.
+        Assert::AreEqual(S_OK, textAnalyzer->ReplaceText(CanvasCharacterRange{ 3, 0 }, WinString(L"b")));
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_ReplaceText_AnalyzesOnlyTheEditedParagraph)
+    {
+        Fixture f;
+        f.Text = L"aaa\nbbb\nccc";
+        auto textAnalyzer = f.Create();
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1, ExpectBidiAnalysis(0, 11, 0));
+        AssertBidiLevels(textAnalyzer, { { { 0, 11 }, 0 } });
+
+        // "aaa\nxxxxx\nccc" - just "xxxxx\n" is analyzed again.
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1, ExpectBidiAnalysis(4, 6, 1));
+        Assert::AreEqual(S_OK, textAnalyzer->ReplaceText(CanvasCharacterRange{ 4, 3 }, WinString(L"xxxxx")));
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(0);
+        AssertBidiLevels(textAnalyzer, { { { 0, 4 }, 0 }, { { 4, 6 }, 1 }, { { 10, 3 }, 0 } });
+
+        // Deleting the first separator joins two paragraphs: "aaaxxxxx\nccc".
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(1, ExpectBidiAnalysis(0, 9, 0));
+        Assert::AreEqual(S_OK, textAnalyzer->ReplaceText(CanvasCharacterRange{ 3, 1 }, WinString(L"")));
+
+        f.TextAnalyzer->AnalyzeBidiMethod.SetExpectedCalls(0);
+        AssertBidiLevels(textAnalyzer, { { { 0, 12 }, 0 } });
+    }
+
+    TEST_METHOD_EX(CanvasTextAnalyzer_ReplaceText_UpdatesBreakpoints)
+    {
+        Fixture f;
+        f.Text = L"aaa\nbbb";
+        auto textAnalyzer = f.Create();
+
+        auto setBreakpoints =
+            [](IDWriteTextAnalysisSource*, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                std::vector<DWRITE_LINE_BREAKPOINT> dwriteLineBreakpoints;
+
+                for (uint32_t i = 0; i < textLength; ++i)
+                {
+                    dwriteLineBreakpoints.push_back(GetTestBreakpoint(textPosition + i).DWriteBreakpoint);
+                }
+
+                ThrowIfFailed(sink->SetLineBreakpoints(textPosition, textLength, dwriteLineBreakpoints.data()));
+
+                return S_OK;
+            };
+
+        f.TextAnalyzer->AnalyzeLineBreakpointsMethod.SetExpectedCalls(1, setBreakpoints);
+
+        uint32_t breakpointCount;
+        CanvasAnalyzedBreakpoint* breakpoints;
+        Assert::AreEqual(S_OK, textAnalyzer->GetBreakpoints(&breakpointCount, &breakpoints));
+        CoTaskMemFree(breakpoints);
+
+        // "aaa\nbbbbb"
+        f.TextAnalyzer->AnalyzeLineBreakpointsMethod.SetExpectedCalls(1,
+            [&](IDWriteTextAnalysisSource* source, uint32_t textPosition, uint32_t textLength, IDWriteTextAnalysisSink* sink)
+            {
+                Assert::AreEqual(4u, textPosition);
+                Assert::AreEqual(5u, textLength);
+
+                return setBreakpoints(source, textPosition, textLength, sink);
+            });
+
+        Assert::AreEqual(S_OK, textAnalyzer->ReplaceText(CanvasCharacterRange{ 7, 0 }, WinString(L"bb")));
+
+        f.TextAnalyzer->AnalyzeLineBreakpointsMethod.SetExpectedCalls(0);
+
+        Assert::AreEqual(S_OK, textAnalyzer->GetBreakpoints(&breakpointCount, &breakpoints));
+        Assert::AreEqual(9u, breakpointCount);
+
+        for (uint32_t i = 0; i < breakpointCount; ++i)
+        {
+            auto expected = GetTestBreakpoint(i).Breakpoint;
+
+            // The edited paragraph's first character follows the one before it.
+            if (i == 4)
+                expected.BreakBefore = GetTestBreakpoint(3).Breakpoint.BreakAfter;
+
+            Assert::AreEqual(expected.BreakBefore, breakpoints[i].BreakBefore);
+            Assert::AreEqual(expected.BreakAfter, breakpoints[i].BreakAfter);
+        }
+
+        CoTaskMemFree(breakpoints);
+    }
+
+    TEST_METHOD_EX(TextAnalysisChunks_GetEditedParagraphs)
+    {
+        std::wstring text = L"aa\nbb\r\ncc\ndd";
+
+        // Within one paragraph.
+        Assert::AreEqual(3u, GetEditedParagraphs(text.c_str(), 12, 3, 4).Start);
+        Assert::AreEqual(7u, GetEditedParagraphs(text.c_str(), 12, 3, 4).End);
+
+        // Ending at the start of a paragraph includes it.
+        Assert::AreEqual(0u, GetEditedParagraphs(text.c_str(), 12, 1, 3).Start);
+        Assert::AreEqual(7u, GetEditedParagraphs(text.c_str(), 12, 1, 3).End);
+
+        // Just after a CR includes the paragraph that the CR ends.
+        Assert::AreEqual(3u, GetEditedParagraphs(text.c_str(), 12, 6, 6).Start);
+        Assert::AreEqual(7u, GetEditedParagraphs(text.c_str(), 12, 6, 6).End);
+
+        // The last paragraph runs to the end of the text.
+        Assert::AreEqual(10u, GetEditedParagraphs(text.c_str(), 12, 11, 12).Start);
+        Assert::AreEqual(12u, GetEditedParagraphs(text.c_str(), 12, 11, 12).End);
+    }
+
+    static void AssertChunks(std::vector<TextChunk> const& expected, std::vector<TextChunk> const& actual)
+    {
+        Assert::AreEqual<size_t>(expected.size(), actual.size());
+
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            Assert::AreEqual(expected[i].Start, actual[i].Start);
+            Assert::AreEqual(expected[i].End, actual[i].End);
+        }
+    }
+
+    TEST_METHOD_EX(TextAnalysisChunks_SplitTextAtParagraphs_SplitsAfterSeparators)
+    {
+        std::wstring text = L"aaaa\r\nbbbb\ncccc";
+
+        // CR LF stays in the first chunk.
+        AssertChunks({ { 0, 6 }, { 6, 11 }, { 11, 15 } }, SplitTextAtParagraphs(text.c_str(), 15, 3, 4));
+
+        AssertChunks({ { 0, 11 }, { 11, 15 } }, SplitTextAtParagraphs(text.c_str(), 15, 2, 4));
+
+        // Fewer chunks are used when they would be too short.
+        AssertChunks({ { 0, 15 } }, SplitTextAtParagraphs(text.c_str(), 15, 3, 6));
+    }
+
+    TEST_METHOD_EX(TextAnalysisChunks_SplitTextAtParagraphs_ShortTailJoinsLastChunk)
+    {
+        std::wstring text = L"aaaa\nbb";
+
+        AssertChunks({ { 0, 7 } }, SplitTextAtParagraphs(text.c_str(), 7, 2, 3));
+    }
+
+    TEST_METHOD_EX(TextAnalysisChunks_SplitTextAtParagraphs_TextWithoutSeparatorsIsOneChunk)
+    {
+        std::wstring text = L"aaaaaaaaaaaa";
+
+        AssertChunks({ { 0, 12 } }, SplitTextAtParagraphs(text.c_str(), 12, 4, 2));
+
+        AssertChunks({ { 0, 0 } }, SplitTextAtParagraphs(L"", 0, 4, 2));
+    }
+
     TEST_METHOD_EX(CanvasTextAnalyzer_GetNumberSubstitutions_BadArg)
     {
         Fixture f;
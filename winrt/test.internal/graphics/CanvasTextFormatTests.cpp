@@ -1213,6 +1213,83 @@ namespace canvas
             Assert::AreEqual(static_cast<wchar_t const*>(f.AnyFullFontFamilyName), static_cast<wchar_t const*>(actualFontFamily));
         }
 
+        TEST_METHOD_EX(CanvasTextFormat_SharedRealizedTextFormat_IsSharedByFormatsWithTheSameProperties)
+        {
+            CustomFontFixture f;
+
+            auto cf1 = Make<CanvasTextFormat>();
+            auto cf2 = Make<CanvasTextFormat>();
+            auto cf3 = Make<CanvasTextFormat>();
+
+            for (auto& cf : { cf1, cf2, cf3 })
+                ThrowIfFailed(cf->put_FontFamily(f.AnyFullFontFamilyName));
+
+            ThrowIfFailed(cf3->put_FontSize(99));
+
+            // The font collection is only loaded for formats that miss the cache
+            f.ExpectCreateCustomFontCollection(f.AnyPath);
+            auto df1 = cf1->GetSharedRealizedTextFormat();
+
+            f.DontExpectCreateCustomFontCollection();
+            auto df2 = cf2->GetSharedRealizedTextFormat();
+
+            Assert::IsTrue(IsSameInstance(df1.Get(), df2.Get()));
+
+            f.ExpectCreateCustomFontCollection(f.AnyPath);
+            auto df3 = cf3->GetSharedRealizedTextFormat();
+
+            Assert::IsFalse(IsSameInstance(df1.Get(), df3.Get()));
+            Assert::AreEqual(99.0f, df3->GetFontSize());
+
+            auto stats = CustomFontManager::GetInstance()->GetRealizedTextFormatCache().GetStatistics();
+            Assert::AreEqual<uint64_t>(1, stats.HitCount);
+            Assert::AreEqual<uint64_t>(2, stats.MissCount);
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedRealizedTextFormat_IsNeverTheFormatsOwnRealizedTextFormat)
+        {
+            CustomFontFixture f;
+
+            auto cf1 = Make<CanvasTextFormat>();
+            auto cf2 = Make<CanvasTextFormat>();
+
+            auto sharedFormat = cf1->GetSharedRealizedTextFormat();
+
+            // Getting the shared format doesn't realize the text format, so
+            // changing a property doesn't affect the shared format.
+            ThrowIfFailed(cf1->put_FontSize(99));
+            Assert::AreEqual(20.0f, sharedFormat->GetFontSize());
+
+            // A format that has been realized (eg. for interop) uses its own
+            // IDWriteTextFormat, since it may have been changed.
+            auto ownFormat = cf2->GetRealizedTextFormat();
+            Assert::IsFalse(IsSameInstance(sharedFormat.Get(), ownFormat.Get()));
+            Assert::IsTrue(IsSameInstance(ownFormat.Get(), cf2->GetSharedRealizedTextFormat().Get()));
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedRealizedTextFormat_IsNotUsedWithACustomTrimmingSign)
+        {
+            CustomFontFixture f;
+
+            auto cf = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf->put_CustomTrimmingSign(Make<CustomInlineObject>().Get()));
+
+            auto df = cf->GetSharedRealizedTextFormat();
+
+            Assert::IsTrue(IsSameInstance(cf->GetRealizedTextFormat().Get(), df.Get()));
+            Assert::AreEqual<size_t>(0, CustomFontManager::GetInstance()->GetRealizedTextFormatCache().GetCount());
+        }
+
+        TEST_METHOD_EX(CanvasTextFormat_SharedRealizedTextFormat_FailsWhenClosed)
+        {
+            CustomFontFixture f;
+
+            auto cf = Make<CanvasTextFormat>();
+            ThrowIfFailed(cf->Close());
+
+            ExpectHResultException(RO_E_CLOSED, [&] { cf->GetSharedRealizedTextFormat(); });
+        }
+
         TEST_METHOD_EX(CanvasTextFormat_WhenGetFileFromApplicationUriFails_HelpfulErrorMessageIsThrown)
         {
             auto adapter = std::make_shared<StubFontManagerAdapter>();
@@ -2835,6 +2835,64 @@ namespace canvas
             Assert::IsTrue(IsSameInstance(expectedTypography.Get(), typography.Get()));
         }
 
+        TEST_METHOD_EX(CanvasTextLayoutTests_CreateCached_ReturnsSameLayoutForSameInputs)
+        {
+            Fixture f;
+            auto factory = Make<CanvasTextLayoutFactory>();
+
+            int createTextLayoutCount = 0;
+            f.Adapter->GetMockDWriteFactory()->CreateTextLayoutMethod.AllowAnyCall(
+                [&](WCHAR const*, UINT32, IDWriteTextFormat*, FLOAT, FLOAT, IDWriteTextLayout** textLayout)
+                {
+                    ++createTextLayoutCount;
+                    return f.Adapter->MockTextLayout.CopyTo(textLayout);
+                });
+
+            ComPtr<ICanvasTextLayout> first;
+            Assert::AreEqual(S_OK, factory->CreateCached(f.Device.Get(), WinString(L"A string"), f.Format.Get(), 100, 50, CanvasDrawTextOptions::Clip, &first));
+
+            ComPtr<ICanvasTextLayout> second;
+            Assert::AreEqual(S_OK, factory->CreateCached(f.Device.Get(), WinString(L"A string"), f.Format.Get(), 100, 50, CanvasDrawTextOptions::Clip, &second));
+
+            Assert::IsTrue(IsSameInstance(first.Get(), second.Get()));
+            Assert::AreEqual(1, createTextLayoutCount);
+
+            CanvasDrawTextOptions options;
+            Assert::AreEqual(S_OK, first->get_Options(&options));
+            Assert::AreEqual(CanvasDrawTextOptions::Clip, options);
+
+            CanvasTextLayoutCacheStatistics statistics;
+            Assert::AreEqual(S_OK, factory->GetCacheStatistics(f.Device.Get(), &statistics));
+            Assert::AreEqual<uint64_t>(1, statistics.HitCount);
+            Assert::AreEqual<uint64_t>(1, statistics.MissCount);
+            Assert::AreEqual(TextLayoutCache::EstimateByteCount(8), statistics.ByteCount);
+
+            Assert::AreEqual(S_OK, factory->SetCacheMaximumByteCount(f.Device.Get(), 0));
+            Assert::AreEqual(S_OK, factory->GetCacheStatistics(f.Device.Get(), &statistics));
+            Assert::AreEqual<uint64_t>(1, statistics.EvictedCount);
+            Assert::AreEqual<uint64_t>(0, statistics.ByteCount);
+        }
+
+        TEST_METHOD_EX(CanvasTextLayoutTests_CreateCached_LayoutCannotBeModified)
+        {
+            Fixture f;
+            auto factory = Make<CanvasTextLayoutFactory>();
+
+            ComPtr<ICanvasTextLayout> textLayout;
+            Assert::AreEqual(S_OK, factory->CreateCached(f.Device.Get(), WinString(L"A string"), f.Format.Get(), 100, 50, CanvasDrawTextOptions::Default, &textLayout));
+
+            Assert::AreEqual(E_ILLEGAL_METHOD_CALL, textLayout->put_Options(CanvasDrawTextOptions::Clip));
+            Assert::AreEqual(E_ILLEGAL_METHOD_CALL, textLayout->put_WordWrapping(CanvasWordWrapping::NoWrap));
+            Assert::AreEqual(E_ILLEGAL_METHOD_CALL, textLayout->SetFontSize(0, 1, 12));
+            Assert::AreEqual(E_ILLEGAL_METHOD_CALL, textLayout->SetColor(0, 1, Color{}));
+
+            // Other callers may share the layout, so closing it does nothing.
+            Assert::AreEqual(S_OK, As<ABI::Windows::Foundation::IClosable>(textLayout)->Close());
+
+            CanvasDrawTextOptions options;
+            Assert::AreEqual(S_OK, textLayout->get_Options(&options));
+        }
+
         TEST_METHOD_EX(CanvasTextLayoutTests_GetGlyphOrientationTransform_InvalidArg)
         {
             auto factory = Make<CanvasTextLayoutFactory>();
@@ -4,6 +4,8 @@
 
 #include "pch.h"
 
+#include "utils/StressTestHelpers.h"
+
 class CountedD2DDeviceContext : public MockD2DDeviceContext
 {
     int* m_counter;
@@ -22,6 +24,17 @@ public:
 };
 
 
+// Thread safe version of CountedD2DDeviceContext, for the stress tests.
+class ThreadSafeCountedD2DDeviceContext : public MockD2DDeviceContext, public PooledObjectTracker
+{
+public:
+    ThreadSafeCountedD2DDeviceContext(std::atomic<int>* counter)
+        : PooledObjectTracker(counter)
+    {
+    }
+};
+
+
 TEST_CLASS(DeviceContextPoolUnitTests)
 {
 public:
@@ -128,7 +141,29 @@ public:
 
         f.PopulatePool();
         
-        Assert::AreEqual<int>(std::thread::hardware_concurrency(), f.NumberOfActiveDeviceContexts);
+        Assert::AreEqual<int>(DeviceContextPool::DefaultMaxPoolSize(), f.NumberOfActiveDeviceContexts);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_SetMaxPoolSize_LimitsPoolAndReleasesSurplusContexts)
+    {
+        Fixture f;
+
+        f.PopulatePool();
+
+        f.Pool.SetMaxPoolSize(1);
+        Assert::AreEqual(1u, f.Pool.GetMaxPoolSize());
+        Assert::AreEqual(1, f.NumberOfActiveDeviceContexts);
+
+        f.Pool.SetMaxPoolSize(0);
+        Assert::AreEqual(0, f.NumberOfActiveDeviceContexts);
+
+        // With no pool, every lease creates a new context and drops it again.
+        f.CreateDeviceContextMethod.SetExpectedCalls(2);
+        f.Pool.TakeLease();
+        f.Pool.TakeLease();
+        Assert::AreEqual(0, f.NumberOfActiveDeviceContexts);
+
+        ExpectHResultException(E_INVALIDARG, [&] { f.Pool.SetMaxPoolSize(DeviceContextPool::MaxPoolSizeLimit + 1); });
     }
 
     TEST_METHOD_EX(DeviceContextPool_WhenClosed_PoolIsEmptied)
@@ -166,4 +201,298 @@ public:
 
         ExpectHResultException(RO_E_CLOSED, [&] { f.Pool.TakeLease(); });
     }
+
+    TEST_METHOD_EX(DeviceContextPool_Statistics_CountLeasesMissesAndDiscards)
+    {
+        Fixture f;
+
+        auto statistics = f.Pool.GetStatistics();
+        Assert::AreEqual<uint64_t>(0, statistics.LeaseCount);
+        Assert::AreEqual<uint32_t>(0, statistics.PeakActiveLeaseCount);
+
+        f.PopulatePool();
+
+        auto poolSize = DeviceContextPool::DefaultMaxPoolSize();
+
+        statistics = f.Pool.GetStatistics();
+        Assert::AreEqual<uint64_t>(100, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(100, statistics.MissCount);
+        Assert::AreEqual<uint64_t>(100, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(100 - poolSize, statistics.DiscardedCount);
+        Assert::AreEqual<uint32_t>(0, statistics.ActiveLeaseCount);
+        Assert::AreEqual<uint32_t>(100, statistics.PeakActiveLeaseCount);
+
+        {
+            auto lease = f.Pool.TakeLease();
+            Assert::AreEqual<uint32_t>(1, f.Pool.GetStatistics().ActiveLeaseCount);
+        }
+
+        statistics = f.Pool.GetStatistics();
+        Assert::AreEqual<uint64_t>(101, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(100, statistics.MissCount);
+        Assert::AreEqual<uint32_t>(0, statistics.ActiveLeaseCount);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_MovedFromLeases_AreNotCountedTwice)
+    {
+        Fixture f;
+        f.CreateDeviceContextMethod.SetExpectedCalls(1);
+
+        {
+            auto lease1 = f.Pool.TakeLease();
+            auto lease2 = std::move(lease1);
+            DeviceContextLease lease3(std::move(lease2));
+        }
+
+        Assert::AreEqual<uint32_t>(0, f.Pool.GetStatistics().ActiveLeaseCount);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_MaxPoolSize_LimitsNumberOfPooledContexts)
+    {
+        for (uint32_t maxPoolSize : { 1U, 2U, 7U })
+        {
+            auto device = Make<MockD2DDevice>();
+            int numberOfActiveDeviceContexts = 0;
+
+            device->MockCreateDeviceContext =
+                [&] (D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** deviceContext)
+                {
+                    Make<CountedD2DDeviceContext>(&numberOfActiveDeviceContexts).CopyTo(deviceContext);
+                };
+
+            DeviceContextPool pool(device.Get(), maxPoolSize);
+
+            {
+                std::vector<DeviceContextLease> leases;
+                for (int i = 0; i < 20; ++i)
+                    leases.push_back(pool.TakeLease());
+            }
+
+            Assert::AreEqual<int>(maxPoolSize, numberOfActiveDeviceContexts);
+            Assert::AreEqual<uint64_t>(20 - maxPoolSize, pool.GetStatistics().DiscardedCount);
+        }
+    }
+
+    struct StressFixture
+    {
+        ComPtr<MockD2DDevice> Device;
+        std::atomic<int> NumberOfActiveDeviceContexts;
+        std::atomic<int> CreateCount;
+        std::atomic<int> SharedLeaseCount;
+        DeviceContextPool Pool;
+
+        StressFixture(uint32_t maxPoolSize)
+            : Device(Make<MockD2DDevice>())
+            , NumberOfActiveDeviceContexts(0)
+            , CreateCount(0)
+            , SharedLeaseCount(0)
+            , Pool(Device.Get(), maxPoolSize)
+        {
+            Device->MockCreateDeviceContext =
+                [=] (D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** deviceContext)
+                {
+                    ++CreateCount;
+                    Make<ThreadSafeCountedD2DDeviceContext>(&NumberOfActiveDeviceContexts).CopyTo(deviceContext);
+                };
+        }
+
+        void Use(DeviceContextLease& lease)
+        {
+            auto deviceContext = static_cast<ThreadSafeCountedD2DDeviceContext*>(lease.Get());
+
+            if (!deviceContext->UseExclusively())
+                ++SharedLeaseCount;
+        }
+    };
+
+    TEST_METHOD_EX(DeviceContextPool_Stress_ConcurrentLeasesAreNeverShared)
+    {
+        int const threadCount = 16;
+        int const iterations = 5000;
+        uint32_t const maxPoolSize = 4;
+
+        StressFixture f(maxPoolSize);
+
+        RunOnThreads(threadCount, iterations,
+            [&]
+            {
+                auto lease = f.Pool.TakeLease();
+                f.Use(lease);
+                return true;
+            });
+
+        Assert::AreEqual(0, static_cast<int>(f.SharedLeaseCount));
+
+        auto statistics = f.Pool.GetStatistics();
+
+        Assert::AreEqual<uint64_t>(threadCount * iterations, statistics.LeaseCount);
+        Assert::AreEqual<uint32_t>(0, statistics.ActiveLeaseCount);
+        Assert::IsTrue(statistics.PeakActiveLeaseCount <= threadCount);
+        Assert::AreEqual<uint64_t>(f.CreateCount, statistics.CreatedCount);
+
+        // Everything that was created and not discarded is sitting in the
+        // pool, which never grows beyond its high water mark.
+        Assert::AreEqual<uint64_t>(statistics.CreatedCount - statistics.DiscardedCount, f.NumberOfActiveDeviceContexts);
+        Assert::IsTrue(f.NumberOfActiveDeviceContexts <= static_cast<int>(maxPoolSize));
+
+        f.Pool.Close();
+        Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveDeviceContexts));
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_Stress_NestedLeasesFromManyThreads)
+    {
+        int const threadCount = 8;
+        int const iterations = 2000;
+
+        StressFixture f(DeviceContextPool::DefaultMaxPoolSize());
+
+        RunOnThreads(threadCount, iterations,
+            [&]
+            {
+                auto outer = f.Pool.TakeLease();
+                auto inner = f.Pool.TakeLease();
+
+                if (outer.Get() == inner.Get())
+                    ++f.SharedLeaseCount;
+
+                f.Use(outer);
+                f.Use(inner);
+                return true;
+            });
+
+        Assert::AreEqual(0, static_cast<int>(f.SharedLeaseCount));
+
+        auto statistics = f.Pool.GetStatistics();
+        Assert::AreEqual<uint64_t>(threadCount * iterations * 2, statistics.LeaseCount);
+        Assert::AreEqual<uint32_t>(0, statistics.ActiveLeaseCount);
+        Assert::IsTrue(statistics.PeakActiveLeaseCount <= threadCount * 2);
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_Stress_CloseWhileLeasesAreActive_DestroysAllContexts)
+    {
+        int const threadCount = 8;
+
+        StressFixture f(DeviceContextPool::DefaultMaxPoolSize());
+
+        std::atomic<int> leasesTaken(0);
+        std::atomic<int> unexpectedErrors(0);
+
+        std::thread closer(
+            [&]
+            {
+                while (leasesTaken < 1000)
+                    std::this_thread::yield();
+
+                f.Pool.Close();
+            });
+
+        RunOnThreads(threadCount, std::numeric_limits<int>::max(),
+            [&]
+            {
+                try
+                {
+                    auto lease = f.Pool.TakeLease();
+                    ++leasesTaken;
+                    f.Use(lease);
+                    return true;
+                }
+                catch (HResultException const& e)
+                {
+                    if (e.GetHr() != RO_E_CLOSED)
+                        ++unexpectedErrors;
+
+                    return false;
+                }
+            });
+
+        closer.join();
+
+        Assert::AreEqual(0, static_cast<int>(unexpectedErrors));
+        Assert::AreEqual(0, static_cast<int>(f.SharedLeaseCount));
+
+        // Every lease has been returned, and the pool is closed, so nothing
+        // should be keeping any contexts alive.
+        Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveDeviceContexts));
+    }
+
+    TEST_METHOD_EX(DeviceContextPool_Stress_CloseWhileLeasesAreBeingCreated_WaitsForThem)
+    {
+        int const threadCount = 8;
+
+        // A pool of one means most leases have to create a context.
+        StressFixture f(1);
+
+        std::atomic<int> creatingCount(0);
+        std::atomic<bool> closed(false);
+        std::atomic<int> createdAfterClose(0);
+
+        f.Device->MockCreateDeviceContext =
+            [&] (D2D1_DEVICE_CONTEXT_OPTIONS, ID2D1DeviceContext1** deviceContext)
+            {
+                ++creatingCount;
+
+                if (closed)
+                    ++createdAfterClose;
+
+                // Give Close a chance to run while this is in progress.
+                std::this_thread::yield();
+
+                ++f.CreateCount;
+                Make<ThreadSafeCountedD2DDeviceContext>(&f.NumberOfActiveDeviceContexts).CopyTo(deviceContext);
+
+                if (closed)
+                    ++createdAfterClose;
+
+                --creatingCount;
+            };
+
+        std::atomic<int> leasesTaken(0);
+        std::atomic<int> unexpectedErrors(0);
+        std::atomic<int> stillCreatingAfterClose(0);
+
+        std::thread closer(
+            [&]
+            {
+                while (leasesTaken < 1000)
+                    std::this_thread::yield();
+
+                f.Pool.Close();
+
+                // Close must not return while any thread is still using the
+                // device to create a context.
+                if (creatingCount != 0)
+                    ++stillCreatingAfterClose;
+
+                closed = true;
+            });
+
+        RunOnThreads(threadCount, std::numeric_limits<int>::max(),
+            [&]
+            {
+                try
+                {
+                    auto outer = f.Pool.TakeLease();
+                    auto inner = f.Pool.TakeLease();
+                    leasesTaken += 2;
+                    return true;
+                }
+                catch (HResultException const& e)
+                {
+                    if (e.GetHr() != RO_E_CLOSED)
+                        ++unexpectedErrors;
+
+                    return false;
+                }
+            });
+
+        closer.join();
+
+        Assert::AreEqual(0, static_cast<int>(unexpectedErrors));
+        Assert::AreEqual(0, static_cast<int>(stillCreatingAfterClose));
+        Assert::AreEqual(0, static_cast<int>(createdAfterClose));
+
+        // Leases returned while, or after, the pool was closed must not have
+        // been put back in a slot.
+        Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveDeviceContexts));
+    }
 };
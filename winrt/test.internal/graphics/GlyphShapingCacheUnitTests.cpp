@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "mocks/MockDWriteFontFace.h"
+#include <lib/text/GlyphShapingCache.h>
+
+TEST_CLASS(GlyphShapingCacheUnitTests)
+{
+    static GlyphShapingKey MakeKey(wchar_t const* text, float fontSize = 12)
+    {
+        GlyphShapingKey key;
+        key.AddBytes(text, wcslen(text) * sizeof(wchar_t));
+        key.AddValue(fontSize);
+        return key;
+    }
+
+    static ShapedGlyphRun MakeRun(uint32_t glyphCount, uint32_t spareCapacity = 0)
+    {
+        ShapedGlyphRun run;
+        run.GlyphCount = glyphCount;
+        run.ClusterMap.resize(glyphCount);
+        run.ShapingTextProperties.resize(glyphCount);
+        run.GlyphIndices.resize(glyphCount + spareCapacity);
+        run.ShapingGlyphProperties.resize(glyphCount + spareCapacity);
+        run.GlyphAdvances.resize(glyphCount);
+        run.GlyphOffsets.resize(glyphCount);
+
+        for (uint32_t i = 0; i < glyphCount; ++i)
+        {
+            run.GlyphIndices[i] = static_cast<uint16_t>(100 + i);
+            run.GlyphAdvances[i] = static_cast<float>(i);
+        }
+
+        return run;
+    }
+
+    TEST_METHOD_EX(GlyphShapingKey_EqualityDependsOnContent)
+    {
+        Assert::IsTrue(MakeKey(L"abc") == MakeKey(L"abc"));
+        Assert::AreEqual(MakeKey(L"abc").GetHash(), MakeKey(L"abc").GetHash());
+
+        Assert::IsTrue(MakeKey(L"abc") != MakeKey(L"abd"));
+        Assert::IsTrue(MakeKey(L"abc") != MakeKey(L"abc", 13));
+
+        auto key = MakeKey(L"abc");
+        key.Reset();
+        Assert::IsTrue(key == GlyphShapingKey());
+    }
+
+    TEST_METHOD_EX(GlyphShapingCache_TryGet_ReturnsTrimmedCopyOfAddedRun)
+    {
+        GlyphShapingCache cache;
+        auto fontFace = Make<MockDWriteFontFace>();
+
+        Assert::IsNull(cache.TryGet(MakeKey(L"abc")).get());
+
+        cache.Add(MakeKey(L"abc"), fontFace.Get(), nullptr, MakeRun(3, 16));
+
+        auto run = cache.TryGet(MakeKey(L"abc"));
+        Assert::IsNotNull(run.get());
+        Assert::AreEqual(3u, run->GlyphCount);
+        Assert::AreEqual<size_t>(3, run->GlyphIndices.size());
+        Assert::AreEqual<size_t>(3, run->ShapingGlyphProperties.size());
+        Assert::AreEqual(static_cast<uint16_t>(102), run->GlyphIndices[2]);
+        Assert::AreEqual(2.0f, run->GlyphAdvances[2]);
+
+        Assert::IsNull(cache.TryGet(MakeKey(L"abc", 24)).get());
+
+        auto stats = cache.GetStatistics();
+        Assert::AreEqual<uint64_t>(1, stats.HitCount);
+        Assert::AreEqual<uint64_t>(2, stats.MissCount);
+    }
+
+    TEST_METHOD_EX(GlyphShapingCache_EvictsLeastRecentlyUsed)
+    {
+        GlyphShapingCache cache(2);
+        auto fontFace = Make<MockDWriteFontFace>();
+
+        cache.Add(MakeKey(L"a"), fontFace.Get(), nullptr, MakeRun(1));
+        cache.Add(MakeKey(L"b"), fontFace.Get(), nullptr, MakeRun(1));
+
+        // Using "a" makes "b" the least recently used.
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).get());
+
+        cache.Add(MakeKey(L"c"), fontFace.Get(), nullptr, MakeRun(1));
+
+        Assert::AreEqual<size_t>(2, cache.GetCount());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"b")).get());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"c")).get());
+
+        Assert::AreEqual<uint64_t>(1, cache.GetStatistics().EvictedCount);
+
+        cache.SetCapacity(0);
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+
+        cache.Add(MakeKey(L"d"), fontFace.Get(), nullptr, MakeRun(1));
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+    }
+
+    TEST_METHOD_EX(GlyphShapingCache_CachedRunsOutliveEviction)
+    {
+        GlyphShapingCache cache;
+        auto fontFace = Make<MockDWriteFontFace>();
+
+        cache.Add(MakeKey(L"abc"), fontFace.Get(), nullptr, MakeRun(3));
+
+        auto run = cache.TryGet(MakeKey(L"abc"));
+
+        cache.Clear();
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+
+        Assert::AreEqual(3u, run->GlyphCount);
+        Assert::AreEqual(static_cast<uint16_t>(101), run->GlyphIndices[1]);
+    }
+};
@@ -0,0 +1,199 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "stubs/StubD2DEffect.h"
+#include "utils/StressTestHelpers.h"
+
+class CountedD2DEffect : public StubD2DEffect, public PooledObjectTracker
+{
+public:
+    IID const EffectId;
+
+    CountedD2DEffect(IID const& effectId, std::atomic<int>* counter)
+        : StubD2DEffect(effectId)
+        , PooledObjectTracker(counter)
+        , EffectId(effectId)
+    {
+    }
+};
+
+
+// CreateEffect may be called from several threads at once, which the
+// CALL_COUNTER based mock doesn't support.
+class EffectCreatingD2DDeviceContext : public MockD2DDeviceContext
+{
+    std::atomic<int>* m_counter;
+
+public:
+    EffectCreatingD2DDeviceContext(std::atomic<int>* counter)
+        : m_counter(counter)
+    {
+    }
+
+    IFACEMETHODIMP CreateEffect(IID const& effectId, ID2D1Effect** effect) override
+    {
+        return Make<CountedD2DEffect>(effectId, m_counter).CopyTo(effect);
+    }
+};
+
+
+TEST_CLASS(HistogramEffectPoolUnitTests)
+{
+    struct Fixture
+    {
+        std::atomic<int> NumberOfActiveEffects;
+        ComPtr<EffectCreatingD2DDeviceContext> DeviceContext;
+
+        Fixture()
+            : NumberOfActiveEffects(0)
+            , DeviceContext(Make<EffectCreatingD2DDeviceContext>(&NumberOfActiveEffects))
+        {
+        }
+    };
+
+    TEST_METHOD_EX(HistogramEffectPool_Lease_CreatesHistogramAndAtlasEffects)
+    {
+        Fixture f;
+        HistogramEffectPool pool;
+
+        auto effects = pool.Lease(f.DeviceContext.Get());
+
+        Assert::AreEqual(CLSID_D2D1Histogram, static_cast<CountedD2DEffect*>(effects.HistogramEffect.Get())->EffectId);
+        Assert::AreEqual(CLSID_D2D1Atlas, static_cast<CountedD2DEffect*>(effects.AtlasEffect.Get())->EffectId);
+        Assert::AreEqual(2, static_cast<int>(f.NumberOfActiveEffects));
+    }
+
+    TEST_METHOD_EX(HistogramEffectPool_ReleasedEffectsAreReused)
+    {
+        Fixture f;
+        HistogramEffectPool pool;
+
+        auto effects = pool.Lease(f.DeviceContext.Get());
+        auto histogram = effects.HistogramEffect;
+        auto atlas = effects.AtlasEffect;
+
+        pool.Release(std::move(effects));
+
+        Assert::IsNull(effects.HistogramEffect.Get());
+        Assert::IsNull(effects.AtlasEffect.Get());
+        Assert::AreEqual(1u, pool.GetPooledCount());
+
+        effects = pool.Lease(f.DeviceContext.Get());
+
+        Assert::IsTrue(IsSameInstance(histogram.Get(), effects.HistogramEffect.Get()));
+        Assert::IsTrue(IsSameInstance(atlas.Get(), effects.AtlasEffect.Get()));
+        Assert::AreEqual(0u, pool.GetPooledCount());
+
+        auto statistics = pool.GetStatistics();
+
+        Assert::AreEqual<uint64_t>(2, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(1, statistics.ReusedCount);
+        Assert::AreEqual<uint64_t>(1, statistics.CreatedCount);
+        Assert::AreEqual<uint64_t>(0, statistics.DiscardedCount);
+    }
+
+    TEST_METHOD_EX(HistogramEffectPool_Capacity_LimitsNumberOfPooledEffects)
+    {
+        Fixture f;
+        HistogramEffectPool pool(2);
+
+        Assert::AreEqual(2u, pool.GetCapacity());
+
+        std::vector<HistogramAndAtlasEffects> leased;
+
+        for (int i = 0; i < 3; i++)
+        {
+            leased.push_back(pool.Lease(f.DeviceContext.Get()));
+        }
+
+        for (auto& effects : leased)
+        {
+            pool.Release(std::move(effects));
+        }
+
+        Assert::AreEqual(2u, pool.GetPooledCount());
+        Assert::AreEqual(4, static_cast<int>(f.NumberOfActiveEffects));
+        Assert::AreEqual<uint64_t>(1, pool.GetStatistics().DiscardedCount);
+
+        // Shrinking the pool releases effects that no longer fit.
+        pool.SetCapacity(1);
+
+        Assert::AreEqual(1u, pool.GetPooledCount());
+        Assert::AreEqual(2, static_cast<int>(f.NumberOfActiveEffects));
+
+        // A capacity of zero disables pooling.
+        pool.SetCapacity(0);
+
+        Assert::AreEqual(0u, pool.GetPooledCount());
+
+        pool.Release(pool.Lease(f.DeviceContext.Get()));
+
+        Assert::AreEqual(0u, pool.GetPooledCount());
+        Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveEffects));
+
+        ExpectHResultException(E_INVALIDARG, [&] { pool.SetCapacity(HistogramEffectPool::MaximumCapacity + 1); });
+        Assert::AreEqual(0u, pool.GetCapacity());
+    }
+
+    TEST_METHOD_EX(HistogramEffectPool_Clear_ReleasesPooledEffects)
+    {
+        Fixture f;
+
+        {
+            HistogramEffectPool pool;
+
+            pool.Release(pool.Lease(f.DeviceContext.Get()));
+            Assert::AreEqual(2, static_cast<int>(f.NumberOfActiveEffects));
+
+            pool.Clear();
+            Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveEffects));
+
+            pool.Release(pool.Lease(f.DeviceContext.Get()));
+            Assert::AreEqual(2, static_cast<int>(f.NumberOfActiveEffects));
+        }
+
+        // As does destroying the pool.
+        Assert::AreEqual(0, static_cast<int>(f.NumberOfActiveEffects));
+    }
+
+    TEST_METHOD_EX(HistogramEffectPool_Stress_ConcurrentLeasesAreNeverShared)
+    {
+        int const threadCount = 16;
+        int const iterations = 2000;
+        uint32_t const capacity = 4;
+
+        Fixture f;
+        HistogramEffectPool pool(capacity);
+        std::atomic<int> sharedLeaseCount(0);
+
+        RunOnThreads(threadCount, iterations,
+            [&]
+            {
+                auto effects = pool.Lease(f.DeviceContext.Get());
+
+                auto histogram = static_cast<CountedD2DEffect*>(effects.HistogramEffect.Get());
+                auto atlas = static_cast<CountedD2DEffect*>(effects.AtlasEffect.Get());
+
+                if (!histogram->UseExclusively() || !atlas->UseExclusively())
+                    ++sharedLeaseCount;
+
+                pool.Release(std::move(effects));
+                return true;
+            });
+
+        Assert::AreEqual(0, static_cast<int>(sharedLeaseCount));
+
+        auto statistics = pool.GetStatistics();
+
+        Assert::AreEqual<uint64_t>(threadCount * iterations, statistics.LeaseCount);
+        Assert::AreEqual<uint64_t>(statistics.LeaseCount, statistics.ReusedCount + statistics.CreatedCount);
+
+        // Everything that was created and not discarded is sitting in the pool.
+        Assert::AreEqual<uint64_t>(statistics.CreatedCount - statistics.DiscardedCount, pool.GetPooledCount());
+        Assert::IsTrue(pool.GetPooledCount() <= capacity);
+        Assert::AreEqual(static_cast<int>(pool.GetPooledCount() * 2), static_cast<int>(f.NumberOfActiveEffects));
+    }
+};
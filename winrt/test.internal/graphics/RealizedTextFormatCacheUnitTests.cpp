@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "mocks/MockDWriteFontCollection.h"
+#include "mocks/MockDWriteTextFormat.h"
+#include <lib/text/RealizedTextFormatCache.h>
+
+TEST_CLASS(RealizedTextFormatCacheUnitTests)
+{
+    static RealizedTextFormatKey MakeKey(
+        wchar_t const* fontFamilyName,
+        float fontSize = 12,
+        wchar_t const* uri = L"",
+        IDWriteFontCollection* fontCollection = nullptr)
+    {
+        RealizedTextFormatProperties properties{};
+        properties.FontSize = fontSize;
+
+        return RealizedTextFormatKey(
+            fontCollection,
+            WinString(uri),
+            WinString(fontFamilyName),
+            WinString(L"en-us"),
+            WinString(),
+            properties);
+    }
+
+    TEST_METHOD_EX(RealizedTextFormatKey_EqualityDependsOnAllProperties)
+    {
+        Assert::IsTrue(MakeKey(L"a") == MakeKey(L"a"));
+        Assert::AreEqual(MakeKey(L"a").GetHash(), MakeKey(L"a").GetHash());
+
+        Assert::IsTrue(MakeKey(L"a") != MakeKey(L"b"));
+        Assert::IsTrue(MakeKey(L"a") != MakeKey(L"a", 13));
+        Assert::IsTrue(MakeKey(L"a") != MakeKey(L"a", 12, L"uri"));
+
+        auto fontCollection = Make<MockDWriteFontCollection>();
+        Assert::IsTrue(MakeKey(L"a") != MakeKey(L"a", 12, L"", fontCollection.Get()));
+
+        Assert::IsFalse(MakeKey(L"a").UsesFontCollectionUri());
+        Assert::IsTrue(MakeKey(L"a", 12, L"uri").UsesFontCollectionUri());
+        Assert::IsFalse(MakeKey(L"a", 12, L"uri", fontCollection.Get()).UsesFontCollectionUri());
+    }
+
+    TEST_METHOD_EX(RealizedTextFormatCache_TryGet_ReturnsAddedFormat)
+    {
+        RealizedTextFormatCache cache;
+        auto textFormat = Make<MockDWriteTextFormat>();
+
+        Assert::IsNull(cache.TryGet(MakeKey(L"a")).Get());
+
+        auto added = cache.Add(MakeKey(L"a"), textFormat.Get());
+        Assert::IsTrue(IsSameInstance(textFormat.Get(), added.Get()));
+
+        Assert::IsTrue(IsSameInstance(textFormat.Get(), cache.TryGet(MakeKey(L"a")).Get()));
+        Assert::IsNull(cache.TryGet(MakeKey(L"a", 24)).Get());
+
+        auto stats = cache.GetStatistics();
+        Assert::AreEqual<uint64_t>(1, stats.HitCount);
+        Assert::AreEqual<uint64_t>(2, stats.MissCount);
+    }
+
+    TEST_METHOD_EX(RealizedTextFormatCache_Add_ReturnsExistingFormatForSameKey)
+    {
+        RealizedTextFormatCache cache;
+        auto firstFormat = Make<MockDWriteTextFormat>();
+        auto secondFormat = Make<MockDWriteTextFormat>();
+
+        cache.Add(MakeKey(L"a"), firstFormat.Get());
+        auto added = cache.Add(MakeKey(L"a"), secondFormat.Get());
+
+        Assert::IsTrue(IsSameInstance(firstFormat.Get(), added.Get()));
+        Assert::AreEqual<size_t>(1, cache.GetCount());
+    }
+
+    TEST_METHOD_EX(RealizedTextFormatCache_EvictsLeastRecentlyUsed)
+    {
+        RealizedTextFormatCache cache(2);
+        auto textFormat = Make<MockDWriteTextFormat>();
+
+        cache.Add(MakeKey(L"a"), textFormat.Get());
+        cache.Add(MakeKey(L"b"), textFormat.Get());
+
+        // Using "a" makes "b" the least recently used.
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).Get());
+
+        cache.Add(MakeKey(L"c"), textFormat.Get());
+
+        Assert::AreEqual<size_t>(2, cache.GetCount());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"a")).Get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"b")).Get());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"c")).Get());
+
+        Assert::AreEqual<uint64_t>(1, cache.GetStatistics().EvictedCount);
+
+        cache.SetCapacity(0);
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+
+        auto added = cache.Add(MakeKey(L"d"), textFormat.Get());
+        Assert::IsTrue(IsSameInstance(textFormat.Get(), added.Get()));
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+    }
+
+    TEST_METHOD_EX(RealizedTextFormatCache_InvalidateFontCollectionUris_RemovesOnlyFormatsLoadedFromUris)
+    {
+        RealizedTextFormatCache cache;
+        auto textFormat = Make<MockDWriteTextFormat>();
+        auto fontCollection = Make<MockDWriteFontCollection>();
+
+        cache.Add(MakeKey(L"system"), textFormat.Get());
+        cache.Add(MakeKey(L"fromUri", 12, L"uri"), textFormat.Get());
+        cache.Add(MakeKey(L"explicit", 12, L"uri", fontCollection.Get()), textFormat.Get());
+
+        cache.InvalidateFontCollectionUris();
+
+        Assert::AreEqual<size_t>(2, cache.GetCount());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"system")).Get());
+        Assert::IsNull(cache.TryGet(MakeKey(L"fromUri", 12, L"uri")).Get());
+        Assert::IsNotNull(cache.TryGet(MakeKey(L"explicit", 12, L"uri", fontCollection.Get())).Get());
+
+        Assert::AreEqual<uint64_t>(1, cache.GetStatistics().InvalidatedCount);
+    }
+};
@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include <lib/images/StagingBitmapRing.h>
+
+TEST_CLASS(StagingBitmapRingUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<MockD2DDeviceContext> DeviceContext;
+        std::vector<ComPtr<MockD2DBitmap>> CreatedBitmaps;
+
+        Fixture()
+            : DeviceContext(Make<MockD2DDeviceContext>())
+        {
+            DeviceContext->CreateBitmapMethod.AllowAnyCall(
+                [=] (D2D1_SIZE_U size, void const* sourceData, UINT32 pitch, D2D1_BITMAP_PROPERTIES1 const* properties, ID2D1Bitmap1** value)
+                {
+                    Assert::IsNull(sourceData);
+                    Assert::AreEqual(0U, pitch);
+                    Assert::AreEqual(D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW, properties->bitmapOptions);
+
+                    auto format = properties->pixelFormat;
+
+                    auto bitmap = Make<MockD2DBitmap>();
+                    bitmap->GetPixelSizeMethod.AllowAnyCall([=] { return size; });
+                    bitmap->GetPixelFormatMethod.AllowAnyCall([=] { return format; });
+
+                    CreatedBitmaps.push_back(bitmap);
+
+                    return bitmap.CopyTo(value);
+                });
+        }
+
+        StagingBitmapLease Acquire(std::shared_ptr<StagingBitmapRing> const& ring, uint32_t width = 16, uint32_t height = 16, DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM)
+        {
+            return ring->Acquire(DeviceContext.Get(), D2D1::SizeU(width, height), D2D1::PixelFormat(format, D2D1_ALPHA_MODE_PREMULTIPLIED));
+        }
+    };
+
+    TEST_METHOD_EX(StagingBitmapRing_ZeroDepth_Fails)
+    {
+        ExpectHResultException(E_INVALIDARG, [] { StagingBitmapRing ring(0); });
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Acquire_CreatesStagingBitmapOfRequestedSizeAndFormat)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>();
+
+        auto lease = f.Acquire(ring, 3, 5, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        Assert::AreEqual<size_t>(1, f.CreatedBitmaps.size());
+        Assert::IsTrue(IsSameInstance(f.CreatedBitmaps[0].Get(), lease.GetBitmap().Get()));
+
+        auto size = lease.GetBitmap()->GetPixelSize();
+        Assert::AreEqual(3U, size.width);
+        Assert::AreEqual(5U, size.height);
+        Assert::AreEqual(DXGI_FORMAT_R8G8B8A8_UNORM, lease.GetBitmap()->GetPixelFormat().format);
+
+        Assert::AreEqual(1U, ring->GetInUseCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Acquire_HandsOutSlotsInRingOrderAndReusesTheirBitmaps)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(3);
+
+        std::vector<ID2D1Bitmap1*> bitmaps;
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            auto lease = f.Acquire(ring);
+            Assert::AreEqual(i, lease.GetSlotIndex());
+            bitmaps.push_back(lease.GetBitmap().Get());
+        }
+
+        // Every slot has now been used once and released, so subsequent
+        // readbacks cycle through them without creating anything new.
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            auto lease = f.Acquire(ring);
+            Assert::AreEqual(i % 3, lease.GetSlotIndex());
+            Assert::IsTrue(IsSameInstance(bitmaps[i % 3], lease.GetBitmap().Get()));
+        }
+
+        Assert::AreEqual(3U, ring->GetCreatedCount());
+        Assert::AreEqual(0U, ring->GetInUseCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Acquire_SkipsSlotsThatAreStillInUse)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(3);
+
+        auto first = f.Acquire(ring);
+        auto second = f.Acquire(ring);
+        auto third = f.Acquire(ring);
+
+        second.Release();
+
+        auto fourth = f.Acquire(ring);
+
+        Assert::AreEqual(1U, fourth.GetSlotIndex());
+        Assert::AreEqual(3U, ring->GetInUseCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Acquire_WhenEverySlotIsInUse_Fails)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(2);
+
+        auto first = f.Acquire(ring);
+        auto second = f.Acquire(ring);
+
+        ExpectHResultException(E_ILLEGAL_METHOD_CALL, [&] { f.Acquire(ring); });
+
+        first.Release();
+
+        auto third = f.Acquire(ring);
+        Assert::AreEqual(0U, third.GetSlotIndex());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Acquire_ReusesLargerBitmapsOfTheSameFormat)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(1);
+
+        f.Acquire(ring, 16, 16);
+        f.Acquire(ring, 8, 16);
+        f.Acquire(ring, 16, 4);
+
+        Assert::AreEqual(1U, ring->GetCreatedCount());
+
+        // Larger than the existing bitmap.
+        f.Acquire(ring, 17, 16);
+        Assert::AreEqual(2U, ring->GetCreatedCount());
+
+        // Different format.
+        f.Acquire(ring, 16, 16, DXGI_FORMAT_R8G8B8A8_UNORM);
+        Assert::AreEqual(3U, ring->GetCreatedCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_WhenReuseIsDisabled_EveryAcquireCreatesANewBitmap)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(2);
+
+        auto lease = f.Acquire(ring);
+        ComPtr<ID2D1Bitmap1> leasedBitmap = lease.GetBitmap();
+        lease.Release();
+
+        ring->SetReuseStagingBitmaps(false);
+
+        // The ring dropped its idle bitmap, leaving only ours and the fixture's.
+        Assert::AreEqual(1UL, leasedBitmap.Reset());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            f.Acquire(ring);
+        }
+
+        Assert::AreEqual(5U, ring->GetCreatedCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_Close_DropsIdleBitmapsAndFailsFurtherAcquires)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(2);
+
+        f.Acquire(ring);
+        auto stillLeased = f.Acquire(ring);
+
+        ring->Close();
+
+        ExpectHResultException(RO_E_CLOSED, [&] { f.Acquire(ring); });
+
+        // The leased bitmap is still usable until it is released.
+        Assert::IsNotNull(stillLeased.GetBitmap().Get());
+        stillLeased.Release();
+
+        Assert::AreEqual(0U, ring->GetInUseCount());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_LeasesKeepTheRingAlive)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(1);
+        std::weak_ptr<StagingBitmapRing> weakRing = ring;
+
+        auto lease = f.Acquire(ring);
+        ring.reset();
+
+        Assert::IsFalse(weakRing.expired());
+
+        lease.Release();
+
+        Assert::IsTrue(weakRing.expired());
+    }
+
+    TEST_METHOD_EX(StagingBitmapRing_MovedLeaseReleasesItsSlotOnce)
+    {
+        Fixture f;
+        auto ring = std::make_shared<StagingBitmapRing>(2);
+
+        auto lease = f.Acquire(ring);
+        StagingBitmapLease moved(std::move(lease));
+
+        Assert::AreEqual(1U, ring->GetInUseCount());
+
+        lease.Release();
+        Assert::AreEqual(1U, ring->GetInUseCount());
+
+        moved = StagingBitmapLease();
+        Assert::AreEqual(0U, ring->GetInUseCount());
+    }
+};
@@ -0,0 +1,180 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+
+#include "mocks/MockDWriteTextFormat.h"
+#include "stubs/StubCanvasTextLayoutAdapter.h"
+#include <lib/text/CanvasTextLayout.h>
+#include <lib/text/TextLayoutCache.h>
+
+TEST_CLASS(TextLayoutCacheUnitTests)
+{
+    struct Fixture
+    {
+        ComPtr<StubCanvasDevice> Device;
+        ComPtr<MockDWriteTextFormat> TextFormat;
+        int WrapperCount;
+
+        Fixture()
+            : Device(Make<StubCanvasDevice>())
+            , TextFormat(Make<MockDWriteTextFormat>())
+            , WrapperCount(0)
+        {
+            CustomFontManagerAdapter::SetInstance(std::make_shared<StubCanvasTextLayoutAdapter>());
+        }
+
+        TextLayoutCacheKey MakeKey(wchar_t const* text, float requestedWidth = 100)
+        {
+            return TextLayoutCacheKey(WinString(text), TextFormat.Get(), requestedWidth, 50, CanvasDrawTextOptions::Default);
+        }
+
+        TextLayoutCache::WrapperFactory GetWrapperFactory()
+        {
+            return [=](IDWriteTextLayout* textLayout) -> ComPtr<ICanvasTextLayout>
+            {
+                ++WrapperCount;
+                return MakeWrapper(textLayout);
+            };
+        }
+
+        ComPtr<ICanvasTextLayout> MakeWrapper(IDWriteTextLayout* textLayout)
+        {
+            return Make<CanvasTextLayout>(Device.Get(), As<DWriteTextLayoutType>(textLayout).Get());
+        }
+
+        ComPtr<ICanvasTextLayout> Add(TextLayoutCache& cache, wchar_t const* text, uint64_t fontCollectionGeneration = 0)
+        {
+            auto textLayout = Make<StubTextLayout>();
+            auto wrapper = MakeWrapper(textLayout.Get());
+
+            return cache.Add(MakeKey(text), fontCollectionGeneration, textLayout.Get(), wrapper.Get());
+        }
+    };
+
+    TEST_METHOD_EX(TextLayoutCacheKey_EqualityDependsOnAllInputs)
+    {
+        Fixture f;
+
+        Assert::IsTrue(f.MakeKey(L"abc") == f.MakeKey(L"abc"));
+        Assert::AreEqual(f.MakeKey(L"abc").GetHash(), f.MakeKey(L"abc").GetHash());
+
+        Assert::IsTrue(f.MakeKey(L"abc") != f.MakeKey(L"abd"));
+        Assert::IsTrue(f.MakeKey(L"abc") != f.MakeKey(L"abc", 200));
+
+        auto otherFormat = Make<MockDWriteTextFormat>();
+        Assert::IsTrue(f.MakeKey(L"abc") != TextLayoutCacheKey(WinString(L"abc"), otherFormat.Get(), 100, 50, CanvasDrawTextOptions::Default));
+        Assert::IsTrue(f.MakeKey(L"abc") != TextLayoutCacheKey(WinString(L"abc"), f.TextFormat.Get(), 100, 50, CanvasDrawTextOptions::Clip));
+
+        Assert::AreEqual(3u, f.MakeKey(L"abc").GetTextLength());
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_TryGet_ReturnsAddedWrapper)
+    {
+        Fixture f;
+        TextLayoutCache cache;
+
+        Assert::IsNull(cache.TryGet(f.MakeKey(L"abc"), 0, f.GetWrapperFactory()).Get());
+
+        auto added = f.Add(cache, L"abc");
+
+        auto cached = cache.TryGet(f.MakeKey(L"abc"), 0, f.GetWrapperFactory());
+        Assert::IsTrue(IsSameInstance(added.Get(), cached.Get()));
+        Assert::AreEqual(0, f.WrapperCount);
+
+        auto stats = cache.GetStatistics();
+        Assert::AreEqual<uint64_t>(1, stats.HitCount);
+        Assert::AreEqual<uint64_t>(1, stats.MissCount);
+        Assert::AreEqual(TextLayoutCache::EstimateByteCount(3), stats.ByteCount);
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_TryGet_RewrapsLayoutWhenWrapperHasBeenReleased)
+    {
+        Fixture f;
+        TextLayoutCache cache;
+
+        auto textLayout = Make<StubTextLayout>();
+        auto wrapper = f.MakeWrapper(textLayout.Get());
+        cache.Add(f.MakeKey(L"abc"), 0, textLayout.Get(), wrapper.Get());
+        wrapper.Reset();
+
+        auto cached = cache.TryGet(f.MakeKey(L"abc"), 0, f.GetWrapperFactory());
+        Assert::IsNotNull(cached.Get());
+        Assert::AreEqual(1, f.WrapperCount);
+
+        Assert::IsTrue(IsSameInstance(textLayout.Get(), GetWrappedResource<IDWriteTextLayout>(cached).Get()));
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_Add_ReturnsExistingLiveWrapperForSameKey)
+    {
+        Fixture f;
+        TextLayoutCache cache;
+
+        auto first = f.Add(cache, L"abc");
+        auto second = f.Add(cache, L"abc");
+
+        Assert::IsTrue(IsSameInstance(first.Get(), second.Get()));
+        Assert::AreEqual<size_t>(1, cache.GetCount());
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_EvictsLeastRecentlyUsedToStayWithinBudget)
+    {
+        Fixture f;
+        TextLayoutCache cache(2 * TextLayoutCache::EstimateByteCount(1));
+
+        f.Add(cache, L"a");
+        f.Add(cache, L"b");
+
+        // Using "a" makes "b" the least recently used.
+        Assert::IsNotNull(cache.TryGet(f.MakeKey(L"a"), 0, f.GetWrapperFactory()).Get());
+
+        f.Add(cache, L"c");
+
+        Assert::AreEqual<size_t>(2, cache.GetCount());
+        Assert::IsNotNull(cache.TryGet(f.MakeKey(L"a"), 0, f.GetWrapperFactory()).Get());
+        Assert::IsNull(cache.TryGet(f.MakeKey(L"b"), 0, f.GetWrapperFactory()).Get());
+        Assert::IsNotNull(cache.TryGet(f.MakeKey(L"c"), 0, f.GetWrapperFactory()).Get());
+
+        auto stats = cache.GetStatistics();
+        Assert::AreEqual<uint64_t>(1, stats.EvictedCount);
+        Assert::AreEqual(2 * TextLayoutCache::EstimateByteCount(1), stats.ByteCount);
+
+        cache.SetMaximumByteCount(0);
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+        Assert::AreEqual<uint64_t>(0, cache.GetStatistics().ByteCount);
+
+        // Layouts that don't fit at all are still returned, just not cached.
+        Assert::IsNotNull(f.Add(cache, L"d").Get());
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_FontCollectionGenerationChange_DropsAllLayouts)
+    {
+        Fixture f;
+        TextLayoutCache cache;
+
+        f.Add(cache, L"a", 0);
+        f.Add(cache, L"b", 0);
+
+        Assert::IsNull(cache.TryGet(f.MakeKey(L"a"), 1, f.GetWrapperFactory()).Get());
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+        Assert::AreEqual<uint64_t>(0, cache.GetStatistics().ByteCount);
+
+        f.Add(cache, L"a", 1);
+        Assert::IsNotNull(cache.TryGet(f.MakeKey(L"a"), 1, f.GetWrapperFactory()).Get());
+    }
+
+    TEST_METHOD_EX(TextLayoutCache_Clear_RemovesEverything)
+    {
+        Fixture f;
+        TextLayoutCache cache;
+
+        f.Add(cache, L"a");
+        cache.Clear();
+
+        Assert::AreEqual<size_t>(0, cache.GetCount());
+        Assert::AreEqual<uint64_t>(0, cache.GetStatistics().ByteCount);
+        Assert::IsNull(cache.TryGet(f.MakeKey(L"a"), 0, f.GetWrapperFactory()).Get());
+    }
+};
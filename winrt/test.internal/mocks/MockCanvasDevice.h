@@ -52,11 +52,14 @@ namespace canvas
         CALL_COUNTER_WITH_MOCK(CreatePrintControlMethod, ComPtr<ID2D1PrintControl>(IPrintDocumentPackageTarget*, float));
         
         CALL_COUNTER_WITH_MOCK(GetResourceCreationDeviceContextMethod, DeviceContextLease());
+        CALL_COUNTER_WITH_MOCK(GetDeviceContextPoolMethod, DeviceContextPool*());
 
         CALL_COUNTER_WITH_MOCK(GetPrimaryDisplayOutputMethod, ComPtr<IDXGIOutput>());
 
         CALL_COUNTER_WITH_MOCK(LeaseHistogramEffectMethod, HistogramAndAtlasEffects(ID2D1DeviceContext*));
         CALL_COUNTER_WITH_MOCK(ReleaseHistogramEffectMethod, void(HistogramAndAtlasEffects));
+        CALL_COUNTER_WITH_MOCK(GetHistogramEffectPoolMethod, std::shared_ptr<HistogramEffectPool>());
+        CALL_COUNTER_WITH_MOCK(GetTextLayoutCacheMethod, std::shared_ptr<Text::TextLayoutCache>());
 
         CALL_COUNTER_WITH_MOCK(IsBufferPrecisionSupportedMethod, HRESULT(CanvasBufferPrecision, boolean*));
 
@@ -405,6 +408,21 @@ namespace canvas
             return ReleaseHistogramEffectMethod.WasCalled(effects);
         }
 
+        virtual DeviceContextPool* GetDeviceContextPool() override
+        {
+            return GetDeviceContextPoolMethod.WasCalled();
+        }
+
+        virtual std::shared_ptr<HistogramEffectPool> GetHistogramEffectPool() override
+        {
+            return GetHistogramEffectPoolMethod.WasCalled();
+        }
+
+        virtual std::shared_ptr<Text::TextLayoutCache> GetTextLayoutCache() override
+        {
+            return GetTextLayoutCacheMethod.WasCalled();
+        }
+
 #if WINVER > _WIN32_WINNT_WINBLUE
         virtual ComPtr<ID2D1GradientMesh> CreateGradientMesh(
             D2D1_GRADIENT_MESH_PATCH const* patches,
@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+namespace canvas
+{
+    class MockCanvasTriangleReceiver : public RuntimeClass<
+        RuntimeClassFlags<WinRtClassicComMix>,
+        ICanvasTriangleReceiver>
+    {
+    public:
+        CALL_COUNTER_WITH_MOCK(AddTrianglesMethod, HRESULT(UINT32, CanvasTriangleVertices*));
+
+        IFACEMETHODIMP AddTriangles(
+            UINT32 trianglesCount,
+            CanvasTriangleVertices* triangles) override
+        {
+            return AddTrianglesMethod.WasCalled(trianglesCount, triangles);
+        }
+    };
+}
@@ -24,6 +24,8 @@ namespace canvas
         ComPtr<MockD3D11Device> m_d3dDevice;
         ComPtr<MockEventSource<DeviceLostHandlerType>> m_deviceLostEventSource;
         DeviceContextPool m_deviceContextPool;
+        std::shared_ptr<Text::TextLayoutCache> m_textLayoutCache;
+        std::shared_ptr<HistogramEffectPool> m_histogramEffectPool;
         
     public:
         StubCanvasDevice(ComPtr<ID2D1Device1> device = Make<StubD2DDevice>(), ComPtr<MockD3D11Device> d3dDevice = nullptr)
@@ -31,6 +33,8 @@ namespace canvas
             , m_d3dDevice(d3dDevice)
             , m_deviceLostEventSource(Make<MockEventSource<DeviceLostHandlerType>>(L"DeviceLost"))
             , m_deviceContextPool(m_d2DDevice.Get())
+            , m_textLayoutCache(std::make_shared<Text::TextLayoutCache>())
+            , m_histogramEffectPool(std::make_shared<HistogramEffectPool>())
         {
             GetInterfaceMethod.AllowAnyCall();
             
@@ -60,6 +64,24 @@ namespace canvas
                     return m_deviceContextPool.TakeLease();
                 });
 
+            GetDeviceContextPoolMethod.AllowAnyCall(
+                [=]
+                {
+                    return &m_deviceContextPool;
+                });
+
+            GetTextLayoutCacheMethod.AllowAnyCall(
+                [=]
+                {
+                    return m_textLayoutCache;
+                });
+
+            GetHistogramEffectPoolMethod.AllowAnyCall(
+                [=]
+                {
+                    return m_histogramEffectPool;
+                });
+
             GetPrimaryDisplayOutputMethod.AllowAnyCall(
                 [=]
                 {
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+#include <chrono>
+
+//
+// Helpers for the benchmarks.  These aren't really unit tests - they time
+// some operation and write the results to the test log.  They do still
+// validate that the results are correct.
+//
+
+typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+inline double ElapsedMilliseconds(BenchmarkClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+// Formats a message, printf style, and writes it to the test log.
+inline void LogBenchmarkMessage(wchar_t const* format, ...)
+{
+    wchar_t message[256];
+
+    va_list args;
+    va_start(args, format);
+    auto hr = StringCchVPrintf(message, _countof(message), format, args);
+    va_end(args);
+
+    ThrowIfFailed(hr);
+
+    Logger::WriteMessage(message);
+}
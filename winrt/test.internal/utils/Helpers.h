@@ -1849,6 +1849,14 @@ namespace Microsoft
                    a.bottom == b.bottom;
         }
 
+        inline bool operator==(D2D1_RECT_U const& a, D2D1_RECT_U const& b)
+        {
+            return a.left == b.left &&
+                   a.top == b.top &&
+                   a.right == b.right &&
+                   a.bottom == b.bottom;
+        }
+
         inline bool operator==(D2D1_ROUNDED_RECT const& a, D2D1_ROUNDED_RECT const& b)
         {
             return a.rect == b.rect &&
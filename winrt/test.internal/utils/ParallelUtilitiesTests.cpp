@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+#include "../lib/utils/ParallelUtilities.h"
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+TEST_CLASS(ParallelUtilitiesTests)
+{
+    TEST_METHOD_EX(RunTasksInParallel_RunsFirstTaskOnCallingThread_AndEveryTaskOnce)
+    {
+        std::vector<std::atomic<int>> runCounts(5);
+        std::thread::id firstTaskThread;
+
+        RunTasksInParallel(5,
+            [&](uint32_t i)
+            {
+                if (i == 0)
+                    firstTaskThread = std::this_thread::get_id();
+
+                runCounts[i]++;
+            });
+
+        Assert::IsTrue(firstTaskThread == std::this_thread::get_id());
+
+        for (auto& count : runCounts)
+            Assert::AreEqual(1, count.load());
+    }
+
+    TEST_METHOD_EX(RunTasksInParallel_WhenTasksThrow_WaitsForAllThenRethrowsOne)
+    {
+        std::atomic<int> finishedCount(0);
+
+        ExpectHResultException(E_FAIL,
+            [&]
+            {
+                RunTasksInParallel(4,
+                    [&](uint32_t i)
+                    {
+                        finishedCount++;
+
+                        if (i % 2)
+                            ThrowHR(E_FAIL);
+                    });
+            });
+
+        Assert::AreEqual(4, finishedCount.load());
+    }
+
+    TEST_METHOD_EX(ForEachRangeInParallel_CoversEveryItemOnce_WithNoEmptyRanges)
+    {
+        for (uint32_t itemCount : { 0u, 1u, 7u, 100u })
+        {
+            for (uint32_t rangeCount : { 0u, 1u, 3u, 200u })
+            {
+                std::vector<std::atomic<int>> visitCounts(itemCount);
+
+                ForEachRangeInParallel(itemCount, rangeCount,
+                    [&](uint32_t begin, uint32_t end)
+                    {
+                        Assert::IsTrue(begin < end);
+
+                        for (auto i = begin; i < end; ++i)
+                            visitCounts[i]++;
+                    });
+
+                for (auto& count : visitCounts)
+                    Assert::AreEqual(1, count.load());
+            }
+        }
+    }
+};
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+#include "../lib/utils/PixelSwizzle.h"
+
+#include <random>
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+
+TEST_CLASS(PixelSwizzleTests)
+{
+    static std::vector<uint8_t> RandomBytes(size_t count)
+    {
+        std::mt19937 random(static_cast<uint32_t>(count));
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        std::vector<uint8_t> bytes(count);
+
+        for (auto& b : bytes)
+            b = static_cast<uint8_t>(byte(random));
+
+        return bytes;
+    }
+
+    // Destination byte i of each pixel comes from source byte order[i].
+    static void ValidatePixels(uint8_t const* source, uint8_t const* destination, size_t pixelCount, std::array<int, 4> const& order)
+    {
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+            {
+                Assert::AreEqual(source[i * 4 + order[j]], destination[i * 4 + j]);
+            }
+        }
+    }
+
+    static std::array<int, 4> GetExpectedOrder(PixelSwizzle swizzle)
+    {
+        switch (swizzle)
+        {
+        case PixelSwizzle::SwapRedBlue:  return { 2, 1, 0, 3 };
+        case PixelSwizzle::ReverseBytes: return { 3, 2, 1, 0 };
+        case PixelSwizzle::ArgbToRgba:   return { 1, 2, 3, 0 };
+        }
+
+        Assert::Fail();
+        return {};
+    }
+
+    static std::vector<PixelSwizzle> AllSwizzles()
+    {
+        return { PixelSwizzle::SwapRedBlue, PixelSwizzle::ReverseBytes, PixelSwizzle::ArgbToRgba };
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_SwizzlePixels_ReordersBytesAndWritesNothingElse)
+    {
+        // Counts either side of the vector widths, and a misaligned start, to
+        // exercise both the vector loops and the scalar tail.
+        for (auto swizzle : AllSwizzles())
+        {
+            for (size_t pixelCount : { 0, 1, 2, 3, 4, 5, 15, 16, 17, 31, 64, 1001 })
+            {
+                auto source = RandomBytes(pixelCount * 4 + 1);
+                std::vector<uint8_t> destination(pixelCount * 4 + 2, 0xCD);
+
+                SwizzlePixels(swizzle, source.data() + 1, destination.data() + 1, pixelCount);
+
+                ValidatePixels(source.data() + 1, destination.data() + 1, pixelCount, GetExpectedOrder(swizzle));
+
+                Assert::AreEqual<uint8_t>(0xCD, destination.front());
+                Assert::AreEqual<uint8_t>(0xCD, destination.back());
+            }
+        }
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_VectorAndScalarPathsAgree)
+    {
+        auto source = RandomBytes(4096 * 4);
+
+        for (auto swizzle : AllSwizzles())
+        {
+            std::vector<uint8_t> vector(source.size());
+            std::vector<uint8_t> scalar(source.size());
+
+            SwizzlePixels(swizzle, source.data(), vector.data(), 4096);
+            SwizzlePixelsScalar(swizzle, source.data(), scalar.data(), 4096);
+
+            Assert::IsTrue(vector == scalar);
+        }
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_InPlace)
+    {
+        for (auto swizzle : AllSwizzles())
+        {
+            auto original = RandomBytes(37 * 4);
+            auto pixels = original;
+
+            SwizzlePixels(swizzle, pixels.data(), pixels.data(), 37);
+
+            ValidatePixels(original.data(), pixels.data(), 37, GetExpectedOrder(swizzle));
+        }
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_ReverseBytesIsItsOwnInverse)
+    {
+        auto original = RandomBytes(100 * 4);
+        std::vector<uint8_t> converted(original.size());
+        std::vector<uint8_t> roundTripped(original.size());
+
+        SwizzlePixels(PixelSwizzle::ReverseBytes, original.data(), converted.data(), 100);
+        SwizzlePixels(PixelSwizzle::ReverseBytes, converted.data(), roundTripped.data(), 100);
+
+        Assert::IsTrue(original == roundTripped);
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_SwizzlePixelRows_HonorsStridesAndLeavesPaddingAlone)
+    {
+        // Includes a size large enough to be split across worker threads.
+        struct TestCase { uint32_t Width; uint32_t Height; } testCases[] =
+        {
+            { 0, 0 },
+            { 1, 1 },
+            { 7, 3 },
+            { 1001, 1200 },
+        };
+
+        for (auto swizzle : AllSwizzles())
+        {
+            for (auto testCase : testCases)
+            {
+                size_t sourceStride = testCase.Width * 4 + 12;
+                size_t destinationStride = testCase.Width * 4 + 8;
+
+                auto source = RandomBytes(sourceStride * testCase.Height);
+                std::vector<uint8_t> destination(destinationStride * testCase.Height, 0xCD);
+
+                SwizzlePixelRows(swizzle, source.data(), sourceStride, destination.data(), destinationStride, testCase.Width, testCase.Height);
+
+                for (uint32_t y = 0; y < testCase.Height; ++y)
+                {
+                    auto sourceRow = source.data() + y * sourceStride;
+                    auto destinationRow = destination.data() + y * destinationStride;
+
+                    ValidatePixels(sourceRow, destinationRow, testCase.Width, GetExpectedOrder(swizzle));
+
+                    for (auto padding = testCase.Width * 4; padding < destinationStride; ++padding)
+                        Assert::AreEqual<uint8_t>(0xCD, destinationRow[padding]);
+                }
+            }
+        }
+    }
+
+    TEST_METHOD_EX(PixelSwizzle_SwizzlePixelRows_PackedRows)
+    {
+        uint32_t const width = 1024;
+        uint32_t const height = 1024;
+
+        auto source = RandomBytes(width * height * 4);
+        std::vector<uint8_t> destination(source.size());
+
+        SwizzlePixelRows(PixelSwizzle::ReverseBytes, source.data(), width * 4, destination.data(), width * 4, width, height);
+
+        ValidatePixels(source.data(), destination.data(), width * height, GetExpectedOrder(PixelSwizzle::ReverseBytes));
+    }
+};
@@ -120,6 +120,25 @@ namespace
             return S_OK;
         }
     };
+
+
+    // A probe that never matches, counting how often it is asked.
+    int countingProbeCalls;
+
+    bool CountingProbe(ICanvasDevice*, IUnknown*, float, ComPtr<IInspectable>*)
+    {
+        countingProbeCalls++;
+        return false;
+    }
+
+
+    // Tester that only accepts one specific resource instance.
+    IDummyResource* specialResource;
+
+    bool IsSpecialResource(IDummyResource* resource)
+    {
+        return resource == specialResource;
+    }
 }
 
 
@@ -378,6 +397,147 @@ TEST_CLASS(ResourceManagerUnitTests)
         ValidateStoredErrorState(E_INVALIDARG, Strings::ResourceManagerWrongDpi);
     }
 
+    TEST_METHOD_EX(ResourceManager_GetOrCreate_RepeatedType_SkipsProbesThatAlreadyFailed)
+    {
+        countingProbeCalls = 0;
+
+        ResourceManager::RegisterType(CountingProbe);
+        auto restoreCountingProbe = MakeScopeWarden([&] { ResourceManager::UnregisterType(CountingProbe); });
+
+        auto tryCreateDummyResource = ResourceManager::TryCreate<IDummyResource, DummyWrapper, ResourceManager::MakeWrapper>;
+        ResourceManager::RegisterType(tryCreateDummyResource);
+        auto restoreTypeTable = MakeScopeWarden([&] { ResourceManager::UnregisterType(tryCreateDummyResource); });
+
+        // The first resource of this type has to go through every probe.
+        auto resource1 = Make<DummyResource>();
+        auto wrapper1 = ResourceManager::GetOrCreate<IDummyWrapper>(resource1.Get());
+        Assert::AreEqual(1, countingProbeCalls);
+
+        // Later ones go straight to the probe that worked last time.
+        for (int i = 0; i < 10; ++i)
+        {
+            auto resource = Make<DummyResource>();
+            auto wrapper = ResourceManager::GetOrCreate<IDummyWrapper>(resource.Get());
+            Assert::IsTrue(wrapper);
+        }
+
+        Assert::AreEqual(1, countingProbeCalls);
+    }
+
+    TEST_METHOD_EX(ResourceManager_GetOrCreateFromInterop_RepeatedType_RunsEveryProbe)
+    {
+        countingProbeCalls = 0;
+
+        ResourceManager::RegisterType(CountingProbe);
+        auto restoreCountingProbe = MakeScopeWarden([&] { ResourceManager::UnregisterType(CountingProbe); });
+
+        auto tryCreateDummyResource = ResourceManager::TryCreate<IDummyResource, DummyWrapper, ResourceManager::MakeWrapper>;
+        ResourceManager::RegisterType(tryCreateDummyResource);
+        auto restoreTypeTable = MakeScopeWarden([&] { ResourceManager::UnregisterType(tryCreateDummyResource); });
+
+        // Resources passed in by apps might not be implemented by D2D, so
+        // the type cache isn't used for them.
+        for (int i = 0; i < 10; ++i)
+        {
+            auto resource = Make<DummyResource>();
+            auto wrapper = ResourceManager::GetOrCreateFromInterop(nullptr, resource.Get(), 0);
+            Assert::IsTrue(wrapper);
+        }
+
+        Assert::AreEqual(10, countingProbeCalls);
+    }
+
+    TEST_METHOD_EX(ResourceManager_GetOrCreate_RepeatedType_StillRunsInstanceSpecificProbes)
+    {
+        auto tryCreateSpecial = ResourceManager::TryCreate<IDummyResource, DummyWrapperWithDevice, ResourceManager::MakeWrapperWithDevice, IsSpecialResource>;
+        ResourceManager::RegisterType(tryCreateSpecial, ResourceManager::InstanceSpecific);
+        auto restoreSpecial = MakeScopeWarden([&] { ResourceManager::UnregisterType(tryCreateSpecial); });
+
+        auto tryCreateDummyResource = ResourceManager::TryCreate<IDummyResource, DummyWrapper, ResourceManager::MakeWrapper>;
+        ResourceManager::RegisterType(tryCreateDummyResource);
+        auto restoreTypeTable = MakeScopeWarden([&] { ResourceManager::UnregisterType(tryCreateDummyResource); });
+
+        auto device = Make<StubCanvasDevice>();
+
+        auto ordinaryResource = Make<DummyResource>();
+        auto ordinaryWrapper = ResourceManager::GetOrCreate(device.Get(), ordinaryResource.Get(), 0);
+        Assert::IsFalse(MaybeAs<ICanvasResourceWrapperWithDevice>(ordinaryWrapper));
+
+        // The type cache now points at the plain DummyWrapper probe, but the
+        // instance specific probe before it must still get a chance.
+        auto special = Make<DummyResource>();
+        specialResource = special.Get();
+        auto clearSpecial = MakeScopeWarden([&] { specialResource = nullptr; });
+
+        auto specialWrapper = ResourceManager::GetOrCreate(device.Get(), special.Get(), 0);
+        Assert::IsTrue(MaybeAs<ICanvasResourceWrapperWithDevice>(specialWrapper));
+    }
+
+    TEST_METHOD_EX(ResourceManager_ConcurrentGetOrCreate_AllThreadsSeeTheSameWrappers)
+    {
+        auto tryCreateDummyResource = ResourceManager::TryCreate<IDummyResource, DummyWrapper, ResourceManager::MakeWrapper>;
+        ResourceManager::RegisterType(tryCreateDummyResource);
+        auto restoreTypeTable = MakeScopeWarden([&] { ResourceManager::UnregisterType(tryCreateDummyResource); });
+
+        int const threadCount = 8;
+        int const resourceCount = 500;
+
+        std::vector<ComPtr<DummyResource>> resources;
+        for (int i = 0; i < resourceCount; ++i)
+            resources.push_back(Make<DummyResource>());
+
+        std::vector<std::vector<ComPtr<IDummyWrapper>>> wrappers(threadCount);
+        std::atomic<int> failures(0);
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                while (!start)
+                    std::this_thread::yield();
+
+                try
+                {
+                    // Each thread walks the resources in a different order, and
+                    // also wraps and releases some resources of its own.
+                    for (int i = 0; i < resourceCount; ++i)
+                    {
+                        auto& resource = resources[(i * 7 + t * 61) % resourceCount];
+                        wrappers[t].push_back(ResourceManager::GetOrCreate<IDummyWrapper>(resource.Get()));
+
+                        auto privateResource = Make<DummyResource>();
+                        auto privateWrapper = ResourceManager::GetOrCreate<IDummyWrapper>(privateResource.Get());
+
+                        if (!IsSameInstance(privateWrapper.Get(), ResourceManager::GetOrCreate<IDummyWrapper>(privateResource.Get()).Get()))
+                            ++failures;
+                    }
+                }
+                catch (...)
+                {
+                    ++failures;
+                }
+            });
+        }
+
+        start = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        Assert::AreEqual(0, static_cast<int>(failures));
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            for (int i = 0; i < resourceCount; ++i)
+            {
+                auto expected = ResourceManager::GetOrCreate<IDummyWrapper>(resources[(i * 7 + t * 61) % resourceCount].Get());
+                Assert::AreEqual(expected.Get(), wrappers[t][i].Get());
+            }
+        }
+    }
+
     TEST_METHOD_EX(ResourceManager_GetOrCreate_UnknownType_Fails)
     {
         // For this test we do NOT register IDummyResource via ResourceManager::RegisterType.
@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#include "pch.h"
+#include "../lib/utils/SpriteTransforms.h"
+
+#include <random>
+#include <WindowsNumerics.h>
+
+using namespace ABI::Microsoft::Graphics::Canvas;
+using namespace Windows::Foundation::Numerics;
+
+TEST_CLASS(SpriteTransformsTests)
+{
+    struct TestData
+    {
+        std::vector<float> Offsets;
+        std::vector<float> Origins;
+        std::vector<float> Rotations;
+        std::vector<float> Scales;
+
+        TestData(uint32_t count)
+        {
+            std::mt19937 random(count);
+            std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+            std::uniform_real_distribution<float> angle(-20.0f, 20.0f);
+            std::uniform_real_distribution<float> scale(-4.0f, 4.0f);
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Offsets.push_back(position(random));
+                Offsets.push_back(position(random));
+                Origins.push_back(position(random));
+                Origins.push_back(position(random));
+                Rotations.push_back(angle(random));
+                Scales.push_back(scale(random));
+                Scales.push_back(scale(random));
+            }
+        }
+
+        SpriteTransformInputs Inputs() const
+        {
+            SpriteTransformInputs inputs{};
+            inputs.Count = static_cast<uint32_t>(Rotations.size());
+            inputs.Offsets = Offsets.data();
+            inputs.Origins = Origins.data();
+            inputs.Rotations = Rotations.data();
+            inputs.Scales = Scales.data();
+            return inputs;
+        }
+
+        // The same composition the single sprite CanvasSpriteBatch methods use
+        float3x2 Expected(uint32_t i) const
+        {
+            return
+                make_float3x2_translation(-Origins[i * 2], -Origins[i * 2 + 1]) *
+                make_float3x2_rotation(Rotations[i]) *
+                make_float3x2_scale(Scales[i * 2], Scales[i * 2 + 1]) *
+                make_float3x2_translation(Offsets[i * 2], Offsets[i * 2 + 1]);
+        }
+    };
+
+    // Output with padding between the matrices, to check that the stride is
+    // honored and nothing is written outside the matrices.
+    struct PaddedTransform
+    {
+        float3x2 Transform;
+        float Padding;
+    };
+
+    static std::vector<PaddedTransform> Compute(SpriteTransformInputs const& inputs, SinCosMode mode)
+    {
+        std::vector<PaddedTransform> results(inputs.Count);
+
+        for (auto& result : results)
+            result.Padding = 12345.0f;
+
+        if (inputs.Count > 0)
+            ComputeSpriteTransforms(inputs, mode, &results[0].Transform.m11, sizeof(PaddedTransform));
+
+        for (auto& result : results)
+            Assert::AreEqual(12345.0f, result.Padding);
+
+        return results;
+    }
+
+    static void AssertClose(float3x2 const& expected, float3x2 const& actual, float tolerance)
+    {
+        float const* e = &expected.m11;
+        float const* a = &actual.m11;
+
+        for (int i = 0; i < 6; ++i)
+        {
+            // The translation terms are sums of products of positions (up to
+            // 500) and scales (up to 4), so errors there are proportionally
+            // larger than in the rotation / scale terms.
+            auto scaledTolerance = tolerance * (i < 4 ? 4.0f : 4000.0f);
+            Assert::AreEqual(e[i], a[i], scaledTolerance);
+        }
+    }
+
+    TEST_METHOD_EX(SpriteTransforms_Accurate_MatchesMatrixComposition)
+    {
+        // Cover counts that are, and aren't, multiples of the four and eight
+        // wide vector paths
+        for (uint32_t count = 0; count <= 21; ++count)
+        {
+            TestData data(count);
+            auto results = Compute(data.Inputs(), SinCosMode::Accurate);
+
+            for (uint32_t i = 0; i < count; ++i)
+                AssertClose(data.Expected(i), results[i].Transform, 1e-5f);
+        }
+    }
+
+    TEST_METHOD_EX(SpriteTransforms_Fast_IsCloseToMatrixComposition)
+    {
+        TestData data(64);
+        auto results = Compute(data.Inputs(), SinCosMode::Fast);
+
+        for (uint32_t i = 0; i < 64; ++i)
+            AssertClose(data.Expected(i), results[i].Transform, 1e-3f);
+    }
+
+    TEST_METHOD_EX(SpriteTransforms_VectorAndScalarPathsAgree)
+    {
+        for (auto mode : { SinCosMode::Accurate, SinCosMode::Fast })
+        {
+            // Eight sprites for the AVX2 path (if supported), then four for
+            // the DirectXMath one.
+            TestData data(12);
+            auto results = Compute(data.Inputs(), mode);
+
+            for (uint32_t i = 0; i < 12; ++i)
+            {
+                float3x2 scalar;
+                ComputeSpriteTransform(
+                    data.Offsets[i * 2], data.Offsets[i * 2 + 1],
+                    data.Origins[i * 2], data.Origins[i * 2 + 1],
+                    data.Rotations[i],
+                    data.Scales[i * 2], data.Scales[i * 2 + 1],
+                    mode,
+                    &scalar.m11);
+
+                AssertClose(scalar, results[i].Transform, 1e-5f);
+            }
+        }
+    }
+
+    TEST_METHOD_EX(SpriteTransforms_OptionalInputsDefaultToIdentity)
+    {
+        TestData data(6);
+
+        SpriteTransformInputs inputs{};
+        inputs.Count = 6;
+        inputs.Offsets = data.Offsets.data();
+
+        for (auto mode : { SinCosMode::Accurate, SinCosMode::Fast })
+        {
+            auto results = Compute(inputs, mode);
+
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                auto expected = make_float3x2_translation(data.Offsets[i * 2], data.Offsets[i * 2 + 1]);
+                AssertClose(expected, results[i].Transform, 0.0f);
+            }
+        }
+    }
+};
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// Licensed under the MIT License. See LICENSE.txt in the project root for license information.
+
+#pragma once
+
+//
+// Helpers for the pool stress tests, which hammer a pool from many threads
+// and check that nothing it hands out is ever used by two threads at once.
+//
+// Test failures are counted rather than asserted on the worker threads, and
+// checked once they have finished.
+//
+
+// Runs 'threadCount' threads, each calling 'body' until it returns false or
+// 'iterations' is reached.  The threads are started together, to make them
+// more likely to contend with each other.
+template<typename FN>
+void RunOnThreads(int threadCount, int iterations, FN&& body)
+{
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&]
+            {
+                while (!start)
+                    std::this_thread::yield();
+
+                for (int i = 0; i < iterations; ++i)
+                {
+                    if (!body())
+                        break;
+                }
+            });
+    }
+
+    start = true;
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+
+// Mixed into mock objects handed out by a pool, to count how many are alive
+// and to spot any that are used by more than one thread at a time.
+class PooledObjectTracker
+{
+    std::atomic<int>* m_liveCount;
+    std::atomic<int> m_users;
+
+public:
+    PooledObjectTracker(std::atomic<int>* liveCount)
+        : m_liveCount(liveCount)
+        , m_users(0)
+    {
+        (*m_liveCount)++;
+    }
+
+    virtual ~PooledObjectTracker()
+    {
+        (*m_liveCount)--;
+    }
+
+    // Uses the object for a moment.  Returns false if another thread was
+    // using it at the same time.
+    bool UseExclusively()
+    {
+        bool isExclusive = (++m_users == 1);
+        std::this_thread::yield();
+        --m_users;
+        return isExclusive;
+    }
+};